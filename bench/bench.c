@@ -0,0 +1,305 @@
+/**
+ * XScrabble - Microbenchmark Harness Implementation
+ *
+ * Each case is calibrated so that a timed sample takes a few microseconds,
+ * then sampled until the minimum run time is reached. Percentiles are taken
+ * over the per-operation latency of the samples.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "bench.h"
+#include "config.h"
+
+#define MAX_RESULTS 128
+#define MAX_SAMPLES 200000
+#define TARGET_SAMPLE_NS 2000.0
+#define MAX_BATCH (1u << 20)
+#define DEFAULT_SEED 20250312u
+#define DEFAULT_MIN_TIME 0.25
+
+/* Harness configuration */
+static const char *suite_name = "bench";
+static const char *json_path = NULL;
+static const char *name_filter = NULL;
+static uint64_t seed = DEFAULT_SEED;
+static double min_time = DEFAULT_MIN_TIME;
+static FILE *report = NULL;
+
+/* Collected results */
+static BenchResult results[MAX_RESULTS];
+static int result_count = 0;
+static double samples[MAX_SAMPLES];
+static volatile uint64_t sink;
+
+/*
+ * Allocation accounting. glibc lets a program replace malloc and friends,
+ * so the harness forwards to the libc implementation and counts the calls,
+ * including the ones made internally by strdup() and fopen().
+ */
+#if defined(__GLIBC__)
+#define BENCH_COUNTS_ALLOCATIONS 1
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static uint64_t alloc_count = 0;
+static uint64_t alloc_bytes = 0;
+
+static void count_allocation(size_t size)
+{
+    __atomic_fetch_add(&alloc_count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&alloc_bytes, size, __ATOMIC_RELAXED);
+}
+
+void *malloc(size_t size)
+{
+    count_allocation(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    count_allocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    count_allocation(size);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    __libc_free(ptr);
+}
+#else
+#define BENCH_COUNTS_ALLOCATIONS 0
+static uint64_t alloc_count = 0;
+static uint64_t alloc_bytes = 0;
+#endif
+
+/* Current monotonic time in nanoseconds */
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static uint64_t read_counter(uint64_t *counter)
+{
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+static int compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Nearest-rank percentile of a sorted sample array */
+static double percentile(const double *sorted, int count, double p)
+{
+    int rank = (int)(p * (count - 1) + 0.5);
+    if (rank < 0) rank = 0;
+    if (rank >= count) rank = count - 1;
+    return sorted[rank];
+}
+
+static void print_usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [--json FILE] [--seed N] [--min-time SECONDS] [--filter TEXT]\n",
+            program);
+}
+
+/* Parse the common benchmark options */
+bool bench_init(const char *suite, int argc, char *argv[])
+{
+    suite_name = suite;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            min_time = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            name_filter = argv[++i];
+        }
+        else {
+            print_usage(argv[0]);
+            return false;
+        }
+    }
+
+    /* Discard library chatter so stdout carries only the report */
+    fflush(stdout);
+    int fd = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    report = fd >= 0 ? fdopen(fd, "w") : NULL;
+    if (report && null_fd >= 0) {
+        dup2(null_fd, STDOUT_FILENO);
+    }
+    if (null_fd >= 0) {
+        close(null_fd);
+    }
+
+    fprintf(stderr, "%-36s %12s %14s %10s %10s %10s %9s\n",
+            suite_name, "ns/op", "ops/sec", "p50", "p90", "p99", "allocs/op");
+    return true;
+}
+
+/* Check whether a case passes the name filter */
+bool bench_enabled(const char *name)
+{
+    return !name_filter || strstr(name, name_filter) != NULL;
+}
+
+/* Calibrate, sample and record one benchmark case */
+void bench_run(const char *name, BenchFunction function, void *context)
+{
+    if (!bench_enabled(name) || result_count == MAX_RESULTS) {
+        return;
+    }
+
+    uint64_t iteration = 0;
+
+    /* Grow the batch until one sample is long enough to time reliably */
+    uint32_t batch = 1;
+    while (batch < MAX_BATCH) {
+        double start = now_ns();
+        for (uint32_t i = 0; i < batch; i++) {
+            function(context, iteration++);
+        }
+        if (now_ns() - start >= TARGET_SAMPLE_NS) {
+            break;
+        }
+        batch *= 2;
+    }
+
+    /* Timed run */
+    uint64_t allocs_before = read_counter(&alloc_count);
+    uint64_t bytes_before = read_counter(&alloc_bytes);
+    double deadline = now_ns() + min_time * 1e9;
+    double total_ns = 0.0;
+    int count = 0;
+
+    while (count < MAX_SAMPLES && (count < 8 || now_ns() < deadline)) {
+        double start = now_ns();
+        for (uint32_t i = 0; i < batch; i++) {
+            function(context, iteration++);
+        }
+        double elapsed = now_ns() - start;
+        total_ns += elapsed;
+        samples[count++] = elapsed / batch;
+    }
+
+    uint64_t allocs = read_counter(&alloc_count) - allocs_before;
+    uint64_t bytes = read_counter(&alloc_bytes) - bytes_before;
+
+    /* Summarize */
+    BenchResult *result = &results[result_count++];
+    uint64_t operations = (uint64_t)count * batch;
+
+    qsort(samples, count, sizeof(samples[0]), compare_doubles);
+    snprintf(result->name, sizeof(result->name), "%s", name);
+    result->operations = operations;
+    result->ns_per_op = total_ns / operations;
+    result->ops_per_sec = result->ns_per_op > 0.0 ? 1e9 / result->ns_per_op : 0.0;
+    result->p50_ns = percentile(samples, count, 0.50);
+    result->p90_ns = percentile(samples, count, 0.90);
+    result->p99_ns = percentile(samples, count, 0.99);
+    result->min_ns = samples[0];
+    result->max_ns = samples[count - 1];
+    result->allocs_per_op = BENCH_COUNTS_ALLOCATIONS ? (double)allocs / operations : -1.0;
+    result->bytes_per_op = BENCH_COUNTS_ALLOCATIONS ? (double)bytes / operations : -1.0;
+
+    fprintf(stderr, "%-36s %12.1f %14.0f %10.1f %10.1f %10.1f %9.2f\n",
+            result->name, result->ns_per_op, result->ops_per_sec,
+            result->p50_ns, result->p90_ns, result->p99_ns, result->allocs_per_op);
+}
+
+/* Write all results as a JSON document */
+static void write_json(FILE *out)
+{
+    fprintf(out, "{\n");
+    fprintf(out, "  \"suite\": \"%s\",\n", suite_name);
+    fprintf(out, "  \"version\": \"%s\",\n", GAME_VERSION);
+    fprintf(out, "  \"seed\": %llu,\n", (unsigned long long)seed);
+    fprintf(out, "  \"min_time_s\": %.3f,\n", min_time);
+    fprintf(out, "  \"results\": [\n");
+
+    for (int i = 0; i < result_count; i++) {
+        const BenchResult *r = &results[i];
+        fprintf(out, "    {\"name\": \"%s\", \"operations\": %llu, "
+                "\"ns_per_op\": %.3f, \"ops_per_sec\": %.1f, "
+                "\"p50_ns\": %.3f, \"p90_ns\": %.3f, \"p99_ns\": %.3f, "
+                "\"min_ns\": %.3f, \"max_ns\": %.3f, "
+                "\"allocs_per_op\": %.4f, \"bytes_per_op\": %.2f}%s\n",
+                r->name, (unsigned long long)r->operations,
+                r->ns_per_op, r->ops_per_sec,
+                r->p50_ns, r->p90_ns, r->p99_ns, r->min_ns, r->max_ns,
+                r->allocs_per_op, r->bytes_per_op,
+                i + 1 < result_count ? "," : "");
+    }
+
+    fprintf(out, "  ]\n}\n");
+}
+
+/* Emit the JSON report; returns a process exit status */
+int bench_finish(void)
+{
+    if (!json_path) {
+        write_json(report ? report : stdout);
+        if (report && fclose(report) != 0) {
+            fprintf(stderr, "Failed to write the report\n");
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    FILE *file = fopen(json_path, "w");
+    if (!file) {
+        fprintf(stderr, "Failed to open %s for writing\n", json_path);
+        return EXIT_FAILURE;
+    }
+    write_json(file);
+    if (fclose(file) != 0) {
+        fprintf(stderr, "Failed to write %s\n", json_path);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/* Base seed for reproducible positions */
+uint64_t bench_seed(void)
+{
+    return seed;
+}
+
+/* splitmix64 step */
+uint64_t bench_random(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+void bench_consume(uint64_t value)
+{
+    sink += value;
+}
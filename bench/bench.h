@@ -0,0 +1,43 @@
+/**
+ * XScrabble - Microbenchmark Harness Definitions
+ */
+
+#ifndef XSCRABBLE_BENCH_H
+#define XSCRABBLE_BENCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* A benchmark body runs one operation; iteration counts up from zero */
+typedef void (*BenchFunction)(void *context, uint64_t iteration);
+
+/* Summary of a single benchmark case */
+typedef struct {
+    char name[64];
+    uint64_t operations;        /* Total timed operations */
+    double ns_per_op;           /* Mean latency */
+    double ops_per_sec;         /* Throughput */
+    double p50_ns;              /* Per-operation latency percentiles */
+    double p90_ns;
+    double p99_ns;
+    double min_ns;
+    double max_ns;
+    double allocs_per_op;       /* Heap allocations per operation (-1 if unknown) */
+    double bytes_per_op;        /* Heap bytes requested per operation (-1 if unknown) */
+} BenchResult;
+
+/* Function prototypes */
+bool bench_init(const char *suite, int argc, char *argv[]);
+int bench_finish(void);
+void bench_run(const char *name, BenchFunction function, void *context);
+bool bench_enabled(const char *name);
+
+/* Reproducible pseudo-random numbers for seeded positions */
+uint64_t bench_seed(void);
+uint64_t bench_random(uint64_t *state);
+
+/* Sink that keeps results of benchmarked calls from being optimized away */
+void bench_consume(uint64_t value);
+
+#endif /* XSCRABBLE_BENCH_H */
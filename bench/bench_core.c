@@ -0,0 +1,405 @@
+/**
+ * XScrabble - Core Benchmarks
+ *
+ * Dictionary and DAWG lookups on the full OSPD3 list, board placement,
+ * move generation and game scoring. Run from the top of the source tree so the word list is found.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "bench.h"
+#include "board.h"
+#include "dawg.h"
+#include "dictionary.h"
+#include "game.h"
+#include "movegen.h"
+#include "record.h"
+#include "tiles.h"
+
+#define BENCH_WORDLIST "data/dictionaries/extracted/OSPD3.txt"
+#define QUERY_COUNT 4096
+#define WORD_BUFFER 32
+#define MIDGAME_PLIES 6
+#define REPLAY_GAMES 8
+
+/* Words read from the list, used to build hit and miss queries */
+static char (*words)[WORD_BUFFER] = NULL;
+static int word_total = 0;
+
+/* Query mixes */
+typedef struct {
+    char queries[QUERY_COUNT][WORD_BUFFER];
+} QuerySet;
+
+static QuerySet hit_queries;
+static QuerySet miss_queries;
+static QuerySet mixed_queries;
+
+/* Seeded board placements */
+typedef struct {
+    int row;
+    int col;
+    int down;
+    int length;
+    char letters[7];
+} Placement;
+
+static Placement placements[QUERY_COUNT];
+
+/* Move generation context */
+typedef struct {
+    Dawg *dawg;
+    MoveList moves;
+    char rack[RACK_SIZE + 1];
+} MovegenBench;
+
+/* Recorded greedy games for the replay case */
+static GameRecord replay_records[REPLAY_GAMES];
+
+/* Graph lexicon shared by the DAWG and move generation cases */
+static Dawg *lexicon = NULL;
+
+static int compare_words(const void *a, const void *b)
+{
+    return strcmp((const char *)a, (const char *)b);
+}
+
+/* Load the word list into a sorted array */
+static bool load_words(const char *filename)
+{
+    FILE *file = fopen(filename, "r");
+    if (!file) {
+        return false;
+    }
+
+    int capacity = 1024;
+    words = malloc(capacity * sizeof(*words));
+    char buffer[WORD_BUFFER];
+
+    while (words && fgets(buffer, sizeof(buffer), file)) {
+        size_t len = strcspn(buffer, "\r\n");
+        buffer[len] = '\0';
+        if (len == 0) {
+            continue;
+        }
+        if (word_total == capacity) {
+            capacity *= 2;
+            words = realloc(words, capacity * sizeof(*words));
+            if (!words) {
+                break;
+            }
+        }
+        for (size_t i = 0; i < len; i++) {
+            buffer[i] = tolower((unsigned char)buffer[i]);
+        }
+        memcpy(words[word_total++], buffer, len + 1);
+    }
+
+    fclose(file);
+    if (!words) {
+        return false;
+    }
+    qsort(words, word_total, sizeof(*words), compare_words);
+    return word_total > 0;
+}
+
+static bool is_listed(const char *word)
+{
+    return bsearch(word, words, word_total, sizeof(*words), compare_words) != NULL;
+}
+
+/* Build a non-word by changing one letter of a real word, like a typo */
+static void make_miss(char *out, uint64_t *rng)
+{
+    do {
+        const char *word = words[bench_random(rng) % word_total];
+        size_t len = strlen(word);
+        strcpy(out, word);
+        out[bench_random(rng) % len] = 'a' + bench_random(rng) % 26;
+    } while (is_listed(out));
+}
+
+static void build_queries(void)
+{
+    uint64_t rng = bench_seed();
+
+    for (int i = 0; i < QUERY_COUNT; i++) {
+        strcpy(hit_queries.queries[i], words[bench_random(&rng) % word_total]);
+        make_miss(miss_queries.queries[i], &rng);
+        if (bench_random(&rng) & 1) {
+            strcpy(mixed_queries.queries[i], words[bench_random(&rng) % word_total]);
+        } else {
+            make_miss(mixed_queries.queries[i], &rng);
+        }
+    }
+}
+
+/* Random straight placements that stay on the board */
+static void build_placements(void)
+{
+    uint64_t rng = bench_seed() ^ 0x5c7ab61eULL;
+
+    for (int i = 0; i < QUERY_COUNT; i++) {
+        Placement *p = &placements[i];
+        p->length = 1 + bench_random(&rng) % 7;
+        p->down = bench_random(&rng) & 1;
+        int along = bench_random(&rng) % (board_size() - p->length + 1);
+        int across = bench_random(&rng) % board_size();
+        p->row = p->down ? along : across;
+        p->col = p->down ? across : along;
+        for (int j = 0; j < p->length; j++) {
+            p->letters[j] = 'A' + bench_random(&rng) % 26;
+        }
+    }
+}
+
+static void place(const Placement *p)
+{
+    for (int j = 0; j < p->length; j++) {
+        int row = p->row + (p->down ? j : 0);
+        int col = p->col + (p->down ? 0 : j);
+        board_place_tile(row, col, p->letters[j]);
+    }
+}
+
+/* Benchmark bodies */
+
+static void bench_dictionary_load(void *context, uint64_t iteration)
+{
+    (void)iteration;
+    bench_consume(dictionary_load_file((const char *)context));
+}
+
+static void bench_is_word(void *context, uint64_t iteration)
+{
+    const QuerySet *set = (const QuerySet *)context;
+    bench_consume(dictionary_is_word(set->queries[iteration % QUERY_COUNT]));
+}
+
+static void bench_board_place_revert(void *context, uint64_t iteration)
+{
+    (void)context;
+    place(&placements[iteration % QUERY_COUNT]);
+    board_revert_word();
+}
+
+static void bench_board_place_commit(void *context, uint64_t iteration)
+{
+    (void)context;
+    if (iteration % 16 == 0) {
+        board_init();
+    }
+    place(&placements[iteration % QUERY_COUNT]);
+    board_commit_word();
+}
+
+static void bench_game_evaluate(void *context, uint64_t iteration)
+{
+    (void)context;
+    place(&placements[iteration % QUERY_COUNT]);
+    bench_consume(game_evaluate_move());
+    board_revert_word();
+}
+
+static void bench_dawg_load(void *context, uint64_t iteration)
+{
+    (void)iteration;
+    Dawg *dawg = dawg_load((const char *)context);
+    bench_consume(dawg != NULL);
+    dawg_free(dawg);
+}
+
+static void bench_dawg_load_parallel(void *context, uint64_t iteration)
+{
+    (void)iteration;
+    Dawg *dawg = dawg_load_parallel((const char *)context, 0);
+    bench_consume(dawg != NULL);
+    dawg_free(dawg);
+}
+
+static void bench_dawg_contains(void *context, uint64_t iteration)
+{
+    const QuerySet *set = (const QuerySet *)context;
+    bench_consume(dawg_contains(lexicon, set->queries[iteration % QUERY_COUNT]));
+}
+
+static void bench_movegen(void *context, uint64_t iteration)
+{
+    MovegenBench *mb = (MovegenBench *)context;
+    (void)iteration;
+    bench_consume(movegen_generate(mb->dawg, mb->rack, &mb->moves));
+}
+
+static void bench_movegen_top1(void *context, uint64_t iteration)
+{
+    MovegenBench *mb = (MovegenBench *)context;
+    Move best;
+    (void)iteration;
+    bench_consume(movegen_top_k(mb->dawg, mb->rack, &best, 1));
+}
+
+static void bench_movegen_top10(void *context, uint64_t iteration)
+{
+    MovegenBench *mb = (MovegenBench *)context;
+    Move best[10];
+    (void)iteration;
+    bench_consume(movegen_top_k(mb->dawg, mb->rack, best, 10));
+}
+
+static void bench_game_score_move(void *context, uint64_t iteration)
+{
+    const MovegenBench *mb = (const MovegenBench *)context;
+    bench_consume(game_score_move(&mb->moves.moves[iteration % mb->moves.count]));
+}
+
+static void bench_record_replay(void *context, uint64_t iteration)
+{
+    const GameRecord *record = &replay_records[iteration % REPLAY_GAMES];
+    RecordReader reader;
+    (void)context;
+    record_reader_open(&reader, record->data, record->size);
+    bench_consume(record_replay(&reader, -1));
+}
+
+static void bench_play_unplay(void *context, uint64_t iteration)
+{
+    const MovegenBench *mb = (const MovegenBench *)context;
+    bench_consume(game_play_move(&mb->moves.moves[iteration % mb->moves.count]));
+    game_unplay_move();
+}
+
+static void bench_snapshot_restore(void *context, uint64_t iteration)
+{
+    static GameSnapshot snapshot;
+    (void)context;
+    (void)iteration;
+    game_snapshot(&snapshot);
+    game_restore(&snapshot);
+    bench_consume(snapshot.hash);
+}
+
+/* Record greedy games to replay */
+static void record_games(MovegenBench *mb)
+{
+    GameState *state = game_get_state();
+    uint64_t rng = bench_seed();
+
+    for (int i = 0; i < REPLAY_GAMES; i++) {
+        GameRecord *record = &replay_records[i];
+        record_init(record);
+        game_new(bench_random(&rng));
+        record_begin(record, "OSPD3", state);
+        while (!game_is_over()) {
+            int player = state->to_move;
+            Move pass = {0};
+            pass.type = MOVE_PASS;
+            movegen_generate(mb->dawg, state->racks[player], &mb->moves);
+            const Move *move = movegen_best(&mb->moves);
+            if (!move) {
+                move = &pass;
+            }
+            game_play_move(move);
+            record_add_move(record, player, move, state->last_drawn);
+        }
+        record_finish(record, state->scores);
+    }
+}
+
+/* Deal a seeded game and play greedy moves into the middle game */
+static void setup_position(MovegenBench *mb, int plies)
+{
+    GameState *state = game_get_state();
+    game_new(bench_seed());
+    for (int i = 0; i < plies && !game_is_over(); i++) {
+        movegen_generate(mb->dawg, state->racks[state->to_move], &mb->moves);
+        const Move *best = movegen_best(&mb->moves);
+        if (best) {
+            game_play_move(best);
+        } else {
+            game_pass_turn();
+        }
+    }
+    strcpy(mb->rack, state->racks[state->to_move]);
+    movegen_generate(mb->dawg, mb->rack, &mb->moves);
+}
+
+int main(int argc, char *argv[])
+{
+    if (!bench_init("core", argc, argv)) {
+        return EXIT_FAILURE;
+    }
+
+    if (!load_words(BENCH_WORDLIST)) {
+        fprintf(stderr, "Failed to load %s (run from the source tree)\n", BENCH_WORDLIST);
+        return EXIT_FAILURE;
+    }
+    build_queries();
+    build_placements();
+
+    /* Dictionary */
+    bench_run("dictionary_load_file/ospd3", bench_dictionary_load, BENCH_WORDLIST);
+    if (!dictionary_load_file(BENCH_WORDLIST) || dictionary_word_count() != word_total) {
+        fprintf(stderr, "Dictionary holds %d of %d words\n", dictionary_word_count(), word_total);
+    }
+    bench_run("dictionary_is_word/hit", bench_is_word, &hit_queries);
+    bench_run("dictionary_is_word/miss", bench_is_word, &miss_queries);
+    bench_run("dictionary_is_word/mixed50", bench_is_word, &mixed_queries);
+
+    /* DAWG */
+    bench_run("dawg_load/ospd3", bench_dawg_load, BENCH_WORDLIST);
+    bench_run("dawg_load_parallel/ospd3", bench_dawg_load_parallel, BENCH_WORDLIST);
+    lexicon = dawg_load(BENCH_WORDLIST);
+    if (lexicon) {
+        bench_run("dawg_contains/hit", bench_dawg_contains, &hit_queries);
+        bench_run("dawg_contains/miss", bench_dawg_contains, &miss_queries);
+    }
+
+    /* Move generation */
+    MovegenBench mb;
+    tiles_reset();
+    mb.dawg = lexicon;
+    movegen_list_init(&mb.moves);
+    if (mb.dawg) {
+        /* Repeating one position would only measure the line cache */
+        movegen_cache_enable(false);
+        setup_position(&mb, 0);
+        bench_run("movegen/generate_opening", bench_movegen, &mb);
+        setup_position(&mb, MIDGAME_PLIES);
+        bench_run("movegen/generate_midgame", bench_movegen, &mb);
+        bench_run("movegen/top1_midgame", bench_movegen_top1, &mb);
+        bench_run("movegen/top10_midgame", bench_movegen_top10, &mb);
+        movegen_cache_enable(true);
+        bench_run("movegen/generate_midgame_cached", bench_movegen, &mb);
+        if (mb.moves.count > 0) {
+            bench_run("game_score_move", bench_game_score_move, &mb);
+            bench_run("game/play_unplay", bench_play_unplay, &mb);
+            bench_run("game/snapshot_restore", bench_snapshot_restore, NULL);
+        }
+
+        record_games(&mb);
+        bench_run("record_replay/game", bench_record_replay, NULL);
+        for (int i = 0; i < REPLAY_GAMES; i++) {
+            record_free(&replay_records[i]);
+        }
+    }
+    movegen_list_free(&mb.moves);
+    dawg_free(lexicon);
+
+    /* Board */
+    board_init();
+    bench_run("board/place_revert", bench_board_place_revert, NULL);
+    bench_run("board/place_commit", bench_board_place_commit, NULL);
+
+    /* Game scoring */
+    if (game_init()) {
+        board_init();
+        bench_run("game_evaluate_move", bench_game_evaluate, NULL);
+        game_cleanup();
+    }
+
+    dictionary_cleanup();
+    free(words);
+    return bench_finish();
+}
@@ -0,0 +1,132 @@
+/**
+ * XScrabble - Enhanced Dictionary Benchmarks
+ *
+ * JSON loading and definition lookups.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "dictionary_enhanced.h"
+
+#define FRENCH_JSON "data/dictionaries/extracted/french_dict_sample.json"
+#define AL_JSON "data/dictionaries/extracted/AL_DEFINITIONS.json"
+#define QUERY_COUNT 4096
+#define MAX_KEYS 256
+#define WORD_BUFFER 32
+
+typedef struct {
+    char queries[QUERY_COUNT][WORD_BUFFER];
+} QuerySet;
+
+static char keys[MAX_KEYS][WORD_BUFFER];
+static int key_count = 0;
+
+static QuerySet hit_queries;
+static QuerySet miss_queries;
+
+/* Collect the top-level keys of a dictionary JSON file */
+static void collect_keys(const char *filename)
+{
+    FILE *file = fopen(filename, "r");
+    if (!file) {
+        return;
+    }
+
+    char line[512];
+    while (fgets(line, sizeof(line), file) && key_count < MAX_KEYS) {
+        char *start = strchr(line, '"');
+        char *end = start ? strchr(start + 1, '"') : NULL;
+        if (!end || !strstr(end, "{")) {
+            continue;
+        }
+        size_t len = end - start - 1;
+        if (len > 0 && len < WORD_BUFFER) {
+            memcpy(keys[key_count], start + 1, len);
+            keys[key_count][len] = '\0';
+            if (dictionary_lookup(keys[key_count])) {
+                key_count++;
+            }
+        }
+    }
+    fclose(file);
+}
+
+static void build_queries(void)
+{
+    uint64_t rng = bench_seed();
+
+    for (int i = 0; i < QUERY_COUNT; i++) {
+        strcpy(hit_queries.queries[i], keys[bench_random(&rng) % key_count]);
+
+        char *miss = miss_queries.queries[i];
+        do {
+            strcpy(miss, keys[bench_random(&rng) % key_count]);
+            miss[bench_random(&rng) % strlen(miss)] = 'a' + bench_random(&rng) % 26;
+        } while (dictionary_lookup(miss));
+    }
+}
+
+/* Benchmark bodies */
+
+static void bench_init_french(void *context, uint64_t iteration)
+{
+    (void)context;
+    (void)iteration;
+    dictionary_enhanced_cleanup();
+    bench_consume(dictionary_enhanced_init());
+}
+
+static void bench_load_al(void *context, uint64_t iteration)
+{
+    (void)context;
+    (void)iteration;
+    dictionary_enhanced_cleanup();
+    dictionary_enhanced_init();
+    bench_consume(dictionary_load_json(AL_JSON));
+}
+
+static void bench_lookup(void *context, uint64_t iteration)
+{
+    const QuerySet *set = (const QuerySet *)context;
+    bench_consume((uintptr_t)dictionary_lookup(set->queries[iteration % QUERY_COUNT]));
+}
+
+static void bench_is_word(void *context, uint64_t iteration)
+{
+    const QuerySet *set = (const QuerySet *)context;
+    bench_consume(dictionary_enhanced_is_word(set->queries[iteration % QUERY_COUNT]));
+}
+
+int main(int argc, char *argv[])
+{
+    if (!bench_init("enhanced", argc, argv)) {
+        return EXIT_FAILURE;
+    }
+
+    /* JSON loading */
+    bench_run("dictionary_enhanced/init_json", bench_init_french, NULL);
+    bench_run("dictionary_enhanced/load_json_al", bench_load_al, NULL);
+
+    /* Lookups against the French sample plus the AL definitions */
+    dictionary_enhanced_cleanup();
+    if (!dictionary_enhanced_init()) {
+        return EXIT_FAILURE;
+    }
+    dictionary_load_json(AL_JSON);
+    collect_keys(FRENCH_JSON);
+    collect_keys(AL_JSON);
+    if (key_count == 0) {
+        fprintf(stderr, "No dictionary keys found (run from the source tree)\n");
+        return EXIT_FAILURE;
+    }
+    build_queries();
+
+    bench_run("dictionary_enhanced/lookup_hit", bench_lookup, &hit_queries);
+    bench_run("dictionary_enhanced/lookup_miss", bench_lookup, &miss_queries);
+    bench_run("dictionary_enhanced/is_word_miss", bench_is_word, &miss_queries);
+
+    dictionary_enhanced_cleanup();
+    return bench_finish();
+}
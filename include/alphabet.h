@@ -0,0 +1,62 @@
+/**
+ * XScrabble - Alphabet Definitions
+ *
+ * Inside the engine every letter is a machine letter: a dense index below
+ * ALPHABET_MAX_LETTERS stored as the char ALPHABET_FIRST + index. Board
+ * cells, racks, the bag and the word graph all hold these, so hot paths
+ * subtract ALPHABET_FIRST and work on a 5-bit integer, and the English
+ * alphabet keeps its plain 'A'-'Z' codes. UTF-8 spellings, accented
+ * letters and digraph tiles such as "CH" or "L·L" only exist at the I/O
+ * boundaries: word lists, tile files and move text.
+ */
+
+#ifndef XSCRABBLE_ALPHABET_H
+#define XSCRABBLE_ALPHABET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "dawg.h"
+
+/* Machine letters run from ALPHABET_FIRST; the code after the last is the blank */
+#define ALPHABET_FIRST 'A'
+#define ALPHABET_MAX_LETTERS DAWG_LETTERS
+#define ALPHABET_MAX_SPELLING 8         /* Bytes of UTF-8 per tile face */
+#define ALPHABET_MAX_SPELLINGS 128
+
+/* One way of writing a letter; ASCII bytes match either case */
+typedef struct {
+    char text[ALPHABET_MAX_SPELLING + 1];
+    uint8_t length;
+    uint8_t letter;             /* Machine letter index */
+} AlphabetSpelling;
+
+typedef struct {
+    int size;
+    char display[ALPHABET_MAX_LETTERS][ALPHABET_MAX_SPELLING + 1];
+    AlphabetSpelling spellings[ALPHABET_MAX_SPELLINGS];   /* By first byte, longest first */
+    int spelling_count;
+    uint8_t first[256];         /* Spellings starting with a folded byte begin here... */
+    uint8_t count[256];         /* ...and run this long */
+} Alphabet;
+
+/* Machine letter for an index, and back; -1 if the char is not a machine letter */
+static inline char alphabet_letter(int index)
+{
+    return (char)(ALPHABET_FIRST + index);
+}
+
+static inline int alphabet_index(const Alphabet *alphabet, char letter)
+{
+    int index = (unsigned char)letter - ALPHABET_FIRST;
+    return index >= 0 && index < alphabet->size ? index : -1;
+}
+
+/* Function prototypes */
+const Alphabet* alphabet_english(void);
+bool alphabet_parse(Alphabet *alphabet, const char *text);
+bool alphabet_load(Alphabet *alphabet, const char *filename);
+int alphabet_encode(const Alphabet *alphabet, const char *text, char *letters, int capacity);
+int alphabet_decode(const Alphabet *alphabet, const char *letters, int count, char *text, int size);
+const char* alphabet_spelling(const Alphabet *alphabet, char letter);
+
+#endif /* XSCRABBLE_ALPHABET_H */
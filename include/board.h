@@ -6,9 +6,15 @@
 #define XSCRABBLE_BOARD_H
 
 #include <stdbool.h>
+#include <stdint.h>
+#include "variant.h"
 
-/* Board dimensions */
-#define BOARD_SIZE 15
+/*
+ * Board dimensions: storage fits the largest variant's board, and
+ * board_size() is the size of the one being played. Squares are numbered
+ * row * BOARD_MAX_SIZE + col whatever the size.
+ */
+#define BOARD_SQUARES (BOARD_MAX_SIZE * BOARD_MAX_SIZE)
 
 /* Special cell types */
 typedef enum {
@@ -19,21 +25,79 @@ typedef enum {
     CELL_TRIPLE_WORD
 } CellType;
 
-/* Board cell structure */
+/* Board cell structure; a blank holds the letter it stands for with TILE_BLANK_BIT set */
 typedef struct {
     CellType type;
     char letter;
     bool is_fixed;
 } BoardCell;
 
+/*
+ * Padded layout, kept in step with the cells for move generation and
+ * scoring. Each orientation holds BOARD_PADDED lines of BOARD_PADDED
+ * squares: across, line r + 1 is board row r; down, line c + 1 is board
+ * column c, so a square's perpendicular neighbours are contiguous in the
+ * other orientation. Square (row, col) sits at [row + 1][col + 1] across
+ * and [col + 1][row + 1] down. The border squares, and any past a
+ * board smaller than the largest, are empty, with 1x multipliers and
+ * BOARD_SQUARE_BORDER set, so stepping to a neighbour never needs a
+ * bounds check. Letters are the faces of the tiles, so the
+ * word graph can be walked through blanks; BOARD_SQUARE_BLANK marks the
+ * squares whose tile scores nothing.
+ */
+#define BOARD_PADDED (BOARD_MAX_SIZE + 2)
+#define BOARD_ACROSS 0          /* Same values as MOVE_ACROSS and MOVE_DOWN */
+#define BOARD_DOWN 1
+
+#define BOARD_SQUARE_FIXED 0x01
+#define BOARD_SQUARE_BORDER 0x02
+#define BOARD_SQUARE_BLANK 0x04
+
+typedef struct {
+    _Alignas(64) char letter[2][BOARD_PADDED][BOARD_PADDED];   /* 0 = empty */
+    uint8_t flags[2][BOARD_PADDED][BOARD_PADDED];
+    uint8_t letter_mult[2][BOARD_PADDED][BOARD_PADDED];
+    uint8_t word_mult[2][BOARD_PADDED][BOARD_PADDED];
+} BoardLayout;
+
+/*
+ * Anchors: empty squares next to a tile, where every placement must touch.
+ * Kept per line of the padded layout in both orientations, as a bitmask
+ * (bit pos for square [d][line][pos]) and as a list in board order. Each
+ * empty square also has its left-extension limit: how many empty
+ * non-anchor squares run directly before it on its line, so a left part
+ * built there cannot reach another anchor. Only lines around changed
+ * squares are recomputed, when board_anchors() is next called.
+ */
+typedef struct {
+    uint32_t mask[2][BOARD_PADDED];
+    uint8_t list[2][BOARD_PADDED][BOARD_MAX_SIZE];
+    uint8_t count[2][BOARD_PADDED];
+    uint8_t left_limit[2][BOARD_PADDED][BOARD_PADDED];
+    int tiles;                  /* Letters on the board */
+} BoardAnchors;
+
 /* Function prototypes */
 bool board_init(void);
 void board_cleanup(void);
+int board_size(void);
+const Variant* board_variant(void);
 BoardCell* board_get_cell(int row, int col);
 CellType board_get_cell_type(int row, int col);
+const BoardLayout* board_layout(void);
+const BoardAnchors* board_anchors(void);
 bool board_place_tile(int row, int col, char letter);
 bool board_remove_tile(int row, int col);
 void board_commit_word(void);
 void board_revert_word(void);
 
+/* Committed-position copies and unplay, for game snapshots and undo */
+void board_snapshot(char letters[BOARD_SQUARES]);
+void board_restore(const char letters[BOARD_SQUARES]);
+bool board_lift_tile(int row, int col);
+
+/* Change stamps: a line's stamp moves whenever a letter on it changes */
+uint64_t board_row_stamp(int row);
+uint64_t board_col_stamp(int col);
+
 #endif /* XSCRABBLE_BOARD_H */
@@ -0,0 +1,67 @@
+/**
+ * XScrabble - Graph Lexicon (DAWG) Definitions
+ *
+ * The lexicon is a minimized directed acyclic word graph stored as a flat
+ * array of 32-bit edges. A node is the run of edges starting at its index;
+ * the last edge of a node has DAWG_EDGE_LAST set. Index 0 is reserved so a
+ * zero child means "no outgoing edges".
+ */
+
+#ifndef XSCRABBLE_DAWG_H
+#define XSCRABBLE_DAWG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Edge layout */
+#define DAWG_LETTER_MASK   0x1fu    /* Letter index, 0 = 'a' */
+#define DAWG_EDGE_TERMINAL 0x20u    /* A word ends after this edge */
+#define DAWG_EDGE_LAST     0x40u    /* Last edge of its node */
+#define DAWG_CHILD_SHIFT   7
+
+#define DAWG_LETTERS 30            /* Machine letters, see alphabet.h */
+#define DAWG_MAX_WORD_LENGTH 32
+
+/* Graph lexicon */
+typedef struct {
+    uint32_t *edges;
+    uint32_t edge_count;
+    uint32_t root;              /* First edge of the root node, 0 if empty */
+    uint32_t word_count;
+    uint64_t serial;            /* Unique per built lexicon, for caches keyed on it */
+} Dawg;
+
+/* Edge accessors */
+static inline int dawg_edge_letter(uint32_t edge)
+{
+    return edge & DAWG_LETTER_MASK;
+}
+
+static inline bool dawg_edge_terminal(uint32_t edge)
+{
+    return (edge & DAWG_EDGE_TERMINAL) != 0;
+}
+
+static inline bool dawg_edge_last(uint32_t edge)
+{
+    return (edge & DAWG_EDGE_LAST) != 0;
+}
+
+static inline uint32_t dawg_edge_child(uint32_t edge)
+{
+    return edge >> DAWG_CHILD_SHIFT;
+}
+
+/* Function prototypes */
+Dawg* dawg_build(const char *const *words, size_t count);
+Dawg* dawg_load(const char *filename);
+Dawg* dawg_build_parallel(const char *const *words, size_t count, int threads);
+Dawg* dawg_load_parallel(const char *filename, int threads);
+void dawg_free(Dawg *dawg);
+bool dawg_contains(const Dawg *dawg, const char *word);
+uint32_t dawg_find_edge(const Dawg *dawg, uint32_t node, int letter);
+bool dawg_walk(const Dawg *dawg, const char *prefix, uint32_t *node, bool *terminal);
+int dawg_letter_index(char letter);
+
+#endif /* XSCRABBLE_DAWG_H */
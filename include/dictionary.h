@@ -6,10 +6,14 @@
 #define XSCRABBLE_DICTIONARY_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 /* Function prototypes */
 bool dictionary_init(void);
 void dictionary_cleanup(void);
 bool dictionary_is_word(const char *word);
+bool dictionary_load_file(const char *filename);
+int dictionary_word_count(void);
+size_t dictionary_memory_usage(void);
 
 #endif /* XSCRABBLE_DICTIONARY_H */
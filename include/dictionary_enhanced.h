@@ -11,14 +11,15 @@
 typedef struct {
     char word[32];              /* The word itself */
     char *definition;           /* Definition of the word */
+    char *english_definition;   /* English gloss (optional) */
     char *example;              /* Example usage (optional) */
     char *part_of_speech;       /* Part of speech (optional) */
 } DictionaryEntry;
 
 /* Function prototypes */
-bool dictionary_init(void);
-void dictionary_cleanup(void);
-bool dictionary_is_word(const char *word);
+bool dictionary_enhanced_init(void);
+void dictionary_enhanced_cleanup(void);
+bool dictionary_enhanced_is_word(const char *word);
 
 /* Enhanced functions for language learning */
 const DictionaryEntry* dictionary_lookup(const char *word);
@@ -28,5 +29,7 @@ const char* dictionary_get_part_of_speech(const char *word);
 
 /* Dictionary management */
 bool dictionary_load_json(const char *filename);
+bool dictionary_parse_json(const char *filename, DictionaryEntry **entries, int *count);
+void dictionary_free_entries(DictionaryEntry *entries, int count);
 
 #endif /* XSCRABBLE_DICTIONARY_ENHANCED_H */
\ No newline at end of file
@@ -0,0 +1,68 @@
+/**
+ * XScrabble - Endgame Search Definitions
+ *
+ * Alpha-beta search of positions where every tile is known: both racks
+ * and the order of whatever is left in the bag. Values are the change in
+ * spread from here on for the side to move, so a position found again
+ * at another score is still a table hit. Searches share a transposition
+ * table keyed by game_position_hash() and the bag.
+ *
+ * The pre-endgame, with one to six tiles in the bag, is searched by
+ * enumerating every split of the unseen tiles into an opponent rack and a
+ * bag order, solving each candidate move on each split as an endgame and
+ * weighting the results by the chance of that split. Splits are shared
+ * out to worker threads.
+ */
+
+#ifndef XSCRABBLE_ENDGAME_H
+#define XSCRABBLE_ENDGAME_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "game.h"
+#include "movegen.h"
+#include "ttable.h"
+
+#define ENDGAME_MAX_PLIES 16
+#define ENDGAME_MAX_THREADS 64
+#define ENDGAME_MAX_BAG (RACK_SIZE - 1)     /* Pre-endgames have 1 to this many tiles in the bag */
+#define ENDGAME_MAX_CANDIDATES 64           /* Moves valued per pre-endgame search */
+#define ENDGAME_MAX_SPLITS 50000            /* Default refusal point for bags with many splits */
+
+/* One thread's search of known positions */
+typedef struct {
+    const Dawg *dawg;
+    TTable *table;                          /* Shared; NULL to search without one */
+    uint64_t nodes;
+    MoveList lists[ENDGAME_MAX_PLIES];      /* Moves at each ply */
+} EndgameSearch;
+
+/* A pre-endgame candidate and its value averaged over the splits */
+typedef struct {
+    Move move;
+    double value;                           /* Expected change in the mover's spread */
+    double wins;                            /* Chance the mover wins, ties counting half */
+} EndgameCandidate;
+
+typedef struct {
+    /* Settings */
+    int threads;
+    int plies;                              /* Plies searched per split, the candidate included */
+    int max_splits;                         /* Refuse bags with more splits than this */
+    TTable *table;                          /* Shared by the workers; NULL for none */
+
+    /* Last search */
+    int splits;
+    uint64_t nodes;
+} PreendgameSearch;
+
+/* Function prototypes */
+void endgame_init(EndgameSearch *search, const Dawg *dawg, TTable *table);
+void endgame_free(EndgameSearch *search);
+int endgame_solve(EndgameSearch *search, int plies, Move *best);
+void endgame_pre_defaults(PreendgameSearch *search);
+int endgame_pre_candidates(const Dawg *dawg, const char *rack, int k, EndgameCandidate *candidates);
+bool endgame_pre_solve(PreendgameSearch *search, const Dawg *dawg, EndgameCandidate *candidates,
+                       int count);
+
+#endif /* XSCRABBLE_ENDGAME_H */
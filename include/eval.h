@@ -0,0 +1,60 @@
+/**
+ * XScrabble - Static Move Evaluation Definitions
+ *
+ * Equity is what a move is worth beyond its score: the value of the tiles
+ * it keeps (per letter, duplicates, vowel/consonant balance), scaled by how
+ * full the bag still is, plus a charge for each triple-word square it
+ * newly lets the opponent reach. eval_prepare() reads the rack and the
+ * board once per position; eval_equity() then only looks at the tiles a
+ * move places, so it can run on every generated move.
+ */
+
+#ifndef XSCRABBLE_EVAL_H
+#define XSCRABBLE_EVAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "alphabet.h"
+#include "board.h"
+#include "movegen.h"
+
+#define EVAL_LETTERS (ALPHABET_MAX_LETTERS + 1)     /* Machine letters and the blank */
+#define EVAL_PHASES 4           /* Bag empty, at most a rack, at most 30 tiles, more */
+#define EVAL_MAX_LANES 32       /* Triple-word squares tracked per board */
+
+/* Weights; eval_default_weights() fills them and a weights file overrides them */
+typedef struct {
+    float letter[EVAL_LETTERS];                     /* Keeping one tile of a letter */
+    float duplicate;                                /* Each extra copy of a kept letter */
+    float balance[RACK_SIZE + 1][RACK_SIZE + 1];    /* By kept vowels, then consonants */
+    float leave_scale[EVAL_PHASES];                 /* Leave weight by bag phase */
+    float lane[EVAL_PHASES];                        /* Per triple-word square opened */
+    bool vowel[EVAL_LETTERS];
+} EvalWeights;
+
+/* One position, prepared for evaluating many moves */
+typedef struct {
+    float leave[EVAL_LETTERS][RACK_SIZE + 1];   /* Scaled value of keeping n of a letter */
+    float balance[RACK_SIZE + 1][RACK_SIZE + 1];
+    float lane;
+    float rack_leave;           /* Leave value of the whole rack */
+    uint8_t rack[EVAL_LETTERS];
+    bool vowel[EVAL_LETTERS];
+    int vowels;
+    int consonants;
+    uint32_t reach[BOARD_MAX_SIZE][BOARD_MAX_SIZE]; /* Triple-word squares a tile here would open */
+    uint32_t open;              /* Triple-word squares already reachable */
+    int8_t lane_index[BOARD_MAX_SIZE][BOARD_MAX_SIZE]; /* Bit of each empty triple-word square, or -1 */
+} EvalContext;
+
+/* Function prototypes */
+void eval_default_weights(EvalWeights *weights);
+bool eval_load_weights(EvalWeights *weights, const char *filename, const Alphabet *alphabet);
+void eval_prepare(EvalContext *context, const EvalWeights *weights, const char *rack,
+                  int tiles_left);
+float eval_equity(const EvalContext *context, const Move *move);
+float eval_leave(const EvalContext *context, const char *leave);
+int eval_best_move(const EvalContext *context, const Dawg *dawg, const char *rack,
+                   Move *best, float *equity);
+
+#endif /* XSCRABBLE_EVAL_H */
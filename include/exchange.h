@@ -0,0 +1,45 @@
+/**
+ * XScrabble - Exchange Evaluation Definitions
+ *
+ * Values every way of playing off part of a rack by what the rack is worth
+ * once refilled. Each distinct sub-rack to keep (at most 2^7 for seven
+ * different tiles) is scored with the evaluation's leave tables against the
+ * same sampled refills from the unseen tiles, so candidates compare on
+ * common draws. The expected values then rank exchanges, and placements
+ * by score plus the value of what they keep, on one scale.
+ */
+
+#ifndef XSCRABBLE_EXCHANGE_H
+#define XSCRABBLE_EXCHANGE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "eval.h"
+#include "game.h"
+
+#define EXCHANGE_MAX_KEEPS (1 << RACK_SIZE)     /* Sub-racks of a rack of distinct tiles */
+#define EXCHANGE_SAMPLES 256    /* Refills sampled per decision by default */
+#define EXCHANGE_MAX_UNSEEN (BAG_CAPACITY + RACK_SIZE)
+
+/* One position's sub-racks and their expected values */
+typedef struct {
+    int keeps;                              /* Distinct sub-racks, index 0 empty, last the whole rack */
+    int letters;                            /* Distinct tiles on the rack */
+    uint8_t letter[RACK_SIZE];              /* Evaluation letter of each, and its count */
+    uint8_t have[RACK_SIZE];
+    int stride[RACK_SIZE];                  /* Sub-rack index = sum of kept count * stride */
+    float value[EXCHANGE_MAX_KEEPS];        /* Expected leave of the refilled rack, by sub-rack */
+    bool can_exchange;                      /* Enough tiles in the bag to exchange */
+} ExchangeContext;
+
+/* Function prototypes */
+int exchange_unseen(const GameState *state, int player, char *buffer);
+void exchange_prepare(ExchangeContext *context, const EvalContext *eval, const char *rack,
+                      const char *unseen, int tiles_left, int samples, uint64_t seed);
+int exchange_keep_index(const ExchangeContext *context, const char *kept);
+float exchange_equity(const ExchangeContext *context, const Move *move);
+bool exchange_best(const ExchangeContext *context, Move *move, float *equity);
+bool exchange_decide(const ExchangeContext *context, const EvalContext *eval, const Dawg *dawg,
+                     const char *rack, Move *best, float *equity);
+
+#endif /* XSCRABBLE_EXCHANGE_H */
@@ -6,6 +6,18 @@
 #define XSCRABBLE_GAME_H
 
 #include <stdbool.h>
+#include <stdint.h>
+#include "lexicon.h"
+#include "movegen.h"
+
+/* Tile bag capacity, enough for the largest variant's tile set */
+#define BAG_CAPACITY 224
+
+/* Consecutive scoreless turns that end the game */
+#define MAX_SCORELESS_TURNS 6
+
+/* Committed moves kept for game_unplay_move(); older ones are dropped */
+#define GAME_UNDO_DEPTH 512
 
 /* Game state structure */
 typedef struct {
@@ -14,8 +26,44 @@ typedef struct {
     int tiles_left;
     char current_word[16];
     char player_rack[7];
+
+    /* Engine state for games started with game_new() */
+    int to_move;
+    uint64_t seed;
+    char racks[2][RACK_SIZE + 1];       /* NUL-terminated */
+    char last_drawn[RACK_SIZE + 1];     /* Tiles drawn by the last move */
+    char bag[BAG_CAPACITY];             /* Draws come from the end */
+    uint64_t rng;
+    int moves_played;
+    int scoreless_turns;
+    bool over;
+    uint64_t hash;                      /* Zobrist hash of board and side to move */
+    Lexicon *lexicon;                   /* Held reference; kept across games */
 } GameState;
 
+/*
+ * Complete committed position as plain data: copy it with memcpy, keep as
+ * many as a search needs, or write it to disk. The board is a bitmap of
+ * occupied squares whose letters share one array with the bag: a game's
+ * tiles are in the bag, on the board or on a rack, so both fit in
+ * BAG_CAPACITY. 336 bytes.
+ */
+typedef struct {
+    uint64_t occupied[(BOARD_SQUARES + 63) / 64];   /* Bit per square holding a tile */
+    char tiles[BAG_CAPACITY];           /* tiles_left bag tiles, then board letters by square */
+    char racks[2][RACK_SIZE + 1];
+    int32_t scores[2];
+    uint64_t rng;
+    uint64_t seed;
+    uint64_t hash;
+    uint16_t moves_played;
+    uint8_t tiles_left;
+    uint8_t to_move;
+    uint8_t scoreless_turns;
+    uint8_t over;
+    uint8_t variant;                    /* VariantId of the board */
+} GameSnapshot;
+
 /* Function prototypes */
 bool game_init(void);
 void game_cleanup(void);
@@ -23,10 +71,33 @@ GameState* game_get_state(void);
 bool game_place_tile(int row, int col, char letter);
 bool game_remove_tile(int row, int col);
 int game_evaluate_move(void);
+int game_best_moves(Move *best, int k);
 bool game_finish_turn(void);
 void game_pass_turn(void);
 bool game_change_letters(void);
 void game_revert_move(void);
 bool game_shuffle_rack(void);
 
+/* Headless engine games; state is per thread */
+bool game_new(uint64_t seed);
+bool game_play_move(const Move *move);
+bool game_is_over(void);
+int game_score_move(const Move *move);
+int game_winner(void);
+bool game_use_lexicon(const char *name);
+
+/* Replay of recorded games */
+bool game_setup(const char *rack0, const char *rack1, int tiles_left);
+bool game_apply_move(const Move *move, const char *drawn);
+
+/* Snapshots, undo and checkpoints */
+bool game_snapshot(GameSnapshot *snapshot);
+void game_restore(const GameSnapshot *snapshot);
+bool game_unplay_move(void);
+int game_undo_depth(void);
+uint64_t game_hash(void);
+uint64_t game_position_hash(void);
+bool game_save_checkpoint(const char *filename);
+bool game_load_checkpoint(const char *filename);
+
 #endif /* XSCRABBLE_GAME_H */
@@ -0,0 +1,21 @@
+/**
+ * XScrabble - GCG Import/Export Definitions
+ */
+
+#ifndef XSCRABBLE_GCG_H
+#define XSCRABBLE_GCG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "record.h"
+
+/* Longest GCG line accepted on import */
+#define GCG_LINE_MAX 512
+
+/* Function prototypes */
+bool gcg_export(FILE *out, const uint8_t *data, size_t size);
+bool gcg_import(FILE *in, GameRecord *record);
+
+#endif /* XSCRABBLE_GCG_H */
@@ -0,0 +1,57 @@
+/**
+ * XScrabble - Opponent Rack Inference Definitions
+ *
+ * A weighted set of racks the opponent might hold, kept consistent with
+ * what has been seen. After each opponent move, every rack is put back to
+ * what it must have been before the move (the tiles played plus what it
+ * kept) and its weight drops by how far the move falls short of the best
+ * that rack could have scored there. The scoring runs as one batch per
+ * worker thread and stops at a per-update deadline; racks not reached in
+ * time keep their weight. Racks are then refilled from the unseen tiles,
+ * and the set is resampled once its weight has piled onto a few racks.
+ */
+
+#ifndef XSCRABBLE_INFER_H
+#define XSCRABBLE_INFER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "alphabet.h"
+#include "game.h"
+
+#define INFER_LETTERS (ALPHABET_MAX_LETTERS + 1)    /* Machine letters and the blank */
+#define INFER_MAX_THREADS 64
+#define INFER_CHUNK 64          /* Racks a worker scores before checking the clock */
+
+typedef struct {
+    int count;
+    char (*racks)[RACK_SIZE + 1];
+    float *weights;
+    double *cumulative;         /* Running weight totals, for sampling */
+    int unseen[INFER_LETTERS];  /* Tiles not visible to us: the bag and the opponent's rack */
+    int rack_size;              /* Tiles on the opponent's rack */
+    uint64_t rng;
+
+    /* Settings */
+    int threads;
+    double budget;              /* Seconds an update may spend scoring */
+    float temperature;          /* Points of shortfall that cost a factor of e */
+    float margin;               /* Shortfall forgiven outright */
+
+    /* Last update */
+    int scored;
+    int resampled;
+} InferState;
+
+/* Function prototypes */
+bool infer_init(InferState *state, int count, int threads, double budget, uint64_t seed);
+void infer_free(InferState *state);
+int infer_unseen(int player, char *buffer, int size);
+void infer_reset(InferState *state, const char *unseen, int rack_size);
+bool infer_observe(InferState *state, const GameSnapshot *before, const Dawg *dawg,
+                   const Move *move);
+void infer_sync(InferState *state, const char *unseen, int rack_size);
+double infer_effective(const InferState *state);
+const char* infer_sample(const InferState *state, uint64_t *rng);
+
+#endif /* XSCRABBLE_INFER_H */
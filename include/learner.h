@@ -0,0 +1,80 @@
+/**
+ * XScrabble - Learner Progress Definitions
+ *
+ * Spaced-repetition state for each learner, indexed by word ID (the
+ * entry's index in the dictionary table). Scheduling fields live in
+ * parallel arrays so the scheduler touches only the bytes it needs, and
+ * the words a learner has studied sit in a min-heap on their due time, so
+ * the next review is found without scanning the word list.
+ *
+ * Each learner has an append-only log of fixed-size records, one per
+ * review, holding the word's new schedule; the last record for a word
+ * wins. Records are buffered and appended in batches, and the log is
+ * rewritten with one record per word once it has grown to twice that.
+ * A learner's arrays are only allocated and its log only read the first
+ * time the learner is asked for.
+ */
+
+#ifndef XSCRABBLE_LEARNER_H
+#define XSCRABBLE_LEARNER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Review grades, SM-2 style: below LEARNER_PASS_GRADE the word is relearned */
+#define LEARNER_MAX_GRADE 5
+#define LEARNER_PASS_GRADE 3
+#define LEARNER_RELEARN_SECONDS 600
+#define LEARNER_DAY_SECONDS 86400
+#define LEARNER_INITIAL_EASE 2500       /* Ease factors are kept in thousandths */
+#define LEARNER_MIN_EASE 1300
+#define LEARNER_PENDING 32              /* Reviews buffered before an append */
+
+/* One log record: a word's schedule after a review */
+typedef struct {
+    uint32_t word;
+    uint32_t due;               /* Seconds since the epoch */
+    uint16_t interval;          /* Days */
+    uint16_t ease;
+    uint8_t reps;               /* Successful reviews in a row */
+    uint8_t lapses;
+    uint8_t reserved[2];
+} LearnerRecord;
+
+typedef struct {
+    uint32_t id;
+    int word_count;
+    uint32_t *due;
+    uint16_t *interval;
+    uint16_t *ease;
+    uint8_t *reps;
+    uint8_t *lapses;
+    int32_t *heap;              /* Studied words, earliest due first */
+    int32_t *heap_pos;          /* Per word: its heap slot, or -1 if never studied */
+    int studied;
+    uint32_t log_records;       /* Records in the file, pending ones not counted */
+    LearnerRecord pending[LEARNER_PENDING];
+    int pending_count;
+    char path[1024];
+} Learner;
+
+/* Learners loaded so far, by ID */
+typedef struct {
+    char directory[960];
+    int word_count;
+    Learner **slots;            /* Open addressing; NULL is empty */
+    int capacity;
+    int count;
+} LearnerStore;
+
+/* Function prototypes */
+bool learner_store_open(LearnerStore *store, const char *directory, int word_count);
+void learner_store_close(LearnerStore *store);
+Learner* learner_get(LearnerStore *store, uint32_t id);
+bool learner_unload(LearnerStore *store, uint32_t id);
+bool learner_review(Learner *learner, int word, int grade, uint32_t now);
+int learner_next_due(const Learner *learner, uint32_t now);
+bool learner_flush(Learner *learner);
+bool learner_compact(Learner *learner);
+
+#endif /* XSCRABBLE_LEARNER_H */
@@ -0,0 +1,55 @@
+/**
+ * XScrabble - Lexicon Registry Definitions
+ *
+ * Lexicons are immutable once built and shared by reference count. The
+ * registry maps a name ("OSPD3", "ODS8", "AL") to its current version;
+ * publishing a new version swaps the pointer atomically, so games that
+ * already hold a handle keep the version they started with.
+ *
+ * Each lexicon carries the alphabet its words were encoded with; lookups
+ * take UTF-8 text and encode it the same way.
+ */
+
+#ifndef XSCRABBLE_LEXICON_H
+#define XSCRABBLE_LEXICON_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "alphabet.h"
+#include "dawg.h"
+#include "dictionary_enhanced.h"
+
+/* Registry limits */
+#define LEXICON_MAX 16
+#define LEXICON_NAME_MAX 32
+
+/* Immutable word list with optional definitions */
+typedef struct {
+    char name[LEXICON_NAME_MAX];
+    uint32_t version;               /* Set when published, counts up per name */
+    Dawg *dawg;                     /* Over machine letters of alphabet */
+    Alphabet alphabet;
+    DictionaryEntry *entries;       /* Sorted by word; NULL for plain word lists */
+    int entry_count;
+    int refs;
+} Lexicon;
+
+/* Building and sharing */
+Lexicon* lexicon_load(const char *name, const char *filename);
+Lexicon* lexicon_load_alphabet(const char *name, const char *filename, const Alphabet *alphabet);
+Lexicon* lexicon_from_words(const char *name, const char *const *words, int count);
+Lexicon* lexicon_retain(Lexicon *lexicon);
+void lexicon_release(Lexicon *lexicon);
+
+/* Lookups; lock-free on a held handle */
+bool lexicon_contains(const Lexicon *lexicon, const char *word);
+const DictionaryEntry* lexicon_definition(const Lexicon *lexicon, const char *word);
+
+/* Registry */
+bool lexicon_publish(Lexicon *lexicon);
+bool lexicon_reload(const char *name, const char *filename);
+Lexicon* lexicon_acquire(const char *name);
+int lexicon_names(const char *names[LEXICON_MAX]);
+void lexicon_registry_clear(void);
+
+#endif /* XSCRABBLE_LEXICON_H */
@@ -0,0 +1,71 @@
+/**
+ * XScrabble - Move Generation Definitions
+ */
+
+#ifndef XSCRABBLE_MOVEGEN_H
+#define XSCRABBLE_MOVEGEN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "alphabet.h"
+#include "board.h"
+#include "dawg.h"
+
+/* Largest rack of any variant; the rack size and bingo bonus in play are the board variant's */
+#define RACK_SIZE 7
+
+/* Move kinds */
+typedef enum {
+    MOVE_PLACE,
+    MOVE_PASS,
+    MOVE_EXCHANGE
+} MoveType;
+
+typedef enum {
+    MOVE_ACROSS,
+    MOVE_DOWN
+} MoveDirection;
+
+/*
+ * A move covers length squares starting at (row, col). tiles[i] is the
+ * letter placed on the i-th square, or 0 where the board already has a
+ * tile. Exchanges list the returned letters in tiles.
+ */
+typedef struct {
+    uint8_t type;
+    uint8_t direction;
+    uint8_t row;
+    uint8_t col;
+    uint8_t length;
+    uint8_t tiles_played;
+    char tiles[BOARD_MAX_SIZE];
+    int score;
+} Move;
+
+/* Growable list of generated moves */
+typedef struct {
+    Move *moves;
+    int count;
+    int capacity;
+} MoveList;
+
+/* Receives each generated move; return false to stop generation */
+typedef bool (*MoveVisitor)(const Move *move, void *context);
+
+/* Function prototypes */
+void movegen_list_init(MoveList *list);
+void movegen_list_free(MoveList *list);
+int movegen_generate(const Dawg *dawg, const char *rack, MoveList *list);
+const Move* movegen_best(const MoveList *list);
+int movegen_visit(const Dawg *dawg, const char *rack, MoveVisitor visit, void *context,
+                  const int *floor);
+int movegen_top_k(const Dawg *dawg, const char *rack, Move *best, int k);
+void movegen_best_scores(const Dawg *dawg, const char *const *racks, int count, int *scores);
+void movegen_format(const Move *move, const Alphabet *alphabet, char *buffer, int size);
+
+/* Per-thread line cache */
+void movegen_cache_enable(bool enabled);
+void movegen_cache_stats(uint64_t *hits, uint64_t *misses);
+void movegen_cache_free(void);
+
+#endif /* XSCRABBLE_MOVEGEN_H */
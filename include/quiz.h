@@ -0,0 +1,69 @@
+/**
+ * XScrabble - Quiz Engine Definitions
+ *
+ * A QuizBank is built once from a table of dictionary entries: every
+ * question an entry can give is worked out up front, including the example
+ * sentence with the word blanked out, and entries are grouped by part of
+ * speech so wrong answers come from words of the same kind. A QuizDeck then
+ * draws entries without replacement from a seeded generator. Drawing a
+ * question only fills in pointers into the bank, so any number of decks can
+ * share one bank and serve questions without allocating.
+ */
+
+#ifndef XSCRABBLE_QUIZ_H
+#define XSCRABBLE_QUIZ_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "dictionary_enhanced.h"
+
+/* Multiple-choice answers offered per question, the right one included */
+#define QUIZ_CHOICES 4
+
+typedef enum {
+    QUIZ_MEANING,               /* Word -> English gloss */
+    QUIZ_WORD,                  /* English gloss -> word */
+    QUIZ_BLANK,                 /* Example with the word blanked -> word */
+    QUIZ_DEFINITION,            /* Word -> definition */
+    QUIZ_KINDS
+} QuizKind;
+
+typedef struct {
+    const DictionaryEntry *entries;     /* Borrowed; must outlive the bank */
+    int count;
+    uint8_t *kinds;             /* Per entry: bit k set if QuizKind k can be asked */
+    uint32_t *blank_offsets;    /* Per entry: blanked example in blanks */
+    char *blanks;
+    int *by_speech;             /* Entry indices grouped by part of speech */
+    int *group_first;           /* Per entry: its group's first slot in by_speech... */
+    int *group_size;            /* ...and the group's length */
+} QuizBank;
+
+typedef struct {
+    const QuizBank *bank;
+    int *order;                 /* Askable entries; the first remaining are still to be drawn */
+    int size;
+    int remaining;
+    uint64_t rng;
+} QuizDeck;
+
+typedef struct {
+    QuizKind kind;
+    int entry;
+    const char *prompt;         /* What the question shows */
+    const char *hint;           /* Extra clue, or NULL */
+    const char *answer;
+    const char *choices[QUIZ_CHOICES];
+    int choice_count;
+    int correct;                /* Index of answer in choices */
+} QuizQuestion;
+
+/* Function prototypes */
+bool quiz_bank_build(QuizBank *bank, const DictionaryEntry *entries, int count);
+void quiz_bank_free(QuizBank *bank);
+bool quiz_deck_init(QuizDeck *deck, const QuizBank *bank, uint64_t seed);
+void quiz_deck_free(QuizDeck *deck);
+bool quiz_next(QuizDeck *deck, QuizQuestion *question);
+bool quiz_check(const QuizQuestion *question, const char *response);
+
+#endif /* XSCRABBLE_QUIZ_H */
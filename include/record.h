@@ -0,0 +1,79 @@
+/**
+ * XScrabble - Game Record Definitions
+ */
+
+#ifndef XSCRABBLE_RECORD_H
+#define XSCRABBLE_RECORD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "game.h"
+#include "movegen.h"
+
+#define RECORD_MAGIC "XSGR"
+#define RECORD_VERSION 3
+#define RECORD_LEXICON_MAX 32
+#define RECORD_STREAM_MAX (1u << 20)    /* Longest record a stream accepts */
+
+/* Encoded game record, built in memory and written in one piece */
+typedef struct {
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+} GameRecord;
+
+/* One decoded move with the tiles drawn after it */
+typedef struct {
+    int player;
+    Move move;
+    char drawn[RACK_SIZE + 1];
+} RecordMove;
+
+/* Sequential decoder over one record in a buffer */
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    size_t pos;                         /* Start of the next record once finished */
+    size_t moves_start;
+    uint64_t seed;
+    const Variant *variant;             /* Standard for version 2 records */
+    char lexicon[RECORD_LEXICON_MAX];
+    int tiles_left;
+    char racks[2][RACK_SIZE + 1];
+    int final_scores[2];
+    bool finished;
+} RecordReader;
+
+/* Reads concatenated records from a file one at a time in bounded memory */
+typedef struct {
+    FILE *file;
+    uint8_t *buffer;
+    size_t capacity;
+    size_t start;                       /* First byte not yet returned */
+    size_t end;                         /* One past the last byte read */
+    bool eof;
+    bool error;                         /* Corrupt or unreadable input */
+} RecordStream;
+
+/* Writing */
+void record_init(GameRecord *record);
+void record_free(GameRecord *record);
+bool record_begin(GameRecord *record, const char *lexicon, const GameState *state);
+bool record_add_move(GameRecord *record, int player, const Move *move, const char *drawn);
+bool record_finish(GameRecord *record, const int scores[2]);
+bool record_write(FILE *file, const GameRecord *record);
+
+/* Reading and replay */
+bool record_read_file(const char *filename, uint8_t **data, size_t *size);
+bool record_reader_open(RecordReader *reader, const uint8_t *data, size_t size);
+bool record_reader_next(RecordReader *reader, RecordMove *out);
+int record_replay(RecordReader *reader, int ply);
+
+/* Streaming */
+void record_stream_open(RecordStream *stream, FILE *file);
+void record_stream_close(RecordStream *stream);
+bool record_stream_next(RecordStream *stream, const uint8_t **data, size_t *size);
+
+#endif /* XSCRABBLE_RECORD_H */
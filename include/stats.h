@@ -0,0 +1,80 @@
+/**
+ * XScrabble - Hot-Path Instrumentation Definitions
+ *
+ * Counters and cycle timers are compiled in only when XSCRABBLE_STATS is
+ * defined; otherwise the macros expand to nothing.
+ */
+
+#ifndef XSCRABBLE_STATS_H
+#define XSCRABBLE_STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+/* Instrumented operations */
+typedef enum {
+    STAT_DICTIONARY_LOOKUP,
+    STAT_DICTIONARY_LOAD,
+    STAT_MOVE_GENERATION,
+    STAT_MOVE_SCORING,
+    STAT_MOVE_VALIDATION,
+    STAT_UI_REDRAW,
+    STAT_COUNT
+} StatID;
+
+/* Histogram buckets are powers of two of elapsed ticks */
+#define STATS_HISTOGRAM_BUCKETS 40
+
+/* Aggregated view of one operation across all threads */
+typedef struct {
+    uint64_t count;
+    uint64_t ticks;
+    uint64_t histogram[STATS_HISTOGRAM_BUCKETS];
+} StatsSummary;
+
+/* Read the cheapest available cycle counter */
+static inline uint64_t stats_ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t value;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(value));
+    return value;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+}
+
+#ifdef XSCRABBLE_STATS
+#define STATS_TIMER_BEGIN(timer) uint64_t timer = stats_ticks()
+#define STATS_TIMER_END(timer, id) stats_record((id), stats_ticks() - (timer))
+#define STATS_COUNT(id) stats_record((id), 0)
+#else
+#define STATS_TIMER_BEGIN(timer)
+#define STATS_TIMER_END(timer, id) ((void)0)
+#define STATS_COUNT(id) ((void)0)
+#endif
+
+/* Function prototypes */
+bool stats_enabled(void);
+void stats_record(StatID id, uint64_t ticks);
+void stats_summary(StatID id, StatsSummary *summary);
+const char* stats_name(StatID id);
+void stats_reset(void);
+void stats_dump(FILE *out);
+
+/* Dump on a signal from programs that poll (the X UI uses XtAppAddSignal) */
+bool stats_install_signal(int signo);
+void stats_poll(FILE *out);
+
+#endif /* XSCRABBLE_STATS_H */
@@ -0,0 +1,56 @@
+/**
+ * XScrabble - Tile Set Definitions
+ */
+
+#ifndef XSCRABBLE_TILES_H
+#define XSCRABBLE_TILES_H
+
+#include <stdbool.h>
+#include "alphabet.h"
+
+/* Letter used for blank tiles in tile files and racks */
+#define TILE_BLANK '_'
+
+/*
+ * A blank on the board or in a move is the machine letter it stands for
+ * with this bit set, which for English is simply lowercase. It scores 0.
+ */
+#define TILE_BLANK_BIT 0x20
+
+/* True for a blank standing for a letter (not for TILE_BLANK on a rack) */
+static inline bool tiles_is_blank(char tile)
+{
+    int index = (unsigned char)tile - (ALPHABET_FIRST | TILE_BLANK_BIT);
+    return index >= 0 && index < ALPHABET_MAX_LETTERS;
+}
+
+/* A blank standing for letter */
+static inline char tiles_blank_as(char letter)
+{
+    return (char)(letter | TILE_BLANK_BIT);
+}
+
+/* The machine letter a tile shows, blank or not */
+static inline char tiles_face(char tile)
+{
+    return tiles_is_blank(tile) ? (char)(tile & ~TILE_BLANK_BIT) : tile;
+}
+
+/* Tile distribution entry */
+typedef struct {
+    char letter;
+    int count;
+    int points;
+} TileInfo;
+
+/* Function prototypes */
+bool tiles_load(const char *filename);
+bool tiles_load_alphabet(const char *filename, const Alphabet *alphabet);
+void tiles_reset(void);
+int tiles_letter_value(char letter);
+int tiles_letter_count(char letter);
+int tiles_total(void);
+int tiles_kinds(void);
+const TileInfo* tiles_get(int index);
+
+#endif /* XSCRABBLE_TILES_H */
@@ -0,0 +1,96 @@
+/**
+ * XScrabble - Transposition Table Definitions
+ *
+ * A fixed-size table of search results shared by any number of threads
+ * without locks. Buckets are one cache line of four entries. An entry is
+ * two 64-bit words written and read independently: the packed result and
+ * the position key XORed with it. A reader recomputes the key from both
+ * words, so an entry torn by a concurrent write fails the check and reads
+ * as a miss instead of as another position's result.
+ *
+ * Within a bucket a new result replaces, in order of preference, the
+ * entry for the same position, an empty entry, or the entry with the
+ * lowest depth after charging each search generation it has sat unused.
+ * The table is backed by huge pages when the system has them.
+ */
+
+#ifndef XSCRABBLE_TTABLE_H
+#define XSCRABBLE_TTABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TTABLE_WAYS 4                   /* Entries per 64-byte bucket */
+#define TTABLE_GENERATIONS 64           /* Ages wrap at this */
+#define TTABLE_AGE_COST 4               /* Depth an entry loses per generation of age */
+#define TTABLE_STAT_SHARDS 16           /* Counter blocks, so threads rarely share a line */
+#define TTABLE_OCCUPANCY_SAMPLE 1024    /* Buckets read to estimate occupancy */
+
+/* How a stored value bounds the true one */
+typedef enum {
+    TTABLE_NONE,
+    TTABLE_EXACT,
+    TTABLE_LOWER,
+    TTABLE_UPPER
+} TTableBound;
+
+typedef struct {
+    int32_t value;
+    uint8_t depth;
+    uint8_t bound;
+    uint16_t hint;              /* Caller's move index or other ordering hint */
+} TTableResult;
+
+typedef struct {
+    uint64_t key_xor;           /* Position key ^ data */
+    uint64_t data;              /* Packed result; 0 = empty */
+} TTableEntry;
+
+typedef struct {
+    _Alignas(64) TTableEntry entries[TTABLE_WAYS];
+} TTableBucket;
+
+typedef struct {
+    _Alignas(64) uint64_t probes;
+    uint64_t hits;
+    uint64_t stores;
+    uint64_t replaced;          /* Stores that evicted another position */
+} TTableCounters;
+
+typedef struct {
+    TTableBucket *buckets;
+    uint64_t mask;              /* Bucket count - 1 */
+    size_t bytes;
+    bool mapped;                /* From mmap rather than the heap */
+    bool huge_pages;
+    uint8_t generation;
+    TTableCounters counters[TTABLE_STAT_SHARDS];
+} TTable;
+
+/* Counters summed over threads, and occupancy from a sample of buckets */
+typedef struct {
+    uint64_t buckets;
+    size_t bytes;
+    bool huge_pages;
+    uint64_t probes;
+    uint64_t hits;
+    uint64_t stores;
+    uint64_t replaced;
+    double hit_rate;
+    double occupancy;           /* Entries holding any result */
+    double current;             /* Entries written in the current generation */
+} TTableStats;
+
+/* Function prototypes */
+bool ttable_init(TTable *table, size_t megabytes);
+void ttable_free(TTable *table);
+void ttable_clear(TTable *table);
+void ttable_new_search(TTable *table);
+bool ttable_probe(TTable *table, uint64_t key, TTableResult *result);
+void ttable_store(TTable *table, uint64_t key, int32_t value, int depth, TTableBound bound,
+                  uint16_t hint);
+void ttable_prefetch(const TTable *table, uint64_t key);
+void ttable_stats(const TTable *table, TTableStats *stats);
+
+#endif /* XSCRABBLE_TTABLE_H */
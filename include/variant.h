@@ -0,0 +1,67 @@
+/**
+ * XScrabble - Rule Variant Definitions
+ *
+ * A variant fixes the board size and premium squares, the rack size, the
+ * bingo bonus and the tile set. The set of variants is closed at compile
+ * time: VARIANT_LIST names each one and VARIANT_<ID>_* give its numbers
+ * as constants, so the hot kernels can be compiled once per variant with
+ * fixed loop bounds and table sizes (see src/movegen_kernel.h) and picked
+ * at run time from the board's variant. Storage that must hold any
+ * variant is sized by the largest.
+ */
+
+#ifndef XSCRABBLE_VARIANT_H
+#define XSCRABBLE_VARIANT_H
+
+#include <stdbool.h>
+#include "tiles.h"
+
+/* Every variant, in the order of VariantId */
+#define VARIANT_LIST(X) X(STANDARD) X(SUPER) X(QUICK)
+
+/* Classic 15x15 board with the 100-tile English set */
+#define VARIANT_STANDARD_NAME "standard"
+#define VARIANT_STANDARD_SIZE 15
+#define VARIANT_STANDARD_RACK 7
+#define VARIANT_STANDARD_BINGO 50
+
+/* 21x21 board with a 200-tile set */
+#define VARIANT_SUPER_NAME "super"
+#define VARIANT_SUPER_SIZE 21
+#define VARIANT_SUPER_RACK 7
+#define VARIANT_SUPER_BINGO 50
+
+/* 11x11 board, six-tile racks and a 54-tile set */
+#define VARIANT_QUICK_NAME "quick"
+#define VARIANT_QUICK_SIZE 11
+#define VARIANT_QUICK_RACK 6
+#define VARIANT_QUICK_BINGO 30
+
+/* Largest board of any variant; RACK_SIZE in movegen.h is the largest rack */
+#define BOARD_MAX_SIZE 21
+
+typedef enum {
+#define VARIANT_ENUM(ID) VARIANT_##ID,
+    VARIANT_LIST(VARIANT_ENUM)
+#undef VARIANT_ENUM
+    VARIANT_COUNT
+} VariantId;
+
+typedef struct {
+    VariantId id;
+    const char *name;
+    int board_size;
+    int rack_size;
+    int bingo_bonus;
+    const char *premiums;       /* Rows of squares: . plain, d/t letter, D/T word premiums */
+    const TileInfo *tiles;
+    int tile_kinds;
+} Variant;
+
+/* Function prototypes */
+const Variant* variant_get(VariantId id);
+const Variant* variant_find(const char *name);
+const Variant* variant_current(void);
+bool variant_select(const char *name);
+
+#endif /* XSCRABBLE_VARIANT_H */
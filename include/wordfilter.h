@@ -0,0 +1,33 @@
+/**
+ * XScrabble - Word Prefilter Definitions
+ *
+ * Split-block Bloom filter over a word list. Each word maps to one 64-byte
+ * block and sets one bit in each of its eight 64-bit lanes, so a query
+ * touches a single cache line. A "no" is exact; a "maybe" still needs the
+ * real lookup.
+ */
+
+#ifndef XSCRABBLE_WORDFILTER_H
+#define XSCRABBLE_WORDFILTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* About 0.2% false positives at 14 bits per word */
+#define WORDFILTER_BITS_PER_WORD 14
+#define WORDFILTER_LANES 8
+
+typedef struct {
+    uint64_t *blocks;           /* block_count * WORDFILTER_LANES lanes, cache-line aligned */
+    uint32_t block_count;
+} WordFilter;
+
+/* Function prototypes */
+bool wordfilter_init(WordFilter *filter, size_t words);
+void wordfilter_free(WordFilter *filter);
+void wordfilter_add(WordFilter *filter, const char *word);
+bool wordfilter_may_contain(const WordFilter *filter, const char *word);
+size_t wordfilter_bytes(const WordFilter *filter);
+
+#endif /* XSCRABBLE_WORDFILTER_H */
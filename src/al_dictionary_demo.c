@@ -10,15 +10,12 @@
 #include <string.h>
 #include <ctype.h>
 #include <stdbool.h>
+#include <time.h>
+#include "dictionary_enhanced.h"
+#include "quiz.h"
 
 /* Dictionary entry structure with definitions */
-typedef struct {
-    char word[32];
-    char *definition;
-    char *english_definition;
-    char *example;
-    char *part_of_speech;
-} ALDictionaryEntry;
+typedef DictionaryEntry ALDictionaryEntry;
 
 #define MAX_ENTRIES 1000
 #define MAX_LINE_LENGTH 256
@@ -27,6 +24,8 @@ static ALDictionaryEntry *dictionary = NULL;
 static int entry_count = 0;
 static char **word_list = NULL;
 static int word_count = 0;
+static QuizBank quiz_bank;
+static QuizDeck quiz_deck;
 
 /* Function prototypes */
 bool load_word_list(const char *filename);
@@ -43,7 +42,7 @@ int main(int argc, char *argv[]) {
     printf("=======================================\n\n");
 
     /* Initialize dictionary with word list and definitions */
-    dictionary = (ALDictionaryEntry *)malloc(MAX_ENTRIES * sizeof(ALDictionaryEntry));
+    dictionary = (ALDictionaryEntry *)calloc(MAX_ENTRIES, sizeof(ALDictionaryEntry));
     if (!dictionary) {
         fprintf(stderr, "Failed to allocate memory for dictionary\n");
         return 1;
@@ -76,6 +75,12 @@ int main(int argc, char *argv[]) {
 
     printf("Loaded %d words and %d definitions\n\n", word_count, entry_count);
 
+    /* Work out every quiz question once, up front */
+    if (!quiz_bank_build(&quiz_bank, dictionary, entry_count) ||
+        !quiz_deck_init(&quiz_deck, &quiz_bank, (uint64_t)time(NULL))) {
+        fprintf(stderr, "Warning: Failed to prepare quiz questions\n");
+    }
+
     /* Process command-line arguments */
     if (argc > 1) {
         if (strcmp(argv[1], "-i") == 0) {
@@ -334,6 +339,9 @@ bool load_definitions(const char *filename) {
 
 /* Clean up resources */
 void cleanup(void) {
+    quiz_deck_free(&quiz_deck);
+    quiz_bank_free(&quiz_bank);
+    
     if (dictionary) {
         for (int i = 0; i < entry_count; i++) {
             if (dictionary[i].definition) free(dictionary[i].definition);
@@ -430,164 +438,62 @@ void list_all_words(void) {
     printf("\n");
 }
 
-/* Quiz the user on random words */
+/* Quiz the user on words drawn from the quiz deck */
 void random_quiz(int num_questions) {
-    if (entry_count == 0) {
+    if (quiz_deck.size == 0) {
         printf("No definitions available for quiz.\n");
         return;
     }
     
-    if (num_questions > entry_count) {
-        num_questions = entry_count;
+    if (num_questions > quiz_deck.size) {
+        num_questions = quiz_deck.size;
     }
     
     printf("French Learning Quiz (%d questions)\n", num_questions);
     printf("----------------------------------\n\n");
     
     int correct = 0;
-    char answer[64];
+    char answer[256];
+    QuizQuestion question;
     
-    for (int i = 0; i < num_questions; i++) {
-        int idx = rand() % entry_count;
-        const ALDictionaryEntry *entry = &dictionary[idx];
-        
-        /* Determine quiz type (1=FR->EN, 2=EN->FR, 3=Example) */
-        int quiz_type = (rand() % 3) + 1;
-        
-        if (quiz_type == 1 && entry->english_definition) {
-            /* French to English */
-            printf("Q%d: What does \"%s\" mean in English?\n", i+1, entry->word);
-            printf("Definition (FR): %s\n", entry->definition);
-            printf("Your answer: ");
-            
-            /* Clear input buffer */
-            int c;
-            while ((c = getchar()) != '\n' && c != EOF);
-            
-            if (fgets(answer, sizeof(answer), stdin)) {
-                /* Remove newline */
-                size_t len = strlen(answer);
-                if (len > 0 && answer[len - 1] == '\n') {
-                    answer[len - 1] = '\0';
-                }
-                
-                printf("Correct answer: %s\n", entry->english_definition);
-                /* Very simple answer checking - in a real app, use better matching */
-                if (strstr(entry->english_definition, answer) || strstr(answer, entry->english_definition)) {
-                    printf("Correct!\n\n");
-                    correct++;
-                } else {
-                    printf("Not quite. Keep learning!\n\n");
-                }
-            }
+    for (int i = 0; i < num_questions && quiz_next(&quiz_deck, &question); i++) {
+        switch (question.kind) {
+        case QUIZ_MEANING:
+            printf("Q%d: What does \"%s\" mean in English?\n", i+1, question.prompt);
+            printf("Definition (FR): %s\n", question.hint);
+            break;
+        case QUIZ_WORD:
+            printf("Q%d: What is the AL dictionary word for \"%s\"?\n", i+1, question.prompt);
+            break;
+        case QUIZ_BLANK:
+            printf("Q%d: Fill in the blank with the correct word:\n", i+1);
+            printf("%s\n", question.prompt);
+            printf("Hint: %s\n", question.hint);
+            break;
+        default:
+            printf("Q%d: What is the meaning of \"%s\"?\n", i+1, question.prompt);
+            break;
         }
-        else if (quiz_type == 2 && entry->english_definition) {
-            /* English to French */
-            printf("Q%d: What is the AL dictionary word for \"%s\"?\n", i+1, entry->english_definition);
-            printf("Your answer: ");
-            
-            /* Clear input buffer */
-            int c;
-            while ((c = getchar()) != '\n' && c != EOF);
-            
-            if (fgets(answer, sizeof(answer), stdin)) {
-                /* Remove newline */
-                size_t len = strlen(answer);
-                if (len > 0 && answer[len - 1] == '\n') {
-                    answer[len - 1] = '\0';
-                }
-                
-                /* Convert to uppercase for comparison */
-                for (int j = 0; answer[j]; j++) {
-                    answer[j] = toupper(answer[j]);
-                }
-                
-                printf("Correct answer: %s\n", entry->word);
-                if (strcmp(answer, entry->word) == 0) {
-                    printf("Correct!\n\n");
-                    correct++;
-                } else {
-                    printf("Not quite. Keep learning!\n\n");
-                }
-            }
+        for (int j = 0; j < question.choice_count; j++) {
+            printf("  %c) %s\n", 'a' + j, question.choices[j]);
         }
-        else if (quiz_type == 3 && entry->example) {
-            /* Fill in the blank */
-            /* Replace the word in the example with blanks */
-            char example_with_blank[256];
-            strcpy(example_with_blank, entry->example);
-            
-            /* Create blank string of same length as word */
-            char blank[32];
-            size_t word_len = strlen(entry->word);
-            for (int j = 0; j < word_len; j++) {
-                blank[j] = '_';
-            }
-            blank[word_len] = '\0';
-            
-            /* Find word in example and replace with blank */
-            char *word_pos = strstr(example_with_blank, entry->word);
-            if (word_pos) {
-                strncpy(word_pos, blank, word_len);
-            }
-            
-            printf("Q%d: Fill in the blank with the correct word:\n", i+1);
-            printf("%s\n", example_with_blank);
-            if (entry->definition) {
-                printf("Hint: %s\n", entry->definition);
-            }
-            printf("Your answer: ");
-            
-            /* Clear input buffer */
-            int c;
+        printf("Your answer: ");
+        
+        /* Clear input buffer */
+        int c;
+        if (i == 0) {
             while ((c = getchar()) != '\n' && c != EOF);
-            
-            if (fgets(answer, sizeof(answer), stdin)) {
-                /* Remove newline */
-                size_t len = strlen(answer);
-                if (len > 0 && answer[len - 1] == '\n') {
-                    answer[len - 1] = '\0';
-                }
-                
-                /* Convert to uppercase for comparison */
-                for (int j = 0; answer[j]; j++) {
-                    answer[j] = toupper(answer[j]);
-                }
-                
-                printf("Correct answer: %s\n", entry->word);
-                if (strcmp(answer, entry->word) == 0) {
-                    printf("Correct!\n\n");
-                    correct++;
-                } else {
-                    printf("Not quite. Keep learning!\n\n");
-                }
-            }
         }
-        else {
-            /* Fallback quiz type */
-            printf("Q%d: What is the meaning of \"%s\"?\n", i+1, entry->word);
-            printf("Your answer: ");
-            
-            /* Clear input buffer */
-            int c;
-            while ((c = getchar()) != '\n' && c != EOF);
-            
-            if (fgets(answer, sizeof(answer), stdin)) {
-                /* Remove newline */
-                size_t len = strlen(answer);
-                if (len > 0 && answer[len - 1] == '\n') {
-                    answer[len - 1] = '\0';
-                }
-                
-                printf("Meaning: %s\n", entry->definition);
-                /* Very simple answer checking */
-                if (strstr(entry->definition, answer) || strstr(answer, entry->definition)) {
-                    printf("Correct!\n\n");
-                    correct++;
-                } else {
-                    printf("Not quite. Keep learning!\n\n");
-                }
-            }
+        
+        if (!fgets(answer, sizeof(answer), stdin)) {
+            break;
+        }
+        printf("Correct answer: %c) %s\n", 'a' + question.correct, question.answer);
+        if (quiz_check(&question, answer)) {
+            printf("Correct!\n\n");
+            correct++;
+        } else {
+            printf("Not quite. Keep learning!\n\n");
         }
     }
     
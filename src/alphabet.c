@@ -0,0 +1,230 @@
+/**
+ * XScrabble - Alphabet Implementation
+ *
+ * An alphabet file lists one tile per line: the face as it should be
+ * printed, then any other spellings that mean the same tile, e.g.
+ * "E É È Ê" to fold French accents or "Ñ ñ" for a letter outside ASCII.
+ * ASCII always matches in either case. Encoding takes the longest
+ * spelling at each position, so "CH" wins over "C" where both exist.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "alphabet.h"
+#include "tiles.h"
+
+_Static_assert(ALPHABET_FIRST + ALPHABET_MAX_LETTERS == TILE_BLANK,
+               "the blank must follow the last machine letter");
+
+#define MAX_ALPHABET_FILE 65536
+
+static Alphabet english;
+static pthread_once_t english_once = PTHREAD_ONCE_INIT;
+
+/* ASCII case folding; other bytes are compared as they are */
+static unsigned char fold(char c)
+{
+    return c >= 'a' && c <= 'z' ? (unsigned char)(c - 'a' + 'A') : (unsigned char)c;
+}
+
+/* Group spellings by folded first byte, longest first within a group */
+static int compare_spellings(const void *a, const void *b)
+{
+    const AlphabetSpelling *x = (const AlphabetSpelling *)a;
+    const AlphabetSpelling *y = (const AlphabetSpelling *)b;
+    if (fold(x->text[0]) != fold(y->text[0])) {
+        return fold(x->text[0]) - fold(y->text[0]);
+    }
+    return y->length - x->length;
+}
+
+static bool spelling_matches(const char *text, const AlphabetSpelling *spelling)
+{
+    for (int i = 0; i < spelling->length; i++) {
+        if (fold(text[i]) != fold(spelling->text[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static const AlphabetSpelling* find_spelling(const Alphabet *alphabet, const char *text)
+{
+    unsigned char byte = fold(*text);
+    int end = alphabet->first[byte] + alphabet->count[byte];
+    for (int i = alphabet->first[byte]; i < end; i++) {
+        if (spelling_matches(text, &alphabet->spellings[i])) {
+            return &alphabet->spellings[i];
+        }
+    }
+    return NULL;
+}
+
+static void build_english(void)
+{
+    alphabet_parse(&english, "A\nB\nC\nD\nE\nF\nG\nH\nI\nJ\nK\nL\nM\n"
+                             "N\nO\nP\nQ\nR\nS\nT\nU\nV\nW\nX\nY\nZ\n");
+}
+
+/* The 26-letter alphabet used when a lexicon names no other */
+const Alphabet* alphabet_english(void)
+{
+    pthread_once(&english_once, build_english);
+    return &english;
+}
+
+/* Read an alphabet from the text of an alphabet file */
+bool alphabet_parse(Alphabet *alphabet, const char *text)
+{
+    Alphabet parsed;
+    const char *p = text;
+
+    memset(&parsed, 0, sizeof(parsed));
+    while (*p) {
+        int tokens = 0;
+
+        /* One line: the display face, then other spellings */
+        while (*p && *p != '\n') {
+            if (*p == ' ' || *p == '\t' || *p == '\r') {
+                p++;
+                continue;
+            }
+            if (*p == '#') {
+                while (*p && *p != '\n') {
+                    p++;
+                }
+                break;
+            }
+
+            size_t length = strcspn(p, " \t\r\n");
+            if (length > ALPHABET_MAX_SPELLING) {
+                fprintf(stderr, "Alphabet spelling %.*s is longer than %d bytes\n",
+                        (int)length, p, ALPHABET_MAX_SPELLING);
+                return false;
+            }
+            if (tokens == 0 && parsed.size == ALPHABET_MAX_LETTERS) {
+                fprintf(stderr, "Alphabet has more than %d letters\n", ALPHABET_MAX_LETTERS);
+                return false;
+            }
+            if (parsed.spelling_count == ALPHABET_MAX_SPELLINGS) {
+                fprintf(stderr, "Alphabet has more than %d spellings\n", ALPHABET_MAX_SPELLINGS);
+                return false;
+            }
+            for (int i = 0; i < parsed.spelling_count; i++) {
+                const AlphabetSpelling *other = &parsed.spellings[i];
+                if (other->length == length && spelling_matches(p, other)) {
+                    fprintf(stderr, "Alphabet spelling %.*s is listed twice\n", (int)length, p);
+                    return false;
+                }
+            }
+
+            AlphabetSpelling *spelling = &parsed.spellings[parsed.spelling_count++];
+            memcpy(spelling->text, p, length);
+            spelling->length = (uint8_t)length;
+            spelling->letter = (uint8_t)parsed.size;
+            if (tokens == 0) {
+                memcpy(parsed.display[parsed.size], p, length);
+            }
+            tokens++;
+            p += length;
+        }
+        if (tokens > 0) {
+            parsed.size++;
+        }
+        if (*p == '\n') {
+            p++;
+        }
+    }
+    if (parsed.size == 0) {
+        fprintf(stderr, "Alphabet has no letters\n");
+        return false;
+    }
+
+    qsort(parsed.spellings, parsed.spelling_count, sizeof(AlphabetSpelling), compare_spellings);
+    for (int i = parsed.spelling_count - 1; i >= 0; i--) {
+        unsigned char byte = fold(parsed.spellings[i].text[0]);
+        parsed.first[byte] = (uint8_t)i;
+        parsed.count[byte]++;
+    }
+    *alphabet = parsed;
+    return true;
+}
+
+/* Load an alphabet file */
+bool alphabet_load(Alphabet *alphabet, const char *filename)
+{
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        return false;
+    }
+
+    char *text = (char *)malloc(MAX_ALPHABET_FILE + 1);
+    size_t size = text ? fread(text, 1, MAX_ALPHABET_FILE, file) : 0;
+    bool loaded = false;
+    if (text && size < MAX_ALPHABET_FILE) {
+        text[size] = '\0';
+        loaded = alphabet_parse(alphabet, text);
+    }
+
+    free(text);
+    fclose(file);
+    return loaded;
+}
+
+/*
+ * Turn UTF-8 text into a NUL-terminated string of machine letters.
+ * Returns the number of letters, or -1 if some text is not a letter of
+ * the alphabet or the result does not fit in capacity bytes.
+ */
+int alphabet_encode(const Alphabet *alphabet, const char *text, char *letters, int capacity)
+{
+    int count = 0;
+
+    for (const char *p = text; *p; ) {
+        const AlphabetSpelling *spelling = find_spelling(alphabet, p);
+        if (!spelling || count + 1 >= capacity) {
+            return -1;
+        }
+        letters[count++] = alphabet_letter(spelling->letter);
+        p += spelling->length;
+    }
+    if (capacity < 1) {
+        return -1;
+    }
+    letters[count] = '\0';
+    return count;
+}
+
+/*
+ * Write count machine letters as UTF-8 into text, NUL-terminated.
+ * Letters outside the alphabet come out as '?'. Returns the number of
+ * bytes written, or -1 if text is too small.
+ */
+int alphabet_decode(const Alphabet *alphabet, const char *letters, int count, char *text, int size)
+{
+    int length = 0;
+
+    for (int i = 0; i < count; i++) {
+        const char *face = alphabet_spelling(alphabet, letters[i]);
+        int bytes = face ? (int)strlen(face) : 1;
+        if (length + bytes >= size) {
+            return -1;
+        }
+        memcpy(text + length, face ? face : "?", bytes);
+        length += bytes;
+    }
+    if (size < 1) {
+        return -1;
+    }
+    text[length] = '\0';
+    return length;
+}
+
+/* Printed face of a machine letter, or NULL; ASCII lowercase is accepted */
+const char* alphabet_spelling(const Alphabet *alphabet, char letter)
+{
+    int index = alphabet_index(alphabet, (char)fold(letter));
+    return index < 0 ? NULL : alphabet->display[index];
+}
@@ -0,0 +1,691 @@
+/**
+ * XScrabble - Batch Game Analysis
+ *
+ * Annotates every position of archived games with the engine's best
+ * plays. Records are streamed from the input files and each position is
+ * one job for the worker pool, so an archive of a few long games still
+ * spreads over every core. The job queue is bounded and a game's record
+ * is freed once its last position is done, so memory does not grow with
+ * the archive. Lines are written as positions finish and carry the game
+ * and ply; sort them if order matters.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "game.h"
+#include "board.h"
+#include "endgame.h"
+#include "eval.h"
+#include "gcg.h"
+#include "infer.h"
+#include "lexicon.h"
+#include "movegen.h"
+#include "record.h"
+#include "tiles.h"
+#include "config.h"
+
+#define MAX_THREADS 256
+#define MAX_TOP 16
+#define JOBS_PER_THREAD 64      /* Queue capacity per worker */
+#define OUTPUT_LINE_MAX 2048
+#define TABLE_MEGABYTES 256     /* Pre-endgame transposition table, shared by the workers */
+
+/* One archived game, shared by the jobs for its positions */
+typedef struct {
+    long index;
+    int pending;                /* Positions not yet analysed */
+    size_t size;
+    uint8_t data[];
+} ArchiveGame;
+
+/* Analyse the position before move ply of game */
+typedef struct {
+    ArchiveGame *game;
+    int ply;
+} Job;
+
+/* Settings, the bounded job queue and the output */
+typedef struct {
+    char lexicon[RECORD_LEXICON_MAX];
+    const Alphabet *alphabet;
+    const EvalWeights *weights;         /* Rank by equity if set, else by score */
+    int top;
+    int sims;
+    int plies;                          /* Pre-endgame search depth; 0 for none */
+    TTable table;
+    uint64_t seed;
+
+    Job *jobs;
+    int capacity;
+    int head;
+    int count;
+    bool closed;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+
+    FILE *out;
+    pthread_mutex_t out_lock;
+} Analysis;
+
+/* Per-thread totals, summed after the pool finishes */
+typedef struct {
+    Analysis *analysis;
+    long positions;
+    long best_played;
+    long failed;
+    double loss;
+} Worker;
+
+/* A candidate play and its value */
+typedef struct {
+    Move move;
+    float value;
+    float sim;                  /* Value less the mean best reply */
+} Candidate;
+
+/* Simulation seed for one position */
+static uint64_t position_seed(uint64_t base, long game, int ply)
+{
+    uint64_t z = base + 0x9e3779b97f4a7c15ULL * (uint64_t)(game * 1024 + ply + 1);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Block until there is room, then queue a job */
+static void push_job(Analysis *a, ArchiveGame *game, int ply)
+{
+    pthread_mutex_lock(&a->lock);
+    while (a->count == a->capacity) {
+        pthread_cond_wait(&a->not_full, &a->lock);
+    }
+    Job *job = &a->jobs[(a->head + a->count) % a->capacity];
+    job->game = game;
+    job->ply = ply;
+    a->count++;
+    pthread_cond_signal(&a->not_empty);
+    pthread_mutex_unlock(&a->lock);
+}
+
+/* Block until a job is queued; false once the queue is closed and drained */
+static bool pop_job(Analysis *a, Job *job)
+{
+    pthread_mutex_lock(&a->lock);
+    while (a->count == 0 && !a->closed) {
+        pthread_cond_wait(&a->not_empty, &a->lock);
+    }
+    bool found = a->count > 0;
+    if (found) {
+        *job = a->jobs[a->head];
+        a->head = (a->head + 1) % a->capacity;
+        a->count--;
+        pthread_cond_signal(&a->not_full);
+    }
+    pthread_mutex_unlock(&a->lock);
+    return found;
+}
+
+static void close_queue(Analysis *a)
+{
+    pthread_mutex_lock(&a->lock);
+    a->closed = true;
+    pthread_cond_broadcast(&a->not_empty);
+    pthread_mutex_unlock(&a->lock);
+}
+
+static float move_value(const Analysis *a, const EvalContext *context, const Move *move)
+{
+    return a->weights ? eval_equity(context, move) : (float)move->score;
+}
+
+static bool same_move(const Move *x, const Move *y)
+{
+    return x->type == y->type && x->row == y->row && x->col == y->col &&
+           x->direction == y->direction && x->length == y->length &&
+           memcmp(x->tiles, y->tiles, x->length) == 0;
+}
+
+/*
+ * Score each candidate against sampled opponent racks: play it, draw from
+ * the unseen tiles, and charge the opponent's best reply. Every candidate
+ * sees the same samples, so their differences are not sampling noise.
+ */
+static void simulate(const Analysis *a, const Dawg *dawg, Candidate *candidates, int count,
+                     uint64_t seed)
+{
+    GameState *state = game_get_state();
+    GameSnapshot position;
+    char unseen[BAG_CAPACITY + RACK_SIZE + 1];
+    double replies[MAX_TOP + 1] = {0};
+    int player = state->to_move;
+    int opponent = 1 - player;
+    int held = (int)strlen(state->racks[opponent]);
+    int total = infer_unseen(player, unseen, sizeof(unseen));
+    uint64_t rng = seed;
+
+    if (total < held) {
+        for (int c = 0; c < count; c++) {
+            candidates[c].sim = candidates[c].value;
+        }
+        return;
+    }
+    game_snapshot(&position);
+
+    for (int s = 0; s < a->sims; s++) {
+        /* Shuffle enough of the pool for the opponent's rack and our draw */
+        int needed = held + RACK_SIZE < total ? held + RACK_SIZE : total;
+        for (int i = 0; i < needed; i++) {
+            int j = i + (int)(next_random(&rng) % (uint64_t)(total - i));
+            char tile = unseen[i];
+            unseen[i] = unseen[j];
+            unseen[j] = tile;
+        }
+        char rack[RACK_SIZE + 1];
+        memcpy(rack, unseen, held);
+        rack[held] = '\0';
+
+        for (int c = 0; c < count; c++) {
+            const Move *move = &candidates[c].move;
+            char drawn[RACK_SIZE + 1];
+            int draws = move->type == MOVE_PLACE ? move->tiles_played :
+                        move->type == MOVE_EXCHANGE ? move->length : 0;
+            if (draws > position.tiles_left) {
+                draws = position.tiles_left;
+            }
+            memcpy(drawn, unseen + held, draws);
+            drawn[draws] = '\0';
+
+            Move reply;
+            game_restore(&position);
+            if (game_apply_move(move, drawn) && !state->over) {
+                strcpy(state->racks[opponent], rack);
+                if (movegen_top_k(dawg, rack, &reply, 1) == 1) {
+                    replies[c] += reply.score;
+                }
+            }
+        }
+    }
+    game_restore(&position);
+
+    for (int c = 0; c < count; c++) {
+        candidates[c].sim = candidates[c].value - (float)(replies[c] / a->sims);
+    }
+}
+
+static int compare_sims(const void *x, const void *y)
+{
+    float a = ((const Candidate *)x)->sim;
+    float b = ((const Candidate *)y)->sim;
+    return (a < b) - (a > b);
+}
+
+/* Value candidates by pre-endgame search into sim; false if the bag cannot be searched */
+static bool search_preendgame(Analysis *a, const Dawg *dawg, Candidate *candidates, int count)
+{
+    EndgameCandidate values[MAX_TOP + 1];
+    PreendgameSearch search;
+
+    endgame_pre_defaults(&search);
+    search.plies = a->plies;
+    search.table = &a->table;
+    for (int c = 0; c < count; c++) {
+        values[c].move = candidates[c].move;
+    }
+    if (!endgame_pre_solve(&search, dawg, values, count)) {
+        return false;
+    }
+    for (int c = 0; c < count; c++) {
+        candidates[c].sim = (float)values[c].value;
+    }
+    return true;
+}
+
+/* Analyse one position and write its line; false if the record does not replay */
+static bool analyse(Worker *worker, const Job *job, MoveList *list)
+{
+    Analysis *a = worker->analysis;
+    GameState *state = game_get_state();
+    const Dawg *dawg = state->lexicon->dawg;
+    RecordReader reader;
+    RecordMove played;
+    EvalContext context;
+    Candidate candidates[MAX_TOP + 1];
+    int count = 0;
+
+    if (!record_reader_open(&reader, job->game->data, job->game->size) ||
+        record_replay(&reader, job->ply) != job->ply || !record_reader_next(&reader, &played)) {
+        return false;
+    }
+    state->to_move = played.player;
+    const char *rack = state->racks[played.player];
+    if (a->weights) {
+        eval_prepare(&context, a->weights, rack, state->tiles_left);
+    }
+
+    /* Keep the best few plays in order, and rank the one made among all of them */
+    float played_value = move_value(a, &context, &played.move);
+    int rank = 1;
+    int moves = movegen_generate(dawg, rack, list);
+    for (int i = 0; i < moves; i++) {
+        const Move *move = &list->moves[i];
+        float value = move_value(a, &context, move);
+        rank += value > played_value;
+        if (count == a->top && value <= candidates[count - 1].value) {
+            continue;
+        }
+        int slot = count < a->top ? count++ : count - 1;
+        while (slot > 0 && candidates[slot - 1].value < value) {
+            candidates[slot] = candidates[slot - 1];
+            slot--;
+        }
+        candidates[slot].move = *move;
+        candidates[slot].value = value;
+    }
+
+    /*
+     * Simulations compare the played move with the candidates on the same
+     * samples; with a few tiles in the bag, the pre-endgame search does
+     * instead, on every split of the unseen tiles.
+     */
+    int with_played = count;
+    bool listed = false;
+    bool pre = a->plies > 0 && state->tiles_left >= 1 && state->tiles_left <= ENDGAME_MAX_BAG;
+    for (int c = 0; c < count; c++) {
+        listed |= same_move(&candidates[c].move, &played.move);
+    }
+    if ((a->sims > 0 || pre) && !listed) {
+        candidates[with_played].move = played.move;
+        candidates[with_played++].value = played_value;
+    }
+    pre = pre && search_preendgame(a, dawg, candidates, with_played);
+    if (!pre && a->sims > 0) {
+        simulate(a, dawg, candidates, with_played,
+                 position_seed(a->seed, job->game->index, job->ply));
+    }
+    bool valued = pre || a->sims > 0;
+    float played_sim = played_value;
+    if (valued) {
+        for (int c = 0; c < with_played; c++) {
+            if (same_move(&candidates[c].move, &played.move)) {
+                played_sim = candidates[c].sim;
+            }
+        }
+        qsort(candidates, with_played, sizeof(Candidate), compare_sims);
+        count = with_played < a->top ? with_played : a->top;
+    }
+
+    float best = count > 0 ? (valued ? candidates[0].sim : candidates[0].value) : 0.0f;
+    float loss = best > played_sim ? best - played_sim : 0.0f;
+    worker->positions++;
+    worker->best_played += loss == 0.0f;
+    worker->loss += loss;
+
+    /* game ply player rack played value rank/moves loss, then the candidates */
+    char line[OUTPUT_LINE_MAX];
+    char text[BOARD_MAX_SIZE * 8 + 32];
+    char letters[RACK_SIZE * 8 + 1];
+    if (alphabet_decode(a->alphabet, rack, (int)strlen(rack), letters, sizeof(letters)) < 0) {
+        strcpy(letters, rack);
+    }
+    movegen_format(&played.move, a->alphabet, text, sizeof(text));
+    int length = snprintf(line, sizeof(line), "%ld\t%d\t%d\t%s\t%s\t%.1f\t%d/%d\t%.1f",
+                          job->game->index, job->ply, played.player + 1, letters, text,
+                          played_sim, rank, moves, loss);
+    for (int c = 0; c < count && length < OUTPUT_LINE_MAX; c++) {
+        movegen_format(&candidates[c].move, a->alphabet, text, sizeof(text));
+        length += snprintf(line + length, sizeof(line) - length, "\t%s=%.1f", text,
+                           valued ? candidates[c].sim : candidates[c].value);
+    }
+    pthread_mutex_lock(&a->out_lock);
+    fprintf(a->out, "%s\n", line);
+    pthread_mutex_unlock(&a->out_lock);
+    return true;
+}
+
+static void *worker_main(void *arg)
+{
+    Worker *worker = (Worker *)arg;
+    Analysis *a = worker->analysis;
+    MoveList list;
+    Job job;
+
+    movegen_list_init(&list);
+    game_use_lexicon(a->lexicon);
+    while (pop_job(a, &job)) {
+        if (!analyse(worker, &job, &list)) {
+            worker->failed++;
+        }
+        if (__atomic_sub_fetch(&job.game->pending, 1, __ATOMIC_ACQ_REL) == 0) {
+            free(job.game);
+        }
+    }
+
+    movegen_list_free(&list);
+    lexicon_release(game_get_state()->lexicon);
+    game_get_state()->lexicon = NULL;
+    movegen_cache_free();
+    return NULL;
+}
+
+/* Copy a record and queue a job per position; blocks while the queue is full */
+static bool queue_game(Analysis *a, const uint8_t *data, size_t size, long index)
+{
+    RecordReader reader;
+    RecordMove entry;
+    int plies = 0;
+
+    if (!record_reader_open(&reader, data, size)) {
+        return false;
+    }
+    while (record_reader_next(&reader, &entry)) {
+        plies++;
+    }
+    if (!reader.finished) {
+        return false;
+    }
+    if (plies == 0) {
+        return true;
+    }
+
+    ArchiveGame *game = (ArchiveGame *)malloc(sizeof(ArchiveGame) + size);
+    if (!game) {
+        return false;
+    }
+    game->index = index;
+    game->pending = plies;
+    game->size = size;
+    memcpy(game->data, data, size);
+    for (int ply = 0; ply < plies; ply++) {
+        push_job(a, game, ply);
+    }
+    return true;
+}
+
+/* Stream every game of one input; GCG files hold a single game */
+static bool queue_file(Analysis *a, const char *filename, long *games)
+{
+    bool stdin_input = strcmp(filename, "-") == 0;
+    const char *extension = strrchr(filename, '.');
+    bool gcg = extension && strcmp(extension, ".gcg") == 0;
+    FILE *file = stdin_input ? stdin : fopen(filename, gcg ? "r" : "rb");
+    bool ok = true;
+
+    if (!file) {
+        fprintf(stderr, "Cannot open %s\n", filename);
+        return false;
+    }
+
+    if (gcg) {
+        GameRecord record;
+        record_init(&record);
+        ok = gcg_import(file, &record) && queue_game(a, record.data, record.size, (*games)++);
+        record_free(&record);
+    } else {
+        RecordStream stream;
+        const uint8_t *data;
+        size_t size;
+        record_stream_open(&stream, file);
+        while (ok && record_stream_next(&stream, &data, &size)) {
+            ok = queue_game(a, data, size, (*games)++);
+        }
+        ok = ok && !stream.error;
+        record_stream_close(&stream);
+    }
+
+    if (!ok) {
+        fprintf(stderr, "Corrupt game record in %s after %ld games\n", filename, *games);
+    }
+    if (!stdin_input) {
+        fclose(file);
+    }
+    return ok;
+}
+
+/* Lexicon ID: the word list's file name without extension */
+static void lexicon_name(const char *path, char *name, size_t size)
+{
+    const char *base = strrchr(path, '/');
+    base = base ? base + 1 : path;
+    size_t length = strcspn(base, ".");
+    if (length >= size) {
+        length = size - 1;
+    }
+    memcpy(name, base, length);
+    name[length] = '\0';
+}
+
+static void print_usage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: %s [-j threads] [-V variant] [-d wordlist] [-a alphabet] [-t tiles] "
+            "[-k top] [-e] [-w weights] [-n sims] [-p plies] [-s seed] [-o output] FILE...\n"
+            "FILE is a record file from selfplay -o, a .gcg game, or - for stdin\n", program);
+}
+
+int main(int argc, char *argv[])
+{
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    const char *wordlist = DICTIONARY_FILE;
+    const char *tiles_file = NULL;
+    const char *variant = NULL;
+    const char *alphabet_file = NULL;
+    const char *weights_file = NULL;
+    const char *output_file = NULL;
+    bool equity = false;
+    int first_input = argc;
+    Analysis a;
+
+    memset(&a, 0, sizeof(a));
+    a.top = 3;
+    a.seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-V") == 0 && i + 1 < argc) {
+            variant = argv[++i];
+        }
+        else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            wordlist = argv[++i];
+        }
+        else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) {
+            alphabet_file = argv[++i];
+        }
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            tiles_file = argv[++i];
+        }
+        else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc) {
+            a.top = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-e") == 0) {
+            equity = true;
+        }
+        else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            weights_file = argv[++i];
+            equity = true;
+        }
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            a.sims = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            a.plies = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            a.seed = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output_file = argv[++i];
+        }
+        else if (argv[i][0] != '-' || strcmp(argv[i], "-") == 0) {
+            first_input = i;
+            break;
+        }
+        else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (first_input == argc || a.top < 1 || a.top > MAX_TOP || a.sims < 0 ||
+        a.plies < 0 || a.plies > ENDGAME_MAX_PLIES) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+    if (threads > MAX_THREADS) {
+        threads = MAX_THREADS;
+    }
+
+    /* Shared, read-only inputs, loaded as selfplay loads them */
+    if (variant && !variant_select(variant)) {
+        return EXIT_FAILURE;
+    }
+    Alphabet alphabet = *alphabet_english();
+    if (alphabet_file && !alphabet_load(&alphabet, alphabet_file)) {
+        fprintf(stderr, "Failed to load alphabet %s\n", alphabet_file);
+        return EXIT_FAILURE;
+    }
+    a.alphabet = &alphabet;
+    lexicon_name(wordlist, a.lexicon, sizeof(a.lexicon));
+
+    Lexicon *lexicon = lexicon_load_alphabet(a.lexicon, wordlist, &alphabet);
+    if (!lexicon || lexicon->dawg->word_count == 0) {
+        fprintf(stderr, "Failed to load word list %s\n", wordlist);
+        lexicon_release(lexicon);
+        return EXIT_FAILURE;
+    }
+    /* The installed tile file is the standard set; other variants bring their own */
+    if (!tiles_file && variant_current()->id == VARIANT_STANDARD) {
+        tiles_file = TILES_FILE;
+    }
+    if (tiles_file && !tiles_load_alphabet(tiles_file, &alphabet)) {
+        if (alphabet_file) {
+            fprintf(stderr, "Failed to load tiles %s; the built-in set is English only\n", tiles_file);
+            lexicon_release(lexicon);
+            return EXIT_FAILURE;
+        }
+        fprintf(stderr, "Using the built-in tile set (%s not found)\n", tiles_file);
+        tiles_reset();
+    }
+    lexicon_publish(lexicon);
+
+    EvalWeights weights;
+    eval_default_weights(&weights);
+    if (weights_file && !eval_load_weights(&weights, weights_file, &alphabet)) {
+        fprintf(stderr, "Failed to load weights %s\n", weights_file);
+        lexicon_registry_clear();
+        return EXIT_FAILURE;
+    }
+    a.weights = equity ? &weights : NULL;
+
+    a.out = output_file ? fopen(output_file, "w") : stdout;
+    a.capacity = threads * JOBS_PER_THREAD;
+    a.jobs = (Job *)malloc(a.capacity * sizeof(Job));
+    if (!a.out || !a.jobs) {
+        fprintf(stderr, "Failed to open %s\n", a.out ? "the job queue" : output_file);
+        free(a.jobs);
+        lexicon_registry_clear();
+        return EXIT_FAILURE;
+    }
+    if (a.plies > 0 && !ttable_init(&a.table, TABLE_MEGABYTES)) {
+        fprintf(stderr, "Failed to allocate the pre-endgame table\n");
+        free(a.jobs);
+        lexicon_registry_clear();
+        return EXIT_FAILURE;
+    }
+    pthread_mutex_init(&a.lock, NULL);
+    pthread_cond_init(&a.not_empty, NULL);
+    pthread_cond_init(&a.not_full, NULL);
+    pthread_mutex_init(&a.out_lock, NULL);
+    fprintf(a.out, "# game\tply\tplayer\track\tplayed\t%s\trank/moves\tloss\tbest...\n",
+            a.sims > 0 ? "sim" : equity ? "equity" : "score");
+
+    /* Workers drain the queue while this thread streams the inputs into it */
+    Worker workers[MAX_THREADS];
+    pthread_t handles[MAX_THREADS];
+    double start = now_seconds();
+    int started = 0;
+    long games = 0;
+    bool ok = true;
+
+    memset(workers, 0, sizeof(workers));
+    for (int i = 0; i < threads; i++) {
+        workers[i].analysis = &a;
+        if (pthread_create(&handles[i], NULL, worker_main, &workers[i]) != 0) {
+            break;
+        }
+        started++;
+    }
+    if (started == 0) {
+        fprintf(stderr, "Failed to start worker threads\n");
+        ok = false;
+    }
+    for (int i = first_input; ok && i < argc; i++) {
+        ok = queue_file(&a, argv[i], &games);
+    }
+    close_queue(&a);
+    for (int i = 0; i < started; i++) {
+        pthread_join(handles[i], NULL);
+    }
+    double elapsed = now_seconds() - start;
+
+    /* Totals */
+    long positions = 0;
+    long best_played = 0;
+    long failed = 0;
+    double loss = 0.0;
+    for (int i = 0; i < started; i++) {
+        positions += workers[i].positions;
+        best_played += workers[i].best_played;
+        failed += workers[i].failed;
+        loss += workers[i].loss;
+    }
+    fprintf(stderr, "Analysed %ld positions from %ld games on %d threads in %.3f s "
+            "(%.1f positions/sec)\n", positions, games, started, elapsed,
+            elapsed > 0 ? positions / elapsed : 0.0);
+    if (positions > 0) {
+        fprintf(stderr, "Best play made: %.1f%%, mean loss %.2f\n",
+                100.0 * best_played / positions, loss / positions);
+    }
+    if (failed > 0) {
+        fprintf(stderr, "%ld positions did not replay\n", failed);
+    }
+
+    if (output_file) {
+        fclose(a.out);
+    }
+    pthread_mutex_destroy(&a.lock);
+    pthread_cond_destroy(&a.not_empty);
+    pthread_cond_destroy(&a.not_full);
+    pthread_mutex_destroy(&a.out_lock);
+    if (a.plies > 0) {
+        ttable_free(&a.table);
+    }
+    free(a.jobs);
+    lexicon_registry_clear();
+    return ok && failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
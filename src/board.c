@@ -5,86 +5,178 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include "board.h"
+#include "tiles.h"
 
-/* The game board */
-static BoardCell board[BOARD_SIZE][BOARD_SIZE];
-
-/* Special cell coordinates */
-static const int triple_word_cells[][2] = {
-    {0, 0}, {0, 7}, {0, 14}, 
-    {7, 0}, {7, 14}, 
-    {14, 0}, {14, 7}, {14, 14}
-};
-
-static const int double_letter_cells[][2] = {
-    {0, 3}, {0, 11}, {2, 6}, {2, 8}, {3, 0}, {3, 7}, {3, 14},
-    {6, 2}, {6, 6}, {6, 8}, {6, 12}, {7, 3}, {7, 11}, {8, 2},
-    {8, 6}, {8, 8}, {8, 12}, {11, 0}, {11, 7}, {11, 14},
-    {12, 6}, {12, 8}, {14, 3}, {14, 11}
-};
-
-static const int double_word_cells[][2] = {
-    {1, 1}, {1, 13}, {2, 2}, {2, 12}, {3, 3}, {3, 11}, {4, 4}, {4, 10},
-    {10, 4}, {10, 10}, {11, 3}, {11, 11}, {12, 2}, {12, 12}, {13, 1}, {13, 13}
-};
-
-static const int triple_letter_cells[][2] = {
-    {1, 5}, {1, 9}, {5, 1}, {5, 5}, {5, 9}, {5, 13},
-    {9, 1}, {9, 5}, {9, 9}, {9, 13}, {13, 5}, {13, 9}
-};
-
-/* Helper function to check if a cell is in a list of coordinates */
-static bool is_cell_in_list(int row, int col, const int list[][2], int list_size)
-{
-    for (int i = 0; i < list_size; i++) {
-        if (list[i][0] == row && list[i][1] == col) {
-            return true;
+/* The game board; each thread plays on its own board, of its own variant */
+static _Thread_local BoardCell board[BOARD_MAX_SIZE][BOARD_MAX_SIZE];
+static _Thread_local const Variant *variant;
+static _Thread_local int size;
+
+/* The same board padded and in both orientations; cells stay the compatibility view */
+static _Thread_local BoardLayout layout;
+static _Thread_local bool initialized;
+
+/* Anchor index, and the lines of each orientation whose anchors are stale */
+static _Thread_local BoardAnchors anchors;
+static _Thread_local uint32_t anchor_dirty[2];
+
+/* Squares holding uncommitted tiles, so commit and revert touch only those */
+static _Thread_local uint16_t pending[BOARD_SQUARES];
+static _Thread_local bool pending_marked[BOARD_SQUARES];
+static _Thread_local int pending_count;
+
+/* Committed letters by square, so snapshots are a plain copy */
+static _Thread_local char committed[BOARD_SQUARES];
+
+/* Per-line change stamps from a counter that never repeats on a thread */
+static _Thread_local uint64_t stamp_counter;
+static _Thread_local uint64_t row_stamps[BOARD_MAX_SIZE];
+static _Thread_local uint64_t col_stamps[BOARD_MAX_SIZE];
+
+/* Note a letter change on the row and column through a square */
+static inline void touch(int row, int col)
+{
+    row_stamps[row] = col_stamps[col] = ++stamp_counter;
+}
+
+/*
+ * Write a square's letter into both orientations of the layout. The
+ * anchors that can change are on the square's own row and column and the
+ * lines either side of them.
+ */
+static inline void layout_letter(int row, int col, char letter)
+{
+    char face = tiles_face(letter);
+    char *across = &layout.letter[BOARD_ACROSS][row + 1][col + 1];
+    uint8_t *flags_across = &layout.flags[BOARD_ACROSS][row + 1][col + 1];
+    uint8_t *flags_down = &layout.flags[BOARD_DOWN][col + 1][row + 1];
+    uint8_t blank = tiles_is_blank(letter) ? BOARD_SQUARE_BLANK : 0;
+
+    *flags_across = *flags_down = (uint8_t)((*flags_across & ~BOARD_SQUARE_BLANK) | blank);
+    if (!*across == !face) {
+        *across = layout.letter[BOARD_DOWN][col + 1][row + 1] = face;
+        return;
+    }
+    anchors.tiles += face ? 1 : -1;
+    *across = layout.letter[BOARD_DOWN][col + 1][row + 1] = face;
+    anchor_dirty[BOARD_ACROSS] |= 7u << row;
+    anchor_dirty[BOARD_DOWN] |= 7u << col;
+}
+
+/* Recompute the anchors and left-extension limits of one line */
+static void anchor_line(int d, int line)
+{
+    const char *before = layout.letter[d][line - 1];
+    const char *here = layout.letter[d][line];
+    const char *after = layout.letter[d][line + 1];
+    uint8_t *limit = anchors.left_limit[d][line];
+    uint32_t mask = 0;
+    int count = 0;
+    int run = 0;
+
+    for (int pos = 1; pos <= size; pos++) {
+        if (here[pos]) {
+            limit[pos] = 0;
+            run = 0;
+            continue;
+        }
+        limit[pos] = (uint8_t)run;
+        if (before[pos] || after[pos] || here[pos - 1] || here[pos + 1]) {
+            mask |= 1u << pos;
+            anchors.list[d][line][count++] = (uint8_t)pos;
+            run = 0;
+        } else {
+            run++;
         }
     }
-    return false;
+    anchors.mask[d][line] = mask;
+    anchors.count[d][line] = (uint8_t)count;
 }
 
-/* Initialize the board */
-bool board_init(void)
+static inline void layout_fixed(int row, int col, bool fixed)
 {
-    /* Initialize all cells as normal */
-    for (int row = 0; row < BOARD_SIZE; row++) {
-        for (int col = 0; col < BOARD_SIZE; col++) {
-            board[row][col].type = CELL_NORMAL;
-            board[row][col].letter = '\0';
-            board[row][col].is_fixed = false;
+    uint8_t *across = &layout.flags[BOARD_ACROSS][row + 1][col + 1];
+    uint8_t *down = &layout.flags[BOARD_DOWN][col + 1][row + 1];
+    *across = *down = fixed ? (*across | BOARD_SQUARE_FIXED) : (*across & ~BOARD_SQUARE_FIXED);
+}
+
+/* Rebuild the layout from the cells */
+static void layout_build(void)
+{
+    memset(&layout, 0, sizeof(layout));
+    memset(&anchors, 0, sizeof(anchors));
+    anchor_dirty[BOARD_ACROSS] = anchor_dirty[BOARD_DOWN] = ~0u;
+    for (int d = BOARD_ACROSS; d <= BOARD_DOWN; d++) {
+        for (int line = 0; line < BOARD_PADDED; line++) {
+            for (int pos = 0; pos < BOARD_PADDED; pos++) {
+                layout.letter_mult[d][line][pos] = 1;
+                layout.word_mult[d][line][pos] = 1;
+                if (line == 0 || line > size || pos == 0 || pos > size) {
+                    layout.flags[d][line][pos] = BOARD_SQUARE_BORDER;
+                }
+            }
         }
     }
-    
-    /* Set triple word score cells */
-    for (int i = 0; i < sizeof(triple_word_cells) / sizeof(triple_word_cells[0]); i++) {
-        int row = triple_word_cells[i][0];
-        int col = triple_word_cells[i][1];
-        board[row][col].type = CELL_TRIPLE_WORD;
+
+    for (int row = 0; row < size; row++) {
+        for (int col = 0; col < size; col++) {
+            const BoardCell *cell = &board[row][col];
+            uint8_t letter_mult = cell->type == CELL_DOUBLE_LETTER ? 2 :
+                                  cell->type == CELL_TRIPLE_LETTER ? 3 : 1;
+            uint8_t word_mult = cell->type == CELL_DOUBLE_WORD ? 2 :
+                                cell->type == CELL_TRIPLE_WORD ? 3 : 1;
+            layout.letter_mult[BOARD_ACROSS][row + 1][col + 1] = letter_mult;
+            layout.letter_mult[BOARD_DOWN][col + 1][row + 1] = letter_mult;
+            layout.word_mult[BOARD_ACROSS][row + 1][col + 1] = word_mult;
+            layout.word_mult[BOARD_DOWN][col + 1][row + 1] = word_mult;
+            layout_letter(row, col, cell->letter);
+            layout_fixed(row, col, cell->is_fixed);
+        }
     }
-    
-    /* Set double letter score cells */
-    for (int i = 0; i < sizeof(double_letter_cells) / sizeof(double_letter_cells[0]); i++) {
-        int row = double_letter_cells[i][0];
-        int col = double_letter_cells[i][1];
-        board[row][col].type = CELL_DOUBLE_LETTER;
+}
+
+/* Cell type of a premium map square */
+static CellType premium_type(char square)
+{
+    switch (square) {
+    case 'd':
+        return CELL_DOUBLE_LETTER;
+    case 't':
+        return CELL_TRIPLE_LETTER;
+    case 'D':
+        return CELL_DOUBLE_WORD;
+    case 'T':
+        return CELL_TRIPLE_WORD;
+    default:
+        return CELL_NORMAL;
     }
+}
+
+/* Initialize an empty board of the current variant */
+bool board_init(void)
+{
+    variant = variant_current();
+    size = variant->board_size;
     
-    /* Set double word score cells */
-    for (int i = 0; i < sizeof(double_word_cells) / sizeof(double_word_cells[0]); i++) {
-        int row = double_word_cells[i][0];
-        int col = double_word_cells[i][1];
-        board[row][col].type = CELL_DOUBLE_WORD;
+    /* Cells past the board stay empty and are never handed out */
+    memset(board, 0, sizeof(board));
+    for (int row = 0; row < size; row++) {
+        for (int col = 0; col < size; col++) {
+            board[row][col].type = premium_type(variant->premiums[row * size + col]);
+        }
     }
-    
-    /* Set triple letter score cells */
-    for (int i = 0; i < sizeof(triple_letter_cells) / sizeof(triple_letter_cells[0]); i++) {
-        int row = triple_letter_cells[i][0];
-        int col = triple_letter_cells[i][1];
-        board[row][col].type = CELL_TRIPLE_LETTER;
+    memset(pending_marked, 0, sizeof(pending_marked));
+    pending_count = 0;
+    memset(committed, 0, sizeof(committed));
+    stamp_counter++;
+    for (int i = 0; i < BOARD_MAX_SIZE; i++) {
+        row_stamps[i] = col_stamps[i] = stamp_counter;
     }
     
+    layout_build();
+    initialized = true;
     return true;
 }
 
@@ -94,10 +186,28 @@ void board_cleanup(void)
     /* No dynamic resources to clean up in current implementation */
 }
 
+/* Squares on a side of the calling thread's board */
+int board_size(void)
+{
+    if (!initialized) {
+        board_init();
+    }
+    return size;
+}
+
+/* Variant the calling thread's board was set up for */
+const Variant* board_variant(void)
+{
+    if (!initialized) {
+        board_init();
+    }
+    return variant;
+}
+
 /* Get a pointer to a board cell */
 BoardCell* board_get_cell(int row, int col)
 {
-    if (row < 0 || row >= BOARD_SIZE || col < 0 || col >= BOARD_SIZE) {
+    if (row < 0 || row >= size || col < 0 || col >= size) {
         return NULL;
     }
     return &board[row][col];
@@ -113,6 +223,28 @@ CellType board_get_cell_type(int row, int col)
     return CELL_NORMAL;
 }
 
+/* The padded layout of the calling thread's board */
+const BoardLayout* board_layout(void)
+{
+    return &layout;
+}
+
+/* The anchor index of the calling thread's board, brought up to date */
+const BoardAnchors* board_anchors(void)
+{
+    for (int d = BOARD_ACROSS; d <= BOARD_DOWN; d++) {
+        /* Bit i of the dirty mask is padded line i; the border lines never change */
+        uint32_t dirty = anchor_dirty[d] & ((1u << size) - 1) << 1;
+        while (dirty) {
+            int line = __builtin_ctz(dirty);
+            dirty &= dirty - 1;
+            anchor_line(d, line);
+        }
+        anchor_dirty[d] = 0;
+    }
+    return &anchors;
+}
+
 /* Place a tile on the board */
 bool board_place_tile(int row, int col, char letter)
 {
@@ -122,6 +254,14 @@ bool board_place_tile(int row, int col, char letter)
     }
     
     cell->letter = letter;
+    layout_letter(row, col, letter);
+    touch(row, col);
+    
+    int square = row * BOARD_MAX_SIZE + col;
+    if (!pending_marked[square]) {
+        pending_marked[square] = true;
+        pending[pending_count++] = (uint16_t)square;
+    }
     return true;
 }
 
@@ -134,29 +274,104 @@ bool board_remove_tile(int row, int col)
     }
     
     cell->letter = '\0';
+    layout_letter(row, col, '\0');
+    touch(row, col);
     return true;
 }
 
 /* Commit word to the board (make tiles fixed) */
 void board_commit_word(void)
 {
-    for (int row = 0; row < BOARD_SIZE; row++) {
-        for (int col = 0; col < BOARD_SIZE; col++) {
-            if (board[row][col].letter != '\0' && !board[row][col].is_fixed) {
-                board[row][col].is_fixed = true;
-            }
+    for (int i = 0; i < pending_count; i++) {
+        BoardCell *cell = &board[0][0] + pending[i];
+        if (cell->letter != '\0') {
+            cell->is_fixed = true;
+            layout_fixed(pending[i] / BOARD_MAX_SIZE, pending[i] % BOARD_MAX_SIZE, true);
+            committed[pending[i]] = cell->letter;
         }
+        pending_marked[pending[i]] = false;
     }
+    pending_count = 0;
 }
 
 /* Revert uncommitted word on the board */
 void board_revert_word(void)
 {
-    for (int row = 0; row < BOARD_SIZE; row++) {
-        for (int col = 0; col < BOARD_SIZE; col++) {
-            if (board[row][col].letter != '\0' && !board[row][col].is_fixed) {
-                board[row][col].letter = '\0';
+    for (int i = 0; i < pending_count; i++) {
+        (&board[0][0] + pending[i])->letter = '\0';
+        layout_letter(pending[i] / BOARD_MAX_SIZE, pending[i] % BOARD_MAX_SIZE, '\0');
+        touch(pending[i] / BOARD_MAX_SIZE, pending[i] % BOARD_MAX_SIZE);
+        pending_marked[pending[i]] = false;
+    }
+    pending_count = 0;
+}
+
+/* Copy the committed tiles, one letter per square (0 = empty) */
+void board_snapshot(char letters[BOARD_SQUARES])
+{
+    memcpy(letters, committed, sizeof(committed));
+}
+
+/* Replace the whole position with committed tiles from a snapshot */
+void board_restore(const char letters[BOARD_SQUARES])
+{
+    BoardCell *cell = &board[0][0];
+    
+    /* A thread may start from a snapshot without ever having set up its board */
+    if (!initialized) {
+        board_init();
+    }
+    board_revert_word();
+    
+    /* Compare eight squares at a time and rewrite only the cells that differ */
+    for (int start = 0; start < BOARD_SQUARES; start += 8) {
+        int end = start + 8 < BOARD_SQUARES ? start + 8 : BOARD_SQUARES;
+        if (end - start == 8) {
+            uint64_t have, want;
+            memcpy(&have, committed + start, 8);
+            memcpy(&want, letters + start, 8);
+            if (have == want) {
+                continue;
+            }
+        }
+        for (int i = start; i < end; i++) {
+            if (committed[i] != letters[i]) {
+                committed[i] = letters[i];
+                cell[i].letter = letters[i];
+                cell[i].is_fixed = letters[i] != '\0';
+                layout_letter(i / BOARD_MAX_SIZE, i % BOARD_MAX_SIZE, letters[i]);
+                layout_fixed(i / BOARD_MAX_SIZE, i % BOARD_MAX_SIZE, letters[i] != '\0');
+                touch(i / BOARD_MAX_SIZE, i % BOARD_MAX_SIZE);
             }
         }
     }
 }
+
+/* Take a committed tile back off the board when a move is unplayed */
+bool board_lift_tile(int row, int col)
+{
+    BoardCell* cell = board_get_cell(row, col);
+    if (!cell || !cell->is_fixed) {
+        return false;
+    }
+    
+    cell->letter = '\0';
+    cell->is_fixed = false;
+    layout_letter(row, col, '\0');
+    layout_fixed(row, col, false);
+    committed[row * BOARD_MAX_SIZE + col] = '\0';
+    touch(row, col);
+    return true;
+}
+
+/* Stamp of the last letter change on a row */
+uint64_t board_row_stamp(int row)
+{
+    return row_stamps[row];
+}
+
+/* Stamp of the last letter change on a column */
+uint64_t board_col_stamp(int col)
+{
+    return col_stamps[col];
+}
@@ -0,0 +1,735 @@
+/**
+ * XScrabble - Graph Lexicon (DAWG) Implementation
+ *
+ * Words are first inserted into a plain trie. The trie is then minimized by
+ * hash-consing: every node is replaced by a canonical node with the same
+ * outgoing edges, children before parents. Finally the canonical graph is
+ * laid out depth-first from the root, so the edge array depends only on the
+ * set of words and not on insertion order.
+ *
+ * The parallel build gives each first letter its own trie and registry on
+ * a worker thread, then interns every partition's canonical nodes into one
+ * registry. Identical subgraphs collapse there just as they would in a
+ * single registry, so the result is the same edge array.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "dawg.h"
+#include "stats.h"
+
+#define INITIAL_NODES 4096
+#define MAX_LINE_LENGTH 64
+#define MAX_BUILD_THREADS 64
+
+static uint64_t next_serial = 0;
+
+/* Trie used while building */
+typedef struct {
+    uint32_t first_child;       /* 0 = none (the root is never a child) */
+    uint32_t next_sibling;
+    uint32_t canon;
+    uint8_t letter;
+    uint8_t terminal;
+} TrieNode;
+
+typedef struct {
+    TrieNode *nodes;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t words;
+} Trie;
+
+/* Canonical (minimized) node registry */
+typedef struct {
+    uint32_t sig_start;
+    uint32_t sig_count;
+    uint32_t position;          /* First edge in the output, 0 = unplaced */
+} CanonNode;
+
+typedef struct {
+    uint64_t *sigs;             /* Edge signatures of all canonical nodes */
+    uint32_t sig_count;
+    uint32_t sig_capacity;
+    CanonNode *nodes;           /* Node 0 is the node with no edges */
+    uint32_t node_count;
+    uint32_t node_capacity;
+    uint32_t *table;            /* Open addressing: canonical id, 0 = empty */
+    uint32_t table_size;
+} Registry;
+
+/* Map a machine letter (or ASCII lowercase) to its edge index, -1 if it is not a letter */
+int dawg_letter_index(char letter)
+{
+    if (letter >= 'a' && letter <= 'z') {
+        return letter - 'a';
+    }
+    int index = (unsigned char)letter - 'A';
+    return index >= 0 && index < DAWG_LETTERS ? index : -1;
+}
+
+/* Trie construction */
+
+static bool trie_init(Trie *trie)
+{
+    trie->nodes = (TrieNode *)calloc(INITIAL_NODES, sizeof(TrieNode));
+    trie->count = 1;
+    trie->capacity = INITIAL_NODES;
+    trie->words = 0;
+    return trie->nodes != NULL;
+}
+
+static uint32_t trie_new_node(Trie *trie, int letter)
+{
+    if (trie->count == trie->capacity) {
+        uint32_t capacity = trie->capacity * 2;
+        TrieNode *grown = (TrieNode *)realloc(trie->nodes, capacity * sizeof(TrieNode));
+        if (!grown) {
+            return 0;
+        }
+        trie->nodes = grown;
+        trie->capacity = capacity;
+    }
+
+    TrieNode *node = &trie->nodes[trie->count];
+    memset(node, 0, sizeof(*node));
+    node->letter = (uint8_t)letter;
+    return trie->count++;
+}
+
+/* Insert a word, keeping sibling lists sorted by letter */
+static bool trie_insert(Trie *trie, const char *word)
+{
+    int letters[DAWG_MAX_WORD_LENGTH];
+    int length = 0;
+
+    for (; word[length]; length++) {
+        if (length == DAWG_MAX_WORD_LENGTH) {
+            return false;
+        }
+        letters[length] = dawg_letter_index(word[length]);
+        if (letters[length] < 0) {
+            return false;
+        }
+    }
+    if (length == 0) {
+        return false;
+    }
+
+    uint32_t node = 0;
+    for (int i = 0; i < length; i++) {
+        uint32_t previous = 0;
+        uint32_t child = trie->nodes[node].first_child;
+        while (child && trie->nodes[child].letter < letters[i]) {
+            previous = child;
+            child = trie->nodes[child].next_sibling;
+        }
+
+        if (!child || trie->nodes[child].letter != letters[i]) {
+            uint32_t created = trie_new_node(trie, letters[i]);
+            if (!created) {
+                return false;
+            }
+            trie->nodes[created].next_sibling = child;
+            if (previous) {
+                trie->nodes[previous].next_sibling = created;
+            } else {
+                trie->nodes[node].first_child = created;
+            }
+            child = created;
+        }
+        node = child;
+    }
+
+    if (!trie->nodes[node].terminal) {
+        trie->nodes[node].terminal = 1;
+        trie->words++;
+    }
+    return true;
+}
+
+/* Registry */
+
+static uint64_t signature_hash(const uint64_t *sigs, uint32_t count)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (uint32_t i = 0; i < count; i++) {
+        hash ^= sigs[i];
+        hash *= 0x100000001b3ULL;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+static bool registry_init(Registry *registry, uint32_t expected_nodes)
+{
+    memset(registry, 0, sizeof(*registry));
+    registry->table_size = 1024;
+    while (registry->table_size < expected_nodes * 2) {
+        registry->table_size *= 2;
+    }
+    registry->table = (uint32_t *)calloc(registry->table_size, sizeof(uint32_t));
+    registry->node_capacity = 1024;
+    registry->nodes = (CanonNode *)calloc(registry->node_capacity, sizeof(CanonNode));
+    registry->sig_capacity = 4096;
+    registry->sigs = (uint64_t *)malloc(registry->sig_capacity * sizeof(uint64_t));
+    registry->node_count = 1;
+    return registry->table && registry->nodes && registry->sigs;
+}
+
+static void registry_free(Registry *registry)
+{
+    free(registry->table);
+    free(registry->nodes);
+    free(registry->sigs);
+}
+
+/* Double the hash table once it is half full */
+static bool registry_grow_table(Registry *registry)
+{
+    uint32_t size = registry->table_size * 2;
+    uint32_t *table = (uint32_t *)calloc(size, sizeof(uint32_t));
+    if (!table) {
+        return false;
+    }
+
+    for (uint32_t id = 1; id < registry->node_count; id++) {
+        const CanonNode *node = &registry->nodes[id];
+        uint32_t slot = (uint32_t)signature_hash(&registry->sigs[node->sig_start],
+                                                 node->sig_count) & (size - 1);
+        while (table[slot]) {
+            slot = (slot + 1) & (size - 1);
+        }
+        table[slot] = id;
+    }
+
+    free(registry->table);
+    registry->table = table;
+    registry->table_size = size;
+    return true;
+}
+
+/* Find or add the canonical node with the given edge signatures */
+static uint32_t registry_intern(Registry *registry, const uint64_t *sigs, uint32_t count)
+{
+    if (count == 0) {
+        return 0;
+    }
+    if (registry->node_count * 2 >= registry->table_size && !registry_grow_table(registry)) {
+        return UINT32_MAX;
+    }
+
+    uint32_t mask = registry->table_size - 1;
+    uint32_t slot = (uint32_t)signature_hash(sigs, count) & mask;
+
+    while (registry->table[slot]) {
+        const CanonNode *node = &registry->nodes[registry->table[slot]];
+        if (node->sig_count == count &&
+            memcmp(&registry->sigs[node->sig_start], sigs, count * sizeof(uint64_t)) == 0) {
+            return registry->table[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    /* Grow storage */
+    if (registry->node_count == registry->node_capacity) {
+        uint32_t capacity = registry->node_capacity * 2;
+        CanonNode *grown = (CanonNode *)realloc(registry->nodes, capacity * sizeof(CanonNode));
+        if (!grown) {
+            return UINT32_MAX;
+        }
+        registry->nodes = grown;
+        registry->node_capacity = capacity;
+    }
+    while (registry->sig_count + count > registry->sig_capacity) {
+        uint32_t capacity = registry->sig_capacity * 2;
+        uint64_t *grown = (uint64_t *)realloc(registry->sigs, capacity * sizeof(uint64_t));
+        if (!grown) {
+            return UINT32_MAX;
+        }
+        registry->sigs = grown;
+        registry->sig_capacity = capacity;
+    }
+
+    uint32_t id = registry->node_count++;
+    CanonNode *node = &registry->nodes[id];
+    node->sig_start = registry->sig_count;
+    node->sig_count = count;
+    node->position = 0;
+    memcpy(&registry->sigs[registry->sig_count], sigs, count * sizeof(uint64_t));
+    registry->sig_count += count;
+    registry->table[slot] = id;
+    return id;
+}
+
+static inline uint64_t make_signature(int letter, int terminal, uint32_t child)
+{
+    return (uint64_t)letter | ((uint64_t)terminal << 8) | ((uint64_t)child << 9);
+}
+
+/* Minimize the trie bottom-up; children always have larger indices */
+static bool trie_minimize(Trie *trie, Registry *registry)
+{
+    uint64_t sigs[DAWG_LETTERS];
+
+    for (uint32_t i = trie->count; i-- > 0;) {
+        uint32_t count = 0;
+        for (uint32_t child = trie->nodes[i].first_child; child;
+             child = trie->nodes[child].next_sibling) {
+            const TrieNode *node = &trie->nodes[child];
+            sigs[count++] = make_signature(node->letter, node->terminal, node->canon);
+        }
+
+        uint32_t canon = registry_intern(registry, sigs, count);
+        if (canon == UINT32_MAX) {
+            return false;
+        }
+        trie->nodes[i].canon = canon;
+    }
+    return true;
+}
+
+/* Layout */
+
+static void assign_positions(Registry *registry, uint32_t id, uint32_t *next)
+{
+    CanonNode *node = &registry->nodes[id];
+    if (id == 0 || node->position) {
+        return;
+    }
+
+    node->position = *next;
+    *next += node->sig_count;
+
+    for (uint32_t i = 0; i < node->sig_count; i++) {
+        assign_positions(registry, (uint32_t)(registry->sigs[node->sig_start + i] >> 9), next);
+    }
+}
+
+/* Lay out the canonical graph reachable from root as a flat edge array */
+static Dawg* registry_layout(Registry *registry, uint32_t root, uint32_t words)
+{
+    Dawg *dawg = (Dawg *)calloc(1, sizeof(Dawg));
+    if (!dawg) {
+        return NULL;
+    }
+
+    uint32_t next = 1;
+    assign_positions(registry, root, &next);
+
+    dawg->edge_count = next;
+    dawg->edges = (uint32_t *)calloc(next, sizeof(uint32_t));
+    if (!dawg->edges) {
+        free(dawg);
+        return NULL;
+    }
+    dawg->root = root ? registry->nodes[root].position : 0;
+    dawg->word_count = words;
+    dawg->serial = __atomic_add_fetch(&next_serial, 1, __ATOMIC_RELAXED);
+
+    for (uint32_t id = 1; id < registry->node_count; id++) {
+        const CanonNode *node = &registry->nodes[id];
+        if (!node->position) {
+            continue;
+        }
+        for (uint32_t i = 0; i < node->sig_count; i++) {
+            uint64_t sig = registry->sigs[node->sig_start + i];
+            uint32_t child = (uint32_t)(sig >> 9);
+            uint32_t edge = (uint32_t)(sig & 0xff);
+
+            if ((sig >> 8) & 1) {
+                edge |= DAWG_EDGE_TERMINAL;
+            }
+            if (i + 1 == node->sig_count) {
+                edge |= DAWG_EDGE_LAST;
+            }
+            if (child) {
+                edge |= registry->nodes[child].position << DAWG_CHILD_SHIFT;
+            }
+            dawg->edges[node->position + i] = edge;
+        }
+    }
+
+    return dawg;
+}
+
+static Dawg* trie_finish(Trie *trie)
+{
+    Registry registry;
+    Dawg *dawg = NULL;
+
+    if (registry_init(&registry, trie->count / 4) && trie_minimize(trie, &registry)) {
+        dawg = registry_layout(&registry, trie->nodes[0].canon, trie->words);
+    }
+
+    registry_free(&registry);
+    free(trie->nodes);
+    return dawg;
+}
+
+/* Build a lexicon from a list of words; words outside a-z are skipped */
+Dawg* dawg_build(const char *const *words, size_t count)
+{
+    Trie trie;
+    if (!trie_init(&trie)) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        trie_insert(&trie, words[i]);
+    }
+    return trie_finish(&trie);
+}
+
+/* Build a lexicon from a word list file, one word per line */
+Dawg* dawg_load(const char *filename)
+{
+    FILE *file = fopen(filename, "r");
+    if (!file) {
+        return NULL;
+    }
+
+    STATS_TIMER_BEGIN(timer);
+    Trie trie;
+    if (!trie_init(&trie)) {
+        fclose(file);
+        return NULL;
+    }
+
+    char buffer[MAX_LINE_LENGTH];
+    while (fgets(buffer, sizeof(buffer), file)) {
+        buffer[strcspn(buffer, "\r\n")] = '\0';
+        trie_insert(&trie, buffer);
+    }
+    fclose(file);
+
+    Dawg *dawg = trie_finish(&trie);
+    STATS_TIMER_END(timer, STAT_DICTIONARY_LOAD);
+    return dawg;
+}
+
+/* Parallel build */
+
+/* Words starting with one letter, built and minimized on their own */
+typedef struct {
+    const char *const *words;
+    size_t count;
+    Registry registry;
+    uint64_t root_sig;          /* Edge from the root into this partition */
+    bool has_root;
+    uint32_t words_added;
+    bool built;
+} Partition;
+
+typedef struct {
+    Partition *partitions;
+    int order[DAWG_LETTERS];    /* Largest partitions first */
+    int next;
+} BuildQueue;
+
+static bool partition_build(Partition *partition)
+{
+    Trie trie;
+    if (!trie_init(&trie)) {
+        return false;
+    }
+    for (size_t i = 0; i < partition->count; i++) {
+        trie_insert(&trie, partition->words[i]);
+    }
+
+    bool ok = registry_init(&partition->registry, trie.count / 4) &&
+              trie_minimize(&trie, &partition->registry);
+    uint32_t child = trie.nodes[0].first_child;
+    if (ok && child) {
+        partition->root_sig = make_signature(trie.nodes[child].letter, trie.nodes[child].terminal,
+                                             trie.nodes[child].canon);
+        partition->has_root = true;
+    }
+    partition->words_added = trie.words;
+    free(trie.nodes);
+    return ok;
+}
+
+static void *build_worker(void *arg)
+{
+    BuildQueue *queue = (BuildQueue *)arg;
+
+    for (;;) {
+        int index = __atomic_fetch_add(&queue->next, 1, __ATOMIC_RELAXED);
+        if (index >= DAWG_LETTERS) {
+            return NULL;
+        }
+        Partition *partition = &queue->partitions[queue->order[index]];
+        if (partition->count) {
+            partition->built = partition_build(partition);
+        }
+    }
+}
+
+/* Intern a partition's canonical nodes, children first, into the shared registry */
+static bool partition_merge(Partition *partition, Registry *registry, uint64_t *root_sigs,
+                            uint32_t *root_count)
+{
+    const Registry *local = &partition->registry;
+    uint32_t *map = (uint32_t *)malloc(local->node_count * sizeof(uint32_t));
+    uint64_t sigs[DAWG_LETTERS];
+
+    if (!map) {
+        return false;
+    }
+    map[0] = 0;
+    for (uint32_t id = 1; id < local->node_count; id++) {
+        const CanonNode *node = &local->nodes[id];
+        for (uint32_t i = 0; i < node->sig_count; i++) {
+            uint64_t sig = local->sigs[node->sig_start + i];
+            sigs[i] = (sig & 0x1ff) | ((uint64_t)map[sig >> 9] << 9);
+        }
+        map[id] = registry_intern(registry, sigs, node->sig_count);
+        if (map[id] == UINT32_MAX) {
+            free(map);
+            return false;
+        }
+    }
+
+    if (partition->has_root) {
+        uint64_t sig = partition->root_sig;
+        root_sigs[(*root_count)++] = (sig & 0x1ff) | ((uint64_t)map[sig >> 9] << 9);
+    }
+    free(map);
+    return true;
+}
+
+/*
+ * Build the same lexicon as dawg_build() on up to threads threads
+ * (0 = one per online CPU), the calling thread included. Only the
+ * per-letter builds run in parallel: merging them into one registry is
+ * serial and bounds the speedup.
+ */
+Dawg* dawg_build_parallel(const char *const *words, size_t count, int threads)
+{
+    Partition partitions[DAWG_LETTERS];
+    BuildQueue queue;
+    const char **sorted;
+    size_t starts[DAWG_LETTERS + 1] = {0};
+    size_t filled[DAWG_LETTERS] = {0};
+
+    if (threads <= 0) {
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (threads > MAX_BUILD_THREADS) {
+        threads = MAX_BUILD_THREADS;
+    }
+    if (threads <= 1 || count == 0) {
+        return dawg_build(words, count);
+    }
+
+    /* Group the words by first letter, keeping their order */
+    sorted = (const char **)malloc(count * sizeof(char *));
+    if (!sorted) {
+        return NULL;
+    }
+    for (size_t i = 0; i < count; i++) {
+        int letter = dawg_letter_index(words[i][0]);
+        if (letter >= 0) {
+            starts[letter + 1]++;
+        }
+    }
+    for (int letter = 0; letter < DAWG_LETTERS; letter++) {
+        starts[letter + 1] += starts[letter];
+    }
+    for (size_t i = 0; i < count; i++) {
+        int letter = dawg_letter_index(words[i][0]);
+        if (letter >= 0) {
+            sorted[starts[letter] + filled[letter]++] = words[i];
+        }
+    }
+
+    memset(partitions, 0, sizeof(partitions));
+    memset(&queue, 0, sizeof(queue));
+    queue.partitions = partitions;
+    for (int letter = 0; letter < DAWG_LETTERS; letter++) {
+        partitions[letter].words = sorted + starts[letter];
+        partitions[letter].count = starts[letter + 1] - starts[letter];
+        queue.order[letter] = letter;
+    }
+    for (int i = 1; i < DAWG_LETTERS; i++) {
+        for (int j = i; j > 0 && partitions[queue.order[j]].count >
+                                 partitions[queue.order[j - 1]].count; j--) {
+            int swap = queue.order[j];
+            queue.order[j] = queue.order[j - 1];
+            queue.order[j - 1] = swap;
+        }
+    }
+
+    /* Build the partitions, the calling thread taking a share */
+    pthread_t workers[MAX_BUILD_THREADS];
+    int started = 0;
+    if (threads > DAWG_LETTERS) {
+        threads = DAWG_LETTERS;
+    }
+    for (int i = 0; i < threads - 1; i++) {
+        if (pthread_create(&workers[i], NULL, build_worker, &queue) != 0) {
+            break;
+        }
+        started++;
+    }
+    build_worker(&queue);
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+
+    /* Merge them in letter order; serial, as they intern into one registry */
+    Registry registry;
+    uint64_t root_sigs[DAWG_LETTERS];
+    uint32_t root_count = 0;
+    uint32_t nodes = 0;
+    uint32_t total_words = 0;
+    bool ok = true;
+
+    for (int letter = 0; letter < DAWG_LETTERS; letter++) {
+        nodes += partitions[letter].registry.node_count;
+        if (partitions[letter].count && !partitions[letter].built) {
+            ok = false;
+        }
+    }
+    ok = registry_init(&registry, nodes) && ok;
+    for (int letter = 0; letter < DAWG_LETTERS && ok; letter++) {
+        if (partitions[letter].built) {
+            ok = partition_merge(&partitions[letter], &registry, root_sigs, &root_count);
+            total_words += partitions[letter].words_added;
+        }
+    }
+
+    Dawg *dawg = NULL;
+    uint32_t root = ok ? registry_intern(&registry, root_sigs, root_count) : UINT32_MAX;
+    if (root != UINT32_MAX) {
+        dawg = registry_layout(&registry, root, total_words);
+    }
+
+    registry_free(&registry);
+    for (int letter = 0; letter < DAWG_LETTERS; letter++) {
+        registry_free(&partitions[letter].registry);
+    }
+    free(sorted);
+    return dawg;
+}
+
+/* Load a word list file and build it on up to threads threads (0 = all CPUs) */
+Dawg* dawg_load_parallel(const char *filename, int threads)
+{
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        return NULL;
+    }
+
+    STATS_TIMER_BEGIN(timer);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *text = size >= 0 ? (char *)malloc(size + 1) : NULL;
+    if (!text || fread(text, 1, size, file) != (size_t)size) {
+        free(text);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+    text[size] = '\0';
+
+    /* Split into lines in place */
+    size_t capacity = 1024;
+    size_t count = 0;
+    const char **words = (const char **)malloc(capacity * sizeof(char *));
+    for (char *line = text; words && *line; ) {
+        size_t length = strcspn(line, "\r\n");
+        char *next = line + length;
+        if (*next) {
+            *next++ = '\0';
+        }
+        if (length) {
+            if (count == capacity) {
+                const char **grown = (const char **)realloc(words, capacity * 2 * sizeof(char *));
+                if (!grown) {
+                    free(words);
+                    words = NULL;
+                    break;
+                }
+                words = grown;
+                capacity *= 2;
+            }
+            words[count++] = line;
+        }
+        line = next;
+    }
+
+    Dawg *dawg = words ? dawg_build_parallel(words, count, threads) : NULL;
+    free(words);
+    free(text);
+    STATS_TIMER_END(timer, STAT_DICTIONARY_LOAD);
+    return dawg;
+}
+
+/* Free a lexicon */
+void dawg_free(Dawg *dawg)
+{
+    if (dawg) {
+        free(dawg->edges);
+        free(dawg);
+    }
+}
+
+/* Find the edge for a letter in a node, 0 if there is none */
+uint32_t dawg_find_edge(const Dawg *dawg, uint32_t node, int letter)
+{
+    if (!node) {
+        return 0;
+    }
+    for (uint32_t i = node;; i++) {
+        uint32_t edge = dawg->edges[i];
+        if (dawg_edge_letter(edge) == letter) {
+            return i;
+        }
+        if (dawg_edge_last(edge) || dawg_edge_letter(edge) > letter) {
+            return 0;
+        }
+    }
+}
+
+/* Follow a prefix from the root; node receives where it leads (0 = no edges) */
+bool dawg_walk(const Dawg *dawg, const char *prefix, uint32_t *node, bool *terminal)
+{
+    uint32_t current = dawg->root;
+    bool ends_word = false;
+
+    for (const char *p = prefix; *p; p++) {
+        int letter = dawg_letter_index(*p);
+        uint32_t index = letter < 0 ? 0 : dawg_find_edge(dawg, current, letter);
+        if (!index) {
+            return false;
+        }
+        ends_word = dawg_edge_terminal(dawg->edges[index]);
+        current = dawg_edge_child(dawg->edges[index]);
+    }
+
+    if (node) {
+        *node = current;
+    }
+    if (terminal) {
+        *terminal = ends_word;
+    }
+    return true;
+}
+
+/* Check if a word is in the lexicon */
+bool dawg_contains(const Dawg *dawg, const char *word)
+{
+    bool terminal = false;
+    STATS_TIMER_BEGIN(timer);
+    bool found = word[0] && dawg_walk(dawg, word, NULL, &terminal) && terminal;
+    STATS_TIMER_END(timer, STAT_DICTIONARY_LOOKUP);
+    return found;
+}
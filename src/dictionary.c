@@ -1,5 +1,11 @@
 /**
  * XScrabble - Dictionary Implementation
+ *
+ * Fallback word list for builds without the graph lexicon. Words are
+ * bucketed by length; each bucket is one contiguous array of fixed-stride
+ * records in Eytzinger (breadth-first search tree) order, so a lookup is a
+ * branch-light walk down an implicit tree with no pointer chasing. Records
+ * are compared 16 bytes at a time with SSE2 where available.
  */
 
 #include <stdio.h>
@@ -8,89 +14,295 @@
 #include <ctype.h>
 #include "dictionary.h"
 #include "config.h"
+#include "stats.h"
+#include "wordfilter.h"
 
-/* Dictionary data structure */
-/* For simplicity, we'll use a basic implementation */
-#define MAX_WORDS 100000
-#define MAX_WORD_LENGTH 20
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
-static char **dictionary = NULL;
+/* Longer lines are skipped rather than truncated */
+#define MAX_WORD_LENGTH 64
+
+/* Readable bytes past every record and query, for 16-byte loads */
+#define COMPARE_SLACK 16
+
+/* Words of one length; records 1..count in Eytzinger order, slot 0 unused */
+typedef struct {
+    char *words;
+    int count;
+} Bucket;
+
+static Bucket buckets[MAX_WORD_LENGTH + 1];
 static int word_count = 0;
+static WordFilter filter;
+static size_t sort_length;
+
+/* Compare two records of the given length */
+static int compare_words(const char *a, const char *b, size_t length)
+{
+#ifdef __SSE2__
+    for (size_t i = 0; i < length; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i *)(b + i));
+        unsigned diff = ~(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) & 0xffffu;
+        if (length - i < 16) {
+            diff &= (1u << (length - i)) - 1;
+        }
+        if (diff) {
+            size_t j = i + __builtin_ctz(diff);
+            return (unsigned char)a[j] - (unsigned char)b[j];
+        }
+    }
+    return 0;
+#else
+    return memcmp(a, b, length);
+#endif
+}
+
+static int compare_sorted(const void *a, const void *b)
+{
+    return memcmp(a, b, sort_length);
+}
+
+/* Copy sorted records into Eytzinger order; returns the next sorted index */
+static int eytzinger_fill(const char *sorted, char *out, size_t length, int count, int next, int k)
+{
+    if (k <= count) {
+        next = eytzinger_fill(sorted, out, length, count, next, 2 * k);
+        memcpy(out + (size_t)k * length, sorted + (size_t)next * length, length);
+        next = eytzinger_fill(sorted, out, length, count, next + 1, 2 * k + 1);
+    }
+    return next;
+}
+
+static void free_buckets(Bucket *set)
+{
+    for (int length = 0; length <= MAX_WORD_LENGTH; length++) {
+        free(set[length].words);
+        set[length].words = NULL;
+        set[length].count = 0;
+    }
+}
+
+/* Sort, deduplicate and lay out one bucket from its unsorted records */
+static bool finish_bucket(Bucket *bucket, char *records, size_t length, int count)
+{
+    int unique = 0;
+
+    /* Word lists are usually sorted already */
+    for (int i = 1; i < count; i++) {
+        if (memcmp(records + (size_t)(i - 1) * length, records + (size_t)i * length, length) > 0) {
+            sort_length = length;
+            qsort(records, count, length, compare_sorted);
+            break;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        if (unique == 0 || memcmp(records + (size_t)(unique - 1) * length,
+                                  records + (size_t)i * length, length) != 0) {
+            memmove(records + (size_t)unique * length, records + (size_t)i * length, length);
+            unique++;
+        }
+    }
+
+    bucket->words = (char *)calloc(1, (size_t)(unique + 1) * length + COMPARE_SLACK);
+    if (!bucket->words) {
+        return false;
+    }
+    eytzinger_fill(records, bucket->words, length, unique, 0, 1);
+    bucket->count = unique;
+    return true;
+}
+
+/* Replace the dictionary with the newline-separated words in text */
+static bool dictionary_build(const char *text, size_t size)
+{
+    Bucket built[MAX_WORD_LENGTH + 1];
+    char *staging[MAX_WORD_LENGTH + 1];
+    int counts[MAX_WORD_LENGTH + 1] = {0};
+    int filled[MAX_WORD_LENGTH + 1] = {0};
+    int skipped = 0;
+    bool ok = true;
+
+    memset(built, 0, sizeof(built));
+    memset(staging, 0, sizeof(staging));
+
+    /* Count words per length */
+    for (size_t pos = 0; pos < size; ) {
+        size_t length = 0;
+        while (pos + length < size && text[pos + length] != '\n' && text[pos + length] != '\r') {
+            length++;
+        }
+        if (length > MAX_WORD_LENGTH) {
+            skipped++;
+        } else if (length > 0) {
+            counts[length]++;
+        }
+        pos += length + 1;
+    }
+
+    for (int length = 1; length <= MAX_WORD_LENGTH && ok; length++) {
+        if (counts[length]) {
+            staging[length] = (char *)malloc((size_t)counts[length] * length);
+            ok = staging[length] != NULL;
+        }
+    }
+
+    /* Copy them into per-length staging arrays, lowercased */
+    for (size_t pos = 0; pos < size && ok; ) {
+        size_t length = 0;
+        while (pos + length < size && text[pos + length] != '\n' && text[pos + length] != '\r') {
+            length++;
+        }
+        if (length > 0 && length <= MAX_WORD_LENGTH) {
+            char *record = staging[length] + (size_t)filled[length]++ * length;
+            for (size_t i = 0; i < length; i++) {
+                record[i] = tolower((unsigned char)text[pos + i]);
+            }
+        }
+        pos += length + 1;
+    }
+
+    for (int length = 1; length <= MAX_WORD_LENGTH && ok; length++) {
+        if (counts[length]) {
+            ok = finish_bucket(&built[length], staging[length], length, counts[length]);
+        }
+    }
+    for (int length = 0; length <= MAX_WORD_LENGTH; length++) {
+        free(staging[length]);
+    }
+    if (!ok) {
+        free_buckets(built);
+        return false;
+    }
+    if (skipped) {
+        fprintf(stderr, "Skipped %d words longer than %d letters\n", skipped, MAX_WORD_LENGTH);
+    }
+
+    /* Install the new buckets and their prefilter */
+    dictionary_cleanup();
+    memcpy(buckets, built, sizeof(buckets));
+    for (int length = 1; length <= MAX_WORD_LENGTH; length++) {
+        word_count += buckets[length].count;
+    }
+    if (wordfilter_init(&filter, word_count)) {
+        for (int length = 1; length <= MAX_WORD_LENGTH; length++) {
+            char word[MAX_WORD_LENGTH + 1];
+            for (int k = 1; k <= buckets[length].count; k++) {
+                memcpy(word, buckets[length].words + (size_t)k * length, length);
+                word[length] = '\0';
+                wordfilter_add(&filter, word);
+            }
+        }
+    }
+    return true;
+}
 
 /* Initialize dictionary */
 bool dictionary_init(void)
 {
-    FILE *file;
-    char buffer[MAX_WORD_LENGTH];
-    
-    /* Allocate memory for dictionary */
-    dictionary = (char **)malloc(MAX_WORDS * sizeof(char *));
-    if (!dictionary) {
-        return false;
+    static const char fallback[] = "weft\nscrabble\n";
+
+    if (dictionary_load_file(DICTIONARY_FILE)) {
+        return true;
     }
-    
+
+    /* For testing - create a minimal dictionary */
+    return dictionary_build(fallback, sizeof(fallback) - 1);
+}
+
+/* Load dictionary words from a file, replacing any loaded words */
+bool dictionary_load_file(const char *filename)
+{
+    FILE *file;
+    char *text;
+    long size;
+    bool loaded;
+
     /* Open dictionary file */
-    file = fopen(DICTIONARY_FILE, "r");
+    file = fopen(filename, "rb");
     if (!file) {
-        /* For testing - create a minimal dictionary */
-        dictionary[0] = strdup("weft");
-        dictionary[1] = strdup("scrabble");
-        word_count = 2;
-        return true;
+        return false;
     }
-    
-    /* Read words from dictionary file */
-    while (fgets(buffer, MAX_WORD_LENGTH, file) && word_count < MAX_WORDS) {
-        /* Remove newline character */
-        size_t len = strlen(buffer);
-        if (len > 0 && buffer[len - 1] == '\n') {
-            buffer[len - 1] = '\0';
-        }
-        
-        /* Convert to lowercase */
-        for (int i = 0; buffer[i]; i++) {
-            buffer[i] = tolower(buffer[i]);
+
+    STATS_TIMER_BEGIN(timer);
+
+    /* Read the whole file and build from it */
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    text = size >= 0 ? (char *)malloc(size + 1) : NULL;
+    loaded = text && fread(text, 1, size, file) == (size_t)size &&
+             dictionary_build(text, size);
+
+    free(text);
+    fclose(file);
+    STATS_TIMER_END(timer, STAT_DICTIONARY_LOAD);
+    return loaded;
+}
+
+/* Get the number of distinct loaded words */
+int dictionary_word_count(void)
+{
+    return word_count;
+}
+
+/* Bytes held by the word arrays and the prefilter */
+size_t dictionary_memory_usage(void)
+{
+    size_t bytes = wordfilter_bytes(&filter);
+    for (int length = 1; length <= MAX_WORD_LENGTH; length++) {
+        if (buckets[length].words) {
+            bytes += (size_t)(buckets[length].count + 1) * length + COMPARE_SLACK;
         }
-        
-        /* Add to dictionary */
-        dictionary[word_count] = strdup(buffer);
-        word_count++;
     }
-    
-    fclose(file);
-    return true;
+    return bytes;
 }
 
 /* Clean up dictionary resources */
 void dictionary_cleanup(void)
 {
-    if (dictionary) {
-        for (int i = 0; i < word_count; i++) {
-            free(dictionary[i]);
-        }
-        free(dictionary);
-        dictionary = NULL;
-    }
+    free_buckets(buckets);
+    word_count = 0;
+    wordfilter_free(&filter);
 }
 
 /* Check if a word is in the dictionary */
 bool dictionary_is_word(const char *word)
 {
-    char lowercase[MAX_WORD_LENGTH];
-    
+    char lowercase[MAX_WORD_LENGTH + COMPARE_SLACK] = {0};    /* Slack read by the wide compare */
+    size_t length = strlen(word);
+    bool found = false;
+
+    if (length == 0 || length > MAX_WORD_LENGTH) {
+        return false;
+    }
+
+    STATS_TIMER_BEGIN(timer);
+
     /* Convert to lowercase for comparison */
-    strncpy(lowercase, word, MAX_WORD_LENGTH - 1);
-    lowercase[MAX_WORD_LENGTH - 1] = '\0';
-    for (int i = 0; lowercase[i]; i++) {
-        lowercase[i] = tolower(lowercase[i]);
-    }
-    
-    /* Search for word in dictionary */
-    for (int i = 0; i < word_count; i++) {
-        if (strcmp(dictionary[i], lowercase) == 0) {
-            return true;
+    for (size_t i = 0; i <= length; i++) {
+        lowercase[i] = tolower((unsigned char)word[i]);
+    }
+
+    /* Most misses stop at the prefilter */
+    if (!wordfilter_may_contain(&filter, lowercase)) {
+        STATS_TIMER_END(timer, STAT_DICTIONARY_LOOKUP);
+        return false;
+    }
+
+    /* Walk the implicit search tree of this length */
+    const Bucket *bucket = &buckets[length];
+    for (int k = 1; k <= bucket->count; ) {
+        int cmp = compare_words(lowercase, bucket->words + (size_t)k * length, length);
+        if (cmp == 0) {
+            found = true;
+            break;
         }
+        k = 2 * k + (cmp > 0);
     }
-    
-    return false;
+
+    STATS_TIMER_END(timer, STAT_DICTIONARY_LOOKUP);
+    return found;
 }
@@ -33,7 +33,7 @@ void print_word_info(const char *word) {
 }
 
 int main(int argc, char *argv[]) {
-    if (!dictionary_init()) {
+    if (!dictionary_enhanced_init()) {
         fprintf(stderr, "Failed to initialize dictionary.\n");
         return 1;
     }
@@ -61,6 +61,6 @@ int main(int argc, char *argv[]) {
         }
     }
     
-    dictionary_cleanup();
+    dictionary_enhanced_cleanup();
     return 0;
 }
\ No newline at end of file
@@ -9,6 +9,8 @@
 #include <stdbool.h>
 #include "dictionary_enhanced.h"
 #include "config.h"
+#include "stats.h"
+#include "wordfilter.h"
 
 /* For JSON parsing - this is a simplified mock implementation */
 /* In a real implementation, you would use a JSON library like cJSON */
@@ -22,16 +24,29 @@ typedef struct {
 
 static DictionaryEntry *dictionary = NULL;
 static int entry_count = 0;
+static WordFilter filter;
+
+/* Rebuild the prefilter over every entry; without one every lookup scans */
+static void dictionary_build_filter(void)
+{
+    wordfilter_free(&filter);
+    if (!wordfilter_init(&filter, entry_count)) {
+        return;
+    }
+    for (int i = 0; i < entry_count; i++) {
+        wordfilter_add(&filter, dictionary[i].word);
+    }
+}
 
 /* Simple JSON parsing functions - these are mocks for demonstration */
 static char* json_extract_string(const char *json, const char *key);
 static JSONBuffer read_file(const char *filename);
 
 /* Initialize dictionary */
-bool dictionary_init(void)
+bool dictionary_enhanced_init(void)
 {
     /* Allocate memory for dictionary */
-    dictionary = (DictionaryEntry *)malloc(MAX_ENTRIES * sizeof(DictionaryEntry));
+    dictionary = (DictionaryEntry *)calloc(MAX_ENTRIES, sizeof(DictionaryEntry));
     if (!dictionary) {
         return false;
     }
@@ -50,29 +65,31 @@ bool dictionary_init(void)
     entry_count = 2;
     
     /* Try to load French dictionary if available */
-    dictionary_load_json("data/dictionaries/extracted/french_dict_sample.json");
+    if (!dictionary_load_json("data/dictionaries/extracted/french_dict_sample.json")) {
+        dictionary_build_filter();
+    }
     
     return true;
 }
 
 /* Clean up dictionary resources */
-void dictionary_cleanup(void)
+void dictionary_enhanced_cleanup(void)
 {
     if (dictionary) {
-        for (int i = 0; i < entry_count; i++) {
-            free(dictionary[i].definition);
-            if (dictionary[i].example) free(dictionary[i].example);
-            if (dictionary[i].part_of_speech) free(dictionary[i].part_of_speech);
-        }
-        free(dictionary);
+        dictionary_free_entries(dictionary, entry_count);
         dictionary = NULL;
     }
+    entry_count = 0;
+    wordfilter_free(&filter);
 }
 
 /* Check if a word is in the dictionary */
-bool dictionary_is_word(const char *word)
+bool dictionary_enhanced_is_word(const char *word)
 {
     char lowercase[32];
+    bool found = false;
+    
+    STATS_TIMER_BEGIN(timer);
     
     /* Convert to lowercase for comparison */
     strncpy(lowercase, word, sizeof(lowercase) - 1);
@@ -81,20 +98,31 @@ bool dictionary_is_word(const char *word)
         lowercase[i] = tolower(lowercase[i]);
     }
     
+    /* Most misses stop at the prefilter */
+    if (!wordfilter_may_contain(&filter, lowercase)) {
+        STATS_TIMER_END(timer, STAT_DICTIONARY_LOOKUP);
+        return false;
+    }
+    
     /* Search for word in dictionary */
     for (int i = 0; i < entry_count; i++) {
         if (strcmp(dictionary[i].word, lowercase) == 0) {
-            return true;
+            found = true;
+            break;
         }
     }
     
-    return false;
+    STATS_TIMER_END(timer, STAT_DICTIONARY_LOOKUP);
+    return found;
 }
 
 /* Look up a word in the dictionary and return its entry */
 const DictionaryEntry* dictionary_lookup(const char *word)
 {
     char lowercase[32];
+    const DictionaryEntry *entry = NULL;
+    
+    STATS_TIMER_BEGIN(timer);
     
     /* Convert to lowercase for comparison */
     strncpy(lowercase, word, sizeof(lowercase) - 1);
@@ -103,14 +131,22 @@ const DictionaryEntry* dictionary_lookup(const char *word)
         lowercase[i] = tolower(lowercase[i]);
     }
     
+    /* Most misses stop at the prefilter */
+    if (!wordfilter_may_contain(&filter, lowercase)) {
+        STATS_TIMER_END(timer, STAT_DICTIONARY_LOOKUP);
+        return NULL;
+    }
+    
     /* Search for word in dictionary */
     for (int i = 0; i < entry_count; i++) {
         if (strcmp(dictionary[i].word, lowercase) == 0) {
-            return &dictionary[i];
+            entry = &dictionary[i];
+            break;
         }
     }
     
-    return NULL;
+    STATS_TIMER_END(timer, STAT_DICTIONARY_LOOKUP);
+    return entry;
 }
 
 /* Get the definition of a word */
@@ -134,12 +170,66 @@ const char* dictionary_get_part_of_speech(const char *word)
     return entry ? entry->part_of_speech : NULL;
 }
 
-/* Load dictionary from JSON file */
-bool dictionary_load_json(const char *filename)
+/* Append a parsed entry to a growable table */
+static DictionaryEntry* add_entry(DictionaryEntry **entries, int *count, int *capacity)
+{
+    if (*count == *capacity) {
+        int grown_capacity = *capacity ? *capacity * 2 : 256;
+        DictionaryEntry *grown = (DictionaryEntry *)realloc(*entries,
+                                                            grown_capacity * sizeof(DictionaryEntry));
+        if (!grown) {
+            return NULL;
+        }
+        *entries = grown;
+        *capacity = grown_capacity;
+    }
+    DictionaryEntry *entry = &(*entries)[(*count)++];
+    memset(entry, 0, sizeof(*entry));
+    return entry;
+}
+
+/* Copy the quoted value that follows key, or NULL */
+static char* extract_value(const char *from, const char *key, const char **after)
+{
+    const char *ptr = strstr(from, key);
+    if (!ptr) {
+        return NULL;
+    }
+    ptr = strchr(ptr + strlen(key), ':');
+    if (!ptr) {
+        return NULL;
+    }
+    ptr = strchr(ptr, '"');
+    if (!ptr) {
+        return NULL;
+    }
+    const char *start = ptr + 1;
+    const char *end = strchr(start, '"');
+    if (!end) {
+        return NULL;
+    }
+    
+    size_t length = end - start;
+    char *value = (char *)malloc(length + 1);
+    if (value) {
+        memcpy(value, start, length);
+        value[length] = '\0';
+    }
+    if (after) {
+        *after = end;
+    }
+    return value;
+}
+
+/* Parse a JSON dictionary into a newly allocated table the caller owns */
+bool dictionary_parse_json(const char *filename, DictionaryEntry **entries, int *count)
 {
     JSONBuffer buffer = read_file(filename);
+    int capacity = 0;
+    
+    *entries = NULL;
+    *count = 0;
     if (!buffer.data) {
-        printf("Failed to load dictionary file: %s\n", filename);
         return false;
     }
     
@@ -156,8 +246,7 @@ bool dictionary_load_json(const char *filename)
     ptr++;
     
     /* Parse each word entry */
-    int loaded = 0;
-    while (ptr < end && entry_count < MAX_ENTRIES) {
+    while (ptr < end) {
         /* Find the next word key */
         char *quote = strchr(ptr, '"');
         if (!quote) break;
@@ -166,86 +255,93 @@ bool dictionary_load_json(const char *filename)
         char *word_end = strchr(word_start, '"');
         if (!word_end) break;
         
-        /* Extract the word */
-        size_t word_len = word_end - word_start;
-        if (word_len >= sizeof(dictionary[entry_count].word)) {
-            word_len = sizeof(dictionary[entry_count].word) - 1;
-        }
-        strncpy(dictionary[entry_count].word, word_start, word_len);
-        dictionary[entry_count].word[word_len] = '\0';
-        
         /* Find the definition section */
-        ptr = strstr(word_end, "\"definition\"");
-        if (!ptr) break;
-        
-        /* Extract definition */
-        char *def_value = strstr(ptr, ":");
-        if (!def_value) break;
-        def_value = strchr(def_value, '"');
-        if (!def_value) break;
-        
-        char *def_start = def_value + 1;
-        char *def_end = strchr(def_start, '"');
-        if (!def_end) break;
-        
-        size_t def_len = def_end - def_start;
-        dictionary[entry_count].definition = (char *)malloc(def_len + 1);
-        strncpy(dictionary[entry_count].definition, def_start, def_len);
-        dictionary[entry_count].definition[def_len] = '\0';
+        const char *def_end;
+        char *definition = extract_value(word_end, "\"definition\"", &def_end);
+        if (!definition) break;
         
-        /* Extract example (optional) */
-        ptr = strstr(def_end, "\"example\"");
-        if (ptr) {
-            char *example_value = strstr(ptr, ":");
-            if (example_value) {
-                example_value = strchr(example_value, '"');
-                if (example_value) {
-                    char *example_start = example_value + 1;
-                    char *example_end = strchr(example_start, '"');
-                    if (example_end) {
-                        size_t example_len = example_end - example_start;
-                        dictionary[entry_count].example = (char *)malloc(example_len + 1);
-                        strncpy(dictionary[entry_count].example, example_start, example_len);
-                        dictionary[entry_count].example[example_len] = '\0';
-                    }
-                }
-            }
-        } else {
-            dictionary[entry_count].example = NULL;
+        DictionaryEntry *entry = add_entry(entries, count, &capacity);
+        if (!entry) {
+            free(definition);
+            break;
         }
         
-        /* Extract part of speech (optional) */
-        ptr = strstr(def_end, "\"part_of_speech\"");
-        if (ptr) {
-            char *pos_value = strstr(ptr, ":");
-            if (pos_value) {
-                pos_value = strchr(pos_value, '"');
-                if (pos_value) {
-                    char *pos_start = pos_value + 1;
-                    char *pos_end = strchr(pos_start, '"');
-                    if (pos_end) {
-                        size_t pos_len = pos_end - pos_start;
-                        dictionary[entry_count].part_of_speech = (char *)malloc(pos_len + 1);
-                        strncpy(dictionary[entry_count].part_of_speech, pos_start, pos_len);
-                        dictionary[entry_count].part_of_speech[pos_len] = '\0';
-                    }
-                }
-            }
-        } else {
-            dictionary[entry_count].part_of_speech = NULL;
+        /* Extract the word */
+        size_t word_len = word_end - word_start;
+        if (word_len >= sizeof(entry->word)) {
+            word_len = sizeof(entry->word) - 1;
         }
+        memcpy(entry->word, word_start, word_len);
+        entry->word[word_len] = '\0';
+        entry->definition = definition;
         
-        /* Move to next entry */
-        entry_count++;
-        loaded++;
+        /* Optional fields belong to this entry only if they come before its closing brace */
+        char *close = strchr(def_end, '}');
+        const char *field_end;
+        char *english_definition = extract_value(def_end, "\"english_definition\"", &field_end);
+        if (english_definition && close && field_end > close) {
+            free(english_definition);
+            english_definition = NULL;
+        }
+        entry->english_definition = english_definition;
+        char *example = extract_value(def_end, "\"example\"", &field_end);
+        if (example && close && field_end > close) {
+            free(example);
+            example = NULL;
+        }
+        entry->example = example;
+        char *part_of_speech = extract_value(def_end, "\"part_of_speech\"", &field_end);
+        if (part_of_speech && close && field_end > close) {
+            free(part_of_speech);
+            part_of_speech = NULL;
+        }
+        entry->part_of_speech = part_of_speech;
         
         /* Find next word or end of data */
-        ptr = strchr(def_end, '}');
-        if (!ptr) break;
-        ptr++;
+        if (!close) break;
+        ptr = close + 1;
     }
     
     free(buffer.data);
+    return *count > 0;
+}
+
+/* Free a table returned by dictionary_parse_json() */
+void dictionary_free_entries(DictionaryEntry *entries, int count)
+{
+    for (int i = 0; i < count; i++) {
+        free(entries[i].definition);
+        free(entries[i].english_definition);
+        free(entries[i].example);
+        free(entries[i].part_of_speech);
+    }
+    free(entries);
+}
+
+/* Load dictionary from JSON file */
+bool dictionary_load_json(const char *filename)
+{
+    DictionaryEntry *parsed;
+    int parsed_count;
+    int loaded = 0;
+    
+    STATS_TIMER_BEGIN(timer);
+    if (!dictionary_parse_json(filename, &parsed, &parsed_count)) {
+        dictionary_free_entries(parsed, parsed_count);
+        printf("Failed to load dictionary file: %s\n", filename);
+        return false;
+    }
+    
+    /* Move the parsed entries into the global table; the rest are freed */
+    for (int i = 0; i < parsed_count && dictionary && entry_count < MAX_ENTRIES; i++) {
+        dictionary[entry_count++] = parsed[i];
+        memset(&parsed[i], 0, sizeof(parsed[i]));
+        loaded++;
+    }
+    dictionary_free_entries(parsed, parsed_count);
+    dictionary_build_filter();
+    
+    STATS_TIMER_END(timer, STAT_DICTIONARY_LOAD);
     printf("Loaded %d words from %s\n", loaded, filename);
     return loaded > 0;
 }
@@ -0,0 +1,452 @@
+/**
+ * XScrabble - Endgame Search Implementation
+ *
+ * Moves are played and taken back through the game module, so the search
+ * scores, draws and ends games exactly as play does. Placements are tried
+ * highest score first, after the move the table remembers as best, and
+ * the pass last.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "endgame.h"
+#include "infer.h"
+
+#define SPREAD_INFINITY 1000000
+
+/* A way the unseen tiles may lie: the opponent's rack and the bag, drawn from the end */
+typedef struct {
+    char rack[RACK_SIZE + 1];
+    char bag[ENDGAME_MAX_BAG];
+    double weight;                          /* Chance of this split */
+} Split;
+
+/* Enumeration state for collect_splits() */
+typedef struct {
+    Split *splits;
+    int count;
+    int limit;
+    int counts[256];                        /* Unseen tiles not yet placed, by tile */
+    char letters[RACK_SIZE + ENDGAME_MAX_BAG];  /* Distinct unseen tiles */
+    int distinct;
+    int rack_size;
+    int bag_size;
+    Split current;
+} SplitBuilder;
+
+/* Work shared by the pre-endgame workers */
+typedef struct {
+    const PreendgameSearch *settings;
+    const Dawg *dawg;
+    const GameSnapshot *root;
+    const Split *splits;
+    int count;
+    const Move *moves;
+    int moves_count;
+    int plies;
+    int next;                               /* Next split to take */
+} PreendgameJob;
+
+/* One worker's sums, merged once it finishes */
+typedef struct {
+    PreendgameJob *job;
+    double value[ENDGAME_MAX_CANDIDATES];
+    double wins[ENDGAME_MAX_CANDIDATES];
+    uint64_t nodes;
+} PreendgameWorker;
+
+/* splitmix64 finalizer */
+static uint64_t mix(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/* Table key: board, racks and side to move, plus the bag in order and the scoreless run */
+static uint64_t position_key(const GameState *state)
+{
+    uint64_t key = game_position_hash() ^
+                   mix(0x9e3779b97f4a7c15ULL * (uint64_t)(state->scoreless_turns + 1));
+    for (int i = 0; i < state->tiles_left; i++) {
+        uint64_t slot = (uint64_t)(i + 1) << 8 | (unsigned char)state->bag[i];
+        key ^= mix(slot * 0xd6e8feb86659fd93ULL);
+    }
+    return key;
+}
+
+static int compare_scores(const void *x, const void *y)
+{
+    int a = ((const Move *)x)->score;
+    int b = ((const Move *)y)->score;
+    return (a < b) - (a > b);
+}
+
+static int spread(const GameState *state, int player)
+{
+    return state->scores[player] - state->scores[player ^ 1];
+}
+
+/*
+ * Best change in spread the side to move can force within plies, searched
+ * in the window (alpha, beta). ply picks the move list; best, if set,
+ * receives the move that achieves it.
+ */
+static int negamax(EndgameSearch *s, int plies, int alpha, int beta, int ply, Move *best)
+{
+    GameState *state = game_get_state();
+    MoveList *list = &s->lists[ply];
+    int player = state->to_move;
+    int original_alpha = alpha;
+    int hint = -1;
+    TTableResult hit;
+
+    if (state->over || plies == 0) {
+        return 0;
+    }
+    s->nodes++;
+
+    uint64_t key = position_key(state);
+    if (s->table && ttable_probe(s->table, key, &hit)) {
+        /* Deeper results are not used, so values do not depend on which thread stored first */
+        hint = hit.hint;
+        if (hit.depth == plies && !best) {
+            if (hit.bound == TTABLE_EXACT ||
+                (hit.bound == TTABLE_LOWER && hit.value >= beta) ||
+                (hit.bound == TTABLE_UPPER && hit.value <= alpha)) {
+                return hit.value;
+            }
+        }
+    }
+
+    movegen_generate(s->dawg, state->racks[player], list);
+    qsort(list->moves, (size_t)list->count, sizeof(Move), compare_scores);
+
+    /* Index count stands for the pass */
+    int value = -SPREAD_INFINITY;
+    int best_index = 0;
+    int before = spread(state, player);
+    for (int n = -1; n <= list->count; n++) {
+        int i = n < 0 ? hint : n;
+        if ((n < 0 && (hint < 0 || hint > list->count)) || (n >= 0 && i == hint)) {
+            continue;
+        }
+        Move pass = {0};
+        const Move *move = &pass;
+        pass.type = MOVE_PASS;
+        if (i < list->count) {
+            move = &list->moves[i];
+        }
+        if (!game_play_move(move)) {
+            continue;
+        }
+        int delta = spread(state, player) - before;
+        int child = delta - negamax(s, plies - 1, delta - beta, delta - alpha, ply + 1, NULL);
+        game_unplay_move();
+
+        if (child > value) {
+            value = child;
+            best_index = i;
+            if (best) {
+                *best = *move;
+            }
+        }
+        if (value > alpha) {
+            alpha = value;
+        }
+        if (alpha >= beta) {
+            break;
+        }
+    }
+
+    if (s->table) {
+        TTableBound bound = value <= original_alpha ? TTABLE_UPPER :
+                            value >= beta ? TTABLE_LOWER : TTABLE_EXACT;
+        ttable_store(s->table, key, value, plies, bound, (uint16_t)best_index);
+    }
+    return value;
+}
+
+void endgame_init(EndgameSearch *search, const Dawg *dawg, TTable *table)
+{
+    search->dawg = dawg;
+    search->table = table;
+    search->nodes = 0;
+    for (int i = 0; i < ENDGAME_MAX_PLIES; i++) {
+        movegen_list_init(&search->lists[i]);
+    }
+}
+
+void endgame_free(EndgameSearch *search)
+{
+    for (int i = 0; i < ENDGAME_MAX_PLIES; i++) {
+        movegen_list_free(&search->lists[i]);
+    }
+}
+
+/*
+ * Search the calling thread's game plies moves ahead, taking everything on
+ * both racks and in the bag as known. Returns the change in spread the side
+ * to move can force, counting the rack adjustments of games that end within
+ * the horizon; best receives the move, a pass if the game is over.
+ */
+int endgame_solve(EndgameSearch *search, int plies, Move *best)
+{
+    plies = plies < 1 ? 1 : plies > ENDGAME_MAX_PLIES ? ENDGAME_MAX_PLIES : plies;
+    if (best) {
+        memset(best, 0, sizeof(*best));
+        best->type = MOVE_PASS;
+    }
+    return negamax(search, plies, -SPREAD_INFINITY, SPREAD_INFINITY, 0, best);
+}
+
+static double factorial(int n)
+{
+    double f = 1.0;
+    for (int i = 2; i <= n; i++) {
+        f *= i;
+    }
+    return f;
+}
+
+/* Every order of the remaining tiles in the bag, from slot position on */
+static void collect_bags(SplitBuilder *b, int position)
+{
+    if (b->count > b->limit) {
+        return;
+    }
+    if (position == b->bag_size) {
+        if (b->count < b->limit) {
+            b->splits[b->count] = b->current;
+        }
+        b->count++;
+        return;
+    }
+    for (int i = 0; i < b->distinct; i++) {
+        unsigned char tile = (unsigned char)b->letters[i];
+        if (b->counts[tile] > 0) {
+            b->counts[tile]--;
+            b->current.bag[position] = (char)tile;
+            collect_bags(b, position + 1);
+            b->counts[tile]++;
+        }
+    }
+}
+
+/*
+ * Every opponent rack, choosing copies of distinct tile letter on, then
+ * every bag order of the rest. A rack is as likely as the number of orders
+ * its tiles could be drawn in, so each copy count n divides by n!.
+ */
+static void collect_splits(SplitBuilder *b, int letter, int length, double weight)
+{
+    if (letter == b->distinct) {
+        if (length == b->rack_size) {
+            b->current.rack[length] = '\0';
+            b->current.weight = weight;
+            collect_bags(b, 0);
+        }
+        return;
+    }
+    unsigned char tile = (unsigned char)b->letters[letter];
+    int available = b->counts[tile];
+    for (int n = 0; n <= available && length + n <= b->rack_size; n++) {
+        for (int i = 0; i < n; i++) {
+            b->current.rack[length + i] = (char)tile;
+        }
+        b->counts[tile] = available - n;
+        collect_splits(b, letter + 1, length + n, weight / factorial(n));
+    }
+    b->counts[tile] = available;
+}
+
+static void *preendgame_worker(void *arg)
+{
+    PreendgameWorker *worker = (PreendgameWorker *)arg;
+    PreendgameJob *job = worker->job;
+    int mover = job->root->to_move;
+    EndgameSearch search;
+
+    endgame_init(&search, job->dawg, job->settings->table);
+    for (;;) {
+        int index = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+        if (index >= job->count) {
+            break;
+        }
+        const Split *split = &job->splits[index];
+        GameSnapshot snapshot = *job->root;
+        strcpy(snapshot.racks[mover ^ 1], split->rack);
+        memcpy(snapshot.tiles, split->bag, (size_t)snapshot.tiles_left);
+        game_restore(&snapshot);
+
+        GameState *state = game_get_state();
+        int before = spread(state, mover);
+        for (int c = 0; c < job->moves_count; c++) {
+            if (!game_play_move(&job->moves[c])) {
+                continue;
+            }
+            int delta = spread(state, mover) - before;
+            int value = delta - negamax(&search, job->plies - 1, -SPREAD_INFINITY,
+                                        SPREAD_INFINITY, 0, NULL);
+            game_unplay_move();
+
+            int final = before + value;
+            worker->value[c] += split->weight * value;
+            worker->wins[c] += split->weight * (final > 0 ? 1.0 : final == 0 ? 0.5 : 0.0);
+        }
+    }
+    worker->nodes = search.nodes;
+    endgame_free(&search);
+    movegen_cache_free();
+    return NULL;
+}
+
+void endgame_pre_defaults(PreendgameSearch *search)
+{
+    memset(search, 0, sizeof(*search));
+    search->threads = 1;
+    search->plies = 4;
+    search->max_splits = ENDGAME_MAX_SPLITS;
+}
+
+/* The k highest-scoring placements for rack and the pass, as pre-endgame candidates */
+int endgame_pre_candidates(const Dawg *dawg, const char *rack, int k, EndgameCandidate *candidates)
+{
+    MoveList list;
+    int count = 0;
+
+    k = k < 0 ? 0 : k > ENDGAME_MAX_CANDIDATES - 1 ? ENDGAME_MAX_CANDIDATES - 1 : k;
+    movegen_list_init(&list);
+    movegen_generate(dawg, rack, &list);
+    qsort(list.moves, (size_t)list.count, sizeof(Move), compare_scores);
+    for (int i = 0; i < list.count && count < k; i++) {
+        memset(&candidates[count], 0, sizeof(EndgameCandidate));
+        candidates[count++].move = list.moves[i];
+    }
+    movegen_list_free(&list);
+    memset(&candidates[count], 0, sizeof(EndgameCandidate));
+    candidates[count++].move.type = MOVE_PASS;
+    return count;
+}
+
+/*
+ * Value each candidate move for the side to move over every split of the
+ * tiles it cannot see, each split solved to search->plies as an endgame.
+ * Only the board, the mover's rack and the opponent's rack size are used,
+ * so positions replayed from records, which have no bag, work too. The
+ * calling thread's game is left as it was. False if the bag does not hold
+ * 1 to ENDGAME_MAX_BAG tiles or has more than max_splits splits.
+ */
+bool endgame_pre_solve(PreendgameSearch *search, const Dawg *dawg, EndgameCandidate *candidates,
+                       int count)
+{
+    GameState *state = game_get_state();
+    int mover = state->to_move;
+    char unseen[BAG_CAPACITY + 1];
+    SplitBuilder builder;
+    GameSnapshot root;
+
+    search->splits = 0;
+    search->nodes = 0;
+    if (state->over || state->tiles_left < 1 || state->tiles_left > ENDGAME_MAX_BAG) {
+        fprintf(stderr, "Pre-endgame search needs 1 to %d tiles in the bag, not %d\n",
+                ENDGAME_MAX_BAG, state->tiles_left);
+        return false;
+    }
+    if (count < 1 || count > ENDGAME_MAX_CANDIDATES) {
+        fprintf(stderr, "Pre-endgame search takes 1 to %d candidates, not %d\n",
+                ENDGAME_MAX_CANDIDATES, count);
+        return false;
+    }
+
+    /* Split the unseen tiles into the opponent's rack and the bag */
+    memset(&builder, 0, sizeof(builder));
+    builder.rack_size = (int)strlen(state->racks[mover ^ 1]);
+    builder.bag_size = state->tiles_left;
+    builder.limit = search->max_splits;
+    int length = infer_unseen(mover, unseen, sizeof(unseen));
+    if (length != builder.rack_size + builder.bag_size) {
+        fprintf(stderr, "Pre-endgame sees %d unseen tiles, expected %d\n", length,
+                builder.rack_size + builder.bag_size);
+        return false;
+    }
+    for (int i = 0; i < length; i++) {
+        builder.counts[(unsigned char)unseen[i]]++;
+    }
+    for (int tile = 0; tile < 256; tile++) {
+        if (builder.counts[tile] > 0) {
+            builder.letters[builder.distinct++] = (char)tile;
+        }
+    }
+    builder.splits = malloc((size_t)builder.limit * sizeof(Split));
+    if (!builder.splits) {
+        return false;
+    }
+    collect_splits(&builder, 0, 0, 1.0);
+    if (builder.count > builder.limit) {
+        fprintf(stderr, "Pre-endgame has more than %d splits of the unseen tiles\n", builder.limit);
+        free(builder.splits);
+        return false;
+    }
+    double total = 0.0;
+    for (int i = 0; i < builder.count; i++) {
+        total += builder.splits[i].weight;
+    }
+    for (int i = 0; i < builder.count; i++) {
+        builder.splits[i].weight /= total;
+    }
+
+    /* Solve every split on the workers */
+    Move moves[ENDGAME_MAX_CANDIDATES];
+    for (int c = 0; c < count; c++) {
+        moves[c] = candidates[c].move;
+    }
+    game_snapshot(&root);
+    int plies = search->plies < 1 ? 1 :
+                search->plies > ENDGAME_MAX_PLIES ? ENDGAME_MAX_PLIES : search->plies;
+    int threads = search->threads < 1 ? 1 :
+                  search->threads > ENDGAME_MAX_THREADS ? ENDGAME_MAX_THREADS : search->threads;
+    PreendgameJob job = {search, dawg, &root, builder.splits, builder.count, moves, count, plies, 0};
+    PreendgameWorker *workers = calloc((size_t)threads, sizeof(PreendgameWorker));
+    pthread_t handles[ENDGAME_MAX_THREADS];
+    int started = 0;
+    if (!workers) {
+        free(builder.splits);
+        return false;
+    }
+    for (int i = 0; i < threads; i++) {
+        workers[i].job = &job;
+        if (pthread_create(&handles[i], NULL, preendgame_worker, &workers[i]) != 0) {
+            break;
+        }
+        started++;
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(handles[i], NULL);
+    }
+    if (started == 0) {
+        fprintf(stderr, "Failed to start pre-endgame workers\n");
+        free(workers);
+        free(builder.splits);
+        return false;
+    }
+
+    for (int c = 0; c < count; c++) {
+        candidates[c].value = 0.0;
+        candidates[c].wins = 0.0;
+        for (int i = 0; i < started; i++) {
+            candidates[c].value += workers[i].value[c];
+            candidates[c].wins += workers[i].wins[c];
+        }
+    }
+    for (int i = 0; i < started; i++) {
+        search->nodes += workers[i].nodes;
+    }
+    search->splits = builder.count;
+
+    free(workers);
+    free(builder.splits);
+    return true;
+}
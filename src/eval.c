@@ -0,0 +1,371 @@
+/**
+ * XScrabble - Static Move Evaluation Implementation
+ *
+ * A weights file holds one weight per line; anything not listed keeps its
+ * default. Letters are tile faces in the lexicon's alphabet, '_' is the
+ * blank, and phases run 0 (bag empty) to 3 (more than 30 tiles left):
+ *
+ *   letter S 7.5           keeping one S
+ *   duplicate -3           each extra copy of a kept letter
+ *   balance 2 3 0.5        keeping 2 vowels and 3 consonants
+ *   scale 1 0.6            leave weight in phase 1
+ *   lane 3 -2.5            per triple-word square opened in phase 3
+ *   vowels A E I O U       letters counted as vowels
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "eval.h"
+#include "tiles.h"
+
+#define MAX_LINE_LENGTH 256
+
+/* Squares a word can stretch from a new tile towards a triple-word square */
+#define LANE_REACH (RACK_SIZE)
+
+/* Rough single-tile leave values for English, blank last */
+static const float english_letters[27] = {
+    1.0f, -2.0f, 0.5f, 0.5f, 1.5f, -2.0f, -2.5f, 1.0f, -0.5f, -1.5f, -1.0f, -0.5f, 0.5f,
+    0.0f, -1.0f, -0.5f, -7.0f, 1.0f, 7.5f, 0.5f, -3.0f, -5.0f, -3.0f, 3.5f, -1.0f, 2.5f,
+    25.0f
+};
+
+/* Equity context for eval_best_move()'s visitor */
+typedef struct {
+    const EvalContext *context;
+    Move *best;
+    float equity;
+    int found;
+} BestMove;
+
+/* Bag phase for a number of tiles left to draw */
+static int phase_of(int tiles_left)
+{
+    return tiles_left <= 0 ? 0 : tiles_left <= RACK_SIZE ? 1 : tiles_left <= 30 ? 2 : 3;
+}
+
+/* Machine letter index of a rack tile, counting the blank last; -1 if neither */
+static int tile_index(char tile)
+{
+    if (tile == TILE_BLANK || tiles_is_blank(tile)) {
+        return ALPHABET_MAX_LETTERS;
+    }
+    int index = (unsigned char)tile - ALPHABET_FIRST;
+    return index >= 0 && index < ALPHABET_MAX_LETTERS ? index : -1;
+}
+
+/* Built-in weights, tuned by hand for English */
+void eval_default_weights(EvalWeights *weights)
+{
+    static const float scale[EVAL_PHASES] = {0.0f, 0.5f, 0.9f, 1.0f};
+    static const float lane[EVAL_PHASES] = {0.0f, -1.0f, -2.0f, -2.5f};
+
+    memset(weights, 0, sizeof(*weights));
+    for (int i = 0; i < 26; i++) {
+        weights->letter[i] = english_letters[i];
+    }
+    weights->letter[ALPHABET_MAX_LETTERS] = english_letters[26];
+    weights->duplicate = -3.0f;
+
+    /* Keeping about two vowels in five is best; lopsided leaves cost more the longer they are */
+    for (int v = 0; v <= RACK_SIZE; v++) {
+        for (int c = 0; v + c <= RACK_SIZE; c++) {
+            float off = fabsf(v - 0.4f * (v + c));
+            float penalty = -1.5f * off * off;
+            weights->balance[v][c] = penalty < -15.0f ? -15.0f : penalty;
+        }
+    }
+
+    memcpy(weights->leave_scale, scale, sizeof(scale));
+    memcpy(weights->lane, lane, sizeof(lane));
+    for (const char *p = "AEIOU"; *p; p++) {
+        weights->vowel[*p - ALPHABET_FIRST] = true;
+    }
+}
+
+/* Machine letter index of a tile face in a weights file, or -1 */
+static int face_index(const char *face, const Alphabet *alphabet)
+{
+    char letters[4];
+    if (strcmp(face, "_") == 0) {
+        return ALPHABET_MAX_LETTERS;
+    }
+    if (alphabet_encode(alphabet, face, letters, sizeof(letters)) != 1) {
+        return -1;
+    }
+    return letters[0] - ALPHABET_FIRST;
+}
+
+/* Override the defaults with a weights file; letters are spelled in alphabet (NULL = English) */
+bool eval_load_weights(EvalWeights *weights, const char *filename, const Alphabet *alphabet)
+{
+    FILE *file = fopen(filename, "r");
+    char line[MAX_LINE_LENGTH];
+    int number = 0;
+    bool ok = true;
+
+    if (!file) {
+        return false;
+    }
+    if (!alphabet) {
+        alphabet = alphabet_english();
+    }
+
+    eval_default_weights(weights);
+    while (ok && fgets(line, sizeof(line), file)) {
+        char key[32];
+        char face[ALPHABET_MAX_SPELLING + 1];
+        int a;
+        int b;
+        float value;
+        int consumed;
+
+        number++;
+        line[strcspn(line, "#\r\n")] = '\0';
+        if (sscanf(line, "%31s%n", key, &consumed) != 1) {
+            continue;
+        }
+
+        const char *rest = line + consumed;
+        if (strcmp(key, "letter") == 0) {
+            ok = sscanf(rest, "%8s %f", face, &value) == 2 &&
+                 (a = face_index(face, alphabet)) >= 0;
+            if (ok) {
+                weights->letter[a] = value;
+            }
+        } else if (strcmp(key, "duplicate") == 0) {
+            ok = sscanf(rest, "%f", &weights->duplicate) == 1;
+        } else if (strcmp(key, "balance") == 0) {
+            ok = sscanf(rest, "%d %d %f", &a, &b, &value) == 3 &&
+                 a >= 0 && b >= 0 && a + b <= RACK_SIZE;
+            if (ok) {
+                weights->balance[a][b] = value;
+            }
+        } else if (strcmp(key, "scale") == 0 || strcmp(key, "lane") == 0) {
+            ok = sscanf(rest, "%d %f", &a, &value) == 2 && a >= 0 && a < EVAL_PHASES;
+            if (ok) {
+                (key[0] == 's' ? weights->leave_scale : weights->lane)[a] = value;
+            }
+        } else if (strcmp(key, "vowels") == 0) {
+            memset(weights->vowel, 0, sizeof(weights->vowel));
+            for (int offset; ok && sscanf(rest, "%8s%n", face, &offset) == 1; rest += offset) {
+                ok = (a = face_index(face, alphabet)) >= 0;
+                if (ok) {
+                    weights->vowel[a] = true;
+                }
+            }
+        } else {
+            ok = false;
+        }
+    }
+    fclose(file);
+
+    if (!ok) {
+        fprintf(stderr, "Bad weight on line %d of %s\n", number, filename);
+    }
+    return ok;
+}
+
+/* Read the rack and board for a position; moves are then evaluated against it */
+void eval_prepare(EvalContext *context, const EvalWeights *weights, const char *rack,
+                  int tiles_left)
+{
+    int phase = phase_of(tiles_left);
+    float scale = weights->leave_scale[phase];
+
+    memset(context->rack, 0, sizeof(context->rack));
+    for (const char *p = rack; *p; p++) {
+        int index = tile_index(*p);
+        if (index >= 0 && context->rack[index] < RACK_SIZE) {
+            context->rack[index]++;
+        }
+    }
+
+    /* Leave tables with the phase folded in */
+    context->rack_leave = 0.0f;
+    context->vowels = 0;
+    context->consonants = 0;
+    for (int letter = 0; letter < EVAL_LETTERS; letter++) {
+        for (int n = 0; n <= RACK_SIZE; n++) {
+            context->leave[letter][n] = scale * (n * weights->letter[letter] +
+                                                 (n > 1 ? (n - 1) * weights->duplicate : 0.0f));
+        }
+        context->vowel[letter] = weights->vowel[letter];
+        context->rack_leave += context->leave[letter][context->rack[letter]];
+        if (letter == ALPHABET_MAX_LETTERS) {
+            continue;
+        }
+        if (weights->vowel[letter]) {
+            context->vowels += context->rack[letter];
+        } else {
+            context->consonants += context->rack[letter];
+        }
+    }
+    for (int v = 0; v <= RACK_SIZE; v++) {
+        for (int c = 0; c <= RACK_SIZE; c++) {
+            context->balance[v][c] = v + c <= RACK_SIZE ? scale * weights->balance[v][c] : 0.0f;
+        }
+    }
+    context->lane = weights->lane[phase];
+
+    /* Which empty triple-word squares each empty square has a clear line to */
+    const BoardLayout *layout = board_layout();
+    int size = board_size();
+    int lanes = 0;
+    memset(context->reach, 0, sizeof(context->reach));
+    context->open = 0;
+    for (int row = 0; row < size; row++) {
+        for (int col = 0; col < size; col++) {
+            context->lane_index[row][col] = -1;
+            if (lanes == EVAL_MAX_LANES || layout->word_mult[BOARD_ACROSS][row + 1][col + 1] != 3 ||
+                layout->letter[BOARD_ACROSS][row + 1][col + 1]) {
+                continue;
+            }
+
+            uint32_t bit = 1u << lanes;
+            context->lane_index[row][col] = (int8_t)lanes++;
+            for (int d = 0; d < 4; d++) {
+                /* Along the square's row (d < 2) or column, walking until the border */
+                int orientation = d < 2 ? BOARD_ACROSS : BOARD_DOWN;
+                int line = orientation == BOARD_ACROSS ? row + 1 : col + 1;
+                int pos = orientation == BOARD_ACROSS ? col + 1 : row + 1;
+                int step = d % 2 ? -1 : 1;
+                for (int k = 1; k <= LANE_REACH; k++) {
+                    int at = pos + step * k;
+                    if (layout->flags[orientation][line][at] & BOARD_SQUARE_BORDER) {
+                        break;
+                    }
+                    if (layout->letter[orientation][line][at]) {
+                        context->open |= bit;
+                        break;
+                    }
+                    if (orientation == BOARD_ACROSS) {
+                        context->reach[row][at - 1] |= bit;
+                    } else {
+                        context->reach[at - 1][col] |= bit;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Equity of a placement, exchange or pass: score plus the scaled value of
+ * the tiles kept, plus the lane charge for triple-word squares the placed
+ * tiles open. Only the move's own tiles are examined.
+ */
+float eval_equity(const EvalContext *context, const Move *move)
+{
+    int letters[BOARD_MAX_SIZE];
+    int counts[BOARD_MAX_SIZE];
+    int distinct = 0;
+    int dr = move->direction == MOVE_DOWN ? 1 : 0;
+    int dc = move->direction == MOVE_ACROSS ? 1 : 0;
+    bool place = move->type == MOVE_PLACE;
+    uint32_t reached = 0;
+    uint32_t covered = 0;
+
+    for (int i = 0; i < move->length; i++) {
+        int index = move->tiles[i] ? tile_index(move->tiles[i]) : -1;
+        if (index < 0) {
+            continue;
+        }
+
+        int j = 0;
+        while (j < distinct && letters[j] != index) {
+            j++;
+        }
+        if (j == distinct) {
+            letters[distinct] = index;
+            counts[distinct++] = 0;
+        }
+        counts[j]++;
+
+        if (place) {
+            int row = move->row + dr * i;
+            int col = move->col + dc * i;
+            reached |= context->reach[row][col];
+            if (context->lane_index[row][col] >= 0) {
+                covered |= 1u << context->lane_index[row][col];
+            }
+        }
+    }
+
+    /* Adjust the whole-rack leave for the letters used */
+    float leave = context->rack_leave;
+    int vowels = context->vowels;
+    int consonants = context->consonants;
+    for (int j = 0; j < distinct; j++) {
+        int letter = letters[j];
+        int have = context->rack[letter];
+        int keep = have > counts[j] ? have - counts[j] : 0;
+        leave += context->leave[letter][keep] - context->leave[letter][have];
+        if (letter == ALPHABET_MAX_LETTERS) {
+            continue;
+        }
+        if (context->vowel[letter]) {
+            vowels -= have - keep;
+        } else {
+            consonants -= have - keep;
+        }
+    }
+    leave += context->balance[vowels][consonants];
+
+    int opened = __builtin_popcount(reached & ~covered & ~context->open);
+    return (place ? (float)move->score : 0.0f) + leave + context->lane * (float)opened;
+}
+
+/* Value of keeping exactly these tiles, in the prepared position's phase */
+float eval_leave(const EvalContext *context, const char *leave)
+{
+    uint8_t counts[EVAL_LETTERS] = {0};
+    int vowels = 0;
+    int consonants = 0;
+    float value = 0.0f;
+
+    for (const char *p = leave; *p; p++) {
+        int index = tile_index(*p);
+        if (index < 0 || counts[index] == RACK_SIZE) {
+            continue;
+        }
+        value += context->leave[index][counts[index] + 1] - context->leave[index][counts[index]];
+        counts[index]++;
+        if (index == ALPHABET_MAX_LETTERS) {
+            continue;
+        }
+        if (context->vowel[index]) {
+            vowels++;
+        } else {
+            consonants++;
+        }
+    }
+    return vowels + consonants <= RACK_SIZE ? value + context->balance[vowels][consonants] : value;
+}
+
+static bool best_visit(const Move *move, void *data)
+{
+    BestMove *best = (BestMove *)data;
+    float equity = eval_equity(best->context, move);
+    if (!best->found || equity > best->equity) {
+        *best->best = *move;
+        best->equity = equity;
+        best->found = 1;
+    }
+    return true;
+}
+
+/* Placement with the highest equity, the first generated on ties; 0 if there is none */
+int eval_best_move(const EvalContext *context, const Dawg *dawg, const char *rack,
+                   Move *best, float *equity)
+{
+    BestMove search = {context, best, 0.0f, 0};
+
+    movegen_visit(dawg, rack, best_visit, &search, NULL);
+    if (equity && search.found) {
+        *equity = search.equity;
+    }
+    return search.found;
+}
@@ -0,0 +1,308 @@
+/**
+ * XScrabble - Exchange Evaluation Implementation
+ *
+ * A sub-rack is numbered by how many of each distinct rack tile it keeps,
+ * in mixed radix, so a placement or exchange finds the value of what it
+ * keeps by subtracting one stride per tile it plays. Sampling is done once
+ * per position: every sub-rack drawing k tiles takes the first k of each
+ * sampled refill. Sub-racks are laid out by size, smallest (most drawn)
+ * first, and their kept counts by letter, so the update for each drawn tile
+ * runs over a contiguous prefix of sub-racks with unit-stride table reads.
+ */
+
+#include <string.h>
+#include <math.h>
+#include "exchange.h"
+#include "board.h"
+#include "tiles.h"
+
+/* splitmix64 step, as for the bag shuffle */
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/* Evaluation letter of a rack tile, counting the blank last; -1 if neither */
+static int tile_index(char tile)
+{
+    if (tile == TILE_BLANK || tiles_is_blank(tile)) {
+        return ALPHABET_MAX_LETTERS;
+    }
+    int index = (unsigned char)tile - ALPHABET_FIRST;
+    return index >= 0 && index < ALPHABET_MAX_LETTERS ? index : -1;
+}
+
+/* Rack tile of an evaluation letter */
+static char index_tile(int index)
+{
+    return index == ALPHABET_MAX_LETTERS ? TILE_BLANK : (char)(ALPHABET_FIRST + index);
+}
+
+/* Position of an evaluation letter among the rack's distinct tiles, or -1 */
+static int rack_slot(const ExchangeContext *context, int index)
+{
+    for (int i = 0; i < context->letters; i++) {
+        if (context->letter[i] == index) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* Tiles player cannot see: the bag and the opponent's rack, in no useful order */
+int exchange_unseen(const GameState *state, int player, char *buffer)
+{
+    const char *other = state->racks[player ^ 1];
+    size_t length = strlen(other);
+
+    memcpy(buffer, state->bag, (size_t)state->tiles_left);
+    memcpy(buffer + state->tiles_left, other, length);
+    buffer[state->tiles_left + length] = '\0';
+    return state->tiles_left + (int)length;
+}
+
+/*
+ * Value every sub-rack of rack: the mean, over samples refills drawn from
+ * unseen (at most tiles_left tiles each), of the evaluation's leave of the
+ * refilled rack. eval must be prepared for the same position.
+ */
+void exchange_prepare(ExchangeContext *context, const EvalContext *eval, const char *rack,
+                      const char *unseen, int tiles_left, int samples, uint64_t seed)
+{
+    int rack_size = board_variant()->rack_size;
+    uint8_t kept[EVAL_LETTERS][EXCHANGE_MAX_KEEPS];     /* By letter, then sub-rack position */
+    uint8_t vowels[EXCHANGE_MAX_KEEPS];
+    uint8_t consonants[EXCHANGE_MAX_KEEPS];
+    uint8_t draws[EXCHANGE_MAX_KEEPS];
+    int order[EXCHANGE_MAX_KEEPS];                      /* Sub-rack at each position */
+    int fewer[RACK_SIZE + 2];                           /* Positions holding fewer than n tiles */
+    float base[EXCHANGE_MAX_KEEPS];
+    float total[EXCHANGE_MAX_KEEPS];
+    float gain[EVAL_LETTERS][RACK_SIZE];
+    uint8_t pool[EXCHANGE_MAX_UNSEEN];
+    int pool_size = 0;
+
+    /* Distinct tiles of the rack and the numbering of its sub-racks */
+    memset(context, 0, sizeof(*context));
+    for (const char *p = rack; *p; p++) {
+        int index = tile_index(*p);
+        if (index < 0) {
+            continue;
+        }
+        int slot = rack_slot(context, index);
+        if (slot < 0) {
+            if (context->letters == RACK_SIZE) {
+                continue;
+            }
+            slot = context->letters++;
+            context->letter[slot] = (uint8_t)index;
+        }
+        context->have[slot]++;
+    }
+    context->keeps = 1;
+    for (int i = 0; i < context->letters; i++) {
+        context->stride[i] = context->keeps;
+        context->keeps *= context->have[i] + 1;
+    }
+    context->can_exchange = tiles_left >= rack_size;
+
+    /* Lay the sub-racks out by size, smallest first */
+    int sizes[EXCHANGE_MAX_KEEPS];
+    memset(fewer, 0, sizeof(fewer));
+    for (int k = 0; k < context->keeps; k++) {
+        sizes[k] = 0;
+        for (int i = 0; i < context->letters; i++) {
+            sizes[k] += k / context->stride[i] % (context->have[i] + 1);
+        }
+        fewer[sizes[k] + 1]++;
+    }
+    for (int n = 1; n <= RACK_SIZE + 1; n++) {
+        fewer[n] += fewer[n - 1];
+    }
+    int next[RACK_SIZE + 1];
+    memcpy(next, fewer, sizeof(next));
+    for (int k = 0; k < context->keeps; k++) {
+        order[next[sizes[k]]++] = k;
+    }
+
+    for (int l = 0; l < EVAL_LETTERS; l++) {
+        for (int n = 0; n < RACK_SIZE; n++) {
+            gain[l][n] = eval->leave[l][n + 1] - eval->leave[l][n];
+        }
+    }
+    for (const char *p = unseen; *p && pool_size < EXCHANGE_MAX_UNSEEN; p++) {
+        int index = tile_index(*p);
+        if (index >= 0) {
+            pool[pool_size++] = (uint8_t)index;
+        }
+    }
+    int max_draw = rack_size;
+    max_draw = max_draw < tiles_left ? max_draw : tiles_left;
+    max_draw = max_draw < pool_size ? max_draw : pool_size;
+    if (max_draw <= 0 || samples < 1) {
+        max_draw = 0;
+        samples = 1;
+    }
+
+    memset(kept, 0, sizeof(kept));
+    for (int pos = 0; pos < context->keeps; pos++) {
+        int k = order[pos];
+        int room = rack_size - sizes[k];
+        base[pos] = 0.0f;
+        vowels[pos] = 0;
+        consonants[pos] = 0;
+        draws[pos] = (uint8_t)(room < max_draw ? (room > 0 ? room : 0) : max_draw);
+        total[pos] = 0.0f;
+        for (int i = 0; i < context->letters; i++) {
+            int letter = context->letter[i];
+            int count = k / context->stride[i] % (context->have[i] + 1);
+            kept[letter][pos] = (uint8_t)count;
+            base[pos] += eval->leave[letter][count];
+            if (letter == ALPHABET_MAX_LETTERS) {
+                continue;
+            }
+            if (eval->vowel[letter]) {
+                vowels[pos] += (uint8_t)count;
+            } else {
+                consonants[pos] += (uint8_t)count;
+            }
+        }
+    }
+
+    /* The same refills for every sub-rack; those keeping fewer tiles read further into each */
+    for (int s = 0; s < samples; s++) {
+        float acc[EXCHANGE_MAX_KEEPS];
+        uint8_t seen[EVAL_LETTERS] = {0};
+        uint8_t drawn_vowels[RACK_SIZE + 1] = {0};
+        uint8_t drawn_consonants[RACK_SIZE + 1] = {0};
+
+        memcpy(acc, base, context->keeps * sizeof(float));
+        for (int j = 0; j < max_draw; j++) {
+            int pick = j + (int)(next_random(&seed) % (uint64_t)(pool_size - j));
+            uint8_t letter = pool[pick];
+            pool[pick] = pool[j];
+            pool[j] = letter;
+
+            int copies = seen[letter]++;
+            int limit = fewer[rack_size - j];
+            const uint8_t *counts = kept[letter];
+            const float *row = gain[letter];
+            for (int pos = 0; pos < limit; pos++) {
+                acc[pos] += row[counts[pos] + copies];
+            }
+            bool vowel = letter != ALPHABET_MAX_LETTERS && eval->vowel[letter];
+            bool consonant = letter != ALPHABET_MAX_LETTERS && !eval->vowel[letter];
+            drawn_vowels[j + 1] = drawn_vowels[j] + vowel;
+            drawn_consonants[j + 1] = drawn_consonants[j] + consonant;
+        }
+        for (int pos = 0; pos < context->keeps; pos++) {
+            int m = draws[pos];
+            total[pos] += acc[pos] + eval->balance[vowels[pos] + drawn_vowels[m]]
+                                                  [consonants[pos] + drawn_consonants[m]];
+        }
+    }
+
+    for (int pos = 0; pos < context->keeps; pos++) {
+        context->value[order[pos]] = total[pos] / (float)samples;
+    }
+}
+
+/* Sub-rack of the prepared rack keeping exactly these tiles, or -1 if it is not one */
+int exchange_keep_index(const ExchangeContext *context, const char *kept)
+{
+    int counts[RACK_SIZE] = {0};
+    int index = 0;
+
+    for (const char *p = kept; *p; p++) {
+        int slot = rack_slot(context, tile_index(*p));
+        if (slot < 0 || ++counts[slot] > context->have[slot]) {
+            return -1;
+        }
+        index += context->stride[slot];
+    }
+    return index;
+}
+
+/* Score plus the expected value of what the move keeps; -INFINITY if the rack cannot make it */
+float exchange_equity(const ExchangeContext *context, const Move *move)
+{
+    int counts[RACK_SIZE] = {0};
+    int index = context->keeps - 1;
+
+    if (move->type == MOVE_PASS) {
+        return context->value[index];
+    }
+    for (int i = 0; i < move->length; i++) {
+        if (!move->tiles[i]) {
+            continue;
+        }
+        int slot = rack_slot(context, tile_index(move->tiles[i]));
+        if (slot < 0 || ++counts[slot] > context->have[slot]) {
+            return -INFINITY;
+        }
+        index -= context->stride[slot];
+    }
+    return (move->type == MOVE_PLACE ? (float)move->score : 0.0f) + context->value[index];
+}
+
+/* Best exchange of at least one tile; false if the bag is too low to exchange */
+bool exchange_best(const ExchangeContext *context, Move *move, float *equity)
+{
+    int best = 0;
+
+    if (!context->can_exchange || context->keeps < 2) {
+        return false;
+    }
+    for (int k = 1; k < context->keeps - 1; k++) {
+        if (context->value[k] > context->value[best]) {
+            best = k;
+        }
+    }
+
+    memset(move, 0, sizeof(*move));
+    move->type = MOVE_EXCHANGE;
+    for (int i = 0; i < context->letters; i++) {
+        int returned = context->have[i] - best / context->stride[i] % (context->have[i] + 1);
+        for (int n = 0; n < returned; n++) {
+            move->tiles[move->length++] = index_tile(context->letter[i]);
+        }
+    }
+    if (equity) {
+        *equity = context->value[best];
+    }
+    return true;
+}
+
+/*
+ * Turn to take: the placement eval ranks best, unless an exchange is worth
+ * more once both are valued by the refilled rack, else a pass. context and
+ * eval must be prepared for rack. Returns false for the pass.
+ */
+bool exchange_decide(const ExchangeContext *context, const EvalContext *eval, const Dawg *dawg,
+                     const char *rack, Move *best, float *equity)
+{
+    Move exchange;
+    float exchange_value;
+    float value = context->value[context->keeps - 1];
+    bool found = eval_best_move(eval, dawg, rack, best, NULL) > 0;
+
+    if (found) {
+        value = exchange_equity(context, best);
+    }
+    if (exchange_best(context, &exchange, &exchange_value) && (!found || exchange_value > value)) {
+        *best = exchange;
+        value = exchange_value;
+        found = true;
+    }
+    if (!found) {
+        memset(best, 0, sizeof(*best));
+        best->type = MOVE_PASS;
+    }
+    if (equity) {
+        *equity = value;
+    }
+    return found;
+}
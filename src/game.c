@@ -9,9 +9,212 @@
 #include "game.h"
 #include "board.h"
 #include "dictionary.h"
+#include "exchange.h"
+#include "lexicon.h"
+#include "tiles.h"
+#include "stats.h"
 
-/* Game state */
-static GameState game_state;
+/* Game state; each thread plays its own game */
+static _Thread_local GameState game_state;
+
+/* What a committed move changed, enough to take it back */
+typedef struct {
+    Move move;
+    char rack[RACK_SIZE + 1];
+    int scores[2];
+    uint64_t hash;
+    uint64_t rng;                       /* Bag generator, to unshuffle an exchange */
+    uint8_t player;
+    uint8_t tiles_left;
+    uint8_t scoreless_turns;
+} UndoEntry;
+
+/* Ring of recent moves; each thread has its own */
+static _Thread_local UndoEntry undo_stack[GAME_UNDO_DEPTH];
+static _Thread_local int undo_top;
+static _Thread_local int undo_count;
+
+/* Game set up by game_init() for the X UI: one seat, player 0, keeps the turn and its display */
+static _Thread_local bool single_seat;
+
+/* Checkpoint file header */
+#define CHECKPOINT_MAGIC "XSCK"
+#define CHECKPOINT_VERSION 3
+
+/* Zobrist key for the side to move */
+#define SIDE_KEY 0x8c3f5e2a7b1d9604ULL
+
+/* splitmix64 step for the bag shuffle */
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/* Zobrist key for a letter on a square, mixed on the fly instead of a table */
+static uint64_t square_key(int square, char letter)
+{
+    uint64_t z = (((uint64_t)square << 8) | (unsigned char)letter) * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/* Remember the state a move is about to change */
+static void push_undo(const Move *move)
+{
+    UndoEntry *entry = &undo_stack[undo_top];
+    int player = game_state.to_move;
+    
+    entry->move = *move;
+    memcpy(entry->rack, game_state.racks[player], sizeof(entry->rack));
+    entry->scores[0] = game_state.scores[0];
+    entry->scores[1] = game_state.scores[1];
+    entry->hash = game_state.hash;
+    entry->rng = game_state.rng;
+    entry->player = (uint8_t)player;
+    entry->tiles_left = (uint8_t)game_state.tiles_left;
+    entry->scoreless_turns = (uint8_t)game_state.scoreless_turns;
+    
+    undo_top = (undo_top + 1) % GAME_UNDO_DEPTH;
+    if (undo_count < GAME_UNDO_DEPTH) {
+        undo_count++;
+    }
+}
+
+static UndoEntry *last_undo(void)
+{
+    return &undo_stack[(undo_top + GAME_UNDO_DEPTH - 1) % GAME_UNDO_DEPTH];
+}
+
+/* Forget the most recent entry, for moves that failed part-way */
+static void drop_undo(void)
+{
+    undo_top = (undo_top + GAME_UNDO_DEPTH - 1) % GAME_UNDO_DEPTH;
+    undo_count--;
+}
+
+static void clear_undo(void)
+{
+    undo_top = 0;
+    undo_count = 0;
+}
+
+/* Remove one letter from a rack */
+static bool rack_take(char *rack, char letter)
+{
+    char *tile = strchr(rack, letter);
+    if (!tile) {
+        return false;
+    }
+    memmove(tile, tile + 1, strlen(tile));
+    return true;
+}
+
+/* The rack tile a placed tile comes from */
+static char rack_tile(char tile)
+{
+    return tiles_is_blank(tile) ? TILE_BLANK : tile;
+}
+
+/* Sum of the point values left on a rack */
+static int rack_value(const char *rack)
+{
+    int value = 0;
+    for (const char *p = rack; *p; p++) {
+        value += tiles_letter_value(*p);
+    }
+    return value;
+}
+
+/* Refill a rack from the bag */
+static void draw_tiles(int player)
+{
+    char *rack = game_state.racks[player];
+    size_t length = strlen(rack);
+    int drawn = 0;
+    
+    while ((int)length < board_variant()->rack_size && game_state.tiles_left > 0) {
+        char tile = game_state.bag[--game_state.tiles_left];
+        rack[length++] = tile;
+        game_state.last_drawn[drawn++] = tile;
+    }
+    rack[length] = '\0';
+    game_state.last_drawn[drawn] = '\0';
+}
+
+/* Mirror the player to move into the display fields; the UI's seat keeps its name */
+static void sync_current_player(void)
+{
+    const char *rack = game_state.racks[game_state.to_move];
+    
+    memset(game_state.player_rack, 0, sizeof(game_state.player_rack));
+    if (single_seat) {
+        memcpy(game_state.player_rack, game_state.racks[0], strlen(game_state.racks[0]));
+        return;
+    }
+    memcpy(game_state.current_player, "Player 1", sizeof("Player 1"));
+    game_state.current_player[7] = (char)('1' + game_state.to_move);
+    memcpy(game_state.player_rack, rack, strlen(rack));
+}
+
+static void switch_turn(void)
+{
+    if (single_seat) {
+        sync_current_player();
+        return;
+    }
+    game_state.to_move ^= 1;
+    game_state.hash ^= SIDE_KEY;
+    sync_current_player();
+}
+
+/* Clear the engine state, keeping the lexicon handle */
+static void reset_state(void)
+{
+    Lexicon *lexicon = game_state.lexicon;
+    single_seat = false;
+    memset(&game_state, 0, sizeof(game_state));
+    game_state.lexicon = lexicon;
+    clear_undo();
+}
+
+/* Apply end-of-game rack adjustments; finisher is -1 when nobody went out */
+static void end_game(int finisher)
+{
+    int left[2] = {
+        rack_value(game_state.racks[0]),
+        rack_value(game_state.racks[1])
+    };
+    
+    if (finisher >= 0) {
+        game_state.scores[finisher] += left[finisher ^ 1];
+        game_state.scores[finisher ^ 1] -= left[finisher ^ 1];
+    } else {
+        game_state.scores[0] -= left[0];
+        game_state.scores[1] -= left[1];
+    }
+    game_state.over = true;
+}
+
+/*
+ * Count a pass or exchange; true when it ends the game. The UI's single
+ * seat never ends this way: its scores are the display's, not a game's.
+ */
+static bool scoreless_turn(void)
+{
+    if (single_seat) {
+        return false;
+    }
+    game_state.scoreless_turns++;
+    if (game_state.scoreless_turns >= MAX_SCORELESS_TURNS) {
+        end_game(-1);
+        return true;
+    }
+    return false;
+}
 
 /* Initialize game */
 bool game_init(void)
@@ -30,6 +233,7 @@ bool game_init(void)
     }
     
     /* Setup initial game state */
+    reset_state();
     strcpy(game_state.current_player, "jwalsh");
     game_state.scores[0] = 0;    /* jwalsh score */
     game_state.scores[1] = 20;   /* Player2 score */
@@ -45,10 +249,47 @@ bool game_init(void)
     game_state.player_rack[6] = 'L';
 
     /* Place initial word on the board (WEFT) */
-    board_place_tile(7, 3, 'W');
-    board_place_tile(7, 4, 'E');
-    board_place_tile(7, 5, 'F');
-    board_place_tile(7, 6, 'T');
+    const char *opening = "WEFT";
+    for (int i = 0; opening[i]; i++) {
+        board_place_tile(7, 3 + i, opening[i]);
+    }
+    board_commit_word();
+
+    /*
+     * Engine state behind the display, so passing and changing letters work:
+     * the seat's rack, and the rest of the tile set less the board shuffled
+     * into the bag and the other rack.
+     */
+    memcpy(game_state.racks[0], game_state.player_rack, sizeof(game_state.player_rack));
+    game_state.racks[0][sizeof(game_state.player_rack)] = '\0';
+    int counts[256] = {0};
+    for (int i = 0; i < tiles_kinds(); i++) {
+        counts[(unsigned char)tiles_get(i)->letter] += tiles_get(i)->count;
+    }
+    for (int i = 0; opening[i]; i++) {
+        counts[(unsigned char)opening[i]]--;
+        game_state.hash ^= square_key(7 * BOARD_MAX_SIZE + 3 + i, opening[i]);
+    }
+    for (int i = 0; i < (int)sizeof(game_state.player_rack); i++) {
+        counts[(unsigned char)game_state.player_rack[i]]--;
+    }
+    int count = 0;
+    for (int tile = 0; tile < 256; tile++) {
+        for (int j = 0; j < counts[tile] && count < BAG_CAPACITY; j++) {
+            game_state.bag[count++] = (char)tile;
+        }
+    }
+    game_state.seed = game_state.rng = (uint64_t)time(NULL);
+    for (int i = count - 1; i > 0; i--) {
+        int j = (int)(next_random(&game_state.rng) % (uint64_t)(i + 1));
+        char tile = game_state.bag[i];
+        game_state.bag[i] = game_state.bag[j];
+        game_state.bag[j] = tile;
+    }
+    game_state.tiles_left = count;
+    draw_tiles(1);
+    game_state.last_drawn[0] = '\0';
+    single_seat = true;
     
     return true;
 }
@@ -58,6 +299,21 @@ void game_cleanup(void)
 {
     board_cleanup();
     dictionary_cleanup();
+    lexicon_release(game_state.lexicon);
+    game_state.lexicon = NULL;
+}
+
+/* Switch this thread's games to the current version of a registered lexicon */
+bool game_use_lexicon(const char *name)
+{
+    Lexicon *lexicon = lexicon_acquire(name);
+    if (!lexicon) {
+        fprintf(stderr, "No lexicon named %s\n", name);
+        return false;
+    }
+    lexicon_release(game_state.lexicon);
+    game_state.lexicon = lexicon;
+    return true;
 }
 
 /* Get current game state */
@@ -83,28 +339,68 @@ bool game_remove_tile(int row, int col)
 /* Evaluate current move and calculate score */
 int game_evaluate_move(void)
 {
+    STATS_TIMER_BEGIN(timer);
     /* Implementation omitted for brevity */
+    STATS_TIMER_END(timer, STAT_MOVE_SCORING);
     return 0;
 }
 
+/* Best k placements for the side to move with this thread's lexicon, best first */
+int game_best_moves(Move *best, int k)
+{
+    if (!game_state.lexicon || !game_state.lexicon->dawg) {
+        return 0;
+    }
+    return movegen_top_k(game_state.lexicon->dawg, game_state.racks[game_state.to_move],
+                         best, k);
+}
+
 /* Finish current turn */
 bool game_finish_turn(void)
 {
+    STATS_TIMER_BEGIN(timer);
     /* Implementation omitted for brevity */
+    STATS_TIMER_END(timer, STAT_MOVE_VALIDATION);
     return true;
 }
 
 /* Pass current turn */
 void game_pass_turn(void)
 {
-    /* Implementation omitted for brevity */
+    if (game_state.over) {
+        return;
+    }
+    
+    Move pass = {0};
+    pass.type = MOVE_PASS;
+    push_undo(&pass);
+    game_state.moves_played++;
+    game_state.last_drawn[0] = '\0';
+    if (scoreless_turn()) {
+        return;
+    }
+    switch_turn();
 }
 
-/* Change letters in player's rack */
+/* Exchange the tiles the exchange evaluator would return for the player to move */
 bool game_change_letters(void)
 {
-    /* Implementation omitted for brevity */
-    return true;
+    const char *rack = game_state.racks[game_state.to_move];
+    char unseen[EXCHANGE_MAX_UNSEEN + 1];
+    EvalWeights weights;
+    EvalContext eval;
+    ExchangeContext exchange;
+    Move move;
+
+    if (game_state.over) {
+        return false;
+    }
+    eval_default_weights(&weights);
+    eval_prepare(&eval, &weights, rack, game_state.tiles_left);
+    exchange_unseen(&game_state, game_state.to_move, unseen);
+    exchange_prepare(&exchange, &eval, rack, unseen, game_state.tiles_left, EXCHANGE_SAMPLES,
+                     game_state.rng);
+    return exchange_best(&exchange, &move, NULL) && game_play_move(&move);
 }
 
 /* Revert current move */
@@ -119,3 +415,540 @@ bool game_shuffle_rack(void)
     /* Implementation omitted for brevity */
     return true;
 }
+
+/* Start a headless game with a shuffled bag on the calling thread */
+bool game_new(uint64_t seed)
+{
+    if (!board_init()) {
+        return false;
+    }
+    
+    reset_state();
+    game_state.seed = seed;
+    game_state.rng = seed;
+    
+    /* Fill the bag */
+    int count = 0;
+    for (int i = 0; i < tiles_kinds(); i++) {
+        const TileInfo *info = tiles_get(i);
+        for (int j = 0; j < info->count && count < BAG_CAPACITY; j++) {
+            game_state.bag[count++] = info->letter;
+        }
+    }
+    
+    /* Fisher-Yates shuffle */
+    for (int i = count - 1; i > 0; i--) {
+        int j = (int)(next_random(&game_state.rng) % (uint64_t)(i + 1));
+        char tile = game_state.bag[i];
+        game_state.bag[i] = game_state.bag[j];
+        game_state.bag[j] = tile;
+    }
+    game_state.tiles_left = count;
+    
+    draw_tiles(0);
+    draw_tiles(1);
+    game_state.last_drawn[0] = '\0';
+    sync_current_player();
+    return true;
+}
+
+/* Score a placement against the current board */
+int game_score_move(const Move *move)
+{
+    if (move->type != MOVE_PLACE) {
+        return 0;
+    }
+    
+    const Variant *variant = board_variant();
+    int across = move->direction == MOVE_ACROSS;
+    int start = across ? move->col : move->row;
+    if (move->row >= variant->board_size || move->col >= variant->board_size ||
+        start + move->length > variant->board_size) {
+        return 0;
+    }
+    
+    /* Read the main word along its line of the layout and cross words across it */
+    STATS_TIMER_BEGIN(timer);
+    const BoardLayout *layout = board_layout();
+    int d = move->direction;
+    int line = (across ? move->row : move->col) + 1;
+    const char *letters = layout->letter[d][line];
+    int main_points = 0;
+    int multiplier = 1;
+    int cross_points = 0;
+    
+    for (int i = 0; i < move->length; i++) {
+        int pos = start + 1 + i;
+        
+        if (!move->tiles[i]) {
+            if (!(layout->flags[d][line][pos] & BOARD_SQUARE_BLANK)) {
+                main_points += tiles_letter_value(letters[pos]);
+            }
+            continue;
+        }
+        
+        int points = tiles_letter_value(move->tiles[i]) * layout->letter_mult[d][line][pos];
+        int word_multiplier = layout->word_mult[d][line][pos];
+        main_points += points;
+        multiplier *= word_multiplier;
+        
+        /* Perpendicular word through the new tile; the border stops both walks */
+        const char *cross = layout->letter[!d][pos];
+        const uint8_t *flags = layout->flags[!d][pos];
+        int sum = 0;
+        bool crossed = false;
+        for (int k = line - 1; cross[k]; k--) {
+            sum += flags[k] & BOARD_SQUARE_BLANK ? 0 : tiles_letter_value(cross[k]);
+            crossed = true;
+        }
+        for (int k = line + 1; cross[k]; k++) {
+            sum += flags[k] & BOARD_SQUARE_BLANK ? 0 : tiles_letter_value(cross[k]);
+            crossed = true;
+        }
+        if (crossed) {
+            cross_points += (sum + points) * word_multiplier;
+        }
+    }
+    
+    int score = main_points * multiplier + cross_points +
+                (move->tiles_played == variant->rack_size ? variant->bingo_bonus : 0);
+    STATS_TIMER_END(timer, STAT_MOVE_SCORING);
+    return score;
+}
+
+/*
+ * Return tiles to the bag for as many new ones; the bag must hold a full
+ * rack. The new tiles come off the end of the bag as usual, then the
+ * returned ones take their slots and are shuffled in with the game's
+ * generator, so game_unplay_move() can undo the same swaps.
+ */
+static bool play_exchange(const Move *move)
+{
+    int player = game_state.to_move;
+    int rack_size = board_variant()->rack_size;
+    char rack[RACK_SIZE + 1];
+
+    if (move->length == 0 || move->length > rack_size || game_state.tiles_left < rack_size) {
+        return false;
+    }
+    strcpy(rack, game_state.racks[player]);
+    for (int i = 0; i < move->length; i++) {
+        if (!rack_take(rack, rack_tile(move->tiles[i]))) {
+            return false;
+        }
+    }
+
+    push_undo(move);
+    last_undo()->move.score = 0;
+    strcpy(game_state.racks[player], rack);
+    draw_tiles(player);
+    int first = game_state.tiles_left;
+    for (int i = 0; i < move->length; i++) {
+        game_state.bag[first + i] = rack_tile(move->tiles[i]);
+    }
+    game_state.tiles_left += move->length;
+    for (int i = first; i < game_state.tiles_left; i++) {
+        int j = (int)(next_random(&game_state.rng) % (uint64_t)(i + 1));
+        char tile = game_state.bag[i];
+        game_state.bag[i] = game_state.bag[j];
+        game_state.bag[j] = tile;
+    }
+
+    game_state.moves_played++;
+    if (scoreless_turn()) {
+        return true;
+    }
+    switch_turn();
+    return true;
+}
+
+/* Put the bag back as it was before an exchange; the rack still holds the draws at its end */
+static void unplay_exchange(const UndoEntry *entry)
+{
+    const Move *move = &entry->move;
+    const char *rack = game_state.racks[entry->player];
+    int first = entry->tiles_left - move->length;
+    int swaps[RACK_SIZE];
+    uint64_t rng = entry->rng;
+
+    for (int i = 0; i < move->length; i++) {
+        swaps[i] = (int)(next_random(&rng) % (uint64_t)(first + i + 1));
+    }
+    for (int i = move->length - 1; i >= 0; i--) {
+        char tile = game_state.bag[first + i];
+        game_state.bag[first + i] = game_state.bag[swaps[i]];
+        game_state.bag[swaps[i]] = tile;
+    }
+
+    /* Draws came off the end of the bag, last slot first */
+    const char *drawn = rack + strlen(rack) - move->length;
+    for (int i = 0; i < move->length; i++) {
+        game_state.bag[entry->tiles_left - 1 - i] = drawn[i];
+    }
+    game_state.rng = entry->rng;
+}
+
+/* Play a move for the player to move: place or exchange, score, draw and pass the turn */
+bool game_play_move(const Move *move)
+{
+    if (game_state.over) {
+        return false;
+    }
+    if (move->type == MOVE_PASS) {
+        game_pass_turn();
+        return true;
+    }
+    if (move->type == MOVE_EXCHANGE) {
+        return play_exchange(move);
+    }
+    if (move->type != MOVE_PLACE || move->tiles_played == 0) {
+        return false;
+    }
+    
+    int player = game_state.to_move;
+    int dr = move->direction == MOVE_DOWN ? 1 : 0;
+    int dc = move->direction == MOVE_ACROSS ? 1 : 0;
+    char rack[RACK_SIZE + 1];
+    strcpy(rack, game_state.racks[player]);
+    
+    /* Validate squares and tiles before touching the board; the border ends smaller boards */
+    const BoardLayout *layout = board_layout();
+    if (move->row < 0 || move->col < 0 || move->row + dr * (move->length - 1) >= BOARD_MAX_SIZE ||
+        move->col + dc * (move->length - 1) >= BOARD_MAX_SIZE) {
+        return false;
+    }
+    for (int i = 0; i < move->length; i++) {
+        int row = move->row + dr * i + 1;
+        int col = move->col + dc * i + 1;
+        char letter = layout->letter[BOARD_ACROSS][row][col];
+        if ((layout->flags[BOARD_ACROSS][row][col] & BOARD_SQUARE_BORDER) ||
+            (move->tiles[i] ? letter != '\0' : letter == '\0')) {
+            return false;
+        }
+        if (move->tiles[i] && !rack_take(rack, rack_tile(move->tiles[i]))) {
+            return false;
+        }
+    }
+    
+    int score = game_score_move(move);
+    push_undo(move);
+    last_undo()->move.score = score;
+    for (int i = 0; i < move->length; i++) {
+        if (move->tiles[i]) {
+            int row = move->row + dr * i;
+            int col = move->col + dc * i;
+            board_place_tile(row, col, move->tiles[i]);
+            game_state.hash ^= square_key(row * BOARD_MAX_SIZE + col, move->tiles[i]);
+        }
+    }
+    board_commit_word();
+    
+    game_state.scores[player] += score;
+    strcpy(game_state.racks[player], rack);
+    draw_tiles(player);
+    game_state.moves_played++;
+    game_state.scoreless_turns = 0;
+    
+    if (game_state.racks[player][0] == '\0') {
+        end_game(player);
+        return true;
+    }
+    switch_turn();
+    return true;
+}
+
+/* Check whether the current game has finished */
+bool game_is_over(void)
+{
+    return game_state.over;
+}
+
+/* Index of the leading player, -1 for a tie */
+int game_winner(void)
+{
+    if (game_state.scores[0] == game_state.scores[1]) {
+        return -1;
+    }
+    return game_state.scores[0] > game_state.scores[1] ? 0 : 1;
+}
+
+/* Start replaying a recorded game from its opening racks */
+bool game_setup(const char *rack0, const char *rack1, int tiles_left)
+{
+    if (!board_init()) {
+        return false;
+    }
+    int rack_size = board_variant()->rack_size;
+    if ((int)strlen(rack0) > rack_size || (int)strlen(rack1) > rack_size) {
+        return false;
+    }
+    
+    reset_state();
+    strcpy(game_state.racks[0], rack0);
+    strcpy(game_state.racks[1], rack1);
+    game_state.tiles_left = tiles_left;
+    sync_current_player();
+    return true;
+}
+
+/*
+ * Apply a recorded move with its recorded score and draws. The move is
+ * trusted: only the board squares are checked, so replay stays cheap.
+ */
+bool game_apply_move(const Move *move, const char *drawn)
+{
+    int player = game_state.to_move;
+    char *rack = game_state.racks[player];
+    
+    if (game_state.over) {
+        return false;
+    }
+    
+    push_undo(move);
+    if (move->type == MOVE_PLACE) {
+        int dr = move->direction == MOVE_DOWN ? 1 : 0;
+        int dc = move->direction == MOVE_ACROSS ? 1 : 0;
+        for (int i = 0; i < move->length; i++) {
+            if (move->tiles[i]) {
+                int row = move->row + dr * i;
+                int col = move->col + dc * i;
+                if (!board_place_tile(row, col, move->tiles[i])) {
+                    board_revert_word();
+                    strcpy(rack, last_undo()->rack);
+                    game_state.hash = last_undo()->hash;
+                    drop_undo();
+                    return false;
+                }
+                game_state.hash ^= square_key(row * BOARD_MAX_SIZE + col, move->tiles[i]);
+                if (!rack_take(rack, rack_tile(move->tiles[i]))) {
+                    rack_take(rack, TILE_BLANK);
+                }
+            }
+        }
+        board_commit_word();
+    } else if (move->type == MOVE_EXCHANGE) {
+        for (int i = 0; i < move->length; i++) {
+            rack_take(rack, move->tiles[i]);
+        }
+    }
+    
+    size_t length = strlen(rack);
+    size_t count = strlen(drawn);
+    size_t rack_size = (size_t)board_variant()->rack_size;
+    if (length + count > rack_size) {
+        count = length < rack_size ? rack_size - length : 0;
+    }
+    memcpy(rack + length, drawn, count);
+    rack[length + count] = '\0';
+    memcpy(game_state.last_drawn, drawn, count);
+    game_state.last_drawn[count] = '\0';
+    if (move->type != MOVE_EXCHANGE) {
+        game_state.tiles_left -= (int)count;
+    }
+    
+    game_state.scores[player] += move->score;
+    game_state.moves_played++;
+    if (move->type == MOVE_PLACE || move->score != 0) {
+        game_state.scoreless_turns = 0;
+    } else {
+        game_state.scoreless_turns++;
+    }
+    switch_turn();
+    return true;
+}
+
+/* Copy the committed position; uncommitted tiles are left out. False if it holds more tiles than a bag */
+bool game_snapshot(GameSnapshot *snapshot)
+{
+    char letters[BOARD_SQUARES];
+    int count = game_state.tiles_left;
+    
+    memset(snapshot, 0, sizeof(*snapshot));     /* Padding and unused tiles too, so snapshots compare */
+    board_snapshot(letters);
+    memcpy(snapshot->tiles, game_state.bag, (size_t)count);
+    for (int square = 0; square < BOARD_SQUARES; square++) {
+        if (!letters[square]) {
+            continue;
+        }
+        if (count == BAG_CAPACITY) {
+            return false;
+        }
+        snapshot->occupied[square / 64] |= 1ULL << (square % 64);
+        snapshot->tiles[count++] = letters[square];
+    }
+    memcpy(snapshot->racks, game_state.racks, sizeof(snapshot->racks));
+    snapshot->scores[0] = game_state.scores[0];
+    snapshot->scores[1] = game_state.scores[1];
+    snapshot->rng = game_state.rng;
+    snapshot->seed = game_state.seed;
+    snapshot->hash = game_state.hash;
+    snapshot->moves_played = (uint16_t)game_state.moves_played;
+    snapshot->tiles_left = (uint8_t)game_state.tiles_left;
+    snapshot->to_move = (uint8_t)game_state.to_move;
+    snapshot->scoreless_turns = (uint8_t)game_state.scoreless_turns;
+    snapshot->over = game_state.over;
+    snapshot->variant = (uint8_t)board_variant()->id;
+    return true;
+}
+
+/* Tiles a snapshot holds in its bag and on its board */
+static int snapshot_tiles(const GameSnapshot *snapshot)
+{
+    int count = snapshot->tiles_left;
+    for (int i = 0; i < (BOARD_SQUARES + 63) / 64; i++) {
+        count += __builtin_popcountll(snapshot->occupied[i]);
+    }
+    return count;
+}
+
+/* Return to a snapshot of a game on the same variant; the undo history is cleared */
+void game_restore(const GameSnapshot *snapshot)
+{
+    char letters[BOARD_SQUARES] = {0};
+    int count = snapshot->tiles_left;
+    
+    for (int i = 0; i < (BOARD_SQUARES + 63) / 64; i++) {
+        for (uint64_t bits = snapshot->occupied[i]; bits; bits &= bits - 1) {
+            letters[i * 64 + __builtin_ctzll(bits)] = snapshot->tiles[count++];
+        }
+    }
+    board_restore(letters);
+    memcpy(game_state.racks, snapshot->racks, sizeof(game_state.racks));
+    memcpy(game_state.bag, snapshot->tiles, (size_t)snapshot->tiles_left);
+    game_state.scores[0] = snapshot->scores[0];
+    game_state.scores[1] = snapshot->scores[1];
+    game_state.rng = snapshot->rng;
+    game_state.seed = snapshot->seed;
+    game_state.hash = snapshot->hash;
+    game_state.moves_played = snapshot->moves_played;
+    game_state.tiles_left = snapshot->tiles_left;
+    game_state.to_move = snapshot->to_move;
+    game_state.scoreless_turns = snapshot->scoreless_turns;
+    game_state.over = snapshot->over;
+    game_state.last_drawn[0] = '\0';
+    clear_undo();
+    sync_current_player();
+}
+
+/* Take back the last committed move, touching only the squares it used */
+bool game_unplay_move(void)
+{
+    if (undo_count == 0) {
+        return false;
+    }
+    
+    drop_undo();
+    const UndoEntry *entry = &undo_stack[undo_top];
+    const Move *move = &entry->move;
+    
+    if (move->type == MOVE_PLACE) {
+        int dr = move->direction == MOVE_DOWN ? 1 : 0;
+        int dc = move->direction == MOVE_ACROSS ? 1 : 0;
+        for (int i = 0; i < move->length; i++) {
+            if (move->tiles[i]) {
+                board_lift_tile(move->row + dr * i, move->col + dc * i);
+            }
+        }
+    } else if (move->type == MOVE_EXCHANGE && entry->rng != game_state.rng) {
+        /* Replayed exchanges never touched the bag or its generator */
+        unplay_exchange(entry);
+    }
+    
+    game_state.to_move = entry->player;
+    memcpy(game_state.racks[entry->player], entry->rack, sizeof(entry->rack));
+    game_state.scores[0] = entry->scores[0];
+    game_state.scores[1] = entry->scores[1];
+    game_state.hash = entry->hash;
+    game_state.tiles_left = entry->tiles_left;
+    game_state.scoreless_turns = entry->scoreless_turns;
+    game_state.moves_played--;
+    game_state.over = false;
+    game_state.last_drawn[0] = '\0';
+    sync_current_player();
+    return true;
+}
+
+/* Number of moves game_unplay_move() can take back */
+int game_undo_depth(void)
+{
+    return undo_count;
+}
+
+uint64_t game_hash(void)
+{
+    return game_state.hash;
+}
+
+/*
+ * Hash of the board, side to move and both racks, for search tables. Each
+ * copy of a letter on a rack is keyed like a square past the board, so
+ * the order of the tiles does not matter.
+ */
+uint64_t game_position_hash(void)
+{
+    uint64_t hash = game_state.hash;
+    for (int player = 0; player < 2; player++) {
+        int copies[256] = {0};
+        for (const char *p = game_state.racks[player]; *p; p++) {
+            int copy = copies[(unsigned char)*p]++;
+            hash ^= square_key(BOARD_SQUARES + player * RACK_SIZE + copy, *p);
+        }
+    }
+    return hash;
+}
+
+/* Write a snapshot of the current game, replacing the file atomically */
+bool game_save_checkpoint(const char *filename)
+{
+    GameSnapshot snapshot;
+    char temporary[1024];
+    uint32_t version = CHECKPOINT_VERSION;
+    
+    if (snprintf(temporary, sizeof(temporary), "%s.tmp", filename) >= (int)sizeof(temporary)) {
+        return false;
+    }
+    FILE *file = fopen(temporary, "wb");
+    if (!file) {
+        return false;
+    }
+    
+    bool ok = game_snapshot(&snapshot) &&
+              fwrite(CHECKPOINT_MAGIC, 1, 4, file) == 4 &&
+              fwrite(&version, sizeof(version), 1, file) == 1 &&
+              fwrite(&snapshot, sizeof(snapshot), 1, file) == 1;
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(temporary, filename) != 0) {
+        remove(temporary);
+        return false;
+    }
+    return true;
+}
+
+/* Restore a game written by game_save_checkpoint() */
+bool game_load_checkpoint(const char *filename)
+{
+    GameSnapshot snapshot;
+    char magic[4];
+    uint32_t version;
+    
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        return false;
+    }
+    bool ok = fread(magic, 1, 4, file) == 4 && memcmp(magic, CHECKPOINT_MAGIC, 4) == 0 &&
+              fread(&version, sizeof(version), 1, file) == 1 && version == CHECKPOINT_VERSION &&
+              fread(&snapshot, sizeof(snapshot), 1, file) == 1 &&
+              snapshot_tiles(&snapshot) <= BAG_CAPACITY;
+    fclose(file);
+    if (ok && snapshot.variant != board_variant()->id) {
+        const Variant *variant = variant_get((VariantId)snapshot.variant);
+        fprintf(stderr, "Checkpoint %s is for the %s variant\n", filename,
+                variant ? variant->name : "unknown");
+        ok = false;
+    }
+    
+    if (ok) {
+        game_restore(&snapshot);
+    }
+    return ok;
+}
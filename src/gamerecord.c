@@ -0,0 +1,222 @@
+/**
+ * XScrabble - Game Record Tool
+ *
+ * Inspects, replays and converts game record files written by selfplay.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "board.h"
+#include "game.h"
+#include "gcg.h"
+#include "record.h"
+#include "tiles.h"
+
+/* Find the record for game index in a file of concatenated records */
+static bool find_game(const uint8_t *data, size_t size, int index, size_t *offset)
+{
+    RecordReader reader;
+    RecordMove entry;
+    size_t pos = 0;
+
+    for (int game = 0; pos < size; game++) {
+        if (game == index) {
+            *offset = pos;
+            return true;
+        }
+        if (!record_reader_open(&reader, data + pos, size - pos)) {
+            return false;
+        }
+        while (record_reader_next(&reader, &entry)) {
+        }
+        if (!reader.finished) {
+            return false;
+        }
+        pos += reader.pos;
+    }
+    return false;
+}
+
+/* Open a record and switch to its variant; the tool replays one game at a time */
+static bool open_record(RecordReader *reader, const uint8_t *data, size_t size)
+{
+    return record_reader_open(reader, data, size) &&
+           (reader->variant == variant_current() || variant_select(reader->variant->name));
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* One line per game */
+static int command_info(const uint8_t *data, size_t size)
+{
+    RecordReader reader;
+    RecordMove entry;
+    size_t pos = 0;
+
+    for (int game = 0; pos < size; game++) {
+        int moves = 0;
+        if (!record_reader_open(&reader, data + pos, size - pos)) {
+            fprintf(stderr, "Corrupt record at offset %zu\n", pos);
+            return EXIT_FAILURE;
+        }
+        while (record_reader_next(&reader, &entry)) {
+            moves++;
+        }
+        if (!reader.finished) {
+            fprintf(stderr, "Truncated record at offset %zu\n", pos);
+            return EXIT_FAILURE;
+        }
+        printf("%6d  seed %-20llu %-8s %-8s %3d moves  %4d - %4d  %zu bytes\n",
+               game, (unsigned long long)reader.seed, reader.lexicon, reader.variant->name, moves,
+               reader.final_scores[0], reader.final_scores[1], reader.pos);
+        pos += reader.pos;
+    }
+    return EXIT_SUCCESS;
+}
+
+static void print_position(void)
+{
+    GameState *state = game_get_state();
+
+    int size = board_size();
+
+    printf("   ");
+    for (int col = 0; col < size; col++) {
+        printf(" %c", 'A' + col);
+    }
+    printf("\n");
+    for (int row = 0; row < size; row++) {
+        printf("%2d ", row + 1);
+        for (int col = 0; col < size; col++) {
+            char letter = board_get_cell(row, col)->letter;
+            printf(" %c", letter ? letter : '.');
+        }
+        printf("\n");
+    }
+    printf("Player 1: %4d  %s\n", state->scores[0], state->racks[0]);
+    printf("Player 2: %4d  %s\n", state->scores[1], state->racks[1]);
+    printf("Moves played: %d, tiles in bag: %d, %s\n", state->moves_played,
+           state->tiles_left, state->over ? "game over" : state->current_player);
+}
+
+/* Replay every game, timing the move application */
+static int command_replay_all(const uint8_t *data, size_t size)
+{
+    RecordReader reader;
+    size_t pos = 0;
+    long moves = 0;
+    int games = 0;
+    double start = now_seconds();
+
+    while (pos < size) {
+        int applied = -1;
+        if (open_record(&reader, data + pos, size - pos)) {
+            applied = record_replay(&reader, -1);
+        }
+        if (applied < 0) {
+            fprintf(stderr, "Corrupt record at offset %zu\n", pos);
+            return EXIT_FAILURE;
+        }
+        pos += reader.pos;
+        moves += applied;
+        games++;
+    }
+
+    double elapsed = now_seconds() - start;
+    printf("Replayed %d games, %ld moves in %.3f s (%.0f moves/sec)\n",
+           games, moves, elapsed, elapsed > 0 ? moves / elapsed : 0.0);
+    return EXIT_SUCCESS;
+}
+
+static void print_usage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: %s info FILE\n"
+            "       %s replay FILE [GAME [PLY]]\n"
+            "       %s gcg FILE [GAME]\n"
+            "       %s import GCG OUT [VARIANT]\n",
+            program, program, program, program);
+}
+
+int main(int argc, char *argv[])
+{
+    uint8_t *data = NULL;
+    size_t size = 0;
+    size_t offset = 0;
+    int status = EXIT_FAILURE;
+
+    if (argc < 3) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    tiles_reset();
+
+    if (strcmp(argv[1], "import") == 0) {
+        GameRecord record;
+        FILE *in = fopen(argv[2], "r");
+        FILE *out = argc > 3 ? fopen(argv[3], "wb") : NULL;
+
+        record_init(&record);
+        if (argc > 4 && !variant_select(argv[4])) {
+            status = EXIT_FAILURE;
+        } else if (!in || !out) {
+            fprintf(stderr, "Cannot open %s\n", !in ? argv[2] : argc > 3 ? argv[3] : "output");
+        } else if (!gcg_import(in, &record)) {
+            fprintf(stderr, "Failed to import %s\n", argv[2]);
+        } else if (record_write(out, &record)) {
+            status = EXIT_SUCCESS;
+        }
+        if (in) {
+            fclose(in);
+        }
+        if (out) {
+            fclose(out);
+        }
+        record_free(&record);
+        return status;
+    }
+
+    if (!record_read_file(argv[2], &data, &size)) {
+        fprintf(stderr, "Cannot read %s\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+
+    int game = argc > 3 ? atoi(argv[3]) : 0;
+    if (strcmp(argv[1], "info") == 0) {
+        status = command_info(data, size);
+    }
+    else if (strcmp(argv[1], "replay") == 0 && argc == 3) {
+        status = command_replay_all(data, size);
+    }
+    else if (strcmp(argv[1], "replay") == 0 || strcmp(argv[1], "gcg") == 0) {
+        if (!find_game(data, size, game, &offset)) {
+            fprintf(stderr, "No game %d in %s\n", game, argv[2]);
+        }
+        else if (argv[1][0] == 'g') {
+            status = gcg_export(stdout, data + offset, size - offset) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        else {
+            RecordReader reader;
+            int ply = argc > 4 ? atoi(argv[4]) : -1;
+            if (open_record(&reader, data + offset, size - offset) &&
+                record_replay(&reader, ply) >= 0) {
+                print_position();
+                status = EXIT_SUCCESS;
+            }
+        }
+    }
+    else {
+        print_usage(argv[0]);
+    }
+
+    free(data);
+    return status;
+}
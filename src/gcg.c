@@ -0,0 +1,453 @@
+/**
+ * XScrabble - GCG Import/Export Implementation
+ *
+ * GCG is the plain-text game format used by most Scrabble tools. Racks
+ * write blanks as '?', words mark played-through squares with '.' and
+ * blank-designated letters in lowercase. Importing rebuilds the draws
+ * from consecutive racks, so a GCG game replays like a native record.
+ * Games on other variants than standard carry a "#variant" pragma, and
+ * are imported only under that variant.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "gcg.h"
+#include "board.h"
+#include "tiles.h"
+
+#define GCG_BLANK '?'
+
+/* One imported move with the rack it was played from */
+typedef struct {
+    int player;
+    Move move;
+    char rack[RACK_SIZE + 1];
+} ImportedMove;
+
+/* Import state */
+typedef struct {
+    char names[2][64];
+    int player_count;
+    char lexicon[RECORD_LEXICON_MAX];
+    uint64_t seed;
+    ImportedMove *moves;
+    int count;
+    int capacity;
+    int totals[2];
+    char end_racks[2][RACK_SIZE + 1];
+    bool has_end_rack[2];
+} Importer;
+
+/* Copy a rack, translating blanks between the record and GCG spellings */
+static void convert_rack(char *out, const char *in, char from, char to)
+{
+    size_t i = 0;
+    for (; in[i] && i < RACK_SIZE; i++) {
+        out[i] = in[i] == from ? to : (char)toupper((unsigned char)in[i]);
+    }
+    out[i] = '\0';
+}
+
+/* Remove one tile from a rack; a lowercase letter uses up a blank */
+static void rack_remove(char *rack, char tile)
+{
+    char *found = strchr(rack, tiles_is_blank(tile) ? TILE_BLANK : tile);
+    if (found) {
+        memmove(found, found + 1, strlen(found));
+    }
+}
+
+static void format_position(const Move *move, char *out, size_t size)
+{
+    if (move->direction == MOVE_ACROSS) {
+        snprintf(out, size, "%d%c", move->row + 1, 'A' + move->col);
+    } else {
+        snprintf(out, size, "%c%d", 'A' + move->col, move->row + 1);
+    }
+}
+
+/* Write the record at data as a GCG game */
+bool gcg_export(FILE *out, const uint8_t *data, size_t size)
+{
+    RecordReader reader;
+    RecordMove entry;
+    char racks[2][RACK_SIZE + 1];
+    int totals[2] = {0, 0};
+
+    if (!record_reader_open(&reader, data, size)) {
+        return false;
+    }
+    memcpy(racks, reader.racks, sizeof(racks));
+
+    fprintf(out, "#character-encoding UTF-8\n");
+    fprintf(out, "#player1 p1 Player 1\n");
+    fprintf(out, "#player2 p2 Player 2\n");
+    if (reader.lexicon[0]) {
+        fprintf(out, "#lexicon %s\n", reader.lexicon);
+    }
+    fprintf(out, "#id xscrabble %llu\n", (unsigned long long)reader.seed);
+    if (reader.variant->id != VARIANT_STANDARD) {
+        fprintf(out, "#variant %s\n", reader.variant->name);
+    }
+
+    while (record_reader_next(&reader, &entry)) {
+        const Move *move = &entry.move;
+        int player = entry.player;
+        char *rack = racks[player];
+        char shown[RACK_SIZE + 1];
+        char play[2 * BOARD_MAX_SIZE];
+
+        convert_rack(shown, rack, TILE_BLANK, GCG_BLANK);
+        if (move->type == MOVE_PLACE) {
+            char position[8];
+            char word[BOARD_MAX_SIZE + 1];
+            format_position(move, position, sizeof(position));
+            for (int i = 0; i < move->length; i++) {
+                word[i] = move->tiles[i] ? move->tiles[i] : '.';
+            }
+            word[move->length] = '\0';
+            snprintf(play, sizeof(play), "%s %s", position, word);
+        } else if (move->type == MOVE_EXCHANGE) {
+            char returned[RACK_SIZE + 1];
+            convert_rack(returned, move->tiles, TILE_BLANK, GCG_BLANK);
+            returned[move->length < RACK_SIZE ? move->length : RACK_SIZE] = '\0';
+            snprintf(play, sizeof(play), "-%s", returned);
+        } else {
+            snprintf(play, sizeof(play), "-");
+        }
+
+        totals[player] += move->score;
+        fprintf(out, ">p%d: %s %s %+d %d\n", player + 1, shown, play, move->score, totals[player]);
+
+        /* Update the rack for the next line */
+        if (move->type != MOVE_PASS) {
+            for (int i = 0; i < move->length; i++) {
+                if (move->tiles[i]) {
+                    rack_remove(rack, move->tiles[i]);
+                }
+            }
+            size_t length = strlen(rack);
+            for (const char *p = entry.drawn; *p && length < RACK_SIZE; p++) {
+                rack[length++] = *p;
+            }
+            rack[length] = '\0';
+        }
+    }
+    if (!reader.finished) {
+        return false;
+    }
+
+    /* End-of-game rack adjustments */
+    for (int player = 0; player < 2; player++) {
+        int adjustment = reader.final_scores[player] - totals[player];
+        char own[RACK_SIZE + 1];
+        char other[RACK_SIZE + 1];
+        convert_rack(own, racks[player], TILE_BLANK, GCG_BLANK);
+        convert_rack(other, racks[player ^ 1], TILE_BLANK, GCG_BLANK);
+        if (adjustment > 0) {
+            fprintf(out, ">p%d: (%s) %+d %d\n", player + 1, other, adjustment,
+                    reader.final_scores[player]);
+        } else if (adjustment < 0) {
+            fprintf(out, ">p%d: %s (%s) %+d %d\n", player + 1, own, own, adjustment,
+                    reader.final_scores[player]);
+        }
+    }
+    return true;
+}
+
+/* Map a GCG nickname to player 0 or 1 */
+static int find_player(Importer *importer, const char *name)
+{
+    for (int i = 0; i < importer->player_count; i++) {
+        if (strcmp(importer->names[i], name) == 0) {
+            return i;
+        }
+    }
+    if (importer->player_count == 2) {
+        return -1;
+    }
+    snprintf(importer->names[importer->player_count], sizeof(importer->names[0]), "%s", name);
+    return importer->player_count++;
+}
+
+/* Parse "8H" (across) or "H8" (down) */
+static bool parse_position(const char *text, Move *move)
+{
+    int row, col;
+    char letter;
+
+    if (isdigit((unsigned char)text[0])) {
+        if (sscanf(text, "%d%c", &row, &letter) != 2) {
+            return false;
+        }
+        move->direction = MOVE_ACROSS;
+    } else {
+        if (sscanf(text, "%c%d", &letter, &row) != 2) {
+            return false;
+        }
+        move->direction = MOVE_DOWN;
+    }
+    col = toupper((unsigned char)letter) - 'A';
+    row -= 1;
+    if (row < 0 || row >= board_size() || col < 0 || col >= board_size()) {
+        return false;
+    }
+    move->row = (uint8_t)row;
+    move->col = (uint8_t)col;
+    return true;
+}
+
+/* Parse a played word; '.' and parenthesised letters are already on the board */
+static bool parse_word(const char *text, Move *move)
+{
+    bool through = false;
+    int length = 0;
+
+    for (const char *p = text; *p; p++) {
+        if (*p == '(' || *p == ')') {
+            through = *p == '(';
+            continue;
+        }
+        if (length == board_size() || (*p != '.' && !isalpha((unsigned char)*p))) {
+            return false;
+        }
+        if (*p == '.' || through) {
+            move->tiles[length++] = 0;
+        } else {
+            move->tiles[length++] = *p;
+            move->tiles_played++;
+        }
+    }
+    move->length = (uint8_t)length;
+    return length > 0 && move->tiles_played > 0;
+}
+
+static ImportedMove *add_move(Importer *importer)
+{
+    if (importer->count == importer->capacity) {
+        int capacity = importer->capacity ? importer->capacity * 2 : 64;
+        ImportedMove *grown = (ImportedMove *)realloc(importer->moves,
+                                                      capacity * sizeof(ImportedMove));
+        if (!grown) {
+            return NULL;
+        }
+        importer->moves = grown;
+        importer->capacity = capacity;
+    }
+    ImportedMove *entry = &importer->moves[importer->count++];
+    memset(entry, 0, sizeof(*entry));
+    return entry;
+}
+
+/* Parse one ">nick: ..." line */
+static bool parse_event(Importer *importer, char *line, int number)
+{
+    char *colon = strchr(line, ':');
+    char *tokens[6];
+    int count = 0;
+
+    if (!colon) {
+        return false;
+    }
+    *colon = '\0';
+    int player = find_player(importer, line + 1);
+    if (player < 0) {
+        fprintf(stderr, "GCG line %d: more than two players\n", number);
+        return false;
+    }
+
+    for (char *token = strtok(colon + 1, " \t\r\n"); token && count < 6;
+         token = strtok(NULL, " \t\r\n")) {
+        tokens[count++] = token;
+    }
+    if (count < 2) {
+        return false;
+    }
+    importer->totals[player] = atoi(tokens[count - 1]);
+
+    /* End-of-game rack bonus: "(RACK) +N TOTAL" */
+    if (tokens[0][0] == '(') {
+        int other = player ^ 1;
+        char rack[RACK_SIZE + 1];
+        snprintf(rack, sizeof(rack), "%.*s", (int)strcspn(tokens[0] + 1, ")"), tokens[0] + 1);
+        convert_rack(importer->end_racks[other], rack, GCG_BLANK, TILE_BLANK);
+        importer->has_end_rack[other] = true;
+        return true;
+    }
+    if (count < 4) {
+        return false;
+    }
+
+    /* Rack penalties, time penalties and challenge bonuses */
+    if (tokens[1][0] == '(') {
+        if (strcmp(tokens[1], "(challenge)") == 0) {
+            for (int i = importer->count - 1; i >= 0; i--) {
+                if (importer->moves[i].player == player) {
+                    importer->moves[i].move.score += atoi(tokens[2]);
+                    break;
+                }
+            }
+        } else if (strcmp(tokens[1], "(time)") != 0) {
+            convert_rack(importer->end_racks[player], tokens[0], GCG_BLANK, TILE_BLANK);
+            importer->has_end_rack[player] = true;
+        }
+        return true;
+    }
+    if (strcmp(tokens[1], "--") == 0) {
+        fprintf(stderr, "GCG line %d: withdrawn phonies are not supported\n", number);
+        return false;
+    }
+
+    ImportedMove *entry = add_move(importer);
+    if (!entry) {
+        return false;
+    }
+    entry->player = player;
+    convert_rack(entry->rack, tokens[0], GCG_BLANK, TILE_BLANK);
+    Move *move = &entry->move;
+
+    if (tokens[1][0] == '-') {
+        const char *returned = tokens[1] + 1;
+        move->type = *returned ? MOVE_EXCHANGE : MOVE_PASS;
+        if (isdigit((unsigned char)*returned)) {
+            returned = "";      /* Hidden exchange: only the count is known */
+        }
+        convert_rack(move->tiles, returned, GCG_BLANK, TILE_BLANK);
+        move->length = (uint8_t)strlen(move->tiles);
+        move->score = atoi(tokens[2]);
+        return true;
+    }
+
+    move->type = MOVE_PLACE;
+    if (count < 5 || !parse_position(tokens[1], move) || !parse_word(tokens[2], move)) {
+        fprintf(stderr, "GCG line %d: cannot parse move\n", number);
+        return false;
+    }
+    move->score = atoi(tokens[3]);
+    return true;
+}
+
+/* Tiles in next that are not in kept */
+static void rack_difference(char *drawn, const char *next, const char *kept)
+{
+    char remaining[RACK_SIZE + 1];
+    int count = 0;
+
+    snprintf(remaining, sizeof(remaining), "%s", kept);
+    for (const char *p = next; *p; p++) {
+        char *found = strchr(remaining, *p);
+        if (found) {
+            memmove(found, found + 1, strlen(found));
+        } else {
+            drawn[count++] = *p;
+        }
+    }
+    drawn[count] = '\0';
+}
+
+/* Rack a player holds after entry, before drawing */
+static void rack_after(const ImportedMove *entry, char *rack)
+{
+    strcpy(rack, entry->rack);
+    if (entry->move.type == MOVE_PASS) {
+        return;
+    }
+    for (int i = 0; i < entry->move.length; i++) {
+        if (entry->move.tiles[i]) {
+            rack_remove(rack, entry->move.tiles[i]);
+        }
+    }
+}
+
+/* Encode the parsed game as a record */
+static bool encode(Importer *importer, GameRecord *record)
+{
+    GameState start;
+    char drawn[RACK_SIZE + 1];
+    char kept[RACK_SIZE + 1];
+
+    memset(&start, 0, sizeof(start));
+    start.seed = importer->seed;
+    for (int player = 0; player < 2; player++) {
+        for (int i = 0; i < importer->count; i++) {
+            if (importer->moves[i].player == player) {
+                strcpy(start.racks[player], importer->moves[i].rack);
+                break;
+            }
+        }
+    }
+    start.tiles_left = tiles_total() - (int)strlen(start.racks[0]) - (int)strlen(start.racks[1]);
+    if (start.tiles_left < 0) {
+        start.tiles_left = 0;
+    }
+
+    if (!record_begin(record, importer->lexicon, &start)) {
+        return false;
+    }
+
+    for (int i = 0; i < importer->count; i++) {
+        const ImportedMove *entry = &importer->moves[i];
+        const char *next = NULL;
+
+        for (int j = i + 1; j < importer->count && !next; j++) {
+            if (importer->moves[j].player == entry->player) {
+                next = importer->moves[j].rack;
+            }
+        }
+        if (!next && importer->has_end_rack[entry->player]) {
+            next = importer->end_racks[entry->player];
+        }
+
+        rack_after(entry, kept);
+        if (next) {
+            rack_difference(drawn, next, kept);
+        } else {
+            drawn[0] = '\0';
+        }
+        if (!record_add_move(record, entry->player, &entry->move, drawn)) {
+            return false;
+        }
+    }
+    return record_finish(record, importer->totals);
+}
+
+/* Read a GCG game into a record */
+bool gcg_import(FILE *in, GameRecord *record)
+{
+    Importer importer;
+    char line[GCG_LINE_MAX];
+    int number = 0;
+    bool ok = true;
+
+    memset(&importer, 0, sizeof(importer));
+
+    while (ok && fgets(line, sizeof(line), in)) {
+        number++;
+        if (line[0] == '#') {
+            char name[64];
+            unsigned long long seed;
+            if (strncmp(line, "#player1 ", 9) == 0 || strncmp(line, "#player2 ", 9) == 0) {
+                int player = line[7] - '1';
+                if (sscanf(line + 9, "%63s", name) == 1 && importer.player_count == player) {
+                    find_player(&importer, name);
+                }
+            } else if (sscanf(line, "#lexicon %31s", importer.lexicon) == 1) {
+                continue;
+            } else if (sscanf(line, "#id xscrabble %llu", &seed) == 1) {
+                importer.seed = seed;
+            } else if (sscanf(line, "#variant %63s", name) == 1 &&
+                       strcmp(name, board_variant()->name) != 0) {
+                fprintf(stderr, "GCG line %d: game is for the %s variant\n", number, name);
+                ok = false;
+            }
+        } else if (line[0] == '>') {
+            ok = parse_event(&importer, line, number);
+        }
+    }
+
+    ok = ok && importer.count > 0 && encode(&importer, record);
+    free(importer.moves);
+    return ok;
+}
@@ -0,0 +1,462 @@
+/**
+ * XScrabble - Opponent Rack Inference Implementation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include "infer.h"
+#include "tiles.h"
+
+/* Scoring work shared by the workers of one update */
+typedef struct {
+    const GameSnapshot *before;
+    const Dawg *dawg;
+    const char *const *racks;
+    int *scores;
+    int count;
+    int next;                   /* Next chunk to take */
+    int scored;
+    double deadline;
+} ScoreJob;
+
+/* splitmix64 step, as for the bag shuffle */
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static int random_below(uint64_t *state, int n)
+{
+    return (int)(next_random(state) % (uint64_t)n);
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Counting index of a rack tile, or -1 */
+static int tile_index(char tile)
+{
+    if (tile == TILE_BLANK || tiles_is_blank(tile)) {
+        return ALPHABET_MAX_LETTERS;
+    }
+    int index = (unsigned char)tile - ALPHABET_FIRST;
+    return index >= 0 && index < ALPHABET_MAX_LETTERS ? index : -1;
+}
+
+static char index_tile(int index)
+{
+    return index == ALPHABET_MAX_LETTERS ? TILE_BLANK : (char)(ALPHABET_FIRST + index);
+}
+
+static void count_tiles(const char *tiles, int *counts)
+{
+    memset(counts, 0, INFER_LETTERS * sizeof(int));
+    for (const char *p = tiles; *p; p++) {
+        int index = tile_index(*p);
+        if (index >= 0) {
+            counts[index]++;
+        }
+    }
+}
+
+/* Remove one random tile from a rack */
+static void drop_random(char *rack, uint64_t *rng)
+{
+    int length = (int)strlen(rack);
+    if (length > 0) {
+        char *tile = rack + random_below(rng, length);
+        memmove(tile, tile + 1, strlen(tile));
+    }
+}
+
+/* Keep only tiles the unseen pool can still supply, at most rack_size of them */
+static void fit_rack(const InferState *state, char *rack, uint64_t *rng)
+{
+    int kept[INFER_LETTERS] = {0};
+    int length = 0;
+
+    for (const char *p = rack; *p; p++) {
+        int index = tile_index(*p);
+        if (index >= 0 && kept[index] < state->unseen[index]) {
+            kept[index]++;
+            rack[length++] = *p;
+        }
+    }
+    rack[length] = '\0';
+    while (length-- > state->rack_size) {
+        drop_random(rack, rng);
+    }
+}
+
+/* Top a rack up to rack_size from the unseen tiles it does not already hold */
+static void fill_rack(const InferState *state, char *rack, uint64_t *rng)
+{
+    int pool[INFER_LETTERS];
+    int held[INFER_LETTERS];
+    int total = 0;
+    int length = (int)strlen(rack);
+
+    count_tiles(rack, held);
+    for (int i = 0; i < INFER_LETTERS; i++) {
+        pool[i] = state->unseen[i] > held[i] ? state->unseen[i] - held[i] : 0;
+        total += pool[i];
+    }
+    while (length < state->rack_size && total > 0) {
+        int pick = random_below(rng, total);
+        int index = 0;
+        while (pick >= pool[index]) {
+            pick -= pool[index++];
+        }
+        rack[length++] = index_tile(index);
+        pool[index]--;
+        total--;
+    }
+    rack[length] = '\0';
+}
+
+/* Recompute the running weight totals the sampler searches */
+static void rebuild_cumulative(InferState *state)
+{
+    double total = 0.0;
+    for (int i = 0; i < state->count; i++) {
+        total += state->weights[i];
+        state->cumulative[i] = total;
+    }
+}
+
+/* Systematic resampling: racks are copied in proportion to their weight */
+static bool resample(InferState *state)
+{
+    char (*racks)[RACK_SIZE + 1] = malloc(state->count * sizeof(*racks));
+    if (!racks) {
+        return false;
+    }
+
+    rebuild_cumulative(state);
+    double total = state->cumulative[state->count - 1];
+    double step = total / state->count;
+    double point = step * (next_random(&state->rng) >> 11) * 0x1.0p-53;
+    int source = 0;
+    for (int i = 0; i < state->count; i++, point += step) {
+        while (source < state->count - 1 && state->cumulative[source] <= point) {
+            source++;
+        }
+        memcpy(racks[i], state->racks[source], RACK_SIZE + 1);
+    }
+
+    memcpy(state->racks, racks, state->count * sizeof(*racks));
+    free(racks);
+    for (int i = 0; i < state->count; i++) {
+        state->weights[i] = 1.0f;
+    }
+    return true;
+}
+
+/* Allocate count racks; budget is in seconds per update */
+bool infer_init(InferState *state, int count, int threads, double budget, uint64_t seed)
+{
+    memset(state, 0, sizeof(*state));
+    if (count <= 0) {
+        fprintf(stderr, "Rack inference needs at least one rack\n");
+        return false;
+    }
+
+    state->racks = calloc(count, sizeof(*state->racks));
+    state->weights = (float *)calloc(count, sizeof(float));
+    state->cumulative = (double *)calloc(count, sizeof(double));
+    if (!state->racks || !state->weights || !state->cumulative) {
+        fprintf(stderr, "Failed to allocate %d inferred racks\n", count);
+        infer_free(state);
+        return false;
+    }
+
+    state->count = count;
+    state->threads = threads < 1 ? 1 : threads > INFER_MAX_THREADS ? INFER_MAX_THREADS : threads;
+    state->budget = budget;
+    state->temperature = 8.0f;
+    state->margin = 0.0f;
+    state->rng = seed;
+    for (int i = 0; i < count; i++) {
+        state->weights[i] = 1.0f;
+    }
+    rebuild_cumulative(state);
+    return true;
+}
+
+void infer_free(InferState *state)
+{
+    free(state->racks);
+    free(state->weights);
+    free(state->cumulative);
+    memset(state, 0, sizeof(*state));
+}
+
+/*
+ * Tiles player cannot see on the current board: the full set less the
+ * board and the player's own rack. Returns the number written, or -1 if
+ * buffer is too small.
+ */
+int infer_unseen(int player, char *buffer, int size)
+{
+    const GameState *game = game_get_state();
+    int counts[INFER_LETTERS] = {0};
+    int held[INFER_LETTERS];
+    int length = 0;
+
+    for (int i = 0; i < tiles_kinds(); i++) {
+        const TileInfo *tile = tiles_get(i);
+        int index = tile_index(tile->letter);
+        if (index >= 0) {
+            counts[index] += tile->count;
+        }
+    }
+    const BoardLayout *layout = board_layout();
+    int lines = board_size();
+    for (int row = 1; row <= lines; row++) {
+        for (int col = 1; col <= lines; col++) {
+            int index = layout->flags[BOARD_ACROSS][row][col] & BOARD_SQUARE_BLANK ?
+                        ALPHABET_MAX_LETTERS : tile_index(layout->letter[BOARD_ACROSS][row][col]);
+            if (index >= 0 && counts[index] > 0) {
+                counts[index]--;
+            }
+        }
+    }
+    count_tiles(game->racks[player], held);
+
+    for (int i = 0; i < INFER_LETTERS; i++) {
+        for (int n = held[i]; n < counts[i]; n++) {
+            if (length + 1 >= size) {
+                return -1;
+            }
+            buffer[length++] = index_tile(i);
+        }
+    }
+    buffer[length] = '\0';
+    return length;
+}
+
+/* Forget everything and draw every rack uniformly from the unseen tiles */
+void infer_reset(InferState *state, const char *unseen, int rack_size)
+{
+    count_tiles(unseen, state->unseen);
+    state->rack_size = rack_size < 0 ? 0 : rack_size > RACK_SIZE ? RACK_SIZE : rack_size;
+    for (int i = 0; i < state->count; i++) {
+        state->racks[i][0] = '\0';
+        fill_rack(state, state->racks[i], &state->rng);
+        state->weights[i] = 1.0f;
+    }
+    state->scored = 0;
+    state->resampled = 0;
+    rebuild_cumulative(state);
+}
+
+static void *score_worker(void *arg)
+{
+    ScoreJob *job = (ScoreJob *)arg;
+    bool first = true;
+
+    game_restore(job->before);
+    for (;;) {
+        int start = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED) * INFER_CHUNK;
+        if (start >= job->count || (!first && now_seconds() > job->deadline)) {
+            break;
+        }
+        int n = job->count - start < INFER_CHUNK ? job->count - start : INFER_CHUNK;
+        movegen_best_scores(job->dawg, job->racks + start, n, job->scores + start);
+        __atomic_fetch_add(&job->scored, n, __ATOMIC_RELAXED);
+        first = false;
+    }
+    movegen_cache_free();
+    return NULL;
+}
+
+/* Best score of each rack on the board before the move, INT_MIN where time ran out */
+static bool score_racks(InferState *state, ScoreJob *job)
+{
+    pthread_t workers[INFER_MAX_THREADS];
+    int started = 0;
+
+    for (int i = 0; i < job->count; i++) {
+        job->scores[i] = INT_MIN;
+    }
+    for (int i = 0; i < state->threads; i++) {
+        if (pthread_create(&workers[i], NULL, score_worker, job) != 0) {
+            break;
+        }
+        started++;
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    if (started == 0) {
+        fprintf(stderr, "Failed to start rack inference workers\n");
+        return false;
+    }
+    return true;
+}
+
+/*
+ * The opponent made move from the position in before. Each rack becomes
+ * the tiles it kept, and racks that could have scored much more lose
+ * weight. Call infer_sync() once the opponent has drawn.
+ */
+bool infer_observe(InferState *state, const GameSnapshot *before, const Dawg *dawg,
+                   const Move *move)
+{
+    state->scored = 0;
+    state->resampled = 0;
+
+    if (move->type == MOVE_PASS) {
+        return true;
+    }
+    if (move->type == MOVE_EXCHANGE) {
+        /* Only the number of tiles returned is visible */
+        for (int i = 0; i < state->count; i++) {
+            for (int n = 0; n < move->length; n++) {
+                drop_random(state->racks[i], &state->rng);
+            }
+        }
+        return true;
+    }
+
+    char played[RACK_SIZE + 1];
+    int played_count = 0;
+    for (int i = 0; i < move->length && played_count < RACK_SIZE; i++) {
+        if (move->tiles[i]) {
+            /* A blank left the rack as a blank, whatever it stands for */
+            played[played_count++] = tiles_is_blank(move->tiles[i]) ? TILE_BLANK : move->tiles[i];
+        }
+    }
+    played[played_count] = '\0';
+    int keep = state->rack_size > played_count ? state->rack_size - played_count : 0;
+
+    char (*before_racks)[RACK_SIZE + 1] = malloc(state->count * sizeof(*before_racks));
+    const char **rack_pointers = (const char **)malloc(state->count * sizeof(char *));
+    int *scores = (int *)malloc(state->count * sizeof(int));
+    if (!before_racks || !rack_pointers || !scores) {
+        fprintf(stderr, "Failed to allocate rack inference scratch\n");
+        free(before_racks);
+        free(rack_pointers);
+        free(scores);
+        return false;
+    }
+
+    /* What each rack must have held: the played tiles and what it keeps */
+    for (int i = 0; i < state->count; i++) {
+        char *rack = state->racks[i];
+        int length = 0;
+        int need[INFER_LETTERS];
+        count_tiles(played, need);
+        for (const char *p = rack; *p; p++) {
+            int index = tile_index(*p);
+            if (index >= 0 && need[index] > 0) {
+                need[index]--;
+            } else {
+                rack[length++] = *p;
+            }
+        }
+        rack[length] = '\0';
+        while (length-- > keep) {
+            drop_random(rack, &state->rng);
+        }
+        snprintf(before_racks[i], RACK_SIZE + 1, "%s%s", played, rack);
+        rack_pointers[i] = before_racks[i];
+    }
+
+    ScoreJob job = { before, dawg, rack_pointers, scores, state->count, 0, 0,
+                     now_seconds() + state->budget };
+    bool ok = score_racks(state, &job);
+    if (ok) {
+        double total = 0.0;
+        for (int i = 0; i < state->count; i++) {
+            if (scores[i] != INT_MIN) {
+                float shortfall = (float)(scores[i] - move->score) - state->margin;
+                if (shortfall > 0.0f) {
+                    state->weights[i] *= expf(-shortfall / state->temperature);
+                }
+            }
+            total += state->weights[i];
+        }
+
+        /* No rack explains the move: start the weights over */
+        if (!(total > 0.0)) {
+            for (int i = 0; i < state->count; i++) {
+                state->weights[i] = 1.0f;
+            }
+        }
+        state->scored = job.scored;
+    }
+
+    state->rack_size = keep;
+    rebuild_cumulative(state);
+    free(before_racks);
+    free(rack_pointers);
+    free(scores);
+    return ok;
+}
+
+/*
+ * Bring the racks in line with what is unseen now and how many tiles the
+ * opponent holds: tiles that have since come into view are dropped, racks
+ * are refilled, and the set is resampled if its effective size has fallen
+ * below half.
+ */
+void infer_sync(InferState *state, const char *unseen, int rack_size)
+{
+    count_tiles(unseen, state->unseen);
+    state->rack_size = rack_size < 0 ? 0 : rack_size > RACK_SIZE ? RACK_SIZE : rack_size;
+    for (int i = 0; i < state->count; i++) {
+        fit_rack(state, state->racks[i], &state->rng);
+        fill_rack(state, state->racks[i], &state->rng);
+    }
+    if (infer_effective(state) < state->count / 2.0 && resample(state)) {
+        state->resampled = 1;
+    }
+    rebuild_cumulative(state);
+}
+
+/* Effective number of racks: (sum of weights)^2 / sum of squared weights */
+double infer_effective(const InferState *state)
+{
+    double sum = 0.0;
+    double squares = 0.0;
+    for (int i = 0; i < state->count; i++) {
+        sum += state->weights[i];
+        squares += (double)state->weights[i] * state->weights[i];
+    }
+    return squares > 0.0 ? sum * sum / squares : 0.0;
+}
+
+/*
+ * A rack drawn in proportion to weight. Reads the state only, so
+ * simulation threads may share one between updates, each with its own rng.
+ */
+const char* infer_sample(const InferState *state, uint64_t *rng)
+{
+    double total = state->cumulative[state->count - 1];
+    double point = total * ((next_random(rng) >> 11) * 0x1.0p-53);
+    int low = 0;
+    int high = state->count - 1;
+
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (state->cumulative[mid] > point) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return state->racks[low];
+}
@@ -0,0 +1,435 @@
+/**
+ * XScrabble - Learner Progress Implementation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include "learner.h"
+
+/* Log file header */
+#define LEARNER_MAGIC "XSLG"
+#define LEARNER_VERSION 1
+
+/* Logs shorter than this are never worth compacting */
+#define LEARNER_COMPACT_MIN 64
+
+#define LEARNER_INITIAL_SLOTS 64
+
+_Static_assert(sizeof(LearnerRecord) == 16, "log records are written as raw 16-byte structs");
+
+/* Due-queue ordering: earlier due first, then lower word ID */
+static bool heap_before(const Learner *learner, int32_t a, int32_t b)
+{
+    return learner->due[a] != learner->due[b] ? learner->due[a] < learner->due[b] : a < b;
+}
+
+static void heap_set(Learner *learner, int slot, int32_t word)
+{
+    learner->heap[slot] = word;
+    learner->heap_pos[word] = slot;
+}
+
+static void heap_up(Learner *learner, int slot)
+{
+    int32_t word = learner->heap[slot];
+    while (slot > 0) {
+        int parent = (slot - 1) / 2;
+        if (!heap_before(learner, word, learner->heap[parent])) {
+            break;
+        }
+        heap_set(learner, slot, learner->heap[parent]);
+        slot = parent;
+    }
+    heap_set(learner, slot, word);
+}
+
+static void heap_down(Learner *learner, int slot)
+{
+    int32_t word = learner->heap[slot];
+    for (;;) {
+        int child = 2 * slot + 1;
+        if (child >= learner->studied) {
+            break;
+        }
+        if (child + 1 < learner->studied &&
+            heap_before(learner, learner->heap[child + 1], learner->heap[child])) {
+            child++;
+        }
+        if (!heap_before(learner, learner->heap[child], word)) {
+            break;
+        }
+        heap_set(learner, slot, learner->heap[child]);
+        slot = child;
+    }
+    heap_set(learner, slot, word);
+}
+
+/* Put a word whose due time changed back in order, adding it if new */
+static void heap_update(Learner *learner, int32_t word)
+{
+    int slot = learner->heap_pos[word];
+    if (slot < 0) {
+        slot = learner->studied++;
+        heap_set(learner, slot, word);
+    }
+    heap_up(learner, slot);
+    heap_down(learner, learner->heap_pos[word]);
+}
+
+static void apply_record(Learner *learner, const LearnerRecord *record)
+{
+    uint32_t word = record->word;
+    learner->due[word] = record->due;
+    learner->interval[word] = record->interval;
+    learner->ease[word] = record->ease;
+    learner->reps[word] = record->reps;
+    learner->lapses[word] = record->lapses;
+}
+
+static void make_record(const Learner *learner, int32_t word, LearnerRecord *record)
+{
+    memset(record, 0, sizeof(*record));
+    record->word = (uint32_t)word;
+    record->due = learner->due[word];
+    record->interval = learner->interval[word];
+    record->ease = learner->ease[word];
+    record->reps = learner->reps[word];
+    record->lapses = learner->lapses[word];
+}
+
+static void learner_free(Learner *learner)
+{
+    if (!learner) {
+        return;
+    }
+    free(learner->due);
+    free(learner->interval);
+    free(learner->ease);
+    free(learner->reps);
+    free(learner->lapses);
+    free(learner->heap);
+    free(learner->heap_pos);
+    free(learner);
+}
+
+static Learner* learner_alloc(uint32_t id, int word_count)
+{
+    Learner *learner = (Learner *)calloc(1, sizeof(Learner));
+    size_t n = word_count > 0 ? (size_t)word_count : 1;
+    if (!learner) {
+        return NULL;
+    }
+    learner->id = id;
+    learner->word_count = word_count;
+    learner->due = (uint32_t *)calloc(n, sizeof(uint32_t));
+    learner->interval = (uint16_t *)calloc(n, sizeof(uint16_t));
+    learner->ease = (uint16_t *)malloc(n * sizeof(uint16_t));
+    learner->reps = (uint8_t *)calloc(n, sizeof(uint8_t));
+    learner->lapses = (uint8_t *)calloc(n, sizeof(uint8_t));
+    learner->heap = (int32_t *)malloc(n * sizeof(int32_t));
+    learner->heap_pos = (int32_t *)malloc(n * sizeof(int32_t));
+    if (!learner->due || !learner->interval || !learner->ease || !learner->reps ||
+        !learner->lapses || !learner->heap || !learner->heap_pos) {
+        learner_free(learner);
+        return NULL;
+    }
+    for (int i = 0; i < word_count; i++) {
+        learner->ease[i] = LEARNER_INITIAL_EASE;
+        learner->heap_pos[i] = -1;
+    }
+    return learner;
+}
+
+/*
+ * Replay a learner's log. A missing file is a learner with no reviews; a
+ * torn final record is dropped and the log rewritten without it.
+ */
+static bool learner_read_log(Learner *learner)
+{
+    FILE *file = fopen(learner->path, "rb");
+    if (!file) {
+        return errno == ENOENT;
+    }
+
+    char magic[4];
+    uint32_t version;
+    if (fread(magic, 1, 4, file) != 4 || memcmp(magic, LEARNER_MAGIC, 4) != 0 ||
+        fread(&version, sizeof(version), 1, file) != 1 || version != LEARNER_VERSION) {
+        fprintf(stderr, "Learner log %s is not a version %d log\n", learner->path, LEARNER_VERSION);
+        fclose(file);
+        return false;
+    }
+
+    LearnerRecord record;
+    size_t got;
+    uint32_t skipped = 0;
+    while ((got = fread(&record, 1, sizeof(record), file)) == sizeof(record)) {
+        learner->log_records++;
+        if (record.word >= (uint32_t)learner->word_count) {
+            skipped++;
+            continue;
+        }
+        apply_record(learner, &record);
+        if (learner->heap_pos[record.word] < 0) {
+            heap_set(learner, learner->studied++, (int32_t)record.word);
+        }
+    }
+    fclose(file);
+
+    /* Order the queue once, after the last record for each word is known */
+    for (int slot = learner->studied / 2 - 1; slot >= 0; slot--) {
+        heap_down(learner, slot);
+    }
+
+    if (skipped > 0) {
+        fprintf(stderr, "Learner log %s: skipped %u records for unknown words\n",
+                learner->path, skipped);
+    }
+    return got == 0 || learner_compact(learner);
+}
+
+/* Home slot of a learner ID */
+static int store_slot(const LearnerStore *store, uint32_t id)
+{
+    return (int)((id * 2654435761u) & (uint32_t)(store->capacity - 1));
+}
+
+static int store_find(const LearnerStore *store, uint32_t id)
+{
+    for (int slot = store_slot(store, id);; slot = (slot + 1) & (store->capacity - 1)) {
+        if (!store->slots[slot] || store->slots[slot]->id == id) {
+            return slot;
+        }
+    }
+}
+
+static bool store_grow(LearnerStore *store)
+{
+    Learner **old = store->slots;
+    int old_capacity = store->capacity;
+
+    store->capacity = old_capacity * 2;
+    store->slots = (Learner **)calloc(store->capacity, sizeof(Learner *));
+    if (!store->slots) {
+        store->slots = old;
+        store->capacity = old_capacity;
+        return false;
+    }
+    for (int i = 0; i < old_capacity; i++) {
+        if (old[i]) {
+            store->slots[store_find(store, old[i]->id)] = old[i];
+        }
+    }
+    free(old);
+    return true;
+}
+
+/* Start a store of learner logs in directory, creating it if needed */
+bool learner_store_open(LearnerStore *store, const char *directory, int word_count)
+{
+    memset(store, 0, sizeof(*store));
+    if (strlen(directory) >= sizeof(store->directory)) {
+        fprintf(stderr, "Learner directory name is too long: %s\n", directory);
+        return false;
+    }
+    if (mkdir(directory, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Cannot create learner directory %s\n", directory);
+        return false;
+    }
+
+    strcpy(store->directory, directory);
+    store->word_count = word_count;
+    store->capacity = LEARNER_INITIAL_SLOTS;
+    store->slots = (Learner **)calloc(store->capacity, sizeof(Learner *));
+    return store->slots != NULL;
+}
+
+/* Flush and drop every loaded learner */
+void learner_store_close(LearnerStore *store)
+{
+    for (int i = 0; i < store->capacity; i++) {
+        if (store->slots[i]) {
+            learner_flush(store->slots[i]);
+            learner_free(store->slots[i]);
+        }
+    }
+    free(store->slots);
+    memset(store, 0, sizeof(*store));
+}
+
+/* A learner's state, read from its log the first time it is asked for */
+Learner* learner_get(LearnerStore *store, uint32_t id)
+{
+    int slot = store_find(store, id);
+    if (store->slots[slot]) {
+        return store->slots[slot];
+    }
+
+    Learner *learner = learner_alloc(id, store->word_count);
+    if (!learner) {
+        fprintf(stderr, "Failed to allocate learner %u\n", id);
+        return NULL;
+    }
+    snprintf(learner->path, sizeof(learner->path), "%s/%u.xsl", store->directory, id);
+    if (!learner_read_log(learner)) {
+        learner_free(learner);
+        return NULL;
+    }
+
+    if ((store->count + 1) * 2 > store->capacity) {
+        if (!store_grow(store)) {
+            learner_free(learner);
+            return NULL;
+        }
+        slot = store_find(store, id);
+    }
+    store->slots[slot] = learner;
+    store->count++;
+    return learner;
+}
+
+/* Write out and forget a loaded learner; false if it was not loaded or the write failed */
+bool learner_unload(LearnerStore *store, uint32_t id)
+{
+    int slot = store_find(store, id);
+    Learner *learner = store->slots[slot];
+    if (!learner) {
+        return false;
+    }
+
+    bool flushed = learner_flush(learner);
+    learner_free(learner);
+    store->slots[slot] = NULL;
+    store->count--;
+
+    /* Shift later members of the probe run back so lookups still find them */
+    int mask = store->capacity - 1;
+    for (int next = (slot + 1) & mask; store->slots[next]; next = (next + 1) & mask) {
+        int home = store_slot(store, store->slots[next]->id);
+        if (((next - home) & mask) >= ((next - slot) & mask)) {
+            store->slots[slot] = store->slots[next];
+            store->slots[next] = NULL;
+            slot = next;
+        }
+    }
+    return flushed;
+}
+
+/*
+ * Record a review graded 0-5 at time now (seconds since the epoch) and
+ * reschedule the word by SM-2: a failed word comes back in ten minutes,
+ * a passed one after 1, 6, then interval * ease days.
+ */
+bool learner_review(Learner *learner, int word, int grade, uint32_t now)
+{
+    if (word < 0 || word >= learner->word_count || grade < 0 || grade > LEARNER_MAX_GRADE) {
+        return false;
+    }
+
+    int miss = LEARNER_MAX_GRADE - grade;
+    int ease = learner->ease[word] + 100 - miss * (80 + miss * 20);
+    learner->ease[word] = (uint16_t)(ease < LEARNER_MIN_EASE ? LEARNER_MIN_EASE :
+                                     ease > UINT16_MAX ? UINT16_MAX : ease);
+
+    uint64_t due;
+    if (grade < LEARNER_PASS_GRADE) {
+        learner->reps[word] = 0;
+        learner->lapses[word] += learner->lapses[word] < UINT8_MAX;
+        learner->interval[word] = 0;
+        due = (uint64_t)now + LEARNER_RELEARN_SECONDS;
+    } else {
+        learner->reps[word] += learner->reps[word] < UINT8_MAX;
+        uint64_t interval = learner->reps[word] == 1 ? 1 :
+                            learner->reps[word] == 2 ? 6 :
+                            ((uint64_t)learner->interval[word] * learner->ease[word] + 500) / 1000;
+        interval = interval < 1 ? 1 : interval > UINT16_MAX ? UINT16_MAX : interval;
+        learner->interval[word] = (uint16_t)interval;
+        due = (uint64_t)now + interval * LEARNER_DAY_SECONDS;
+    }
+    learner->due[word] = due > UINT32_MAX ? UINT32_MAX : (uint32_t)due;
+    heap_update(learner, word);
+
+    make_record(learner, word, &learner->pending[learner->pending_count++]);
+    if (learner->pending_count == LEARNER_PENDING) {
+        return learner_flush(learner);
+    }
+    return true;
+}
+
+/* The word due soonest if it is due by now, else -1; never scans the word list */
+int learner_next_due(const Learner *learner, uint32_t now)
+{
+    if (learner->studied == 0 || learner->due[learner->heap[0]] > now) {
+        return -1;
+    }
+    return learner->heap[0];
+}
+
+/* Append buffered reviews to the log, compacting it once it has doubled */
+bool learner_flush(Learner *learner)
+{
+    if (learner->pending_count == 0) {
+        return true;
+    }
+    if (learner->log_records + learner->pending_count >= LEARNER_COMPACT_MIN &&
+        learner->log_records + learner->pending_count >= 2 * (uint32_t)learner->studied) {
+        return learner_compact(learner);
+    }
+
+    FILE *file = fopen(learner->path, "ab");
+    if (!file) {
+        fprintf(stderr, "Cannot append to learner log %s\n", learner->path);
+        return false;
+    }
+
+    uint32_t version = LEARNER_VERSION;
+    bool ok = true;
+    if (ftell(file) == 0) {
+        ok = fwrite(LEARNER_MAGIC, 1, 4, file) == 4 &&
+             fwrite(&version, sizeof(version), 1, file) == 1;
+    }
+    ok = ok && fwrite(learner->pending, sizeof(LearnerRecord), learner->pending_count, file) ==
+               (size_t)learner->pending_count;
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        fprintf(stderr, "Failed to append to learner log %s\n", learner->path);
+        return false;
+    }
+    learner->log_records += learner->pending_count;
+    learner->pending_count = 0;
+    return true;
+}
+
+/* Rewrite the log with one record per studied word, replacing it atomically */
+bool learner_compact(Learner *learner)
+{
+    char temporary[sizeof(learner->path) + 4];
+    uint32_t version = LEARNER_VERSION;
+
+    snprintf(temporary, sizeof(temporary), "%s.tmp", learner->path);
+    FILE *file = fopen(temporary, "wb");
+    if (!file) {
+        fprintf(stderr, "Cannot write learner log %s\n", temporary);
+        return false;
+    }
+
+    bool ok = fwrite(LEARNER_MAGIC, 1, 4, file) == 4 &&
+              fwrite(&version, sizeof(version), 1, file) == 1;
+    for (int i = 0; i < learner->studied && ok; i++) {
+        LearnerRecord record;
+        make_record(learner, learner->heap[i], &record);
+        ok = fwrite(&record, sizeof(record), 1, file) == 1;
+    }
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(temporary, learner->path) != 0) {
+        fprintf(stderr, "Failed to compact learner log %s\n", learner->path);
+        remove(temporary);
+        return false;
+    }
+    learner->log_records = (uint32_t)learner->studied;
+    learner->pending_count = 0;
+    return true;
+}
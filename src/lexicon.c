@@ -0,0 +1,358 @@
+/**
+ * XScrabble - Lexicon Registry Implementation
+ *
+ * Readers never lock. lexicon_acquire() announces itself in the slot's
+ * acquiring count, loads the current pointer and takes a reference.
+ * lexicon_publish() swaps the pointer, then waits for the count to drain
+ * before dropping the registry's reference to the old version; that wait
+ * is the grace period that keeps a reader from retaining a freed lexicon.
+ *
+ * Words are encoded into machine letters once, while loading; the graph
+ * never sees UTF-8.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sched.h>
+#include <pthread.h>
+#include "lexicon.h"
+
+/* One registry entry; names are never removed once added */
+typedef struct {
+    char name[LEXICON_NAME_MAX];
+    Lexicon *current;
+    int acquiring;
+    uint32_t versions;
+} LexiconSlot;
+
+static LexiconSlot slots[LEXICON_MAX];
+static int slot_count = 0;
+static pthread_mutex_t publish_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int compare_entries(const void *a, const void *b)
+{
+    return strcasecmp(((const DictionaryEntry *)a)->word, ((const DictionaryEntry *)b)->word);
+}
+
+static Lexicon* lexicon_create(const char *name, const Alphabet *alphabet)
+{
+    Lexicon *lexicon = (Lexicon *)calloc(1, sizeof(Lexicon));
+    if (lexicon) {
+        snprintf(lexicon->name, sizeof(lexicon->name), "%s", name);
+        lexicon->alphabet = *alphabet;
+        lexicon->refs = 1;
+    }
+    return lexicon;
+}
+
+/*
+ * Encode words into machine letters in storage, which needs as many bytes
+ * as the words and their terminators. Words the alphabet cannot spell are
+ * left out. Returns the number encoded into encoded.
+ */
+static size_t encode_words(const Alphabet *alphabet, const char *const *words, size_t count,
+                           char *storage, const char **encoded)
+{
+    size_t kept = 0;
+    size_t skipped = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        int length = alphabet_encode(alphabet, words[i], storage, (int)strlen(words[i]) + 1);
+        if (length <= 0) {
+            skipped++;
+            continue;
+        }
+        encoded[kept++] = storage;
+        storage += length + 1;
+    }
+    if (skipped) {
+        fprintf(stderr, "Skipped %zu words the alphabet cannot spell\n", skipped);
+    }
+    return kept;
+}
+
+/* Graph over words given as UTF-8 */
+static Dawg* build_graph(const Alphabet *alphabet, const char *const *words, size_t count)
+{
+    size_t bytes = 1;
+    for (size_t i = 0; i < count; i++) {
+        bytes += strlen(words[i]) + 1;
+    }
+
+    char *storage = (char *)malloc(bytes);
+    const char **encoded = (const char **)malloc((count + 1) * sizeof(char *));
+    Dawg *dawg = NULL;
+    if (storage && encoded) {
+        dawg = dawg_build_parallel(encoded, encode_words(alphabet, words, count, storage, encoded), 0);
+    }
+    free(encoded);
+    free(storage);
+    return dawg;
+}
+
+/* Graph over a word list file, one word per line; '#' starts a comment line */
+static Dawg* load_graph(const Alphabet *alphabet, const char *filename)
+{
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *text = size >= 0 ? (char *)malloc(size + 1) : NULL;
+    if (!text || fread(text, 1, size, file) != (size_t)size) {
+        free(text);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+    text[size] = '\0';
+
+    /* Split into lines in place */
+    size_t count = 0;
+    for (long i = 0; i < size; i++) {
+        count += text[i] == '\n';
+    }
+    const char **words = (const char **)malloc((count + 1) * sizeof(char *));
+    count = 0;
+    for (char *line = text; words && *line; ) {
+        size_t length = strcspn(line, "\r\n");
+        char *next = line + length;
+        if (*next) {
+            *next++ = '\0';
+        }
+        if (length && line[0] != '#') {
+            words[count++] = line;
+        }
+        line = next;
+    }
+
+    Dawg *dawg = words ? build_graph(alphabet, words, count) : NULL;
+    free(words);
+    free(text);
+    return dawg;
+}
+
+/* Definitions from a JSON dictionary, with a word graph over their words */
+static Lexicon* lexicon_load_json(const char *name, const char *filename, const Alphabet *alphabet)
+{
+    DictionaryEntry *entries;
+    int count;
+
+    if (!dictionary_parse_json(filename, &entries, &count)) {
+        dictionary_free_entries(entries, count);
+        return NULL;
+    }
+    qsort(entries, count, sizeof(DictionaryEntry), compare_entries);
+
+    const char **words = (const char **)malloc(count * sizeof(char *));
+    Lexicon *lexicon = lexicon_create(name, alphabet);
+    if (!words || !lexicon) {
+        free(words);
+        free(lexicon);
+        dictionary_free_entries(entries, count);
+        return NULL;
+    }
+    for (int i = 0; i < count; i++) {
+        words[i] = entries[i].word;
+    }
+
+    lexicon->dawg = build_graph(alphabet, words, count);
+    lexicon->entries = entries;
+    lexicon->entry_count = count;
+    free(words);
+    if (!lexicon->dawg) {
+        lexicon_release(lexicon);
+        return NULL;
+    }
+    return lexicon;
+}
+
+/* Build an English lexicon from a word list, or from a JSON dictionary with definitions */
+Lexicon* lexicon_load(const char *name, const char *filename)
+{
+    return lexicon_load_alphabet(name, filename, alphabet_english());
+}
+
+/* Build a lexicon whose words are spelled in the given alphabet */
+Lexicon* lexicon_load_alphabet(const char *name, const char *filename, const Alphabet *alphabet)
+{
+    size_t length = strlen(filename);
+    if (length > 5 && strcasecmp(filename + length - 5, ".json") == 0) {
+        return lexicon_load_json(name, filename, alphabet);
+    }
+
+    Dawg *dawg = load_graph(alphabet, filename);
+    Lexicon *lexicon = dawg ? lexicon_create(name, alphabet) : NULL;
+    if (!lexicon) {
+        dawg_free(dawg);
+        return NULL;
+    }
+    lexicon->dawg = dawg;
+    return lexicon;
+}
+
+/* Build an English lexicon from words in memory */
+Lexicon* lexicon_from_words(const char *name, const char *const *words, int count)
+{
+    Dawg *dawg = build_graph(alphabet_english(), words, count);
+    Lexicon *lexicon = dawg ? lexicon_create(name, alphabet_english()) : NULL;
+    if (!lexicon) {
+        dawg_free(dawg);
+        return NULL;
+    }
+    lexicon->dawg = dawg;
+    return lexicon;
+}
+
+/* Take another reference to a lexicon already held */
+Lexicon* lexicon_retain(Lexicon *lexicon)
+{
+    if (lexicon) {
+        __atomic_fetch_add(&lexicon->refs, 1, __ATOMIC_RELAXED);
+    }
+    return lexicon;
+}
+
+/* Drop a reference; the last one frees the lexicon */
+void lexicon_release(Lexicon *lexicon)
+{
+    if (!lexicon || __atomic_sub_fetch(&lexicon->refs, 1, __ATOMIC_ACQ_REL) != 0) {
+        return;
+    }
+    dawg_free(lexicon->dawg);
+    dictionary_free_entries(lexicon->entries, lexicon->entry_count);
+    free(lexicon);
+}
+
+/* Check a UTF-8 word; JSON lexicons also match words the graph cannot spell */
+bool lexicon_contains(const Lexicon *lexicon, const char *word)
+{
+    char letters[DAWG_MAX_WORD_LENGTH + 1];
+
+    if (alphabet_encode(&lexicon->alphabet, word, letters, sizeof(letters)) > 0 &&
+        dawg_contains(lexicon->dawg, letters)) {
+        return true;
+    }
+    return lexicon->entries && lexicon_definition(lexicon, word) != NULL;
+}
+
+/* Definition entry for a word, or NULL */
+const DictionaryEntry* lexicon_definition(const Lexicon *lexicon, const char *word)
+{
+    DictionaryEntry key;
+
+    if (!lexicon->entries || strlen(word) >= sizeof(key.word)) {
+        return NULL;
+    }
+    strcpy(key.word, word);
+    return (const DictionaryEntry *)bsearch(&key, lexicon->entries, lexicon->entry_count,
+                                            sizeof(DictionaryEntry), compare_entries);
+}
+
+static LexiconSlot* find_slot(const char *name)
+{
+    int count = __atomic_load_n(&slot_count, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < count; i++) {
+        if (strcmp(slots[i].name, name) == 0) {
+            return &slots[i];
+        }
+    }
+    return NULL;
+}
+
+/* Swap a slot's lexicon and release the old one after the grace period */
+static void swap_current(LexiconSlot *slot, Lexicon *lexicon)
+{
+    Lexicon *old = __atomic_exchange_n(&slot->current, lexicon, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&slot->acquiring, __ATOMIC_SEQ_CST) != 0) {
+        sched_yield();
+    }
+    lexicon_release(old);
+}
+
+/*
+ * Make lexicon the current version under its name. The registry takes
+ * over the caller's reference. Games holding the previous version keep
+ * it until they release it.
+ */
+bool lexicon_publish(Lexicon *lexicon)
+{
+    pthread_mutex_lock(&publish_lock);
+
+    LexiconSlot *slot = find_slot(lexicon->name);
+    if (!slot) {
+        if (slot_count == LEXICON_MAX) {
+            pthread_mutex_unlock(&publish_lock);
+            return false;
+        }
+        slot = &slots[slot_count];
+        memset(slot, 0, sizeof(*slot));
+        strcpy(slot->name, lexicon->name);
+        __atomic_store_n(&slot_count, slot_count + 1, __ATOMIC_RELEASE);
+    }
+
+    lexicon->version = ++slot->versions;
+    swap_current(slot, lexicon);
+
+    pthread_mutex_unlock(&publish_lock);
+    return true;
+}
+
+/* Load a new version from disk, in the current version's alphabet, and publish it */
+bool lexicon_reload(const char *name, const char *filename)
+{
+    Lexicon *current = lexicon_acquire(name);
+    Lexicon *lexicon = lexicon_load_alphabet(name, filename,
+                                             current ? &current->alphabet : alphabet_english());
+    lexicon_release(current);
+    if (!lexicon) {
+        return false;
+    }
+    if (!lexicon_publish(lexicon)) {
+        lexicon_release(lexicon);
+        return false;
+    }
+    return true;
+}
+
+/* Reference to the current version of a lexicon, or NULL; release when done */
+Lexicon* lexicon_acquire(const char *name)
+{
+    LexiconSlot *slot = find_slot(name);
+    if (!slot) {
+        return NULL;
+    }
+
+    __atomic_fetch_add(&slot->acquiring, 1, __ATOMIC_SEQ_CST);
+    Lexicon *lexicon = lexicon_retain(__atomic_load_n(&slot->current, __ATOMIC_SEQ_CST));
+    __atomic_fetch_sub(&slot->acquiring, 1, __ATOMIC_RELEASE);
+    return lexicon;
+}
+
+/* Names with a published lexicon */
+int lexicon_names(const char *names[LEXICON_MAX])
+{
+    int count = __atomic_load_n(&slot_count, __ATOMIC_ACQUIRE);
+    int found = 0;
+    for (int i = 0; i < count; i++) {
+        if (__atomic_load_n(&slots[i].current, __ATOMIC_ACQUIRE)) {
+            names[found++] = slots[i].name;
+        }
+    }
+    return found;
+}
+
+/* Drop the registry's references; held handles stay valid */
+void lexicon_registry_clear(void)
+{
+    pthread_mutex_lock(&publish_lock);
+    for (int i = 0; i < slot_count; i++) {
+        swap_current(&slots[i], NULL);
+    }
+    pthread_mutex_unlock(&publish_lock);
+}
@@ -6,6 +6,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <signal.h>
 #include <X11/Intrinsic.h>
 #include <X11/StringDefs.h>
 #include <X11/Shell.h>
@@ -18,11 +20,33 @@
 #include "board.h"
 #include "ui.h"
 #include "config.h"
+#include "stats.h"
 
 /* Global variables */
 XtAppContext app_context;
 Widget       top_level;
 
+/* Statistics dump requests (SIGUSR1) */
+static XtSignalId stats_signal;
+
+static void stats_signal_handler(int signo)
+{
+    (void)signo;
+    XtNoticeSignal(stats_signal);
+}
+
+static void stats_signal_callback(XtPointer client_data, XtSignalId *id)
+{
+    (void)client_data;
+    (void)id;
+    stats_dump(stderr);
+}
+
+static void stats_dump_at_exit(void)
+{
+    stats_dump(stderr);
+}
+
 int main(int argc, char *argv[])
 {
     /* Initialize X toolkit */
@@ -35,6 +59,17 @@ int main(int argc, char *argv[])
         NULL, 0
     );
     
+    /* Remaining arguments are ours once Xt has taken its own */
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--stats") == 0) {
+            atexit(stats_dump_at_exit);
+        }
+    }
+    
+    /* Dump statistics whenever SIGUSR1 arrives */
+    stats_signal = XtAppAddSignal(app_context, stats_signal_callback, NULL);
+    signal(SIGUSR1, stats_signal_handler);
+    
     /* Initialize game state */
     if (!game_init()) {
         fprintf(stderr, "Failed to initialize game\n");
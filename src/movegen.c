@@ -0,0 +1,426 @@
+/**
+ * XScrabble - Move Generation Implementation
+ *
+ * Anchor-based generation over the graph lexicon (Appel & Jacobson). Each
+ * direction is generated as rows of the board's padded layout; down moves
+ * read its transposed orientation so the same row code handles both, and
+ * cross words are read along the other orientation. Grid coordinates are
+ * padded (board squares run from FIRST to LAST) so neighbours need no
+ * bounds checks. Anchors and their left-extension limits come from the
+ * board's incrementally kept index. Scores are accumulated while tiles
+ * are placed instead of rescanning the board.
+ *
+ * Two per-thread caches skip work that the last call already did. Cross
+ * checks are kept per perpendicular line and recomputed only for lines
+ * whose board stamp moved. The moves of each line are memoized under the
+ * line's letters, anchors, cross checks, premiums and the rack multiset,
+ * so asking again about the same position and rack is mostly copying.
+ *
+ * A blank is tried on each graph edge the rack's own tiles cannot follow,
+ * so it costs one extra branch per node rather than a generation pass per
+ * letter it could stand for. It is never used for a letter the rack still
+ * holds: that play would score less and keep a letter instead of the
+ * blank. Plays that differ only in which copies of a letter are blanks are
+ * generated once, with the blanks then moved to the squares where they
+ * cost least.
+ *
+ * Generation is compiled once per rule variant from movegen_kernel.h,
+ * with that variant's board size, rack size and bingo bonus as constants,
+ * and each call runs the kernel for the variant of the thread's board.
+ *
+ * Moves can also be streamed to a visitor instead of a list. A visitor
+ * may pass a score floor; rows whose best conceivable move cannot reach it
+ * are skipped without generating them, which is what makes top-K cheap.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "movegen.h"
+#include "tiles.h"
+#include "stats.h"
+
+#define ALL_LETTERS ((1u << DAWG_LETTERS) - 1)
+#define NO_CROSS_WORD -1
+#define FIRST 1                 /* Padded index of the first board square on a line */
+#define LINE_CACHE_WAYS 4
+
+/* Running score of a partial move */
+typedef struct {
+    int main;           /* Letter points of the main word */
+    int multiplier;     /* Word multiplier of the main word */
+    int cross;          /* Complete score of perpendicular words */
+} Score;
+
+/* Moves of one line while streaming to a visitor through the line cache */
+static _Thread_local MoveList line_moves;
+
+/* Best moves so far, worst at the root; seq breaks ties in movegen_generate() order */
+typedef struct {
+    Move move;
+    uint32_t seq;
+} TopEntry;
+
+typedef struct {
+    TopEntry *heap;
+    int count;
+    int capacity;
+    int line;                   /* Direction and row of the moves being visited */
+    uint32_t position;          /* Index of the next move within that line */
+    int floor;
+} TopK;
+
+static _Thread_local TopEntry *top_storage;
+static _Thread_local int top_storage_capacity;
+
+/* Move lists */
+
+void movegen_list_init(MoveList *list)
+{
+    list->moves = NULL;
+    list->count = 0;
+    list->capacity = 0;
+}
+
+void movegen_list_free(MoveList *list)
+{
+    free(list->moves);
+    movegen_list_init(list);
+}
+
+static Move* list_push(MoveList *list)
+{
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 256;
+        Move *grown = (Move *)realloc(list->moves, capacity * sizeof(Move));
+        if (!grown) {
+            return NULL;
+        }
+        list->moves = grown;
+        list->capacity = capacity;
+    }
+    return &list->moves[list->count++];
+}
+
+/* Line caching is on unless turned off for the thread */
+static _Thread_local bool cache_disabled;
+
+/* Score bounds */
+
+/* Keep the limit largest values in top, in descending order */
+static void keep_largest(int *top, int *count, int limit, int value)
+{
+    int i = *count;
+    if (i == limit) {
+        if (top[limit - 1] >= value) {
+            return;
+        }
+        i--;
+    } else {
+        (*count)++;
+    }
+    while (i > 0 && top[i - 1] < value) {
+        top[i] = top[i - 1];
+        i--;
+    }
+    top[i] = value;
+}
+
+/* Visitor for movegen_best_scores(): keep the best score seen */
+static bool best_visit(const Move *move, void *context)
+{
+    int *best = (int *)context;
+    if (move->score > *best) {
+        *best = move->score;
+    }
+    return true;
+}
+
+/* One generator per variant */
+
+#define KERNEL_VARIANT STANDARD
+#include "movegen_kernel.h"
+#define KERNEL_VARIANT SUPER
+#include "movegen_kernel.h"
+#define KERNEL_VARIANT QUICK
+#include "movegen_kernel.h"
+
+typedef struct {
+    int (*generate)(const Dawg *dawg, const char *rack, MoveList *list,
+                    MoveVisitor visit, void *context, const int *floor);
+    void (*best_scores)(const Dawg *dawg, const char *const *racks, int count, int *scores);
+    void (*cache_free)(void);
+    void (*cache_counts)(uint64_t *hits, uint64_t *misses);
+} Kernel;
+
+/* A variant added to VARIANT_LIST without a kernel above fails to compile here */
+static const Kernel kernels[VARIANT_COUNT] = {
+#define KERNEL_ENTRY(ID) [VARIANT_##ID] = { generate_##ID, best_scores_##ID, cache_free_##ID, cache_counts_##ID },
+    VARIANT_LIST(KERNEL_ENTRY)
+#undef KERNEL_ENTRY
+};
+
+/* Turn the line cache on or off for the calling thread */
+void movegen_cache_enable(bool enabled)
+{
+    cache_disabled = !enabled;
+}
+
+/* Line cache hits and misses on the calling thread */
+void movegen_cache_stats(uint64_t *hits, uint64_t *misses)
+{
+    *hits = 0;
+    *misses = 0;
+    for (int i = 0; i < VARIANT_COUNT; i++) {
+        kernels[i].cache_counts(hits, misses);
+    }
+}
+
+/* Release the calling thread's cached moves and buffers */
+void movegen_cache_free(void)
+{
+    movegen_list_free(&line_moves);
+    free(top_storage);
+    top_storage = NULL;
+    top_storage_capacity = 0;
+    for (int i = 0; i < VARIANT_COUNT; i++) {
+        kernels[i].cache_free();
+    }
+}
+
+/* Generate all placements for the rack on the current board */
+int movegen_generate(const Dawg *dawg, const char *rack, MoveList *list)
+{
+    STATS_TIMER_BEGIN(timer);
+    list->count = 0;
+    kernels[board_variant()->id].generate(dawg, rack, list, NULL, NULL, NULL);
+    STATS_TIMER_END(timer, STAT_MOVE_GENERATION);
+    return list->count;
+}
+
+/*
+ * Stream every placement to visit without building a list; generation
+ * stops when it returns false. If floor is set, rows whose moves cannot
+ * score *floor are skipped and the rest come in order of promise rather
+ * than board order; the visitor may raise it as it goes.
+ */
+int movegen_visit(const Dawg *dawg, const char *rack, MoveVisitor visit, void *context,
+                  const int *floor)
+{
+    STATS_TIMER_BEGIN(timer);
+    int count = kernels[board_variant()->id].generate(dawg, rack, NULL, visit, context, floor);
+    STATS_TIMER_END(timer, STAT_MOVE_GENERATION);
+    return count;
+}
+
+/*
+ * Best placement score for each of count racks on the current board, or
+ * -1 where a rack has none. The board is prepared once per direction for
+ * the whole batch, and each rack only generates rows that can beat its
+ * best so far. Racks rarely repeat, so the line cache is bypassed.
+ */
+void movegen_best_scores(const Dawg *dawg, const char *const *racks, int count, int *scores)
+{
+    for (int i = 0; i < count; i++) {
+        scores[i] = -1;
+    }
+    if (!dawg->root || count <= 0) {
+        return;
+    }
+
+    STATS_TIMER_BEGIN(timer);
+    kernels[board_variant()->id].best_scores(dawg, racks, count, scores);
+    STATS_TIMER_END(timer, STAT_MOVE_GENERATION);
+}
+
+/* True if a ranks below b: lower score, or equal and generated later */
+static bool top_worse(const TopEntry *a, const TopEntry *b)
+{
+    return a->move.score < b->move.score ||
+           (a->move.score == b->move.score && a->seq > b->seq);
+}
+
+static void top_sift_down(TopK *top, int i)
+{
+    for (;;) {
+        int worst = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        if (left < top->count && top_worse(&top->heap[left], &top->heap[worst])) {
+            worst = left;
+        }
+        if (right < top->count && top_worse(&top->heap[right], &top->heap[worst])) {
+            worst = right;
+        }
+        if (worst == i) {
+            return;
+        }
+        TopEntry swap = top->heap[i];
+        top->heap[i] = top->heap[worst];
+        top->heap[worst] = swap;
+        i = worst;
+    }
+}
+
+static bool top_visit(const Move *move, void *context)
+{
+    TopK *top = (TopK *)context;
+
+    /* Rows arrive whole but maybe reordered; rank by line, then position in it */
+    int line = move->direction * BOARD_MAX_SIZE +
+               (move->direction == MOVE_ACROSS ? move->row : move->col);
+    if (line != top->line) {
+        top->line = line;
+        top->position = 0;
+    }
+    TopEntry entry = { *move, (uint32_t)line << 24 | top->position++ };
+
+    if (top->count < top->capacity) {
+        int i = top->count++;
+        top->heap[i] = entry;
+        while (i > 0 && top_worse(&top->heap[i], &top->heap[(i - 1) / 2])) {
+            TopEntry swap = top->heap[i];
+            top->heap[i] = top->heap[(i - 1) / 2];
+            top->heap[(i - 1) / 2] = swap;
+            i = (i - 1) / 2;
+        }
+    } else if (top_worse(&top->heap[0], &entry)) {
+        top->heap[0] = entry;
+        top_sift_down(top, 0);
+    } else {
+        return true;
+    }
+
+    /* Once full, nothing below the weakest kept move matters */
+    if (top->count == top->capacity) {
+        top->floor = top->heap[0].move.score;
+    }
+    return true;
+}
+
+static int compare_top(const void *a, const void *b)
+{
+    const TopEntry *x = (const TopEntry *)a;
+    const TopEntry *y = (const TopEntry *)b;
+    if (x->move.score != y->move.score) {
+        return x->move.score > y->move.score ? -1 : 1;
+    }
+    return x->seq < y->seq ? -1 : x->seq > y->seq;
+}
+
+/*
+ * The k highest-scoring placements, best first, into best. Ties keep
+ * generation order, so best[0] is the move movegen_best() would pick.
+ * Returns the number of moves stored.
+ */
+int movegen_top_k(const Dawg *dawg, const char *rack, Move *best, int k)
+{
+    TopK top;
+
+    if (k <= 0) {
+        return 0;
+    }
+    if (k > top_storage_capacity) {
+        TopEntry *grown = (TopEntry *)realloc(top_storage, k * sizeof(TopEntry));
+        if (!grown) {
+            return 0;
+        }
+        top_storage = grown;
+        top_storage_capacity = k;
+    }
+
+    top.heap = top_storage;
+    top.count = 0;
+    top.capacity = k;
+    top.line = -1;
+    top.position = 0;
+    top.floor = INT_MIN;
+    movegen_visit(dawg, rack, top_visit, &top, &top.floor);
+
+    qsort(top.heap, top.count, sizeof(TopEntry), compare_top);
+    for (int i = 0; i < top.count; i++) {
+        best[i] = top.heap[i].move;
+    }
+    return top.count;
+}
+
+/* Highest-scoring move, NULL if the list is empty */
+const Move* movegen_best(const MoveList *list)
+{
+    const Move *best = NULL;
+    for (int i = 0; i < list->count; i++) {
+        if (!best || list->moves[i].score > best->score) {
+            best = &list->moves[i];
+        }
+    }
+    return best;
+}
+
+/* Append the printed face of a machine letter */
+static int format_letter(const Alphabet *alphabet, char letter, char *out)
+{
+    const char *face = letter ? alphabet_spelling(alphabet, tiles_face(letter)) : NULL;
+    int length = face ? (int)strlen(face) : 1;
+    memcpy(out, face ? face : "?", length);
+
+    /* Blanks print in lowercase, where the spelling has a case */
+    for (int i = 0; i < length && tiles_is_blank(letter); i++) {
+        if (out[i] >= 'A' && out[i] <= 'Z') {
+            out[i] = (char)(out[i] - 'A' + 'a');
+        }
+    }
+    return length;
+}
+
+/*
+ * Format a move as "8H WE(F)T 24", spelling letters in the alphabet
+ * (English if NULL); played-through letters are in brackets.
+ */
+void movegen_format(const Move *move, const Alphabet *alphabet, char *buffer, int size)
+{
+    char word[BOARD_MAX_SIZE * (ALPHABET_MAX_SPELLING + 2) + 1];
+    int length = 0;
+
+    if (!alphabet) {
+        alphabet = alphabet_english();
+    }
+    if (move->type == MOVE_PASS) {
+        snprintf(buffer, size, "pass");
+        return;
+    }
+    if (move->type == MOVE_EXCHANGE) {
+        for (int i = 0; i < move->length; i++) {
+            length += format_letter(alphabet, move->tiles[i], word + length);
+        }
+        snprintf(buffer, size, "exchange %.*s", length, word);
+        return;
+    }
+
+    for (int i = 0; i < move->length; i++) {
+        int row = move->row + (move->direction == MOVE_DOWN ? i : 0);
+        int col = move->col + (move->direction == MOVE_ACROSS ? i : 0);
+        if (move->tiles[i]) {
+            length += format_letter(alphabet, move->tiles[i], word + length);
+        } else {
+            char letter = 0;
+            if (row >= 0 && row < BOARD_MAX_SIZE && col >= 0 && col < BOARD_MAX_SIZE) {
+                const BoardLayout *layout = board_layout();
+                letter = layout->letter[BOARD_ACROSS][row + 1][col + 1];
+                if (letter && (layout->flags[BOARD_ACROSS][row + 1][col + 1] & BOARD_SQUARE_BLANK)) {
+                    letter = tiles_blank_as(letter);
+                }
+            }
+            word[length++] = '(';
+            length += format_letter(alphabet, letter, word + length);
+            word[length++] = ')';
+        }
+    }
+    word[length] = '\0';
+
+    if (move->direction == MOVE_ACROSS) {
+        snprintf(buffer, size, "%d%c %s %d", move->row + 1, 'A' + move->col, word, move->score);
+    } else {
+        snprintf(buffer, size, "%c%d %s %d", 'A' + move->col, move->row + 1, word, move->score);
+    }
+}
@@ -0,0 +1,937 @@
+/**
+ * XScrabble - Move Generation Kernel
+ *
+ * The variant-specific half of move generation, included by movegen.c
+ * once per variant with KERNEL_VARIANT set to its VARIANT_LIST name. The
+ * board size, rack size and bingo bonus are that variant's constants, so
+ * every loop over a line has a fixed bound and the generator's tables are
+ * sized for its board alone. Each inclusion renames the kernel's types,
+ * state and functions with the variant as a suffix, so generate_STANDARD
+ * and generate_SUPER sit side by side; movegen.c dispatches on the board's
+ * variant. Shared helpers (Score, keep_largest, best_visit, line_moves)
+ * come from movegen.c.
+ */
+
+#ifndef KERNEL_VARIANT
+#error "Define KERNEL_VARIANT before including movegen_kernel.h"
+#endif
+
+#define KERNEL_JOIN(name, variant) name##_##variant
+#define KERNEL_EXPAND(name, variant) KERNEL_JOIN(name, variant)
+#define KERNEL(name) KERNEL_EXPAND(name, KERNEL_VARIANT)
+#define KERNEL_CONSTANT(variant, field) VARIANT_##variant##_##field
+#define KERNEL_PARAMETER(variant, field) KERNEL_CONSTANT(variant, field)
+
+#define KERNEL_SIZE KERNEL_PARAMETER(KERNEL_VARIANT, SIZE)
+#define KERNEL_RACK KERNEL_PARAMETER(KERNEL_VARIANT, RACK)
+#define KERNEL_BINGO KERNEL_PARAMETER(KERNEL_VARIANT, BINGO)
+#define KERNEL_PADDED (KERNEL_SIZE + 2)
+#define LAST KERNEL_SIZE        /* Padded index of the last board square on a line */
+#define CENTER (KERNEL_SIZE / 2 + 1)
+
+#define Generator KERNEL(Generator)
+#define LineKey KERNEL(LineKey)
+#define LineEntry KERNEL(LineEntry)
+#define LineCache KERNEL(LineCache)
+#define line_cache KERNEL(line_cache)
+#define load_grid KERNEL(load_grid)
+#define square_points KERNEL(square_points)
+#define cross_check KERNEL(cross_check)
+#define prepare_cross KERNEL(prepare_cross)
+#define prepare KERNEL(prepare)
+#define emit KERNEL(emit)
+#define emit_all KERNEL(emit_all)
+#define square_weight KERNEL(square_weight)
+#define place_blanks KERNEL(place_blanks)
+#define record KERNEL(record)
+#define place_tile KERNEL(place_tile)
+#define extend_right KERNEL(extend_right)
+#define left_part KERNEL(left_part)
+#define generate_row KERNEL(generate_row)
+#define row_bound KERNEL(row_bound)
+#define line_key KERNEL(line_key)
+#define line_hash KERNEL(line_hash)
+#define line_cache_check KERNEL(line_cache_check)
+#define generate_row_cached KERNEL(generate_row_cached)
+#define cache_free KERNEL(cache_free)
+#define cache_counts KERNEL(cache_counts)
+#define generator KERNEL(generator)
+#define load_rack KERNEL(load_rack)
+#define begin KERNEL(begin)
+#define generate_rows KERNEL(generate_rows)
+#define generate KERNEL(generate)
+#define best_scores KERNEL(best_scores)
+
+/* Working state for one generation call */
+typedef struct {
+    const Dawg *dawg;
+    MoveDirection direction;
+
+    /* Moves go to out, or to visit when it is set */
+    MoveList *out;
+    MoveVisitor visit;
+    void *context;
+    const int *floor;           /* Skip rows that cannot score this much */
+    bool stopped;
+    int emitted;
+
+    /* Board layout in generation orientation: machine letters or 0 */
+    const char (*grid)[BOARD_PADDED];
+    const char (*perpendicular)[BOARD_PADDED];      /* The other orientation: grid columns */
+    const uint8_t (*flags)[BOARD_PADDED];
+    const uint8_t (*perpendicular_flags)[BOARD_PADDED];
+    const uint8_t (*letter_mult)[BOARD_PADDED];
+    const uint8_t (*word_mult)[BOARD_PADDED];
+    uint32_t cross[KERNEL_PADDED][KERNEL_PADDED];     /* Letters allowed on empty squares */
+    int cross_score[KERNEL_PADDED][KERNEL_PADDED];    /* Perpendicular points, NO_CROSS_WORD if none */
+    uint32_t anchors[KERNEL_PADDED];                 /* Anchor bits by row */
+    const uint8_t (*anchor_list)[BOARD_MAX_SIZE];       /* From the board's anchor index */
+    const uint8_t *anchor_count;
+    const uint8_t (*left_limit)[BOARD_PADDED];
+    bool empty;                 /* Opening move: the centre is the only anchor */
+
+    int values[DAWG_LETTERS];
+    int rack[DAWG_LETTERS];
+    int blanks;
+    int rack_blanks;            /* Blanks on the rack before any were placed */
+    int rack_size;
+
+    /* Current line */
+    int row;
+    int anchor_col;
+    int start;
+    int placed;
+    char line[KERNEL_PADDED];    /* Tiles placed by the move being built */
+
+    /* Cross checks by direction and grid column, valid while the stamp matches */
+    uint64_t cross_serial;
+    int cross_values[DAWG_LETTERS];
+    uint64_t cross_stamp[2][KERNEL_PADDED];
+    uint32_t cross_cache[2][KERNEL_PADDED][KERNEL_PADDED];
+    int cross_score_cache[2][KERNEL_PADDED][KERNEL_PADDED];
+} Generator;
+
+/* Everything the moves of one line depend on, in generation orientation */
+typedef struct {
+    uint32_t cross[KERNEL_SIZE];
+    int16_t cross_score[KERNEL_SIZE];
+    char grid[KERNEL_SIZE];
+    uint8_t anchor[KERNEL_SIZE];
+    uint8_t letter_mult[KERNEL_SIZE];
+    uint8_t word_mult[KERNEL_SIZE];
+    uint8_t rack[DAWG_LETTERS];
+    uint8_t blanks;
+} LineKey;
+
+typedef struct {
+    uint64_t hash;              /* 0 = unused */
+    uint64_t used;
+    LineKey key;
+    Move *moves;
+    int count;
+    int capacity;
+} LineEntry;
+
+/* Per-thread line cache; cleared when the lexicon or tile values change */
+typedef struct {
+    uint64_t serial;
+    int values[DAWG_LETTERS];
+    uint64_t tick;
+    uint64_t hits;
+    uint64_t misses;
+    LineEntry entries[2][KERNEL_SIZE][LINE_CACHE_WAYS];
+} LineCache;
+
+static _Thread_local LineCache line_cache;
+
+/* Board preparation */
+
+/* Point the generator at the board layout for its direction */
+static void load_grid(Generator *g)
+{
+    const BoardLayout *layout = board_layout();
+    int d = g->direction;
+
+    g->grid = layout->letter[d];
+    g->perpendicular = layout->letter[!d];
+    g->flags = layout->flags[d];
+    g->perpendicular_flags = layout->flags[!d];
+    g->letter_mult = layout->letter_mult[d];
+    g->word_mult = layout->word_mult[d];
+}
+
+/* Face value of the tile on a square of a line; blanks score nothing */
+static inline int square_points(const Generator *g, const char *letters, const uint8_t *flags,
+                                int pos)
+{
+    return flags[pos] & BOARD_SQUARE_BLANK ? 0 : g->values[letters[pos] - ALPHABET_FIRST];
+}
+
+/* Letters that complete the vertical word through an empty square */
+static uint32_t cross_check(const Generator *g, int row, int col, int *points)
+{
+    const char *column = g->perpendicular[col];
+    const uint8_t *flags = g->perpendicular_flags[col];
+    int top = row;
+    int bottom = row;
+    while (column[top - 1]) {
+        top--;
+    }
+    while (column[bottom + 1]) {
+        bottom++;
+    }
+
+    if (top == row && bottom == row) {
+        *points = NO_CROSS_WORD;
+        return ALL_LETTERS;
+    }
+
+    /* Walk the part above the square */
+    const Dawg *dawg = g->dawg;
+    uint32_t node = dawg->root;
+    int sum = 0;
+    for (int r = top; r < row; r++) {
+        int letter = column[r] - ALPHABET_FIRST;
+        uint32_t index = dawg_find_edge(dawg, node, letter);
+        sum += square_points(g, column, flags, r);
+        if (!index) {
+            node = 0;
+            break;
+        }
+        node = dawg_edge_child(dawg->edges[index]);
+    }
+    for (int r = row + 1; r <= bottom; r++) {
+        sum += square_points(g, column, flags, r);
+    }
+    *points = sum;
+
+    if (!node) {
+        return 0;
+    }
+
+    /* Try each continuation against the part below */
+    uint32_t allowed = 0;
+    for (uint32_t i = node;; i++) {
+        uint32_t edge = dawg->edges[i];
+        uint32_t next = dawg_edge_child(edge);
+        bool terminal = dawg_edge_terminal(edge);
+
+        for (int r = row + 1; r <= bottom; r++) {
+            uint32_t index = dawg_find_edge(dawg, next, column[r] - ALPHABET_FIRST);
+            if (!index) {
+                terminal = false;
+                break;
+            }
+            terminal = dawg_edge_terminal(dawg->edges[index]);
+            next = dawg_edge_child(dawg->edges[index]);
+        }
+        if (terminal) {
+            allowed |= 1u << dawg_edge_letter(edge);
+        }
+        if (dawg_edge_last(edge)) {
+            break;
+        }
+    }
+    return allowed;
+}
+
+/*
+ * Cross checks for grid column c, reusing the last ones if its board line
+ * is unchanged. Only anchors (the bits of hooks) can have a cross word;
+ * every other empty square takes any letter.
+ */
+static void prepare_cross(Generator *g, int c, uint32_t hooks)
+{
+    int d = g->direction;
+    uint64_t stamp = d == MOVE_ACROSS ? board_col_stamp(c - FIRST) : board_row_stamp(c - FIRST);
+
+    if (g->cross_stamp[d][c] != stamp) {
+        for (int r = FIRST; r <= LAST; r++) {
+            g->cross_score_cache[d][c][r] = NO_CROSS_WORD;
+            g->cross_cache[d][c][r] = g->grid[r][c] ? 0 : ALL_LETTERS;
+        }
+        for (; hooks; hooks &= hooks - 1) {
+            int r = __builtin_ctz(hooks);
+            g->cross_cache[d][c][r] = cross_check(g, r, c, &g->cross_score_cache[d][c][r]);
+        }
+        g->cross_stamp[d][c] = stamp;
+    }
+    for (int r = FIRST; r <= LAST; r++) {
+        g->cross[r][c] = g->cross_cache[d][c][r];
+        g->cross_score[r][c] = g->cross_score_cache[d][c][r];
+    }
+}
+
+static void prepare(Generator *g)
+{
+    const BoardAnchors *index = board_anchors();
+    int d = g->direction;
+
+    load_grid(g);
+    memcpy(g->anchors, index->mask[d], sizeof(g->anchors));
+    g->anchor_list = index->list[d];
+    g->anchor_count = index->count[d];
+    g->left_limit = index->left_limit[d];
+    for (int c = FIRST; c <= LAST; c++) {
+        prepare_cross(g, c, index->mask[!d][c]);
+    }
+
+    /* The opening move must cover the centre square */
+    g->empty = index->tiles == 0;
+    if (g->empty) {
+        g->anchors[CENTER] = 1u << CENTER;
+    }
+}
+
+/* Recording */
+
+static void emit(Generator *g, const Move *move)
+{
+    g->emitted++;
+    if (g->visit) {
+        g->stopped = !g->visit(move, g->context);
+        return;
+    }
+
+    Move *slot = list_push(g->out);
+    if (slot) {
+        *slot = *move;
+    }
+}
+
+static void emit_all(Generator *g, const Move *moves, int count)
+{
+    for (int i = 0; i < count && !g->stopped; i++) {
+        emit(g, &moves[i]);
+    }
+}
+
+/* Letter points a tile placed at col counts for, per point of its face value */
+static int square_weight(const Generator *g, int col, int multiplier)
+{
+    int weight = multiplier;
+    if (g->cross_score[g->row][col] != NO_CROSS_WORD) {
+        weight += g->word_mult[g->row][col];
+    }
+    return weight * g->letter_mult[g->row][col];
+}
+
+/*
+ * Generation puts a blank on the last copies of a letter the move also
+ * plays from the rack. Move each such blank to the copy of its letter
+ * where a natural tile would score least, and return the points gained.
+ */
+static int place_blanks(const Generator *g, Move *move, int multiplier)
+{
+    int start = move->direction == MOVE_ACROSS ? move->col + FIRST : move->row + FIRST;
+    int gain = 0;
+
+    for (int i = 0; i < move->length; i++) {
+        char blank = move->tiles[i];
+        if (!tiles_is_blank(blank)) {
+            continue;
+        }
+        char face = tiles_face(blank);
+        int blank_weight = square_weight(g, start + i, multiplier);
+        int cheapest = -1;
+        int cheapest_weight = blank_weight;
+        for (int j = 0; j < move->length; j++) {
+            if (move->tiles[j] == face) {
+                int weight = square_weight(g, start + j, multiplier);
+                if (weight < cheapest_weight) {
+                    cheapest = j;
+                    cheapest_weight = weight;
+                }
+            }
+        }
+        if (cheapest >= 0) {
+            move->tiles[cheapest] = blank;
+            move->tiles[i] = face;
+            gain += g->values[face - ALPHABET_FIRST] * (blank_weight - cheapest_weight);
+        }
+    }
+    return gain;
+}
+
+static void record(Generator *g, int end, Score score)
+{
+    /* A lone tile that also forms an across word was already generated */
+    if (g->direction == MOVE_DOWN && g->placed == 1) {
+        for (int c = g->start; c < end; c++) {
+            if (g->line[c] && g->cross_score[g->row][c] != NO_CROSS_WORD) {
+                return;
+            }
+        }
+    }
+
+    Move move;
+    move.type = MOVE_PLACE;
+    move.direction = g->direction;
+    move.row = (g->direction == MOVE_ACROSS ? g->row : g->start) - FIRST;
+    move.col = (g->direction == MOVE_ACROSS ? g->start : g->row) - FIRST;
+    move.length = end - g->start;
+    move.tiles_played = g->placed;
+    for (int c = g->start; c < end; c++) {
+        move.tiles[c - g->start] = g->line[c];
+    }
+    move.score = score.main * score.multiplier + score.cross +
+                 (g->placed == KERNEL_RACK ? KERNEL_BINGO : 0);
+    if (g->blanks < g->rack_blanks) {
+        move.score += place_blanks(g, &move, score.multiplier);
+    }
+    emit(g, &move);
+}
+
+static Score place_tile(const Generator *g, Score score, int col, int letter, bool blank)
+{
+    int points = blank ? 0 : g->values[letter] * g->letter_mult[g->row][col];
+    int multiplier = g->word_mult[g->row][col];
+
+    score.main += points;
+    score.multiplier *= multiplier;
+    if (g->cross_score[g->row][col] != NO_CROSS_WORD) {
+        score.cross += (g->cross_score[g->row][col] + points) * multiplier;
+    }
+    return score;
+}
+
+/* Extend the partial word rightwards from col */
+static void extend_right(Generator *g, uint32_t node, int col, bool terminal, Score score)
+{
+    const Dawg *dawg = g->dawg;
+
+    if (g->stopped) {
+        return;
+    }
+    if (g->grid[g->row][col]) {
+        /* Play through the tile already on the board */
+        int letter = g->grid[g->row][col] - ALPHABET_FIRST;
+        uint32_t index = dawg_find_edge(dawg, node, letter);
+        if (index) {
+            score.main += square_points(g, g->grid[g->row], g->flags[g->row], col);
+            extend_right(g, dawg_edge_child(dawg->edges[index]), col + 1,
+                         dawg_edge_terminal(dawg->edges[index]), score);
+        }
+        return;
+    }
+
+    if (terminal && col > g->anchor_col && g->placed > 0 && col - g->start >= 2) {
+        record(g, col, score);
+    }
+    if (col > LAST || !node) {
+        return;
+    }
+
+    uint32_t allowed = g->cross[g->row][col];
+    for (uint32_t i = node;; i++) {
+        uint32_t edge = dawg->edges[i];
+        int letter = dawg_edge_letter(edge);
+
+        if (allowed >> letter & 1) {
+            if (g->rack[letter] > 0) {
+                g->rack[letter]--;
+                g->placed++;
+                g->line[col] = alphabet_letter(letter);
+                extend_right(g, dawg_edge_child(edge), col + 1, dawg_edge_terminal(edge),
+                             place_tile(g, score, col, letter, false));
+                g->line[col] = 0;
+                g->placed--;
+                g->rack[letter]++;
+            } else if (g->blanks > 0) {
+                g->blanks--;
+                g->placed++;
+                g->line[col] = tiles_blank_as(alphabet_letter(letter));
+                extend_right(g, dawg_edge_child(edge), col + 1, dawg_edge_terminal(edge),
+                             place_tile(g, score, col, letter, true));
+                g->line[col] = 0;
+                g->placed--;
+                g->blanks++;
+            }
+        }
+        if (dawg_edge_last(edge)) {
+            break;
+        }
+    }
+}
+
+/* Build left parts of up to limit tiles on empty squares before the anchor */
+static void left_part(Generator *g, uint32_t node, int limit, char *prefix, int length)
+{
+    /* The prefix now occupies the squares just left of the anchor */
+    Score score = {0, 1, 0};
+    g->start = g->anchor_col - length;
+    for (int i = 0; i < length; i++) {
+        int col = g->start + i;
+        g->line[col] = prefix[i];
+        score = place_tile(g, score, col, tiles_face(prefix[i]) - ALPHABET_FIRST,
+                           tiles_is_blank(prefix[i]));
+    }
+    extend_right(g, node, g->anchor_col, false, score);
+    for (int i = 0; i < length; i++) {
+        g->line[g->start + i] = 0;
+    }
+
+    if (limit == 0 || !node || g->stopped) {
+        return;
+    }
+
+    const Dawg *dawg = g->dawg;
+    for (uint32_t i = node;; i++) {
+        uint32_t edge = dawg->edges[i];
+        int letter = dawg_edge_letter(edge);
+
+        if (g->rack[letter] > 0) {
+            g->rack[letter]--;
+            g->placed++;
+            prefix[length] = alphabet_letter(letter);
+            left_part(g, dawg_edge_child(edge), limit - 1, prefix, length + 1);
+            g->placed--;
+            g->rack[letter]++;
+        } else if (g->blanks > 0) {
+            g->blanks--;
+            g->placed++;
+            prefix[length] = tiles_blank_as(alphabet_letter(letter));
+            left_part(g, dawg_edge_child(edge), limit - 1, prefix, length + 1);
+            g->placed--;
+            g->blanks++;
+        }
+        if (dawg_edge_last(edge)) {
+            break;
+        }
+    }
+}
+
+static void generate_row(Generator *g, int row)
+{
+    const Dawg *dawg = g->dawg;
+    static const uint8_t centre[1] = { CENTER };
+    const uint8_t *anchors = g->empty ? centre : g->anchor_list[row];
+    int count = g->empty ? row == CENTER : g->anchor_count[row];
+    char prefix[KERNEL_SIZE];
+
+    g->row = row;
+    for (int i = 0; i < count && !g->stopped; i++) {
+        int col = anchors[i];
+        g->anchor_col = col;
+
+        if (g->grid[row][col - 1]) {
+            /* The left part is the run of tiles already on the board */
+            int start = col - 1;
+            while (g->grid[row][start - 1]) {
+                start--;
+            }
+
+            uint32_t node = dawg->root;
+            Score score = {0, 1, 0};
+            for (int c = start; c < col && node; c++) {
+                int letter = g->grid[row][c] - ALPHABET_FIRST;
+                uint32_t index = dawg_find_edge(dawg, node, letter);
+                node = index ? dawg_edge_child(dawg->edges[index]) : 0;
+                score.main += square_points(g, g->grid[row], g->flags[row], c);
+            }
+            if (node) {
+                g->start = start;
+                extend_right(g, node, col, false, score);
+            }
+            continue;
+        }
+
+        /* Left parts may use empty squares that are not anchors themselves */
+        int limit = g->left_limit[row][col];
+        if (limit > g->rack_size - 1) {
+            limit = g->rack_size > 0 ? g->rack_size - 1 : 0;
+        }
+        left_part(g, dawg->root, limit, prefix, 0);
+    }
+}
+
+/* Score bounds */
+
+/*
+ * No move in the row scores more than this. A move fills every empty
+ * square of its word, so each span that could be a word (bounded by empty
+ * squares, covering an anchor, needing no more tiles than the rack holds)
+ * is scored with its real premiums, the best rack tiles on its best letter
+ * squares and the best tile in every cross word.
+ */
+static int row_bound(const Generator *g, int row)
+{
+    int tiles[KERNEL_SIZE];
+    int tile_count = 0;
+    int best_value = 0;
+    uint32_t rack_letters = 0;
+    int bound = 0;
+
+    for (int letter = 0; letter < DAWG_LETTERS; letter++) {
+        for (int k = 0; k < g->rack[letter] && k < KERNEL_SIZE; k++) {
+            keep_largest(tiles, &tile_count, KERNEL_SIZE, g->values[letter]);
+        }
+        if (g->rack[letter]) {
+            rack_letters |= 1u << letter;
+            if (g->values[letter] > best_value) {
+                best_value = g->values[letter];
+            }
+        }
+    }
+    for (int k = 0; k < g->blanks && k < KERNEL_SIZE; k++) {
+        keep_largest(tiles, &tile_count, KERNEL_SIZE, 0);
+        rack_letters = ALL_LETTERS;
+    }
+
+    for (int start = FIRST; start <= LAST; start++) {
+        int letter_mult[KERNEL_SIZE];
+        int empty = 0;
+        int board = 0;
+        int multiplier = 1;
+        int cross = 0;
+        bool anchored = false;
+
+        if (g->grid[row][start - 1]) {
+            continue;
+        }
+        for (int end = start; end <= LAST; end++) {
+            if (g->grid[row][end]) {
+                board += square_points(g, g->grid[row], g->flags[row], end);
+            } else {
+                if (empty == tile_count || !(g->cross[row][end] & rack_letters)) {
+                    break;
+                }
+                keep_largest(letter_mult, &empty, KERNEL_SIZE, g->letter_mult[row][end]);
+                multiplier *= g->word_mult[row][end];
+                if (g->cross_score[row][end] != NO_CROSS_WORD) {
+                    cross += (g->cross_score[row][end] + best_value * g->letter_mult[row][end]) *
+                             g->word_mult[row][end];
+                }
+                anchored |= g->anchors[row] >> end & 1;
+            }
+            if (!anchored || end == start || g->grid[row][end + 1]) {
+                continue;
+            }
+
+            int main = board;
+            for (int i = 0; i < empty; i++) {
+                main += tiles[i] * letter_mult[i];
+            }
+            int score = main * multiplier + cross + (empty == KERNEL_RACK ? KERNEL_BINGO : 0);
+            if (score > bound) {
+                bound = score;
+            }
+        }
+    }
+    return bound;
+}
+
+/* Line cache */
+
+static void line_key(const Generator *g, int row, LineKey *key)
+{
+    memset(key, 0, sizeof(*key));
+    for (int c = 0; c < KERNEL_SIZE; c++) {
+        key->cross[c] = g->cross[row][c + FIRST];
+        key->cross_score[c] = (int16_t)g->cross_score[row][c + FIRST];
+        key->grid[c] = g->grid[row][c + FIRST] |
+                       (g->flags[row][c + FIRST] & BOARD_SQUARE_BLANK ? TILE_BLANK_BIT : 0);
+        key->anchor[c] = g->anchors[row] >> (c + FIRST) & 1;
+        key->letter_mult[c] = g->letter_mult[row][c + FIRST];
+        key->word_mult[c] = g->word_mult[row][c + FIRST];
+    }
+    for (int letter = 0; letter < DAWG_LETTERS; letter++) {
+        key->rack[letter] = (uint8_t)g->rack[letter];
+    }
+    key->blanks = (uint8_t)g->blanks;
+}
+
+static uint64_t line_hash(const LineKey *key)
+{
+    const unsigned char *bytes = (const unsigned char *)key;
+    uint64_t hash = 0x9e3779b97f4a7c15ULL;
+
+    for (size_t i = 0; i + 8 <= sizeof(*key); i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        hash = (hash ^ word) * 0xbf58476d1ce4e5b9ULL;
+        hash ^= hash >> 31;
+    }
+    return hash | 1;
+}
+
+/* Drop every cached line when the lexicon or the tile values change */
+static void line_cache_check(const Generator *g)
+{
+    if (line_cache.serial == g->dawg->serial &&
+        memcmp(line_cache.values, g->values, sizeof(g->values)) == 0) {
+        return;
+    }
+    for (int d = 0; d < 2; d++) {
+        for (int row = 0; row < KERNEL_SIZE; row++) {
+            for (int way = 0; way < LINE_CACHE_WAYS; way++) {
+                line_cache.entries[d][row][way].hash = 0;
+            }
+        }
+    }
+    line_cache.serial = g->dawg->serial;
+    memcpy(line_cache.values, g->values, sizeof(g->values));
+}
+
+/* Generate a row, or copy its moves from the last time it looked the same */
+static void generate_row_cached(Generator *g, int row)
+{
+    LineEntry *ways = line_cache.entries[g->direction][row - FIRST];
+    LineEntry *victim = &ways[0];
+    LineKey key;
+
+    line_key(g, row, &key);
+    uint64_t hash = line_hash(&key);
+    line_cache.tick++;
+
+    for (int way = 0; way < LINE_CACHE_WAYS; way++) {
+        LineEntry *entry = &ways[way];
+        if (entry->hash == hash && memcmp(&entry->key, &key, sizeof(key)) == 0) {
+            entry->used = line_cache.tick;
+            line_cache.hits++;
+            emit_all(g, entry->moves, entry->count);
+            return;
+        }
+        if (entry->used < victim->used) {
+            victim = entry;
+        }
+    }
+
+    /* Miss: generate the whole line into a list, then keep a copy of it */
+    MoveVisitor visit = g->visit;
+    MoveList *out = g->out;
+    int emitted = g->emitted;
+    if (visit) {
+        line_moves.count = 0;
+        g->out = &line_moves;
+        g->visit = NULL;
+    }
+    int first = g->out->count;
+    line_cache.misses++;
+    generate_row(g, row);
+
+    const Move *moves = g->out->moves + first;
+    int count = g->out->count - first;
+    g->out = out;
+    g->visit = visit;
+    if (visit) {
+        g->emitted = emitted;
+        emit_all(g, moves, count);
+    }
+
+    if (count > victim->capacity) {
+        Move *grown = (Move *)realloc(victim->moves, count * sizeof(Move));
+        if (!grown) {
+            victim->hash = 0;
+            return;
+        }
+        victim->moves = grown;
+        victim->capacity = count;
+    }
+    if (count > 0) {
+        memcpy(victim->moves, moves, count * sizeof(Move));
+    }
+    victim->count = count;
+    victim->key = key;
+    victim->hash = hash;
+    victim->used = line_cache.tick;
+}
+
+/* Release this variant's cached moves */
+static void cache_free(void)
+{
+    for (int d = 0; d < 2; d++) {
+        for (int row = 0; row < KERNEL_SIZE; row++) {
+            for (int way = 0; way < LINE_CACHE_WAYS; way++) {
+                LineEntry *entry = &line_cache.entries[d][row][way];
+                free(entry->moves);
+                memset(entry, 0, sizeof(*entry));
+            }
+        }
+    }
+    line_cache.hits = 0;
+    line_cache.misses = 0;
+}
+
+/* Add this variant's line cache hits and misses */
+static void cache_counts(uint64_t *hits, uint64_t *misses)
+{
+    *hits += line_cache.hits;
+    *misses += line_cache.misses;
+}
+
+static _Thread_local Generator generator;
+
+/* Count the rack's tiles by letter, and its blanks */
+static void load_rack(Generator *g, const char *rack)
+{
+    memset(g->rack, 0, sizeof(g->rack));
+    g->blanks = 0;
+    g->rack_size = 0;
+    for (const char *p = rack; *p; p++) {
+        int letter = *p == TILE_BLANK ? -1 : dawg_letter_index(*p);
+        if (letter >= 0) {
+            g->rack[letter]++;
+            g->rack_size++;
+        } else if (*p == TILE_BLANK) {
+            g->blanks++;
+            g->rack_size++;
+        }
+    }
+    g->rack_blanks = g->blanks;
+}
+
+/* Reset the generator for a call and drop caches that belong to another lexicon */
+static void begin(Generator *g, const Dawg *dawg, MoveList *list,
+                  MoveVisitor visit, void *context, const int *floor)
+{
+    for (int letter = 0; letter < DAWG_LETTERS; letter++) {
+        g->values[letter] = tiles_letter_value(alphabet_letter(letter));
+    }
+
+    g->dawg = dawg;
+    g->out = list;
+    g->visit = visit;
+    g->context = context;
+    g->floor = floor;
+    g->stopped = false;
+    g->emitted = 0;
+    g->placed = 0;
+    memset(g->line, 0, sizeof(g->line));
+
+    /* Cached cross checks belong to one lexicon and tile set */
+    if (g->cross_serial != dawg->serial ||
+        memcmp(g->cross_values, g->values, sizeof(g->values)) != 0) {
+        memset(g->cross_stamp, 0xff, sizeof(g->cross_stamp));
+        g->cross_serial = dawg->serial;
+        memcpy(g->cross_values, g->values, sizeof(g->values));
+    }
+    if (!cache_disabled) {
+        line_cache_check(g);
+    }
+}
+
+/* Generate the rows of the prepared direction; with a floor, promising rows go first */
+static void generate_rows(Generator *g, bool cached)
+{
+    int rows[KERNEL_SIZE];
+    int bounds[KERNEL_SIZE];
+    int row_count = 0;
+
+    for (int row = FIRST; row <= LAST; row++) {
+        if (!g->anchors[row]) {
+            continue;
+        }
+        int i = row_count++;
+        int bound = g->floor ? row_bound(g, row) : 0;
+        while (i > 0 && bounds[i - 1] < bound) {
+            rows[i] = rows[i - 1];
+            bounds[i] = bounds[i - 1];
+            i--;
+        }
+        rows[i] = row;
+        bounds[i] = bound;
+    }
+
+    for (int i = 0; i < row_count && !g->stopped; i++) {
+        int row = rows[i];
+        if (g->floor && bounds[i] < *g->floor) {
+            break;
+        }
+        if (cached) {
+            generate_row_cached(g, row);
+        } else {
+            generate_row(g, row);
+        }
+    }
+}
+
+/* Run one generation call, sending moves to the list or the visitor */
+static int generate(const Dawg *dawg, const char *rack, MoveList *list,
+                    MoveVisitor visit, void *context, const int *floor)
+{
+    Generator *g = &generator;
+
+    if (!dawg->root) {
+        return 0;
+    }
+
+    load_rack(g, rack);
+    begin(g, dawg, list, visit, context, floor);
+    for (int direction = MOVE_ACROSS; direction <= MOVE_DOWN && !g->stopped; direction++) {
+        g->direction = (MoveDirection)direction;
+        prepare(g);
+        generate_rows(g, !cache_disabled);
+    }
+    return g->emitted;
+}
+
+
+/*
+ * Best placement score for each of count racks on the current board, or
+ * -1 where a rack has none. The board is prepared once per direction for
+ * the whole batch, and each rack only generates rows that can beat its
+ * best so far. Racks rarely repeat, so the line cache is bypassed.
+ */
+static void best_scores(const Dawg *dawg, const char *const *racks, int count, int *scores)
+{
+    Generator *g = &generator;
+
+    begin(g, dawg, NULL, best_visit, NULL, NULL);
+    for (int direction = MOVE_ACROSS; direction <= MOVE_DOWN; direction++) {
+        g->direction = (MoveDirection)direction;
+        prepare(g);
+        for (int i = 0; i < count; i++) {
+            load_rack(g, racks[i]);
+            g->context = &scores[i];
+            g->floor = &scores[i];
+            generate_rows(g, false);
+        }
+    }
+}
+
+#undef Generator
+#undef LineKey
+#undef LineEntry
+#undef LineCache
+#undef line_cache
+#undef load_grid
+#undef square_points
+#undef cross_check
+#undef prepare_cross
+#undef prepare
+#undef emit
+#undef emit_all
+#undef square_weight
+#undef place_blanks
+#undef record
+#undef place_tile
+#undef extend_right
+#undef left_part
+#undef generate_row
+#undef row_bound
+#undef line_key
+#undef line_hash
+#undef line_cache_check
+#undef generate_row_cached
+#undef cache_free
+#undef cache_counts
+#undef generator
+#undef load_rack
+#undef begin
+#undef generate_rows
+#undef generate
+#undef best_scores
+
+#undef KERNEL_JOIN
+#undef KERNEL_EXPAND
+#undef KERNEL
+#undef KERNEL_CONSTANT
+#undef KERNEL_PARAMETER
+#undef KERNEL_SIZE
+#undef KERNEL_RACK
+#undef KERNEL_BINGO
+#undef KERNEL_PADDED
+#undef LAST
+#undef CENTER
+#undef KERNEL_VARIANT
@@ -0,0 +1,319 @@
+/**
+ * XScrabble - Quiz Engine Implementation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include "quiz.h"
+
+/* Part of speech paired with its entry, for grouping */
+typedef struct {
+    const char *speech;
+    int entry;
+} SpeechKey;
+
+/* splitmix64 step, as for the bag shuffle */
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static int random_below(uint64_t *state, int n)
+{
+    return (int)(next_random(state) % (uint64_t)n);
+}
+
+static int compare_speech(const void *a, const void *b)
+{
+    const SpeechKey *x = (const SpeechKey *)a;
+    const SpeechKey *y = (const SpeechKey *)b;
+    int cmp = strcmp(x->speech, y->speech);
+    return cmp ? cmp : x->entry - y->entry;
+}
+
+/* First ASCII case-insensitive occurrence of word in text, or NULL */
+static const char* find_word(const char *text, const char *word)
+{
+    size_t length = strlen(word);
+    if (length == 0) {
+        return NULL;
+    }
+    for (const char *p = text; *p; p++) {
+        if (strncasecmp(p, word, length) == 0) {
+            return p;
+        }
+    }
+    return NULL;
+}
+
+/* The text a question of this kind expects for an entry, or NULL */
+static const char* answer_text(const DictionaryEntry *entry, QuizKind kind)
+{
+    switch (kind) {
+    case QUIZ_MEANING:
+        return entry->english_definition;
+    case QUIZ_DEFINITION:
+        return entry->definition;
+    default:
+        return entry->word;
+    }
+}
+
+/* Work out every question each entry can give, once */
+bool quiz_bank_build(QuizBank *bank, const DictionaryEntry *entries, int count)
+{
+    size_t blank_bytes = 0;
+
+    memset(bank, 0, sizeof(*bank));
+    bank->entries = entries;
+    bank->count = count;
+    bank->kinds = (uint8_t *)calloc(count > 0 ? count : 1, sizeof(uint8_t));
+    bank->blank_offsets = (uint32_t *)calloc(count > 0 ? count : 1, sizeof(uint32_t));
+    bank->by_speech = (int *)malloc((count > 0 ? count : 1) * sizeof(int));
+    bank->group_first = (int *)malloc((count > 0 ? count : 1) * sizeof(int));
+    bank->group_size = (int *)malloc((count > 0 ? count : 1) * sizeof(int));
+    SpeechKey *keys = (SpeechKey *)malloc((count > 0 ? count : 1) * sizeof(SpeechKey));
+    if (!bank->kinds || !bank->blank_offsets || !bank->by_speech || !bank->group_first ||
+        !bank->group_size || !keys) {
+        fprintf(stderr, "Failed to allocate quiz bank for %d entries\n", count);
+        free(keys);
+        quiz_bank_free(bank);
+        return false;
+    }
+
+    /* Which kinds each entry supports, and room for its blanked example */
+    for (int i = 0; i < count; i++) {
+        const DictionaryEntry *entry = &entries[i];
+        if (entry->definition) {
+            bank->kinds[i] |= 1u << QUIZ_DEFINITION;
+        }
+        if (entry->english_definition) {
+            bank->kinds[i] |= 1u << QUIZ_MEANING | 1u << QUIZ_WORD;
+        }
+        if (entry->example && find_word(entry->example, entry->word)) {
+            bank->kinds[i] |= 1u << QUIZ_BLANK;
+            bank->blank_offsets[i] = (uint32_t)blank_bytes;
+            blank_bytes += strlen(entry->example) + 1;
+        }
+    }
+
+    bank->blanks = (char *)malloc(blank_bytes + 1);
+    if (!bank->blanks) {
+        fprintf(stderr, "Failed to allocate %zu bytes of quiz examples\n", blank_bytes);
+        free(keys);
+        quiz_bank_free(bank);
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        if (bank->kinds[i] & 1u << QUIZ_BLANK) {
+            char *blanked = bank->blanks + bank->blank_offsets[i];
+            strcpy(blanked, entries[i].example);
+            char *at = blanked + (find_word(entries[i].example, entries[i].word) - entries[i].example);
+            memset(at, '_', strlen(entries[i].word));
+        }
+    }
+
+    /* Group entries by part of speech for distractors */
+    for (int i = 0; i < count; i++) {
+        keys[i].speech = entries[i].part_of_speech ? entries[i].part_of_speech : "";
+        keys[i].entry = i;
+    }
+    qsort(keys, count, sizeof(SpeechKey), compare_speech);
+    for (int start = 0; start < count; ) {
+        int end = start + 1;
+        while (end < count && strcmp(keys[end].speech, keys[start].speech) == 0) {
+            end++;
+        }
+        for (int i = start; i < end; i++) {
+            bank->by_speech[i] = keys[i].entry;
+            bank->group_first[keys[i].entry] = start;
+            bank->group_size[keys[i].entry] = end - start;
+        }
+        start = end;
+    }
+
+    free(keys);
+    return true;
+}
+
+void quiz_bank_free(QuizBank *bank)
+{
+    free(bank->kinds);
+    free(bank->blank_offsets);
+    free(bank->blanks);
+    free(bank->by_speech);
+    free(bank->group_first);
+    free(bank->group_size);
+    memset(bank, 0, sizeof(*bank));
+}
+
+/* Start a deck over the entries that can be asked; the only allocation a deck makes */
+bool quiz_deck_init(QuizDeck *deck, const QuizBank *bank, uint64_t seed)
+{
+    memset(deck, 0, sizeof(*deck));
+    deck->bank = bank;
+    deck->rng = seed;
+    deck->order = (int *)malloc((bank->count > 0 ? bank->count : 1) * sizeof(int));
+    if (!deck->order) {
+        return false;
+    }
+    for (int i = 0; i < bank->count; i++) {
+        if (bank->kinds[i]) {
+            deck->order[deck->size++] = i;
+        }
+    }
+    deck->remaining = deck->size;
+    return true;
+}
+
+void quiz_deck_free(QuizDeck *deck)
+{
+    free(deck->order);
+    memset(deck, 0, sizeof(*deck));
+}
+
+/* Whether entry may stand as a wrong answer next to the ones already chosen */
+static bool usable_distractor(const QuizBank *bank, const QuizQuestion *question, int entry)
+{
+    const char *text = answer_text(&bank->entries[entry], question->kind);
+    if (entry == question->entry || !text) {
+        return false;
+    }
+    for (int i = 0; i < question->choice_count; i++) {
+        if (strcmp(question->choices[i], text) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Add wrong answers from slots[0..size), starting at a random slot */
+static void add_distractors(QuizDeck *deck, QuizQuestion *question, const int *slots, int size)
+{
+    const QuizBank *bank = deck->bank;
+    int start = size > 0 ? random_below(&deck->rng, size) : 0;
+
+    for (int i = 0; i < size && question->choice_count < QUIZ_CHOICES; i++) {
+        int entry = slots ? slots[(start + i) % size] : (start + i) % size;
+        if (usable_distractor(bank, question, entry)) {
+            question->choices[question->choice_count++] =
+                answer_text(&bank->entries[entry], question->kind);
+        }
+    }
+}
+
+/*
+ * Draw the next question. Each askable entry comes up once before any
+ * repeats; when the deck runs out it starts a new pass. Returns false
+ * only if the bank has nothing to ask.
+ */
+bool quiz_next(QuizDeck *deck, QuizQuestion *question)
+{
+    const QuizBank *bank = deck->bank;
+
+    if (deck->size == 0) {
+        return false;
+    }
+    if (deck->remaining == 0) {
+        deck->remaining = deck->size;
+    }
+
+    /* Partial Fisher-Yates: swap the drawn entry behind the remaining ones */
+    int slot = random_below(&deck->rng, deck->remaining);
+    int entry = deck->order[slot];
+    deck->order[slot] = deck->order[--deck->remaining];
+    deck->order[deck->remaining] = entry;
+
+    /* Pick one of the kinds this entry supports */
+    unsigned kinds = bank->kinds[entry];
+    int pick = random_below(&deck->rng, __builtin_popcount(kinds));
+    int kind = 0;
+    while (!(kinds >> kind & 1) || pick-- > 0) {
+        kind++;
+    }
+
+    const DictionaryEntry *source = &bank->entries[entry];
+    memset(question, 0, sizeof(*question));
+    question->kind = (QuizKind)kind;
+    question->entry = entry;
+    question->answer = answer_text(source, question->kind);
+    switch (question->kind) {
+    case QUIZ_MEANING:
+        question->prompt = source->word;
+        question->hint = source->definition;
+        break;
+    case QUIZ_WORD:
+        question->prompt = source->english_definition;
+        break;
+    case QUIZ_BLANK:
+        question->prompt = bank->blanks + bank->blank_offsets[entry];
+        question->hint = source->definition;
+        break;
+    default:
+        question->prompt = source->word;
+        question->hint = source->part_of_speech;
+        break;
+    }
+
+    /* Wrong answers from the same part of speech first, then from anywhere */
+    question->choices[question->choice_count++] = question->answer;
+    add_distractors(deck, question, bank->by_speech + bank->group_first[entry],
+                    bank->group_size[entry]);
+    add_distractors(deck, question, NULL, bank->count);
+
+    /* Move the right answer to a random place */
+    question->correct = random_below(&deck->rng, question->choice_count);
+    question->choices[0] = question->choices[question->correct];
+    question->choices[question->correct] = question->answer;
+    return true;
+}
+
+/* Letters and digits, and any byte of a UTF-8 sequence, make up words */
+static bool word_byte(char c)
+{
+    return isalnum((unsigned char)c) || (unsigned char)c >= 0x80;
+}
+
+/*
+ * Mark a response: a choice number (1-4) or letter (a-d), or the answer
+ * itself. Words must match exactly, ignoring case; glosses and definitions
+ * may be given in part, as whole words. A single character is only ever a
+ * choice.
+ */
+bool quiz_check(const QuizQuestion *question, const char *response)
+{
+    while (isspace((unsigned char)*response)) {
+        response++;
+    }
+    size_t length = strlen(response);
+    while (length > 0 && isspace((unsigned char)response[length - 1])) {
+        length--;
+    }
+    if (length == 0) {
+        return false;
+    }
+
+    if (length == 1) {
+        int choice = tolower((unsigned char)response[0]);
+        choice = choice >= 'a' ? choice - 'a' : choice - '1';
+        return choice >= 0 && choice < question->choice_count && choice == question->correct;
+    }
+
+    if (question->kind == QUIZ_WORD || question->kind == QUIZ_BLANK) {
+        return strlen(question->answer) == length &&
+               strncasecmp(question->answer, response, length) == 0;
+    }
+    for (const char *p = question->answer; *p; p++) {
+        if ((p == question->answer || !word_byte(p[-1])) && strncasecmp(p, response, length) == 0 &&
+            !word_byte(p[length])) {
+            return true;
+        }
+    }
+    return false;
+}
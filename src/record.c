@@ -0,0 +1,459 @@
+/**
+ * XScrabble - Game Record Implementation
+ *
+ * Records are self-contained: they carry both opening racks and every
+ * draw, so a game can be replayed without the bag or the lexicon.
+ * Integers are unsigned LEB128 varints; scores are zigzag encoded.
+ *
+ *   header  "XSGR", version byte, variant byte, seed, lexicon (length +
+ *           bytes), tiles left in the bag, rack 0, rack 1 (length + letters)
+ *   move    tag (type | direction << 2 | player << 3), then
+ *             place:    square (row * board size + col), length,
+ *                       tiles (0 = played through),
+ *                       blank mask, score, draws
+ *             exchange: tiles, score, draws
+ *             pass:     score
+ *   end     RECORD_TAG_END, two final scores
+ *
+ * Letters are stored uppercase; a set bit in the blank mask marks a tile
+ * played as a blank, which decodes to lowercase. Version 2 records,
+ * which have no variant byte, are standard games and are still read.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "record.h"
+#include "board.h"
+#include "tiles.h"
+
+#define RECORD_TAG_END 0x10
+
+static bool record_reserve(GameRecord *record, size_t extra)
+{
+    if (record->size + extra <= record->capacity) {
+        return true;
+    }
+
+    size_t capacity = record->capacity ? record->capacity : 256;
+    while (capacity < record->size + extra) {
+        capacity *= 2;
+    }
+    uint8_t *grown = (uint8_t *)realloc(record->data, capacity);
+    if (!grown) {
+        return false;
+    }
+    record->data = grown;
+    record->capacity = capacity;
+    return true;
+}
+
+static void put_byte(GameRecord *record, uint8_t value)
+{
+    record->data[record->size++] = value;
+}
+
+static void put_varint(GameRecord *record, uint64_t value)
+{
+    while (value >= 0x80) {
+        put_byte(record, (uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    put_byte(record, (uint8_t)value);
+}
+
+static void put_score(GameRecord *record, int value)
+{
+    put_varint(record, ((uint64_t)(uint32_t)value << 1) ^ (uint64_t)(int64_t)(value >> 31));
+}
+
+/* Length-prefixed letters, at most max of them */
+static void put_letters(GameRecord *record, const char *letters, size_t max)
+{
+    size_t length = strnlen(letters, max);
+    put_varint(record, length);
+    for (size_t i = 0; i < length; i++) {
+        put_byte(record, (uint8_t)tiles_face(letters[i]));
+    }
+}
+
+void record_init(GameRecord *record)
+{
+    record->data = NULL;
+    record->size = 0;
+    record->capacity = 0;
+}
+
+void record_free(GameRecord *record)
+{
+    free(record->data);
+    record_init(record);
+}
+
+/* Start a record for the game just dealt into state */
+bool record_begin(GameRecord *record, const char *lexicon, const GameState *state)
+{
+    record->size = 0;
+    if (!record_reserve(record, 32 + RECORD_LEXICON_MAX + 2 * RACK_SIZE)) {
+        return false;
+    }
+
+    memcpy(record->data, RECORD_MAGIC, 4);
+    record->size = 4;
+    put_byte(record, RECORD_VERSION);
+    put_byte(record, (uint8_t)board_variant()->id);
+    put_varint(record, state->seed);
+    size_t length = lexicon ? strnlen(lexicon, RECORD_LEXICON_MAX - 1) : 0;
+    put_varint(record, length);
+    for (size_t i = 0; i < length; i++) {
+        put_byte(record, (uint8_t)lexicon[i]);
+    }
+    put_varint(record, (uint64_t)state->tiles_left);
+    put_letters(record, state->racks[0], RACK_SIZE);
+    put_letters(record, state->racks[1], RACK_SIZE);
+    return true;
+}
+
+/* Append one move and the tiles drawn after it */
+bool record_add_move(GameRecord *record, int player, const Move *move, const char *drawn)
+{
+    if (!record_reserve(record, 32 + 2 * BOARD_MAX_SIZE)) {
+        return false;
+    }
+
+    put_varint(record, (uint64_t)(move->type | move->direction << 2 | player << 3));
+    if (move->type == MOVE_PLACE) {
+        uint32_t blanks = 0;
+        put_varint(record, (uint64_t)(move->row * board_size() + move->col));
+        put_varint(record, move->length);
+        for (int i = 0; i < move->length; i++) {
+            char tile = move->tiles[i];
+            if (tiles_is_blank(tile)) {
+                blanks |= 1u << i;
+            }
+            put_byte(record, (uint8_t)tiles_face(tile));
+        }
+        put_varint(record, blanks);
+    } else if (move->type == MOVE_EXCHANGE) {
+        put_letters(record, move->tiles, move->length);
+    }
+    put_score(record, move->score);
+    if (move->type != MOVE_PASS) {
+        put_letters(record, drawn ? drawn : "", RACK_SIZE);
+    }
+    return true;
+}
+
+/* Close the record with the final scores */
+bool record_finish(GameRecord *record, const int scores[2])
+{
+    if (!record_reserve(record, 32)) {
+        return false;
+    }
+
+    put_varint(record, RECORD_TAG_END);
+    put_score(record, scores[0]);
+    put_score(record, scores[1]);
+    return true;
+}
+
+/* Write a finished record */
+bool record_write(FILE *file, const GameRecord *record)
+{
+    return fwrite(record->data, 1, record->size, file) == record->size;
+}
+
+/* Decoding; every getter fails cleanly on truncated input */
+
+static bool get_varint(RecordReader *reader, uint64_t *value)
+{
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64 && reader->pos < reader->size; shift += 7) {
+        uint8_t byte = reader->data[reader->pos++];
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool get_score(RecordReader *reader, int *value)
+{
+    uint64_t raw;
+    if (!get_varint(reader, &raw)) {
+        return false;
+    }
+    *value = (int)(raw >> 1) ^ -(int)(raw & 1);
+    return true;
+}
+
+static bool get_letters(RecordReader *reader, char *out, size_t max)
+{
+    uint64_t length;
+    if (!get_varint(reader, &length) || length > max || reader->size - reader->pos < length) {
+        return false;
+    }
+    memcpy(out, reader->data + reader->pos, length);
+    out[length] = '\0';
+    reader->pos += length;
+    return true;
+}
+
+/* Read a whole record file into memory */
+bool record_read_file(const char *filename, uint8_t **data, size_t *size)
+{
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        return false;
+    }
+
+    size_t capacity = 1 << 16;
+    size_t length = 0;
+    uint8_t *buffer = (uint8_t *)malloc(capacity);
+    while (buffer) {
+        length += fread(buffer + length, 1, capacity - length, file);
+        if (length < capacity) {
+            break;
+        }
+        capacity *= 2;
+        uint8_t *grown = (uint8_t *)realloc(buffer, capacity);
+        if (!grown) {
+            free(buffer);
+        }
+        buffer = grown;
+    }
+    fclose(file);
+
+    if (!buffer) {
+        return false;
+    }
+    *data = buffer;
+    *size = length;
+    return true;
+}
+
+/* Decode the header of the record starting at data */
+bool record_reader_open(RecordReader *reader, const uint8_t *data, size_t size)
+{
+    uint64_t seed, length, tiles_left;
+
+    memset(reader, 0, sizeof(*reader));
+    reader->data = data;
+    reader->size = size;
+    if (size < 5 || memcmp(data, RECORD_MAGIC, 4) != 0 ||
+        (data[4] != RECORD_VERSION && data[4] != 2)) {
+        return false;
+    }
+    reader->pos = 5;
+    reader->variant = variant_get(VARIANT_STANDARD);
+    if (data[4] == RECORD_VERSION) {
+        if (size < 6 || !(reader->variant = variant_get((VariantId)data[5]))) {
+            return false;
+        }
+        reader->pos = 6;
+    }
+
+    if (!get_varint(reader, &seed) || !get_varint(reader, &length) ||
+        length >= RECORD_LEXICON_MAX || size - reader->pos < length) {
+        return false;
+    }
+    reader->seed = seed;
+    memcpy(reader->lexicon, data + reader->pos, length);
+    reader->lexicon[length] = '\0';
+    reader->pos += length;
+
+    if (!get_varint(reader, &tiles_left) || tiles_left > BAG_CAPACITY) {
+        return false;
+    }
+    reader->tiles_left = (int)tiles_left;
+    if (!get_letters(reader, reader->racks[0], RACK_SIZE) ||
+        !get_letters(reader, reader->racks[1], RACK_SIZE)) {
+        return false;
+    }
+    reader->moves_start = reader->pos;
+    return true;
+}
+
+/* Decode the next move; false at the end of the record or on corrupt input */
+bool record_reader_next(RecordReader *reader, RecordMove *out)
+{
+    uint64_t tag, square, length, blanks;
+    uint64_t size = (uint64_t)reader->variant->board_size;
+    Move *move = &out->move;
+
+    if (reader->finished || !get_varint(reader, &tag)) {
+        return false;
+    }
+    if (tag == RECORD_TAG_END) {
+        reader->finished = get_score(reader, &reader->final_scores[0]) &&
+                           get_score(reader, &reader->final_scores[1]);
+        return false;
+    }
+    if ((tag & 3) > MOVE_EXCHANGE || tag > 0x0f) {
+        return false;
+    }
+
+    memset(move, 0, sizeof(*move));
+    move->type = (uint8_t)(tag & 3);
+    move->direction = (uint8_t)((tag >> 2) & 1);
+    out->player = (int)((tag >> 3) & 1);
+    out->drawn[0] = '\0';
+
+    if (move->type == MOVE_PLACE) {
+        if (!get_varint(reader, &square) || square >= size * size ||
+            !get_varint(reader, &length) || length == 0 || length > size ||
+            reader->size - reader->pos < length) {
+            return false;
+        }
+        move->row = (uint8_t)(square / size);
+        move->col = (uint8_t)(square % size);
+        move->length = (uint8_t)length;
+        memcpy(move->tiles, reader->data + reader->pos, length);
+        reader->pos += length;
+        if (!get_varint(reader, &blanks)) {
+            return false;
+        }
+        for (int i = 0; i < move->length; i++) {
+            if (move->tiles[i]) {
+                move->tiles_played++;
+                if (blanks & (1u << i)) {
+                    move->tiles[i] = tiles_blank_as(move->tiles[i]);
+                }
+            }
+        }
+    } else if (move->type == MOVE_EXCHANGE) {
+        char tiles[RACK_SIZE + 1];
+        if (!get_letters(reader, tiles, RACK_SIZE)) {
+            return false;
+        }
+        move->length = (uint8_t)strlen(tiles);
+        memcpy(move->tiles, tiles, move->length);
+    }
+
+    if (!get_score(reader, &move->score)) {
+        return false;
+    }
+    return move->type == MOVE_PASS || get_letters(reader, out->drawn, RACK_SIZE);
+}
+
+/*
+ * Rebuild the calling thread's board and game state after the first ply
+ * moves of an open record (all of them when ply is negative). Returns the
+ * number of moves applied, or -1 when the record is corrupt or is for a
+ * variant other than the selected one. After a full replay reader->pos is
+ * the length of the record.
+ */
+int record_replay(RecordReader *reader, int ply)
+{
+    RecordMove entry;
+    int applied = 0;
+
+    if (!game_setup(reader->racks[0], reader->racks[1], reader->tiles_left) ||
+        board_variant() != reader->variant) {
+        return -1;
+    }
+    reader->pos = reader->moves_start;
+    reader->finished = false;
+
+    GameState *state = game_get_state();
+    state->seed = reader->seed;
+
+    while (ply < 0 || applied < ply) {
+        if (!record_reader_next(reader, &entry)) {
+            if (!reader->finished) {
+                return -1;
+            }
+            state->scores[0] = reader->final_scores[0];
+            state->scores[1] = reader->final_scores[1];
+            state->over = true;
+            break;
+        }
+        state->to_move = entry.player;
+        if (!game_apply_move(&entry.move, entry.drawn)) {
+            return -1;
+        }
+        applied++;
+    }
+    return applied;
+}
+
+/* Start streaming the records in file; the caller keeps ownership of it */
+void record_stream_open(RecordStream *stream, FILE *file)
+{
+    memset(stream, 0, sizeof(*stream));
+    stream->file = file;
+}
+
+void record_stream_close(RecordStream *stream)
+{
+    free(stream->buffer);
+    memset(stream, 0, sizeof(*stream));
+}
+
+/* Length of the complete record at data, or 0 if it is cut short or corrupt */
+static size_t complete_record(const uint8_t *data, size_t size)
+{
+    RecordReader reader;
+    RecordMove entry;
+
+    if (!record_reader_open(&reader, data, size)) {
+        return 0;
+    }
+    while (record_reader_next(&reader, &entry)) {
+    }
+    return reader.finished ? reader.pos : 0;
+}
+
+/*
+ * Point data at the next whole record, valid until the next call. Reads
+ * more of the file only when the buffered bytes end mid-record, so memory
+ * stays at the longest record seen. Returns false at the end of the file
+ * or, with stream->error set, on a corrupt record or read error.
+ */
+bool record_stream_next(RecordStream *stream, const uint8_t **data, size_t *size)
+{
+    for (;;) {
+        size_t available = stream->end - stream->start;
+        if (available > 0) {
+            size_t length = complete_record(stream->buffer + stream->start, available);
+            if (length > 0) {
+                *data = stream->buffer + stream->start;
+                *size = length;
+                stream->start += length;
+                return true;
+            }
+            if (stream->eof || available >= RECORD_STREAM_MAX) {
+                stream->error = true;
+                return false;
+            }
+        } else if (stream->eof) {
+            return false;
+        }
+
+        /* Keep the partial record at the front and read more behind it */
+        if (stream->start > 0) {
+            memmove(stream->buffer, stream->buffer + stream->start, available);
+            stream->start = 0;
+        }
+        stream->end = available;
+        if (stream->end == stream->capacity) {
+            size_t capacity = stream->capacity ? stream->capacity * 2 : 1 << 16;
+            uint8_t *grown = (uint8_t *)realloc(stream->buffer, capacity);
+            if (!grown) {
+                stream->error = true;
+                return false;
+            }
+            stream->buffer = grown;
+            stream->capacity = capacity;
+        }
+        size_t read = fread(stream->buffer + stream->end, 1, stream->capacity - stream->end,
+                            stream->file);
+        stream->end += read;
+        if (read == 0) {
+            stream->eof = true;
+            stream->error = ferror(stream->file) != 0;
+        }
+    }
+}
@@ -0,0 +1,421 @@
+/**
+ * XScrabble - Headless Self-Play Tournament
+ *
+ * Plays bot-vs-bot games on all cores for throughput and strength
+ * regression testing. Game i is dealt from a seed derived from the base
+ * seed and i, so results do not depend on the number of threads.
+ * SIGHUP reloads the word list; games already running finish on the
+ * version they started with.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "game.h"
+#include "board.h"
+#include "eval.h"
+#include "exchange.h"
+#include "lexicon.h"
+#include "movegen.h"
+#include "record.h"
+#include "tiles.h"
+#include "stats.h"
+#include "config.h"
+
+#define MAX_THREADS 256
+#define SCORE_BUCKET 50
+#define SCORE_BUCKETS 16
+
+/* Outcome of one game */
+typedef struct {
+    int scores[2];
+    int moves;
+} GameResult;
+
+/* Tournament configuration and shared progress */
+typedef struct {
+    char lexicon[RECORD_LEXICON_MAX];
+    uint64_t seed;
+    int games;
+    GameResult *results;
+    const EvalWeights *weights;         /* Player 1 plays by equity if set */
+    FILE *records;
+    pthread_mutex_t records_lock;
+    bool records_failed;                /* A record did not write; set under records_lock */
+    int next_game;
+    int completed;
+} Tournament;
+
+/* Seed for game i */
+static uint64_t game_seed(uint64_t base, int index)
+{
+    uint64_t z = base + 0x9e3779b97f4a7c15ULL * (uint64_t)(index + 1);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static volatile sig_atomic_t reload_requested = 0;
+
+static void request_reload(int signum)
+{
+    (void)signum;
+    reload_requested = 1;
+}
+
+/* Play one bot-vs-bot game on the calling thread; greedy unless player 1 uses equity */
+static void play_game(Tournament *t, int index, GameRecord *record)
+{
+    uint64_t seed = game_seed(t->seed, index);
+    GameState *state = game_get_state();
+
+    game_use_lexicon(t->lexicon);
+    game_new(seed);
+    if (t->records) {
+        record_begin(record, t->lexicon, state);
+    }
+
+    while (!game_is_over()) {
+        int player = state->to_move;
+        Move pass = {0};
+        Move best;
+        const Move *move = &best;
+
+        pass.type = MOVE_PASS;
+        if (t->weights && player == 0) {
+            EvalContext context;
+            ExchangeContext exchange;
+            char unseen[EXCHANGE_MAX_UNSEEN + 1];
+            eval_prepare(&context, t->weights, state->racks[player], state->tiles_left);
+            exchange_unseen(state, player, unseen);
+            exchange_prepare(&exchange, &context, state->racks[player], unseen, state->tiles_left,
+                             EXCHANGE_SAMPLES, seed + (uint64_t)state->moves_played);
+            if (!exchange_decide(&exchange, &context, state->lexicon->dawg, state->racks[player], &best, NULL)) {
+                move = &pass;
+            }
+        } else if (game_best_moves(&best, 1) == 0) {
+            move = &pass;
+        }
+
+        if (!game_play_move(move)) {
+            move = &pass;
+            game_pass_turn();
+        }
+        if (t->records) {
+            record_add_move(record, player, move, state->last_drawn);
+        }
+    }
+
+    t->results[index].scores[0] = state->scores[0];
+    t->results[index].scores[1] = state->scores[1];
+    t->results[index].moves = state->moves_played;
+
+    if (t->records) {
+        record_finish(record, state->scores);
+        pthread_mutex_lock(&t->records_lock);
+        if (!record_write(t->records, record)) {
+            t->records_failed = true;
+        }
+        pthread_mutex_unlock(&t->records_lock);
+    }
+}
+
+static void *worker(void *arg)
+{
+    Tournament *t = (Tournament *)arg;
+    GameRecord record;
+
+    record_init(&record);
+
+    for (;;) {
+        int index = __atomic_fetch_add(&t->next_game, 1, __ATOMIC_RELAXED);
+        if (index >= t->games) {
+            break;
+        }
+        play_game(t, index, &record);
+        __atomic_fetch_add(&t->completed, 1, __ATOMIC_RELEASE);
+    }
+
+    lexicon_release(game_get_state()->lexicon);
+    game_get_state()->lexicon = NULL;
+    movegen_cache_free();
+    record_free(&record);
+    return NULL;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int compare_ints(const void *a, const void *b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+/* Lexicon ID for records: the word list's file name without extension */
+static void lexicon_name(const char *path, char *name, size_t size)
+{
+    const char *base = strrchr(path, '/');
+    base = base ? base + 1 : path;
+    size_t length = strcspn(base, ".");
+    if (length >= size) {
+        length = size - 1;
+    }
+    memcpy(name, base, length);
+    name[length] = '\0';
+}
+
+/* Print throughput, score distribution and win rates */
+static void report(const Tournament *t, int threads, double elapsed)
+{
+    int games = t->games;
+    int *scores = (int *)malloc(2 * games * sizeof(int));
+    long moves = 0;
+    int wins[2] = {0, 0};
+    int draws = 0;
+    double sum[2] = {0.0, 0.0};
+    double squares = 0.0;
+    int histogram[SCORE_BUCKETS] = {0};
+
+    if (!scores) {
+        return;
+    }
+
+    for (int i = 0; i < games; i++) {
+        const GameResult *r = &t->results[i];
+        moves += r->moves;
+        for (int p = 0; p < 2; p++) {
+            int score = r->scores[p];
+            int bucket = score < 0 ? 0 : score / SCORE_BUCKET;
+            scores[2 * i + p] = score;
+            sum[p] += score;
+            squares += (double)score * score;
+            histogram[bucket < SCORE_BUCKETS ? bucket : SCORE_BUCKETS - 1]++;
+        }
+        if (r->scores[0] == r->scores[1]) {
+            draws++;
+        } else {
+            wins[r->scores[0] > r->scores[1] ? 0 : 1]++;
+        }
+    }
+    qsort(scores, 2 * games, sizeof(int), compare_ints);
+
+    double mean = (sum[0] + sum[1]) / (2.0 * games);
+    double stdev = sqrt(squares / (2.0 * games) - mean * mean);
+
+    printf("Self-play: %d games on %d threads, seed %llu\n",
+           games, threads, (unsigned long long)t->seed);
+    printf("Elapsed:   %.3f s\n", elapsed);
+    printf("Games/sec: %.1f\n", games / elapsed);
+    printf("Moves/sec: %.1f (%.1f moves/game)\n", moves / elapsed, (double)moves / games);
+    printf("Scores:    mean %.1f, stdev %.1f, min %d, p10 %d, p50 %d, p90 %d, max %d\n",
+           mean, stdev, scores[0], scores[(2 * games) / 10], scores[games],
+           scores[(2 * games * 9) / 10], scores[2 * games - 1]);
+    printf("Mean:      player 1 %.1f, player 2 %.1f\n", sum[0] / games, sum[1] / games);
+    printf("Wins:      player 1 %.1f%%, player 2 %.1f%%, draws %.1f%%\n",
+           100.0 * wins[0] / games, 100.0 * wins[1] / games, 100.0 * draws / games);
+
+    printf("Score distribution:\n");
+    for (int b = 0; b < SCORE_BUCKETS; b++) {
+        if (histogram[b]) {
+            printf("  %4d-%-4d %s%6d\n", b * SCORE_BUCKET, (b + 1) * SCORE_BUCKET - 1,
+                   b == SCORE_BUCKETS - 1 ? "+" : " ", histogram[b]);
+        }
+    }
+
+    free(scores);
+}
+
+static void print_usage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: %s [-n games] [-j threads] [-s seed] [-V variant] [-d wordlist] "
+            "[-a alphabet] [-t tiles] [-e] [-w weights] [-o records] [--stats]\n", program);
+}
+
+int main(int argc, char *argv[])
+{
+    int games = 100;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    uint64_t seed = 1;
+    const char *wordlist = DICTIONARY_FILE;
+    const char *tiles_file = NULL;
+    const char *variant = NULL;
+    const char *alphabet_file = NULL;
+    const char *records_file = NULL;
+    const char *weights_file = NULL;
+    bool equity = false;
+    bool show_stats = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            games = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "-V") == 0 && i + 1 < argc) {
+            variant = argv[++i];
+        }
+        else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            wordlist = argv[++i];
+        }
+        else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) {
+            alphabet_file = argv[++i];
+        }
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            tiles_file = argv[++i];
+        }
+        else if (strcmp(argv[i], "-e") == 0) {
+            equity = true;
+        }
+        else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            weights_file = argv[++i];
+            equity = true;
+        }
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            records_file = argv[++i];
+        }
+        else if (strcmp(argv[i], "--stats") == 0) {
+            show_stats = true;
+        }
+        else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (games <= 0) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+    if (threads > MAX_THREADS) {
+        threads = MAX_THREADS;
+    }
+
+    /* Shared, read-only inputs; tile letters are spelled in the lexicon's alphabet */
+    if (variant && !variant_select(variant)) {
+        return EXIT_FAILURE;
+    }
+    Alphabet alphabet = *alphabet_english();
+    if (alphabet_file && !alphabet_load(&alphabet, alphabet_file)) {
+        fprintf(stderr, "Failed to load alphabet %s\n", alphabet_file);
+        return EXIT_FAILURE;
+    }
+
+    Tournament t;
+    memset(&t, 0, sizeof(t));
+    lexicon_name(wordlist, t.lexicon, sizeof(t.lexicon));
+
+    Lexicon *lexicon = lexicon_load_alphabet(t.lexicon, wordlist, &alphabet);
+    if (!lexicon || lexicon->dawg->word_count == 0) {
+        fprintf(stderr, "Failed to load word list %s\n", wordlist);
+        lexicon_release(lexicon);
+        return EXIT_FAILURE;
+    }
+    /* The installed tile file is the standard set; other variants bring their own */
+    if (!tiles_file && variant_current()->id == VARIANT_STANDARD) {
+        tiles_file = TILES_FILE;
+    }
+    if (tiles_file && !tiles_load_alphabet(tiles_file, &alphabet)) {
+        if (alphabet_file) {
+            fprintf(stderr, "Failed to load tiles %s; the built-in set is English only\n", tiles_file);
+            lexicon_release(lexicon);
+            return EXIT_FAILURE;
+        }
+        fprintf(stderr, "Using the built-in tile set (%s not found)\n", tiles_file);
+        tiles_reset();
+    }
+    lexicon_publish(lexicon);
+
+    /* Player 1 picks moves by equity instead of score */
+    EvalWeights weights;
+    eval_default_weights(&weights);
+    if (weights_file && !eval_load_weights(&weights, weights_file, &alphabet)) {
+        fprintf(stderr, "Failed to load weights %s\n", weights_file);
+        lexicon_registry_clear();
+        return EXIT_FAILURE;
+    }
+    t.weights = equity ? &weights : NULL;
+    t.seed = seed;
+    t.games = games;
+    t.results = (GameResult *)calloc(games, sizeof(GameResult));
+    pthread_mutex_init(&t.records_lock, NULL);
+
+    if (records_file) {
+        t.records = fopen(records_file, "wb");
+        if (!t.records) {
+            fprintf(stderr, "Failed to open %s for writing\n", records_file);
+        }
+    }
+    if (!t.results) {
+        fprintf(stderr, "Failed to allocate results\n");
+        return EXIT_FAILURE;
+    }
+
+    stats_install_signal(SIGUSR1);
+    signal(SIGHUP, request_reload);
+
+    /* Run the tournament */
+    pthread_t workers[MAX_THREADS];
+    double start = now_seconds();
+    int started = 0;
+
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&workers[i], NULL, worker, &t) != 0) {
+            break;
+        }
+        started++;
+    }
+    if (started == 0) {
+        worker(&t);
+    }
+
+    while (__atomic_load_n(&t.completed, __ATOMIC_ACQUIRE) < games) {
+        struct timespec pause = {0, 50 * 1000 * 1000};
+        nanosleep(&pause, NULL);
+        stats_poll(stderr);
+        if (reload_requested) {
+            reload_requested = 0;
+            if (lexicon_reload(t.lexicon, wordlist)) {
+                fprintf(stderr, "Reloaded %s\n", wordlist);
+            } else {
+                fprintf(stderr, "Reload of %s failed, keeping the current version\n", wordlist);
+            }
+        }
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    double elapsed = now_seconds() - start;
+
+    report(&t, started ? started : 1, elapsed);
+    if (show_stats) {
+        stats_dump(stderr);
+    }
+
+    int status = EXIT_SUCCESS;
+    if (t.records && (fclose(t.records) != 0 || t.records_failed)) {
+        fprintf(stderr, "Failed to write %s\n", records_file);
+        status = EXIT_FAILURE;
+    }
+    pthread_mutex_destroy(&t.records_lock);
+    free(t.results);
+    lexicon_registry_clear();
+    return status;
+}
@@ -0,0 +1,250 @@
+/**
+ * XScrabble - Hot-Path Instrumentation Implementation
+ *
+ * Every thread records into its own block, so the hot path is a handful of
+ * plain stores. Blocks are linked into a global list the first time a thread
+ * records anything and are kept after the thread exits, so dumps always
+ * cover the whole process.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <pthread.h>
+#include <time.h>
+#include "stats.h"
+
+/* Per-thread counters */
+typedef struct StatsBlock {
+    uint64_t count[STAT_COUNT];
+    uint64_t ticks[STAT_COUNT];
+    uint64_t histogram[STAT_COUNT][STATS_HISTOGRAM_BUCKETS];
+    struct StatsBlock *next;
+} StatsBlock;
+
+static StatsBlock *blocks = NULL;
+static int block_count = 0;
+static pthread_mutex_t blocks_lock = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local StatsBlock *local_block = NULL;
+
+/* Tick-to-nanosecond calibration base, taken at the first registration */
+static uint64_t base_ticks = 0;
+static double base_ns = 0.0;
+
+static volatile sig_atomic_t dump_requested = 0;
+
+static const char *stat_names[STAT_COUNT] = {
+    "dictionary_lookup",
+    "dictionary_load",
+    "move_generation",
+    "move_scoring",
+    "move_validation",
+    "ui_redraw"
+};
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* Attach a counter block to the calling thread */
+static StatsBlock* register_thread(void)
+{
+    StatsBlock *block = (StatsBlock *)calloc(1, sizeof(StatsBlock));
+    if (!block) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&blocks_lock);
+    if (!blocks) {
+        base_ticks = stats_ticks();
+        base_ns = now_ns();
+    }
+    block->next = blocks;
+    blocks = block;
+    block_count++;
+    pthread_mutex_unlock(&blocks_lock);
+
+    local_block = block;
+    return block;
+}
+
+/* Relaxed stores keep dumps from other threads well-defined */
+static inline void bump(uint64_t *counter, uint64_t amount)
+{
+    __atomic_store_n(counter, *counter + amount, __ATOMIC_RELAXED);
+}
+
+static inline int bucket_for(uint64_t ticks)
+{
+    int bucket = ticks ? 64 - __builtin_clzll(ticks) : 0;
+    return bucket < STATS_HISTOGRAM_BUCKETS ? bucket : STATS_HISTOGRAM_BUCKETS - 1;
+}
+
+/* Check whether instrumentation was compiled in */
+bool stats_enabled(void)
+{
+#ifdef XSCRABBLE_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+/* Record one operation; zero ticks counts it without timing */
+void stats_record(StatID id, uint64_t ticks)
+{
+    StatsBlock *block = local_block ? local_block : register_thread();
+    if (!block || id >= STAT_COUNT) {
+        return;
+    }
+
+    bump(&block->count[id], 1);
+    if (ticks) {
+        bump(&block->ticks[id], ticks);
+        bump(&block->histogram[id][bucket_for(ticks)], 1);
+    }
+}
+
+/* Aggregate one operation across all threads */
+void stats_summary(StatID id, StatsSummary *summary)
+{
+    memset(summary, 0, sizeof(*summary));
+    if (id >= STAT_COUNT) {
+        return;
+    }
+
+    pthread_mutex_lock(&blocks_lock);
+    for (StatsBlock *block = blocks; block; block = block->next) {
+        summary->count += __atomic_load_n(&block->count[id], __ATOMIC_RELAXED);
+        summary->ticks += __atomic_load_n(&block->ticks[id], __ATOMIC_RELAXED);
+        for (int b = 0; b < STATS_HISTOGRAM_BUCKETS; b++) {
+            summary->histogram[b] += __atomic_load_n(&block->histogram[id][b], __ATOMIC_RELAXED);
+        }
+    }
+    pthread_mutex_unlock(&blocks_lock);
+}
+
+/* Get the display name of an operation */
+const char* stats_name(StatID id)
+{
+    return id < STAT_COUNT ? stat_names[id] : "unknown";
+}
+
+/* Zero all counters */
+void stats_reset(void)
+{
+    pthread_mutex_lock(&blocks_lock);
+    for (StatsBlock *block = blocks; block; block = block->next) {
+        StatsBlock *next = block->next;
+        memset(block, 0, sizeof(*block));
+        block->next = next;
+    }
+    pthread_mutex_unlock(&blocks_lock);
+}
+
+/* Upper tick bound of the bucket that holds the given fraction of samples */
+static uint64_t histogram_percentile(const StatsSummary *summary, double fraction)
+{
+    uint64_t timed = 0;
+    for (int b = 0; b < STATS_HISTOGRAM_BUCKETS; b++) {
+        timed += summary->histogram[b];
+    }
+
+    uint64_t target = (uint64_t)(fraction * timed);
+    uint64_t seen = 0;
+    for (int b = 0; b < STATS_HISTOGRAM_BUCKETS; b++) {
+        seen += summary->histogram[b];
+        if (seen > target) {
+            return b ? (1ULL << b) - 1 : 0;
+        }
+    }
+    return 0;
+}
+
+/* Print a table and histograms of all recorded operations */
+void stats_dump(FILE *out)
+{
+    if (!stats_enabled()) {
+        fprintf(out, "Statistics are disabled (rebuild with XSCRABBLE_STATS)\n");
+        return;
+    }
+
+    pthread_mutex_lock(&blocks_lock);
+    int threads = block_count;
+    double elapsed_ns = now_ns() - base_ns;
+    double ticks_per_ns = elapsed_ns > 0.0 ? (stats_ticks() - base_ticks) / elapsed_ns : 1.0;
+    pthread_mutex_unlock(&blocks_lock);
+
+    if (ticks_per_ns <= 0.0) {
+        ticks_per_ns = 1.0;
+    }
+
+    fprintf(out, "XScrabble statistics (%d threads, %.2f ticks/ns)\n", threads, ticks_per_ns);
+    fprintf(out, "%-20s %12s %12s %10s %10s %10s %10s\n",
+            "operation", "count", "total ms", "mean ns", "p50 ns", "p90 ns", "p99 ns");
+
+    for (int id = 0; id < STAT_COUNT; id++) {
+        StatsSummary summary;
+        stats_summary((StatID)id, &summary);
+        if (summary.count == 0) {
+            continue;
+        }
+
+        double total_ns = summary.ticks / ticks_per_ns;
+        fprintf(out, "%-20s %12llu %12.3f %10.1f %10.1f %10.1f %10.1f\n",
+                stats_name((StatID)id), (unsigned long long)summary.count,
+                total_ns / 1e6, total_ns / summary.count,
+                histogram_percentile(&summary, 0.50) / ticks_per_ns,
+                histogram_percentile(&summary, 0.90) / ticks_per_ns,
+                histogram_percentile(&summary, 0.99) / ticks_per_ns);
+    }
+
+    /* Histograms, one line per operation */
+    for (int id = 0; id < STAT_COUNT; id++) {
+        StatsSummary summary;
+        stats_summary((StatID)id, &summary);
+        if (summary.count == 0) {
+            continue;
+        }
+
+        fprintf(out, "%s:", stats_name((StatID)id));
+        for (int b = 0; b < STATS_HISTOGRAM_BUCKETS; b++) {
+            if (summary.histogram[b]) {
+                fprintf(out, " <%.0fns:%llu", (double)(1ULL << b) / ticks_per_ns,
+                        (unsigned long long)summary.histogram[b]);
+            }
+        }
+        fprintf(out, "\n");
+    }
+    fflush(out);
+}
+
+static void handle_dump_signal(int signo)
+{
+    (void)signo;
+    dump_requested = 1;
+}
+
+/* Request a dump on the next stats_poll() whenever signo arrives */
+bool stats_install_signal(int signo)
+{
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_dump_signal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    return sigaction(signo, &action, NULL) == 0;
+}
+
+/* Dump if a signal asked for it since the last poll */
+void stats_poll(FILE *out)
+{
+    if (dump_requested) {
+        dump_requested = 0;
+        stats_dump(out);
+    }
+}
@@ -0,0 +1,148 @@
+/**
+ * XScrabble - Tile Set Implementation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "tiles.h"
+#include "variant.h"
+
+#define MAX_TILE_KINDS 64
+#define MAX_LINE_LENGTH 128
+
+static TileInfo tiles[MAX_TILE_KINDS];
+static int tile_kinds = 0;
+static int tile_total = 0;
+
+/* Point values indexed by uppercase letter */
+static int letter_values[256];
+
+/* Rebuild the lookup tables from the tile list */
+static void tiles_index(void)
+{
+    memset(letter_values, 0, sizeof(letter_values));
+    tile_total = 0;
+    for (int i = 0; i < tile_kinds; i++) {
+        letter_values[(unsigned char)tiles[i].letter] = tiles[i].points;
+        tile_total += tiles[i].count;
+    }
+}
+
+/* Restore the current variant's distribution; it is used until a tile file is loaded */
+void tiles_reset(void)
+{
+    const Variant *variant = variant_current();
+    tile_kinds = variant->tile_kinds;
+    memcpy(tiles, variant->tiles, tile_kinds * sizeof(TileInfo));
+    tiles_index();
+}
+
+/* Load an English tile distribution file ("Letter Count Points" per line) */
+bool tiles_load(const char *filename)
+{
+    return tiles_load_alphabet(filename, alphabet_english());
+}
+
+/* Load a tile distribution file whose letters are spelled in an alphabet; '_' is the blank */
+bool tiles_load_alphabet(const char *filename, const Alphabet *alphabet)
+{
+    FILE *file = fopen(filename, "r");
+    if (!file) {
+        return false;
+    }
+
+    TileInfo loaded[MAX_TILE_KINDS];
+    int kinds = 0;
+    char line[MAX_LINE_LENGTH];
+
+    while (fgets(line, sizeof(line), file) && kinds < MAX_TILE_KINDS) {
+        char face[MAX_LINE_LENGTH];
+        char letter[2];
+        int count, points;
+
+        /* Skip comments and blank lines */
+        if (line[0] == '#' || isspace((unsigned char)line[0])) {
+            continue;
+        }
+        if (sscanf(line, "%127s %d %d", face, &count, &points) != 3 || count < 0) {
+            continue;
+        }
+        if (face[0] == TILE_BLANK && face[1] == '\0') {
+            letter[0] = TILE_BLANK;
+        } else if (alphabet_encode(alphabet, face, letter, sizeof(letter)) != 1) {
+            fprintf(stderr, "Skipping tile %s in %s: not a letter of the alphabet\n", face, filename);
+            continue;
+        }
+
+        loaded[kinds].letter = letter[0];
+        loaded[kinds].count = count;
+        loaded[kinds].points = points;
+        kinds++;
+    }
+    fclose(file);
+
+    if (kinds == 0) {
+        return false;
+    }
+
+    memcpy(tiles, loaded, kinds * sizeof(TileInfo));
+    tile_kinds = kinds;
+    tiles_index();
+    return true;
+}
+
+/* Get the point value of a letter (blanks and unknown letters score 0) */
+int tiles_letter_value(char letter)
+{
+    if (tile_kinds == 0) {
+        tiles_reset();
+    }
+    if (tiles_is_blank(letter)) {
+        return 0;
+    }
+    return letter_values[(unsigned char)letter];
+}
+
+/* Get the number of tiles of a letter in a full bag */
+int tiles_letter_count(char letter)
+{
+    if (tile_kinds == 0) {
+        tiles_reset();
+    }
+    letter = toupper((unsigned char)letter);
+    for (int i = 0; i < tile_kinds; i++) {
+        if (tiles[i].letter == letter) {
+            return tiles[i].count;
+        }
+    }
+    return 0;
+}
+
+/* Get the number of tiles in a full bag */
+int tiles_total(void)
+{
+    if (tile_kinds == 0) {
+        tiles_reset();
+    }
+    return tile_total;
+}
+
+/* Get the number of distinct tiles */
+int tiles_kinds(void)
+{
+    if (tile_kinds == 0) {
+        tiles_reset();
+    }
+    return tile_kinds;
+}
+
+/* Get a distribution entry */
+const TileInfo* tiles_get(int index)
+{
+    if (tile_kinds == 0) {
+        tiles_reset();
+    }
+    return index >= 0 && index < tile_kinds ? &tiles[index] : NULL;
+}
@@ -0,0 +1,274 @@
+/**
+ * XScrabble - Transposition Table Implementation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "ttable.h"
+
+#define HUGE_PAGE_BYTES (2u << 20)
+
+/* Packed result: value, depth, bound, generation, hint from the low bits up */
+#define DATA_DEPTH_SHIFT 32
+#define DATA_BOUND_SHIFT 40
+#define DATA_GENERATION_SHIFT 42
+#define DATA_HINT_SHIFT 48
+
+/* Counter block of the calling thread, picked once per thread */
+static _Thread_local int counter_shard = -1;
+static int next_shard;
+
+static TTableCounters* counters(TTable *table)
+{
+    if (counter_shard < 0) {
+        counter_shard = __atomic_fetch_add(&next_shard, 1, __ATOMIC_RELAXED) % TTABLE_STAT_SHARDS;
+    }
+    return &table->counters[counter_shard];
+}
+
+static void count(uint64_t *counter)
+{
+    __atomic_fetch_add(counter, 1, __ATOMIC_RELAXED);
+}
+
+static uint64_t pack(int32_t value, int depth, TTableBound bound, uint8_t generation,
+                     uint16_t hint)
+{
+    return (uint64_t)(uint32_t)value |
+           (uint64_t)(uint8_t)depth << DATA_DEPTH_SHIFT |
+           (uint64_t)(bound & 3) << DATA_BOUND_SHIFT |
+           (uint64_t)(generation % TTABLE_GENERATIONS) << DATA_GENERATION_SHIFT |
+           (uint64_t)hint << DATA_HINT_SHIFT;
+}
+
+static int data_depth(uint64_t data)
+{
+    return (int)(data >> DATA_DEPTH_SHIFT & 0xff);
+}
+
+static int data_generation(uint64_t data)
+{
+    return (int)(data >> DATA_GENERATION_SHIFT & (TTABLE_GENERATIONS - 1));
+}
+
+/* Searches since an entry was written */
+static int data_age(const TTable *table, uint64_t data)
+{
+    return (table->generation - data_generation(data)) & (TTABLE_GENERATIONS - 1);
+}
+
+/* Load an entry's two words; relaxed, since the XOR check catches a mismatched pair */
+static void load_entry(const TTableEntry *entry, uint64_t *key_xor, uint64_t *data)
+{
+    *key_xor = __atomic_load_n(&entry->key_xor, __ATOMIC_RELAXED);
+    *data = __atomic_load_n(&entry->data, __ATOMIC_RELAXED);
+}
+
+static void store_entry(TTableEntry *entry, uint64_t key, uint64_t data)
+{
+    __atomic_store_n(&entry->key_xor, key ^ data, __ATOMIC_RELAXED);
+    __atomic_store_n(&entry->data, data, __ATOMIC_RELAXED);
+}
+
+static TTableBucket* bucket_of(const TTable *table, uint64_t key)
+{
+    return &table->buckets[key & table->mask];
+}
+
+/* Zeroed memory for the buckets: huge pages if reserved, else transparent ones, else the heap */
+static bool allocate(TTable *table, size_t bytes)
+{
+#if defined(__linux__) && defined(MAP_HUGETLB)
+    if (bytes >= HUGE_PAGE_BYTES && bytes % HUGE_PAGE_BYTES == 0) {
+        void *memory = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory != MAP_FAILED) {
+            table->buckets = (TTableBucket *)memory;
+            table->mapped = true;
+            table->huge_pages = true;
+            return true;
+        }
+    }
+#endif
+#if defined(MAP_ANONYMOUS)
+    void *memory = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory != MAP_FAILED) {
+        table->buckets = (TTableBucket *)memory;
+        table->mapped = true;
+#if defined(MADV_HUGEPAGE)
+        table->huge_pages = bytes >= HUGE_PAGE_BYTES && madvise(memory, bytes, MADV_HUGEPAGE) == 0;
+#endif
+        return true;
+    }
+#endif
+    table->buckets = (TTableBucket *)aligned_alloc(sizeof(TTableBucket), bytes);
+    if (!table->buckets) {
+        return false;
+    }
+    memset(table->buckets, 0, bytes);
+    return true;
+}
+
+/* Allocate the largest power-of-two bucket count that fits in megabytes */
+bool ttable_init(TTable *table, size_t megabytes)
+{
+    memset(table, 0, sizeof(*table));
+
+    size_t budget = megabytes << 20;
+    size_t count = 1;
+    while (count * 2 * sizeof(TTableBucket) <= budget) {
+        count *= 2;
+    }
+    if (!allocate(table, count * sizeof(TTableBucket))) {
+        fprintf(stderr, "Failed to allocate a %zu MB transposition table\n", megabytes);
+        return false;
+    }
+    table->mask = count - 1;
+    table->bytes = count * sizeof(TTableBucket);
+    return true;
+}
+
+void ttable_free(TTable *table)
+{
+    if (table->mapped) {
+        munmap(table->buckets, table->bytes);
+    } else {
+        free(table->buckets);
+    }
+    memset(table, 0, sizeof(*table));
+}
+
+/* Forget every entry and reset the counters; not safe while other threads use the table */
+void ttable_clear(TTable *table)
+{
+    memset(table->buckets, 0, table->bytes);
+    memset(table->counters, 0, sizeof(table->counters));
+    table->generation = 0;
+}
+
+/* Start a new search: entries from earlier ones age and become easier to replace */
+void ttable_new_search(TTable *table)
+{
+    table->generation = (uint8_t)((table->generation + 1) % TTABLE_GENERATIONS);
+}
+
+/* Look up a position; on a hit the entry is also refreshed to the current generation */
+bool ttable_probe(TTable *table, uint64_t key, TTableResult *result)
+{
+    TTableBucket *bucket = bucket_of(table, key);
+    TTableCounters *shard = counters(table);
+
+    count(&shard->probes);
+    for (int way = 0; way < TTABLE_WAYS; way++) {
+        TTableEntry *entry = &bucket->entries[way];
+        uint64_t key_xor, data;
+        load_entry(entry, &key_xor, &data);
+        if (!data || (key_xor ^ data) != key) {
+            continue;
+        }
+
+        result->value = (int32_t)(uint32_t)data;
+        result->depth = (uint8_t)data_depth(data);
+        result->bound = (uint8_t)(data >> DATA_BOUND_SHIFT & 3);
+        result->hint = (uint16_t)(data >> DATA_HINT_SHIFT);
+        if (data_age(table, data) != 0) {
+            uint64_t fresh = pack(result->value, result->depth, (TTableBound)result->bound,
+                                  table->generation, result->hint);
+            store_entry(entry, key, fresh);
+        }
+        count(&shard->hits);
+        return true;
+    }
+    return false;
+}
+
+/* Record a search result; stores without a bound carry nothing and are dropped */
+void ttable_store(TTable *table, uint64_t key, int32_t value, int depth, TTableBound bound,
+                  uint16_t hint)
+{
+    if (bound == TTABLE_NONE) {
+        return;
+    }
+    depth = depth < 0 ? 0 : depth > 255 ? 255 : depth;
+
+    TTableBucket *bucket = bucket_of(table, key);
+    TTableEntry *victim = NULL;
+    int victim_worth = 0;
+    bool evicting = false;
+
+    for (int way = 0; way < TTABLE_WAYS; way++) {
+        TTableEntry *entry = &bucket->entries[way];
+        uint64_t key_xor, data;
+        load_entry(entry, &key_xor, &data);
+
+        if (data && (key_xor ^ data) == key) {
+            /* Same position: keep a deeper current result over a shallow one */
+            if (bound != TTABLE_EXACT && depth < data_depth(data) && data_age(table, data) == 0) {
+                return;
+            }
+            victim = entry;
+            evicting = false;
+            break;
+        }
+        if (!data) {
+            if (!victim || evicting) {
+                victim = entry;
+                evicting = false;
+                victim_worth = -1;
+            }
+            continue;
+        }
+        int worth = data_depth(data) - TTABLE_AGE_COST * data_age(table, data);
+        if (!victim || (evicting && worth < victim_worth)) {
+            victim = entry;
+            victim_worth = worth;
+            evicting = true;
+        }
+    }
+
+    TTableCounters *shard = counters(table);
+    store_entry(victim, key, pack(value, depth, bound, table->generation, hint));
+    count(&shard->stores);
+    if (evicting) {
+        count(&shard->replaced);
+    }
+}
+
+/* Start loading a position's bucket ahead of the probe */
+void ttable_prefetch(const TTable *table, uint64_t key)
+{
+    __builtin_prefetch(bucket_of(table, key));
+}
+
+/* Sum the counters and sample the first buckets for occupancy */
+void ttable_stats(const TTable *table, TTableStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->buckets = table->mask + 1;
+    stats->bytes = table->bytes;
+    stats->huge_pages = table->huge_pages;
+    for (int i = 0; i < TTABLE_STAT_SHARDS; i++) {
+        const TTableCounters *shard = &table->counters[i];
+        stats->probes += __atomic_load_n(&shard->probes, __ATOMIC_RELAXED);
+        stats->hits += __atomic_load_n(&shard->hits, __ATOMIC_RELAXED);
+        stats->stores += __atomic_load_n(&shard->stores, __ATOMIC_RELAXED);
+        stats->replaced += __atomic_load_n(&shard->replaced, __ATOMIC_RELAXED);
+    }
+    stats->hit_rate = stats->probes ? (double)stats->hits / stats->probes : 0.0;
+
+    uint64_t sample = stats->buckets < TTABLE_OCCUPANCY_SAMPLE ? stats->buckets :
+                      TTABLE_OCCUPANCY_SAMPLE;
+    uint64_t filled = 0;
+    uint64_t current = 0;
+    for (uint64_t i = 0; i < sample; i++) {
+        for (int way = 0; way < TTABLE_WAYS; way++) {
+            uint64_t data = __atomic_load_n(&table->buckets[i].entries[way].data, __ATOMIC_RELAXED);
+            filled += data != 0;
+            current += data && data_age(table, data) == 0;
+        }
+    }
+    stats->occupancy = (double)filled / (sample * TTABLE_WAYS);
+    stats->current = (double)current / (sample * TTABLE_WAYS);
+}
@@ -17,11 +17,12 @@
 #include "game.h"
 #include "board.h"
 #include "config.h"
+#include "stats.h"
 
 /* UI components */
 static Widget main_form;
 static Widget board_widget;
-static Widget board_cells[BOARD_SIZE][BOARD_SIZE];
+static Widget board_cells[BOARD_MAX_SIZE][BOARD_MAX_SIZE];
 static Widget rack_widget;
 static Widget rack_cells[7];
 static Widget score_widget;
@@ -94,10 +95,12 @@ void ui_cleanup(void)
 /* Update all UI components */
 void ui_update(void)
 {
+    STATS_TIMER_BEGIN(timer);
     ui_update_component(UI_BOARD);
     ui_update_component(UI_RACK);
     ui_update_component(UI_SCORE);
     ui_update_component(UI_STATUS);
+    STATS_TIMER_END(timer, STAT_UI_REDRAW);
 }
 
 /* Update a specific UI component */
@@ -0,0 +1,152 @@
+/**
+ * XScrabble - Rule Variant Implementation
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "variant.h"
+#include "movegen.h"
+
+static const char premiums_STANDARD[] =
+    "T..d...T...d..T"
+    ".D...t...t...D."
+    "..D...d.d...D.."
+    "d..D...d...D..d"
+    "....D.....D...."
+    ".t...t...t...t."
+    "..d...d.d...d.."
+    "T..d.......d..T"
+    "..d...d.d...d.."
+    ".t...t...t...t."
+    "....D.....D...."
+    "d..D...d...D..d"
+    "..D...d.d...D.."
+    ".D...t...t...D."
+    "T..d...T...d..T";
+
+static const char premiums_SUPER[] =
+    "T..d...T..D..T...d..T"
+    ".D...t...t.t...t...D."
+    "..D...d..d.d..d...D.."
+    "d..D......d......D..d"
+    "....D...d...d...D...."
+    ".t...t...t.t...t...t."
+    "..d...t...d...t...d.."
+    "T......D.....D......T"
+    "....d...D...D...d...."
+    ".td..t...d.d...t..dt."
+    "D..d..d.......d..d..D"
+    ".td..t...d.d...t..dt."
+    "....d...D...D...d...."
+    "T......D.....D......T"
+    "..d...t...d...t...d.."
+    ".t...t...t.t...t...t."
+    "....D...d...d...D...."
+    "d..D......d......D..d"
+    "..D...d..d.d..d...D.."
+    ".D...t...t.t...t...D."
+    "T..d...T..D..T...d..T";
+
+static const char premiums_QUICK[] =
+    "T.d..D..d.T"
+    ".D..t.t..D."
+    "d.D..d..D.d"
+    "...d...d..."
+    ".t..t.t..t."
+    "D.d.....d.D"
+    ".t..t.t..t."
+    "...d...d..."
+    "d.D..d..D.d"
+    ".D..t.t..D."
+    "T.d..D..d.T";
+
+/* Standard English distribution */
+static const TileInfo tiles_STANDARD[] = {
+    {'A', 9, 1}, {'B', 2, 3}, {'C', 2, 3}, {'D', 4, 2}, {'E', 12, 1},
+    {'F', 2, 4}, {'G', 3, 2}, {'H', 2, 4}, {'I', 9, 1}, {'J', 1, 8},
+    {'K', 1, 5}, {'L', 4, 1}, {'M', 2, 3}, {'N', 6, 1}, {'O', 8, 1},
+    {'P', 2, 3}, {'Q', 1, 10}, {'R', 6, 1}, {'S', 4, 1}, {'T', 6, 1},
+    {'U', 4, 1}, {'V', 2, 4}, {'W', 2, 4}, {'X', 1, 8}, {'Y', 2, 4},
+    {'Z', 1, 10}, {TILE_BLANK, 2, 0}
+};
+
+/* Twice the board area: about twice the tiles, same values */
+static const TileInfo tiles_SUPER[] = {
+    {'A', 16, 1}, {'B', 4, 3}, {'C', 6, 3}, {'D', 8, 2}, {'E', 24, 1},
+    {'F', 4, 4}, {'G', 5, 2}, {'H', 5, 4}, {'I', 13, 1}, {'J', 2, 8},
+    {'K', 2, 5}, {'L', 7, 1}, {'M', 6, 3}, {'N', 13, 1}, {'O', 15, 1},
+    {'P', 4, 3}, {'Q', 2, 10}, {'R', 13, 1}, {'S', 10, 1}, {'T', 15, 1},
+    {'U', 7, 1}, {'V', 3, 4}, {'W', 4, 4}, {'X', 2, 8}, {'Y', 4, 4},
+    {'Z', 2, 10}, {TILE_BLANK, 4, 0}
+};
+
+/* About half the standard set, every letter kept */
+static const TileInfo tiles_QUICK[] = {
+    {'A', 5, 1}, {'B', 1, 3}, {'C', 1, 3}, {'D', 2, 2}, {'E', 7, 1},
+    {'F', 1, 4}, {'G', 1, 2}, {'H', 1, 4}, {'I', 5, 1}, {'J', 1, 8},
+    {'K', 1, 5}, {'L', 2, 1}, {'M', 1, 3}, {'N', 3, 1}, {'O', 4, 1},
+    {'P', 1, 3}, {'Q', 1, 10}, {'R', 3, 1}, {'S', 2, 1}, {'T', 3, 1},
+    {'U', 2, 1}, {'V', 1, 4}, {'W', 1, 4}, {'X', 1, 8}, {'Y', 1, 4},
+    {'Z', 1, 10}, {TILE_BLANK, 1, 0}
+};
+
+/* Tables of each variant are premiums_<ID> and tiles_<ID>, checked against its numbers */
+#define VARIANT_CHECK(ID) \
+    _Static_assert(sizeof(premiums_##ID) == VARIANT_##ID##_SIZE * VARIANT_##ID##_SIZE + 1, \
+                   "premium map must cover the board"); \
+    _Static_assert(VARIANT_##ID##_SIZE <= BOARD_MAX_SIZE, "BOARD_MAX_SIZE must hold every board"); \
+    _Static_assert(VARIANT_##ID##_RACK <= RACK_SIZE, "RACK_SIZE must hold every rack");
+VARIANT_LIST(VARIANT_CHECK)
+
+#define VARIANT_ENTRY(ID) \
+    { VARIANT_##ID, VARIANT_##ID##_NAME, VARIANT_##ID##_SIZE, VARIANT_##ID##_RACK, \
+      VARIANT_##ID##_BINGO, premiums_##ID, tiles_##ID, sizeof(tiles_##ID) / sizeof(TileInfo) },
+
+static const Variant variants[VARIANT_COUNT] = {
+    VARIANT_LIST(VARIANT_ENTRY)
+};
+
+/* Variant new games are played under; process-wide, like the tile set */
+static const Variant *current = &variants[VARIANT_STANDARD];
+
+const Variant* variant_get(VariantId id)
+{
+    return id >= 0 && id < VARIANT_COUNT ? &variants[id] : NULL;
+}
+
+/* Look a variant up by name, NULL if there is none */
+const Variant* variant_find(const char *name)
+{
+    for (int i = 0; i < VARIANT_COUNT; i++) {
+        if (strcmp(variants[i].name, name) == 0) {
+            return &variants[i];
+        }
+    }
+    return NULL;
+}
+
+const Variant* variant_current(void)
+{
+    return current;
+}
+
+/*
+ * Play new games under a variant and reset the tile set to its own; a
+ * tile file may be loaded afterwards. Call before games start, not while
+ * other threads are playing.
+ */
+bool variant_select(const char *name)
+{
+    const Variant *variant = variant_find(name);
+    if (!variant) {
+        fprintf(stderr, "Unknown variant %s (have:", name);
+        for (int i = 0; i < VARIANT_COUNT; i++) {
+            fprintf(stderr, " %s", variants[i].name);
+        }
+        fprintf(stderr, ")\n");
+        return false;
+    }
+    current = variant;
+    tiles_reset();
+    return true;
+}
@@ -0,0 +1,100 @@
+/**
+ * XScrabble - Word Prefilter Implementation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "wordfilter.h"
+
+/* Odd multipliers picking one bit per lane from the low hash word */
+static const uint32_t lane_salts[WORDFILTER_LANES] = {
+    0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+    0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u
+};
+
+/* Case-insensitive FNV-1a with a final avalanche */
+static uint64_t hash_word(const char *word)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (const unsigned char *p = (const unsigned char *)word; *p; p++) {
+        unsigned char c = *p;
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+        h = (h ^ c) * 0x100000001b3ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    return h ^ (h >> 33);
+}
+
+static uint64_t *block_for(const WordFilter *filter, uint64_t h)
+{
+    uint32_t block = (uint32_t)(((h >> 32) * filter->block_count) >> 32);
+    return filter->blocks + (size_t)block * WORDFILTER_LANES;
+}
+
+/* Size an empty filter for the given number of words */
+bool wordfilter_init(WordFilter *filter, size_t words)
+{
+    size_t bits = words * WORDFILTER_BITS_PER_WORD;
+    size_t blocks = (bits + 64 * WORDFILTER_LANES - 1) / (64 * WORDFILTER_LANES);
+    size_t bytes;
+
+    if (blocks == 0) {
+        blocks = 1;
+    }
+    bytes = blocks * WORDFILTER_LANES * sizeof(uint64_t);
+    filter->blocks = (uint64_t *)aligned_alloc(64, bytes);
+    if (!filter->blocks) {
+        filter->block_count = 0;
+        return false;
+    }
+    memset(filter->blocks, 0, bytes);
+    filter->block_count = (uint32_t)blocks;
+    return true;
+}
+
+/* Release the filter; an empty filter accepts every word */
+void wordfilter_free(WordFilter *filter)
+{
+    free(filter->blocks);
+    filter->blocks = NULL;
+    filter->block_count = 0;
+}
+
+/* Add a word */
+void wordfilter_add(WordFilter *filter, const char *word)
+{
+    uint64_t h = hash_word(word);
+    uint64_t *lanes = block_for(filter, h);
+
+    for (int i = 0; i < WORDFILTER_LANES; i++) {
+        lanes[i] |= 1ULL << (((uint32_t)h * lane_salts[i]) >> 26);
+    }
+}
+
+/* False means the word was never added */
+bool wordfilter_may_contain(const WordFilter *filter, const char *word)
+{
+    if (!filter->blocks) {
+        return true;
+    }
+
+    uint64_t h = hash_word(word);
+    const uint64_t *lanes = block_for(filter, h);
+    uint64_t missing = 0;
+
+    for (int i = 0; i < WORDFILTER_LANES; i++) {
+        missing |= ~lanes[i] & (1ULL << (((uint32_t)h * lane_salts[i]) >> 26));
+    }
+    return missing == 0;
+}
+
+/* Memory used by the filter bits */
+size_t wordfilter_bytes(const WordFilter *filter)
+{
+    return (size_t)filter->block_count * WORDFILTER_LANES * sizeof(uint64_t);
+}
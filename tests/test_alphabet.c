@@ -0,0 +1,124 @@
+/**
+ * XScrabble - Alphabet Tests
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../include/alphabet.h"
+#include "../include/game.h"
+#include "../include/lexicon.h"
+#include "../include/movegen.h"
+#include "../include/tiles.h"
+
+/* A cut-down Spanish alphabet: digraph tiles, Ñ, and folded accents */
+static const char spanish[] =
+    "# Spanish\n"
+    "A \xc3\x81 \xc3\xa1\n"         /* Á á */
+    "C\n"
+    "CH\n"
+    "D\n"
+    "L\n"
+    "LL\n"
+    "N\n"
+    "\xc3\x91 \xc3\xb1\n"           /* Ñ ñ */
+    "O\n"
+    "R\n"
+    "RR\n"
+    "U \xc3\x9a \xc3\xba\n";        /* Ú ú */
+
+static void write_file(const char *path, const char *text)
+{
+    FILE *file = fopen(path, "w");
+    assert(file != NULL);
+    fputs(text, file);
+    fclose(file);
+}
+
+int main(void)
+{
+    char letters[DAWG_MAX_WORD_LENGTH + 1];
+    char text[64];
+
+    printf("Running alphabet tests...\n");
+
+    /* Test that English machine letters are the plain uppercase codes */
+    const Alphabet *english = alphabet_english();
+    assert(english->size == 26);
+    assert(alphabet_encode(english, "Cat", letters, sizeof(letters)) == 3);
+    assert(strcmp(letters, "CAT") == 0);
+    assert(alphabet_encode(english, "caf\xc3\xa9", letters, sizeof(letters)) == -1);
+    assert(alphabet_encode(english, "cats", letters, 4) == -1);
+    assert(alphabet_decode(english, "QI", 2, text, sizeof(text)) == 2);
+    assert(strcmp(text, "QI") == 0);
+    assert(alphabet_index(english, 'Z') == 25 && alphabet_index(english, '[') == -1);
+
+    /* Test longest-match encoding of digraphs and folding of accents */
+    Alphabet alphabet;
+    assert(alphabet_parse(&alphabet, spanish));
+    assert(alphabet.size == 12);
+    assert(alphabet_encode(&alphabet, "chorro", letters, sizeof(letters)) == 4);
+    assert(letters[0] == alphabet_letter(2) && letters[2] == alphabet_letter(10));
+    assert(alphabet_encode(&alphabet, "\xc3\x91" "and\xc3\xba", letters, sizeof(letters)) == 5);
+    assert(alphabet_decode(&alphabet, letters, 5, text, sizeof(text)) == 6);
+    assert(strcmp(text, "\xc3\x91" "ANDU") == 0);
+    assert(alphabet_encode(&alphabet, "llorar", letters, sizeof(letters)) == 5);
+    assert(strcmp(alphabet_spelling(&alphabet, letters[0]), "LL") == 0);
+    assert(alphabet_encode(&alphabet, "cabra", letters, sizeof(letters)) == -1);
+    assert(alphabet_decode(&alphabet, "C[", 2, text, 3) == -1);
+
+    /* Test malformed alphabets */
+    assert(!alphabet_parse(&alphabet, "# nothing\n"));
+    assert(!alphabet_parse(&alphabet, "A\nB a\n"));
+    assert(!alphabet_parse(&alphabet, "ABCDEFGHI\n"));
+    char *crowded = malloc(4 * (ALPHABET_MAX_LETTERS + 1) + 1);
+    assert(crowded != NULL);
+    crowded[0] = '\0';
+    for (int i = 0; i <= ALPHABET_MAX_LETTERS; i++) {
+        sprintf(crowded + strlen(crowded), "%c%c\n", 'A' + i / 26, 'A' + i % 26);
+    }
+    assert(!alphabet_parse(&alphabet, crowded));
+    free(crowded);
+
+    /* Test a lexicon, tiles and move generation in the alphabet */
+    assert(alphabet_parse(&alphabet, spanish));
+    write_file("test_alphabet_words.txt", "chorro\nllorar\n\xc3\x91" "and\xc3\xba\ncarro\ncabra\n");
+    Lexicon *lexicon = lexicon_load_alphabet("es", "test_alphabet_words.txt", &alphabet);
+    remove("test_alphabet_words.txt");
+    assert(lexicon != NULL);
+    assert(lexicon->dawg->word_count == 4);
+    assert(lexicon_contains(lexicon, "CHORRO"));
+    assert(lexicon_contains(lexicon, "\xc3\xb1" "andu"));
+    assert(!lexicon_contains(lexicon, "chorr"));
+    assert(!lexicon_contains(lexicon, "cabra"));
+
+    write_file("test_alphabet_tiles.txt",
+               "A 9 1\nCH 1 5\nD 2 2\nL 4 1\nLL 1 8\nN 5 1\n\xc3\x91 1 8\nO 9 1\nR 5 1\n"
+               "RR 1 8\nU 5 1\nZZ 1 1\n_ 2 0\n");
+    assert(tiles_load_alphabet("test_alphabet_tiles.txt", &alphabet));
+    remove("test_alphabet_tiles.txt");
+    assert(tiles_kinds() == 12);
+    assert(alphabet_encode(&alphabet, "ch", letters, sizeof(letters)) == 1);
+    assert(tiles_letter_value(letters[0]) == 5);
+    assert(tiles_letter_count(letters[0]) == 1);
+
+    MoveList moves;
+    bool found = false;
+    movegen_list_init(&moves);
+    assert(game_new(3));
+    assert(alphabet_encode(&alphabet, "rrochoa", letters, sizeof(letters)) == 5);
+    assert(movegen_generate(lexicon->dawg, letters, &moves) > 0);
+    for (int i = 0; i < moves.count; i++) {
+        movegen_format(&moves.moves[i], &alphabet, text, sizeof(text));
+        found |= strstr(text, " CHORRO ") != NULL && moves.moves[i].length == 4;
+    }
+    assert(found);
+    movegen_list_free(&moves);
+    movegen_cache_free();
+    lexicon_release(lexicon);
+    tiles_reset();
+
+    printf("Alphabet tests passed!\n");
+    return EXIT_SUCCESS;
+}
@@ -7,6 +7,97 @@
 #include <string.h>
 #include <assert.h>
 #include "../include/board.h"
+#include "../include/tiles.h"
+
+/* The padded layout agrees with the cells in both orientations, with an empty border */
+static bool layout_matches(void)
+{
+    const BoardLayout *layout = board_layout();
+    for (int d = BOARD_ACROSS; d <= BOARD_DOWN; d++) {
+        for (int line = 0; line < BOARD_PADDED; line++) {
+            for (int pos = 0; pos < BOARD_PADDED; pos++) {
+                int row = (d == BOARD_ACROSS ? line : pos) - 1;
+                int col = (d == BOARD_ACROSS ? pos : line) - 1;
+                const BoardCell *cell = board_get_cell(row, col);
+                uint8_t flags = layout->flags[d][line][pos];
+                if (!cell) {
+                    if (layout->letter[d][line][pos] || flags != BOARD_SQUARE_BORDER ||
+                        layout->letter_mult[d][line][pos] != 1 || layout->word_mult[d][line][pos] != 1) {
+                        return false;
+                    }
+                    continue;
+                }
+                int letter_mult = cell->type == CELL_DOUBLE_LETTER ? 2 :
+                                  cell->type == CELL_TRIPLE_LETTER ? 3 : 1;
+                int word_mult = cell->type == CELL_DOUBLE_WORD ? 2 :
+                                cell->type == CELL_TRIPLE_WORD ? 3 : 1;
+                if (layout->letter[d][line][pos] != tiles_face(cell->letter) ||
+                    !(flags & BOARD_SQUARE_BLANK) != !tiles_is_blank(cell->letter) ||
+                    !(flags & BOARD_SQUARE_FIXED) != !cell->is_fixed || (flags & BOARD_SQUARE_BORDER) ||
+                    layout->letter_mult[d][line][pos] != letter_mult ||
+                    layout->word_mult[d][line][pos] != word_mult) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/* The anchor index agrees with a scan of every square */
+static bool anchors_match(void)
+{
+    const BoardAnchors *anchors = board_anchors();
+    int tiles = 0;
+    for (int row = 0; row < board_size(); row++) {
+        for (int col = 0; col < board_size(); col++) {
+            tiles += board_get_cell(row, col)->letter != '\0';
+        }
+    }
+    if (anchors->tiles != tiles) {
+        return false;
+    }
+
+    for (int d = BOARD_ACROSS; d <= BOARD_DOWN; d++) {
+        for (int line = 1; line <= board_size(); line++) {
+            int count = 0;
+            int run = 0;
+            for (int pos = 1; pos <= board_size(); pos++) {
+                int row = (d == BOARD_ACROSS ? line : pos) - 1;
+                int col = (d == BOARD_ACROSS ? pos : line) - 1;
+                const BoardCell *cell = board_get_cell(row, col);
+                const BoardCell *up = board_get_cell(row - 1, col);
+                const BoardCell *down = board_get_cell(row + 1, col);
+                const BoardCell *left = board_get_cell(row, col - 1);
+                const BoardCell *right = board_get_cell(row, col + 1);
+                bool anchor = !cell->letter && ((up && up->letter) || (down && down->letter) ||
+                                                (left && left->letter) || (right && right->letter));
+                if (anchor != (anchors->mask[d][line] >> pos & 1)) {
+                    return false;
+                }
+                if (cell->letter) {
+                    run = 0;
+                    continue;
+                }
+                if (anchors->left_limit[d][line][pos] != run) {
+                    return false;
+                }
+                if (anchor) {
+                    if (anchors->list[d][line][count++] != pos) {
+                        return false;
+                    }
+                    run = 0;
+                } else {
+                    run++;
+                }
+            }
+            if (anchors->count[d][line] != count) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
 
 int main(void)
 {
@@ -53,6 +144,62 @@ int main(void)
     cell = board_get_cell(9, 9);
     assert(cell->letter == '\0');
     
+    /* Test the padded layout through every change */
+    assert(layout_matches());
+    assert(board_place_tile(0, 14, 'Q') && board_place_tile(1, 14, 'I'));
+    assert(board_layout()->letter[BOARD_DOWN][15][1] == 'Q');
+    assert(board_layout()->letter[BOARD_DOWN][15][2] == 'I');
+    assert(layout_matches());
+    board_commit_word();
+    assert(layout_matches());
+    char letters[BOARD_SQUARES];
+    board_snapshot(letters);
+    assert(board_lift_tile(1, 14));
+    assert(layout_matches());
+    assert(board_place_tile(14, 0, 'Z'));
+    board_restore(letters);
+    assert(layout_matches());
+    assert(board_get_cell(1, 14)->letter == 'I' && board_get_cell(14, 0)->letter == '\0');
+
+    /* A blank is laid out as its face, flagged as scoring nothing */
+    assert(board_place_tile(2, 14, tiles_blank_as('S')));
+    assert(board_layout()->letter[BOARD_DOWN][15][3] == 'S');
+    assert(board_layout()->flags[BOARD_DOWN][15][3] & BOARD_SQUARE_BLANK);
+    assert(layout_matches());
+    assert(board_remove_tile(2, 14));
+    assert(!(board_layout()->flags[BOARD_ACROSS][3][15] & BOARD_SQUARE_BLANK));
+    assert(layout_matches());
+    
+    /* Test the anchor index through random placements, commits and restores */
+    assert(anchors_match());
+    uint64_t rng = 1;
+    for (int step = 0; step < 400; step++) {
+        rng = rng * 6364136223846793005ULL + 1442695040888963407ULL;
+        int row = (int)(rng >> 33) % board_size();
+        int col = (int)(rng >> 45) % board_size();
+        switch ((rng >> 60) % 5) {
+        case 0:
+        case 1:
+            board_place_tile(row, col, (char)('A' + step % 26));
+            break;
+        case 2:
+            board_commit_word();
+            break;
+        case 3:
+            board_lift_tile(row, col);
+            break;
+        default:
+            if (step % 50 == 4) {
+                board_restore(letters);
+            } else {
+                board_revert_word();
+            }
+            break;
+        }
+        assert(anchors_match());
+        assert(layout_matches());
+    }
+    
     /* Clean up */
     board_cleanup();
     
@@ -0,0 +1,112 @@
+/**
+ * XScrabble - DAWG Tests
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../include/dawg.h"
+
+#define GENERATED_WORDS 20000
+
+/* Byte-for-byte comparison of two graphs */
+static bool same_graph(const Dawg *a, const Dawg *b)
+{
+    return a->edge_count == b->edge_count && a->root == b->root &&
+           a->word_count == b->word_count &&
+           memcmp(a->edges, b->edges, a->edge_count * sizeof(uint32_t)) == 0;
+}
+
+int main(void)
+{
+    printf("Running DAWG tests...\n");
+    
+    const char *words[] = { "care", "cares", "cat", "cats", "bare", "bares", "bat", "bats" };
+    const char *shuffled[] = { "bats", "cares", "bat", "care", "cats", "bare", "cat", "bares" };
+    size_t count = sizeof(words) / sizeof(words[0]);
+    
+    /* Test building and lookup */
+    Dawg *dawg = dawg_build(words, count);
+    assert(dawg != NULL);
+    assert(dawg->word_count == count);
+    for (size_t i = 0; i < count; i++) {
+        assert(dawg_contains(dawg, words[i]));
+    }
+    assert(dawg_contains(dawg, "CATS"));
+    assert(!dawg_contains(dawg, "ca"));
+    assert(!dawg_contains(dawg, "bar"));
+    assert(!dawg_contains(dawg, "catss"));
+    assert(!dawg_contains(dawg, ""));
+    
+    /* Test prefix walks */
+    uint32_t node;
+    bool terminal;
+    assert(dawg_walk(dawg, "car", &node, &terminal));
+    assert(!terminal && node != 0);
+    assert(dawg_walk(dawg, "bat", &node, &terminal));
+    assert(terminal);
+    assert(!dawg_walk(dawg, "cb", &node, &terminal));
+    
+    /* Test minimization: b... and c... share one suffix graph */
+    uint32_t b_edge = dawg_find_edge(dawg, dawg->root, dawg_letter_index('b'));
+    uint32_t c_edge = dawg_find_edge(dawg, dawg->root, dawg_letter_index('c'));
+    assert(b_edge && c_edge);
+    assert(dawg_edge_child(dawg->edges[b_edge]) == dawg_edge_child(dawg->edges[c_edge]));
+    
+    /* Test that the layout does not depend on insertion order */
+    Dawg *other = dawg_build(shuffled, count);
+    assert(other != NULL);
+    assert(other->edge_count == dawg->edge_count);
+    assert(other->root == dawg->root);
+    assert(memcmp(other->edges, dawg->edges, dawg->edge_count * sizeof(uint32_t)) == 0);
+    dawg_free(other);
+    
+    /* Test that the parallel build matches the sequential one */
+    for (int threads = 1; threads <= 8; threads *= 2) {
+        other = dawg_build_parallel(shuffled, count, threads);
+        assert(other != NULL && same_graph(dawg, other));
+        dawg_free(other);
+    }
+    
+    char (*generated)[12] = malloc(GENERATED_WORDS * sizeof(*generated));
+    const char **list = malloc((GENERATED_WORDS + 2) * sizeof(char *));
+    assert(generated && list);
+    unsigned x = 12345;
+    for (int i = 0; i < GENERATED_WORDS; i++) {
+        int length = 1 + i % 10;
+        for (int j = 0; j < length; j++) {
+            x = x * 1103515245u + 12345u;
+            generated[i][j] = "aeiostrnlcdbpmz"[(x >> 16) % 15];
+        }
+        generated[i][length] = '\0';
+        list[i] = generated[i];
+    }
+    list[GENERATED_WORDS] = "Mixed";
+    list[GENERATED_WORDS + 1] = "n0t-a-word";
+    Dawg *sequential = dawg_build(list, GENERATED_WORDS + 2);
+    for (int threads = 2; threads <= 32; threads *= 2) {
+        Dawg *parallel = dawg_build_parallel(list, GENERATED_WORDS + 2, threads);
+        assert(parallel != NULL && same_graph(sequential, parallel));
+        assert(dawg_contains(parallel, "mixed"));
+        dawg_free(parallel);
+    }
+    dawg_free(sequential);
+    free(list);
+    free(generated);
+    
+    /* Test the empty lexicon */
+    Dawg *empty = dawg_build(NULL, 0);
+    assert(empty != NULL);
+    assert(!dawg_contains(empty, "cat"));
+    dawg_free(empty);
+    empty = dawg_build_parallel(NULL, 0, 4);
+    assert(empty != NULL && empty->root == 0);
+    dawg_free(empty);
+    
+    /* Clean up */
+    dawg_free(dawg);
+    
+    printf("DAWG tests passed!\n");
+    return EXIT_SUCCESS;
+}
@@ -26,7 +26,27 @@ int main(void)
     /* Test invalid words */
     assert(!dictionary_is_word("xyzzy"));
     assert(!dictionary_is_word("qqq"));
-    
+
+    /* Test that a loaded list replaces the words and the prefilter */
+    const char *path = "test_dictionary.txt";
+    FILE *file = fopen(path, "w");
+    assert(file != NULL);
+    fputs("zebu\r\nAardvark\nqi\n\nzebu\nphotolithographically\n", file);
+    fclose(file);
+    assert(dictionary_load_file(path));
+    remove(path);
+    assert(dictionary_word_count() == 4);
+    assert(dictionary_memory_usage() < 256);
+    assert(dictionary_is_word("photolithographically"));
+    assert(!dictionary_is_word("photolithographicall"));
+    assert(!dictionary_is_word("photolithographicallyy"));
+    assert(!dictionary_is_word(""));
+    assert(dictionary_is_word("aardvark"));
+    assert(dictionary_is_word("QI"));
+    assert(dictionary_is_word("zebu"));
+    assert(!dictionary_is_word("weft"));
+    assert(!dictionary_is_word("zebus"));
+
     /* Clean up */
     dictionary_cleanup();
     
@@ -0,0 +1,188 @@
+/**
+ * XScrabble - Endgame Search Tests
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "../include/endgame.h"
+#include "../include/game.h"
+#include "../include/infer.h"
+#include "../include/movegen.h"
+#include "../include/tiles.h"
+
+static const char *words[] = {
+    "aa", "ab", "ad", "ae", "ag", "ah", "ai", "al", "am", "an", "ar", "as", "at", "aw",
+    "ax", "ay", "ba", "be", "bi", "bo", "by", "de", "do", "ed", "ef", "eh", "el", "em",
+    "en", "er", "es", "et", "ex", "fa", "go", "ha", "he", "hi", "hm", "ho", "id", "if",
+    "in", "is", "it", "jo", "ka", "la", "li", "lo", "ma", "me", "mi", "mo", "mu", "my",
+    "na", "ne", "no", "nu", "od", "oe", "of", "oh", "oi", "om", "on", "op", "or", "os",
+    "ow", "ox", "oy", "pa", "pe", "pi", "re", "sh", "si", "so", "ta", "ti", "to", "uh",
+    "um", "un", "up", "us", "ut", "we", "wo", "xi", "xu", "ya", "ye", "yo", "za",
+    "eat", "tea", "ate", "rat", "tar", "art", "net", "ten", "tone", "note", "stone",
+    "onset", "notes", "rates", "stare", "tears", "aster", "irate", "retain", "ratine"
+};
+
+/* Plain minimax over the same moves, for checking the search */
+static int minimax(const Dawg *dawg, int plies)
+{
+    GameState *state = game_get_state();
+    MoveList list;
+    int player = state->to_move;
+    int best = -1000000;
+
+    if (state->over || plies == 0) {
+        return 0;
+    }
+    movegen_list_init(&list);
+    movegen_generate(dawg, state->racks[player], &list);
+    for (int i = 0; i <= list.count; i++) {
+        Move pass = {0};
+        pass.type = MOVE_PASS;
+        const Move *move = i < list.count ? &list.moves[i] : &pass;
+        int before = state->scores[player] - state->scores[player ^ 1];
+        assert(game_play_move(move));
+        int delta = state->scores[player] - state->scores[player ^ 1] - before;
+        int value = delta - minimax(dawg, plies - 1);
+        assert(game_unplay_move());
+        best = value > best ? value : best;
+    }
+    movegen_list_free(&list);
+    return best;
+}
+
+/* Deal a new game from a tile set small enough to leave a pre-endgame bag */
+static void deal(const char *tiles, uint64_t seed)
+{
+    FILE *file = fopen("test_endgame_tiles.txt", "w");
+    assert(file != NULL);
+    fputs(tiles, file);
+    fclose(file);
+    assert(tiles_load("test_endgame_tiles.txt"));
+    assert(game_new(seed));
+}
+
+int main(void)
+{
+    printf("Running endgame search tests...\n");
+
+    Dawg *dawg = dawg_build(words, sizeof(words) / sizeof(words[0]));
+    assert(dawg != NULL);
+    TTable table;
+    assert(ttable_init(&table, 4));
+
+    /* Test the search against plain minimax, with and without the table */
+    assert(game_setup("TONES", "RATE", 0));
+    EndgameSearch search;
+    Move best;
+    endgame_init(&search, dawg, NULL);
+    int plain = minimax(dawg, 3);
+    assert(endgame_solve(&search, 3, &best) == plain);
+    assert(best.type == MOVE_PLACE);
+    endgame_free(&search);
+    endgame_init(&search, dawg, &table);
+    assert(endgame_solve(&search, 3, &best) == plain);
+    assert(endgame_solve(&search, 3, NULL) == plain);
+    endgame_free(&search);
+
+    /* Test a rack that goes out wins the opponent's tiles */
+    assert(game_setup("TEA", "QZ", 0));
+    endgame_init(&search, dawg, &table);
+    int value = endgame_solve(&search, 2, &best);
+    assert(best.type == MOVE_PLACE && best.tiles_played == 3);
+    assert(value == best.score + 2 * 20);
+    endgame_free(&search);
+
+    /* Test pre-endgame values against solving each split by hand */
+    deal("A 3 1\nE 3 1\nT 2 1\nO 2 1\nN 2 1\nS 1 1\nR 1 1\nZ 1 10\n", 5);
+    GameState *state = game_get_state();
+    assert(state->tiles_left == 1);
+    int mover = state->to_move;
+    EndgameCandidate candidates[ENDGAME_MAX_CANDIDATES];
+    int count = endgame_pre_candidates(dawg, state->racks[mover], 3, candidates);
+    assert(count >= 1 && count <= 4);
+    assert(candidates[count - 1].move.type == MOVE_PASS);
+
+    PreendgameSearch pre;
+    endgame_pre_defaults(&pre);
+    pre.plies = 2;
+    pre.threads = 1;
+    GameSnapshot root, after;
+    game_snapshot(&root);
+    assert(endgame_pre_solve(&pre, dawg, candidates, count));
+    game_snapshot(&after);
+    assert(memcmp(&root, &after, sizeof(root)) == 0);
+
+    char unseen[BAG_CAPACITY + 1];
+    int length = infer_unseen(mover, unseen, sizeof(unseen));
+    assert(length == 1 + (int)strlen(state->racks[mover ^ 1]));
+    int distinct = 0;
+    for (int i = 0; i < length; i++) {
+        distinct += strchr(unseen, unseen[i]) == &unseen[i];
+    }
+    assert(pre.splits == distinct);
+
+    endgame_init(&search, dawg, NULL);
+    for (int c = 0; c < count; c++) {
+        double expected = 0.0;
+        for (int i = 0; i < length; i++) {
+            /* Bag tile unseen[i], one way in length; the rest are the opponent's */
+            GameSnapshot split = root;
+            int slot = 0;
+            for (int j = 0; j < length; j++) {
+                if (j != i) {
+                    split.racks[mover ^ 1][slot++] = unseen[j];
+                }
+            }
+            split.racks[mover ^ 1][slot] = '\0';
+            split.tiles[0] = unseen[i];
+            game_restore(&split);
+            int before = state->scores[mover] - state->scores[mover ^ 1];
+            assert(game_play_move(&candidates[c].move));
+            int delta = state->scores[mover] - state->scores[mover ^ 1] - before;
+            expected += (delta - endgame_solve(&search, 1, NULL)) / (double)length;
+            assert(game_unplay_move());
+        }
+        assert(fabs(candidates[c].value - expected) < 1e-6);
+        assert(candidates[c].wins >= 0.0 && candidates[c].wins <= 1.0);
+    }
+    endgame_free(&search);
+    game_restore(&root);
+
+    /* Test threads sharing the table agree with one thread */
+    deal("A 3 1\nE 3 1\nT 2 1\nO 2 1\nN 2 1\nS 1 1\nR 1 1\nZ 1 10\nI 2 1\n", 7);
+    assert(state->tiles_left == 3);
+    count = endgame_pre_candidates(dawg, state->racks[state->to_move], 4, candidates);
+    EndgameCandidate shared[ENDGAME_MAX_CANDIDATES];
+    memcpy(shared, candidates, sizeof(candidates));
+    pre.table = NULL;
+    assert(endgame_pre_solve(&pre, dawg, candidates, count));
+    assert(pre.splits > 0);
+    ttable_clear(&table);
+    pre.threads = 4;
+    pre.table = &table;
+    assert(endgame_pre_solve(&pre, dawg, shared, count));
+    for (int c = 0; c < count; c++) {
+        assert(fabs(candidates[c].value - shared[c].value) < 1e-6);
+        assert(fabs(candidates[c].wins - shared[c].wins) < 1e-6);
+    }
+
+    /* Test bags outside the pre-endgame and split limits are refused */
+    pre.max_splits = 1;
+    assert(!endgame_pre_solve(&pre, dawg, candidates, count));
+    assert(game_setup("TEA", "QZ", 0));
+    pre.max_splits = ENDGAME_MAX_SPLITS;
+    assert(!endgame_pre_solve(&pre, dawg, candidates, count));
+
+    /* Clean up */
+    remove("test_endgame_tiles.txt");
+    tiles_reset();
+    ttable_free(&table);
+    movegen_cache_free();
+    dawg_free(dawg);
+
+    printf("Endgame search tests passed!\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,189 @@
+/**
+ * XScrabble - Static Evaluation Tests
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "../include/eval.h"
+#include "../include/game.h"
+#include "../include/tiles.h"
+
+static const char *words[] = {
+    "at", "ta", "cat", "act", "tab", "bat", "cab", "scab", "cats", "acts", "tabs", "bats",
+    "cabs", "stab", "abs", "as", "sat", "tas", "ad", "da", "dab", "bad", "sad", "ads",
+    "eat", "tea", "ate", "seat", "east", "eats", "teas", "set", "sea", "ae", "es", "ed"
+};
+
+static const char *racks[] = { "CATSBED", "EATSQ_D", "ABCDEST", "SEATTAB" };
+
+static void write_file(const char *path, const char *text)
+{
+    FILE *file = fopen(path, "w");
+    assert(file != NULL);
+    fputs(text, file);
+    fclose(file);
+}
+
+static bool close_to(float a, float b)
+{
+    return fabsf(a - b) < 1e-3f;
+}
+
+/* Rack left after a move */
+static void leave_after(const char *rack, const Move *move, char *leave)
+{
+    strcpy(leave, rack);
+    for (int i = 0; i < move->length; i++) {
+        char played = tiles_is_blank(move->tiles[i]) ? TILE_BLANK : move->tiles[i];
+        char *tile = played ? strchr(leave, played) : NULL;
+        if (tile) {
+            memmove(tile, tile + 1, strlen(tile));
+        }
+    }
+}
+
+/* Triple-word squares a move opens, found by walking from each placed tile */
+static int naive_lanes(const Move *move)
+{
+    int dr = move->direction == MOVE_DOWN ? 1 : 0;
+    int dc = move->direction == MOVE_ACROSS ? 1 : 0;
+    int opened = 0;
+
+    for (int row = 0; row < board_size(); row++) {
+        for (int col = 0; col < board_size(); col++) {
+            if (board_get_cell_type(row, col) != CELL_TRIPLE_WORD || board_get_cell(row, col)->letter) {
+                continue;
+            }
+
+            bool covered = false;
+            bool reached = false;
+            bool open = false;
+            for (int i = 0; i < move->length; i++) {
+                covered |= move->tiles[i] && move->row + dr * i == row && move->col + dc * i == col;
+            }
+            for (int d = 0; d < 4; d++) {
+                int sr = d == 0 ? 1 : d == 1 ? -1 : 0;
+                int sc = d == 2 ? 1 : d == 3 ? -1 : 0;
+                for (int step = 1; step <= RACK_SIZE; step++) {
+                    const BoardCell *cell = board_get_cell(row + sr * step, col + sc * step);
+                    if (!cell) {
+                        break;
+                    }
+                    if (cell->letter) {
+                        open = true;
+                        break;
+                    }
+                    for (int i = 0; i < move->length; i++) {
+                        reached |= move->tiles[i] && move->row + dr * i == row + sr * step &&
+                                   move->col + dc * i == col + sc * step;
+                    }
+                }
+            }
+            opened += reached && !covered && !open;
+        }
+    }
+    return opened;
+}
+
+int main(void)
+{
+    EvalWeights weights;
+    EvalContext context;
+    MoveList list;
+    char leave[RACK_SIZE + 1];
+
+    printf("Running evaluation tests...\n");
+    tiles_reset();
+    eval_default_weights(&weights);
+
+    /* Test leave values */
+    eval_prepare(&context, &weights, "", 50);
+    assert(eval_leave(&context, "S") > eval_leave(&context, "Q"));
+    assert(eval_leave(&context, "_") > eval_leave(&context, "S"));
+    assert(eval_leave(&context, "EE") < 2 * eval_leave(&context, "E"));
+    assert(eval_leave(&context, "AERST") > eval_leave(&context, "BCDFG"));
+    assert(eval_leave(&context, "AERST") > eval_leave(&context, "AEIOU"));
+    assert(close_to(eval_leave(&context, ""), 0.0f));
+    eval_prepare(&context, &weights, "", 0);
+    assert(close_to(eval_leave(&context, "QVVU"), 0.0f));
+
+    /* A pass keeps the whole rack */
+    Move pass = {0};
+    pass.type = MOVE_PASS;
+    eval_prepare(&context, &weights, "AQRSTU_", 50);
+    assert(close_to(eval_equity(&context, &pass), eval_leave(&context, "AQRSTU_")));
+
+    /* Test every generated move against its score, leave and naively counted lanes */
+    int word_count = sizeof(words) / sizeof(words[0]);
+    assert(lexicon_publish(lexicon_from_words("test", words, word_count)));
+    assert(game_use_lexicon("test"));
+    assert(game_new(5));
+    GameState *state = game_get_state();
+    const Dawg *dawg = state->lexicon->dawg;
+    int lanes_seen = 0;
+    movegen_list_init(&list);
+    for (int ply = 0; ply < 16 && !game_is_over(); ply++) {
+        strcpy(state->racks[state->to_move], racks[ply % 4]);
+        const char *rack = state->racks[state->to_move];
+        eval_prepare(&context, &weights, rack, state->tiles_left);
+        movegen_generate(dawg, rack, &list);
+
+        int best = -1;
+        for (int i = 0; i < list.count; i++) {
+            const Move *move = &list.moves[i];
+            int lanes = naive_lanes(move);
+            leave_after(rack, move, leave);
+            float expected = move->score + eval_leave(&context, leave) + context.lane * lanes;
+            float equity = eval_equity(&context, move);
+            assert(close_to(equity, expected));
+            if (best < 0 || equity > eval_equity(&context, &list.moves[best])) {
+                best = i;
+            }
+            lanes_seen += lanes;
+        }
+
+        /* The streaming search finds the same best move */
+        Move chosen;
+        float equity;
+        if (best < 0) {
+            assert(eval_best_move(&context, dawg, rack, &chosen, &equity) == 0);
+            game_pass_turn();
+            continue;
+        }
+        assert(eval_best_move(&context, dawg, rack, &chosen, &equity) == 1);
+        assert(close_to(equity, eval_equity(&context, &list.moves[best])));
+        assert(game_play_move(&chosen));
+    }
+    assert(lanes_seen > 0);
+    movegen_list_free(&list);
+
+    /* Test loading weights */
+    write_file("test_eval_weights.txt",
+               "# test weights\nletter Q 5\nletter _ 30 # blank\nduplicate -1\n"
+               "balance 0 2 -4\nscale 3 2\nlane 3 -10\nvowels A E I O U Y\n");
+    assert(eval_load_weights(&weights, "test_eval_weights.txt", NULL));
+    assert(weights.letter['Q' - 'A'] == 5.0f && weights.letter[ALPHABET_MAX_LETTERS] == 30.0f);
+    assert(weights.letter['S' - 'A'] == 7.5f);
+    assert(weights.duplicate == -1.0f && weights.balance[0][2] == -4.0f);
+    assert(weights.leave_scale[3] == 2.0f && weights.lane[3] == -10.0f);
+    assert(weights.vowel['Y' - 'A'] && weights.vowel['A' - 'A'] && !weights.vowel['S' - 'A']);
+    eval_prepare(&context, &weights, "", 50);
+    assert(close_to(eval_leave(&context, "Q"), 2 * (5.0f + weights.balance[0][1])));
+
+    write_file("test_eval_weights.txt", "letter Q 5\nletter 7 1\n");
+    assert(!eval_load_weights(&weights, "test_eval_weights.txt", NULL));
+    write_file("test_eval_weights.txt", "scale 4 1\n");
+    assert(!eval_load_weights(&weights, "test_eval_weights.txt", NULL));
+    write_file("test_eval_weights.txt", "bogus 1\n");
+    assert(!eval_load_weights(&weights, "test_eval_weights.txt", NULL));
+    remove("test_eval_weights.txt");
+    assert(!eval_load_weights(&weights, "test_eval_weights.txt", NULL));
+
+    movegen_cache_free();
+    lexicon_registry_clear();
+    printf("Evaluation tests passed!\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,164 @@
+/**
+ * XScrabble - Exchange Evaluation Tests
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "../include/exchange.h"
+#include "../include/game.h"
+#include "../include/movegen.h"
+#include "../include/tiles.h"
+
+static const char *words[] = {
+    "at", "ta", "cat", "act", "tab", "bat", "cab", "scab", "cats", "acts", "tabs", "bats",
+    "cabs", "stab", "abs", "as", "sat", "tas", "ad", "da", "dab", "bad", "sad", "ads",
+    "eat", "tea", "ate", "seat", "east", "eats", "teas", "set", "sea", "ae", "es", "ed"
+};
+
+/* Per-tile counts of a string of rack tiles */
+static void count_tiles(const char *tiles, int length, int counts[256])
+{
+    for (int i = 0; i < length; i++) {
+        counts[(unsigned char)tiles[i]]++;
+    }
+}
+
+/* Counts of the bag and both racks, which an exchange must leave unchanged */
+static void count_game(const GameState *state, int counts[256])
+{
+    memset(counts, 0, 256 * sizeof(int));
+    count_tiles(state->bag, state->tiles_left, counts);
+    count_tiles(state->racks[0], (int)strlen(state->racks[0]), counts);
+    count_tiles(state->racks[1], (int)strlen(state->racks[1]), counts);
+}
+
+static bool close_to(float a, float b)
+{
+    return fabsf(a - b) < 1e-3f;
+}
+
+int main(void)
+{
+    printf("Running exchange evaluation tests...\n");
+
+    EvalWeights weights;
+    EvalContext eval;
+    ExchangeContext context;
+    char unseen[EXCHANGE_MAX_UNSEEN + 1];
+    eval_default_weights(&weights);
+
+    /* Test sub-rack numbering: a repeated tile counts once per copy kept */
+    const char *rack = "AEEQSTT";
+    const char *pool = "AAEEIIOOUNNRRLLSTDG";
+    eval_prepare(&eval, &weights, rack, 80);
+    exchange_prepare(&context, &eval, rack, pool, 80, EXCHANGE_SAMPLES, 1);
+    assert(context.letters == 5);
+    assert(context.keeps == 2 * 3 * 2 * 2 * 3);
+    assert(context.can_exchange);
+    assert(exchange_keep_index(&context, "") == 0);
+    assert(exchange_keep_index(&context, rack) == context.keeps - 1);
+    assert(exchange_keep_index(&context, "TEST") == exchange_keep_index(&context, "SETT"));
+    assert(exchange_keep_index(&context, "TTT") == -1);
+    assert(exchange_keep_index(&context, "Z") == -1);
+
+    /* Test the same seed samples the same refills */
+    ExchangeContext again;
+    exchange_prepare(&again, &eval, rack, pool, 80, EXCHANGE_SAMPLES, 1);
+    assert(memcmp(again.value, context.value, context.keeps * sizeof(float)) == 0);
+
+    /* Test moves are valued by what they keep */
+    Move move = {0};
+    move.type = MOVE_EXCHANGE;
+    strcpy(move.tiles, "QT");
+    move.length = 2;
+    assert(close_to(exchange_equity(&context, &move),
+                    context.value[exchange_keep_index(&context, "AEEST")]));
+    move.type = MOVE_PLACE;
+    move.score = 12;
+    assert(close_to(exchange_equity(&context, &move),
+                    12.0f + context.value[exchange_keep_index(&context, "AEEST")]));
+    strcpy(move.tiles, "QQ");
+    assert(exchange_equity(&context, &move) == -INFINITY);
+    move.type = MOVE_PASS;
+    assert(close_to(exchange_equity(&context, &move), context.value[context.keeps - 1]));
+
+    /* Test the best exchange returns the tiles of the best proper sub-rack */
+    Move exchange;
+    float value;
+    assert(exchange_best(&context, &exchange, &value));
+    assert(exchange.type == MOVE_EXCHANGE && exchange.length > 0 && exchange.length < 7);
+    assert(close_to(exchange_equity(&context, &exchange), value));
+    for (int k = 0; k < context.keeps - 1; k++) {
+        assert(context.value[k] <= value + 1e-3f);
+    }
+
+    /* Test a bag with fewer tiles than a rack cannot be exchanged into */
+    exchange_prepare(&context, &eval, rack, pool, 3, EXCHANGE_SAMPLES, 1);
+    assert(!context.can_exchange);
+    assert(!exchange_best(&context, &exchange, NULL));
+
+    /* Test an unplayable rack exchanges rather than passes */
+    Dawg *dawg = dawg_build(words, sizeof(words) / sizeof(words[0]));
+    assert(dawg != NULL);
+    assert(game_setup("QVVWWUU", "AEIOUST", 80));
+    eval_prepare(&eval, &weights, "QVVWWUU", 80);
+    exchange_prepare(&context, &eval, "QVVWWUU", pool, 80, EXCHANGE_SAMPLES, 5);
+    assert(exchange_decide(&context, &eval, dawg, "QVVWWUU", &move, &value));
+    assert(move.type == MOVE_EXCHANGE);
+    exchange_prepare(&context, &eval, "QVVWWUU", pool, 3, EXCHANGE_SAMPLES, 5);
+    assert(!exchange_decide(&context, &eval, dawg, "QVVWWUU", &move, NULL));
+    assert(move.type == MOVE_PASS);
+
+    /* Test a good rack plays */
+    assert(game_setup("CATSBED", "AEIOUST", 80));
+    eval_prepare(&eval, &weights, "CATSBED", 80);
+    exchange_prepare(&context, &eval, "CATSBED", pool, 80, EXCHANGE_SAMPLES, 5);
+    assert(exchange_decide(&context, &eval, dawg, "CATSBED", &move, NULL));
+    assert(move.type == MOVE_PLACE);
+
+    /* Test exchanging in an engine game keeps every tile and undoes exactly */
+    GameState *state = game_get_state();
+    GameSnapshot before, after;
+    int counts[256], counts_after[256];
+    assert(game_new(9));
+    count_game(state, counts);
+    assert(exchange_unseen(state, 0, unseen) == state->tiles_left + (int)strlen(state->racks[1]));
+    game_snapshot(&before);
+    assert(game_change_letters());
+    assert(state->to_move == 1 && state->scores[0] == 0);
+    assert(state->tiles_left == before.tiles_left);
+    assert((int)strlen(state->racks[0]) == 7);
+    count_game(state, counts_after);
+    assert(memcmp(counts, counts_after, sizeof(counts)) == 0);
+    game_snapshot(&after);
+    assert(game_unplay_move());
+    GameSnapshot undone;
+    game_snapshot(&undone);
+    assert(memcmp(&undone, &before, sizeof(undone)) == 0);
+    assert(game_change_letters());
+    game_snapshot(&undone);
+    assert(memcmp(&undone, &after, sizeof(undone)) == 0);
+
+    /* Test an exchange of tiles not on the rack, or from a short bag, is refused */
+    move.type = MOVE_EXCHANGE;
+    strcpy(move.tiles, "ZZ");
+    move.length = 2;
+    if (!strchr(state->racks[state->to_move], 'Z')) {
+        assert(!game_play_move(&move));
+    }
+    assert(game_setup("QVVWWUU", "AEIOUST", 6));
+    strcpy(move.tiles, "Q");
+    move.length = 1;
+    assert(!game_play_move(&move));
+    assert(!game_change_letters());
+
+    /* Clean up */
+    movegen_cache_free();
+    dawg_free(dawg);
+
+    printf("Exchange evaluation tests passed!\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,642 @@
+/**
+ * XScrabble - Differential Fuzz Tests
+ *
+ * Replays move sequences chosen by an input byte string and checks the
+ * optimized engine against naive references: a linear word-list scan for
+ * the dictionary, brute-force placement of every word for move generation,
+ * and a plain char grid for the board, its scores and its undo, on every
+ * rule variant. Built with
+ * XSCRABBLE_LIBFUZZER the file is a libFuzzer target; otherwise main()
+ * runs a fixed number of pseudo-random inputs as a bounded test.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <assert.h>
+#include "../include/board.h"
+#include "../include/dawg.h"
+#include "../include/dictionary.h"
+#include "../include/game.h"
+#include "../include/lexicon.h"
+#include "../include/movegen.h"
+#include "../include/tiles.h"
+
+#define FUZZ_CASES 32           /* Inputs run by the bounded test */
+#define FUZZ_INPUT_SIZE 96
+#define FUZZ_MAX_STEPS 40       /* Operations replayed per input */
+#define FUZZ_MAX_MOVES 4096
+
+/* Short words, so that almost every rack has plays */
+static const char *words[] = {
+    "aa", "ab", "ad", "ae", "ag", "ah", "ai", "al", "am", "an", "ar", "as", "at", "aw", "ax",
+    "ay", "ba", "be", "bi", "bo", "by", "da", "de", "do", "ed", "ef", "eh", "el", "em", "en",
+    "er", "es", "et", "ex", "fa", "go", "ha", "he", "hi", "hm", "ho", "id", "if", "in", "is",
+    "it", "jo", "ka", "la", "li", "lo", "ma", "me", "mi", "mm", "mo", "mu", "my", "na", "ne",
+    "no", "nu", "od", "oe", "of", "oh", "om", "on", "op", "or", "os", "ow", "ox", "oy", "pa",
+    "pe", "pi", "re", "sh", "si", "so", "ta", "ti", "to", "uh", "um", "un", "up", "us", "ut",
+    "we", "wo", "xi", "xu", "ya", "ye", "yo", "ads", "ait", "apt", "axe", "bas", "bel", "bet",
+    "bos", "bur", "buy", "cay", "cor", "coy", "dap", "den", "dig", "dis", "eme", "eth", "fas",
+    "fed", "fig", "fir", "fun", "gal", "ghi", "gut", "guy", "heh", "hie", "hon", "hue", "huh",
+    "ice", "ire", "jam", "jun", "kab", "keg", "kex", "kif", "lap", "lav", "lee", "lib", "lie",
+    "luv", "mel", "mol", "mop", "mor", "mut", "nun", "oft", "ole", "out", "oxo", "pac", "pas",
+    "pet", "phi", "pud", "qua", "raw", "rec", "res", "ret", "rob", "rut", "rye", "sad", "sag",
+    "sha", "sin", "sob", "sow", "vee", "wet", "wot", "yob", "adds", "ansa", "aped", "asci",
+    "azan", "bend", "bets", "coil", "coof", "cool", "coot", "curt", "dyke", "etas", "fair",
+    "geds", "haps", "hins", "hots", "hoys", "keef", "knee", "knot", "meou", "milk", "mots",
+    "nixe", "okay", "okes", "ours", "pugs", "regs", "shat", "shew", "sims", "swap", "syli",
+    "titi", "tour", "trio", "twas", "vamp", "volt", "weds", "weka", "weld", "whit", "woes",
+    "wyte", "yech", "agaze", "aquas", "auxin", "balmy", "biali", "chess", "clone", "cores",
+    "dusky", "gloss", "gunks", "hiked", "kikes", "leafs", "lippy", "loams", "loofa", "midst",
+    "minor", "nasty", "plots", "roast", "sabra", "silos", "simps", "smalt", "sulfa", "throw",
+    "tramp", "zebus",
+};
+
+#define WORD_COUNT ((int)(sizeof(words) / sizeof(words[0])))
+
+/* Input bytes; reading past the end gives zeros */
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+} FuzzInput;
+
+/* Reference copy of a committed position, one per turn taken */
+typedef struct {
+    char grid[BOARD_MAX_SIZE][BOARD_MAX_SIZE];
+    char racks[2][RACK_SIZE + 1];
+    int scores[2];
+    int to_move;
+    uint64_t hash;
+} ModelEntry;
+
+/* Characters dictionary queries are made of, including some that are never letters */
+static const char query_chars[] = "aeinorstlcdmuABEHIOSTXZqjwy['- ";
+
+static Lexicon *lexicon;
+static char model[BOARD_MAX_SIZE][BOARD_MAX_SIZE];
+static bool fresh[BOARD_MAX_SIZE][BOARD_MAX_SIZE];
+static ModelEntry history[FUZZ_MAX_STEPS];
+static int history_count;
+static Move expected[FUZZ_MAX_MOVES];
+static int expected_count;
+
+static unsigned next_byte(FuzzInput *input)
+{
+    return input->pos < input->size ? input->data[input->pos++] : 0;
+}
+
+/* Reference dictionary: a linear scan of the word list */
+static bool reference_is_word(const char *word)
+{
+    for (int i = 0; i < WORD_COUNT; i++) {
+        if (strcasecmp(word, words[i]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Letter on the model board; 0 for empty squares and off the board */
+static char model_at(int row, int col)
+{
+    if (row < 0 || row >= board_size() || col < 0 || col >= board_size()) {
+        return 0;
+    }
+    return model[row][col];
+}
+
+/* Read the word through (row, col) along (dr, dc) and score it, premiums only under new tiles */
+static int model_word(int row, int col, int dr, int dc, char *word)
+{
+    int sum = 0;
+    int multiplier = 1;
+    int length = 0;
+
+    while (model_at(row - dr, col - dc)) {
+        row -= dr;
+        col -= dc;
+    }
+    for (; model_at(row, col); row += dr, col += dc) {
+        CellType type = board_get_cell_type(row, col);
+        int points = tiles_letter_value(model[row][col]);
+        if (fresh[row][col]) {
+            points *= type == CELL_DOUBLE_LETTER ? 2 : type == CELL_TRIPLE_LETTER ? 3 : 1;
+            multiplier *= type == CELL_DOUBLE_WORD ? 2 : type == CELL_TRIPLE_WORD ? 3 : 1;
+        }
+        word[length++] = model[row][col];
+        sum += points;
+    }
+    word[length] = '\0';
+    return length < 2 ? 0 : sum * multiplier;
+}
+
+/* Put a move's tiles down, read every word formed, then lift them again; -1 if one is not a word */
+static int model_score(const Move *move)
+{
+    int dr = move->direction == MOVE_DOWN ? 1 : 0;
+    int dc = move->direction == MOVE_ACROSS ? 1 : 0;
+    int row = move->row;
+    int col = move->col;
+
+    for (int i = 0; i < move->length; i++) {
+        if (move->tiles[i]) {
+            model[row + dr * i][col + dc * i] = move->tiles[i];
+            fresh[row + dr * i][col + dc * i] = true;
+        }
+    }
+    char text[BOARD_MAX_SIZE + 1];
+    bool legal = true;
+    int score = model_word(row, col, dr, dc, text);
+    for (int i = 0; i < move->length && legal; i++) {
+        if (move->tiles[i]) {
+            int cross = model_word(row + dr * i, col + dc * i, dc, dr, text);
+            legal = strlen(text) < 2 || reference_is_word(text);
+            score += cross;
+
+            /* The generator lists a lone tile once, as the across word it makes */
+            legal &= !(move->direction == MOVE_DOWN && move->tiles_played == 1 && strlen(text) >= 2);
+        }
+    }
+    for (int i = 0; i < move->length; i++) {
+        if (move->tiles[i]) {
+            model[row + dr * i][col + dc * i] = 0;
+            fresh[row + dr * i][col + dc * i] = false;
+        }
+    }
+    const Variant *variant = board_variant();
+    return legal ? score + (move->tiles_played == variant->rack_size ? variant->bingo_bonus : 0) : -1;
+}
+
+/*
+ * Reference move generation: lay word from (row, col) and keep it if the
+ * squares, the rack, the connection rules and every cross word allow it.
+ * Blanks stand in only for letters the rack runs out of, and every choice
+ * of which copies of such a letter are blank is scored to keep the best.
+ */
+static void reference_try(int direction, int row, int col, const char *word, const int rack[26],
+                          int blanks, bool empty_board)
+{
+    int dr = direction == MOVE_DOWN ? 1 : 0;
+    int dc = direction == MOVE_ACROSS ? 1 : 0;
+    int length = (int)strlen(word);
+    int used[26] = {0};
+    int blanked[26] = {0};
+    bool touches = false;
+    bool centre = false;
+    Move move;
+
+    if (row + dr * (length - 1) >= board_size() || col + dc * (length - 1) >= board_size() ||
+        model_at(row - dr, col - dc) || model_at(row + dr * length, col + dc * length)) {
+        return;
+    }
+
+    memset(&move, 0, sizeof(move));
+    move.type = MOVE_PLACE;
+    move.direction = (uint8_t)direction;
+    move.row = (uint8_t)row;
+    move.col = (uint8_t)col;
+    move.length = (uint8_t)length;
+    for (int i = 0; i < length; i++) {
+        int r = row + dr * i;
+        int c = col + dc * i;
+        char letter = (char)(word[i] - 'a' + 'A');
+        if (model[r][c]) {
+            if (tiles_face(model[r][c]) != letter) {
+                return;
+            }
+            continue;
+        }
+        if (++used[letter - 'A'] > rack[letter - 'A']) {
+            if (blanks-- == 0) {
+                return;
+            }
+            blanked[letter - 'A']++;
+        }
+        move.tiles[i] = letter;
+        move.tiles_played++;
+        touches |= model_at(r - 1, c) || model_at(r + 1, c) || model_at(r, c - 1) || model_at(r, c + 1);
+        centre |= r == board_size() / 2 && c == board_size() / 2;
+    }
+    if (move.tiles_played == 0 || !(empty_board ? centre : touches)) {
+        return;
+    }
+
+    /* Try every set of squares for the blanks, keeping the best scoring */
+    Move best;
+    best.score = -1;
+    for (unsigned mask = 0; mask < 1u << length; mask++) {
+        int count[26] = {0};
+        bool fits = true;
+        Move trial = move;
+        for (int i = 0; i < length && fits; i++) {
+            if (mask >> i & 1) {
+                fits = move.tiles[i] && ++count[move.tiles[i] - 'A'] <= blanked[move.tiles[i] - 'A'];
+                trial.tiles[i] = tiles_blank_as(move.tiles[i]);
+            }
+        }
+        for (int letter = 0; letter < 26 && fits; letter++) {
+            fits = count[letter] == blanked[letter];
+        }
+        if (!fits) {
+            continue;
+        }
+        trial.score = model_score(&trial);
+        if (trial.score < 0) {
+            return;
+        }
+        if (trial.score > best.score) {
+            best = trial;
+        }
+    }
+
+    assert(expected_count < FUZZ_MAX_MOVES);
+    expected[expected_count++] = best;
+}
+
+/* Tiles of a move laid out by face, so designations of the blanks compare equal */
+static void move_faces(const Move *move, char *faces)
+{
+    for (int i = 0; i < move->length; i++) {
+        faces[i] = tiles_face(move->tiles[i]);
+    }
+}
+
+static int move_blanks(const Move *move)
+{
+    int blanks = 0;
+    for (int i = 0; i < move->length; i++) {
+        blanks += tiles_is_blank(move->tiles[i]);
+    }
+    return blanks;
+}
+
+static int compare_moves(const void *a, const void *b)
+{
+    const Move *x = (const Move *)a;
+    const Move *y = (const Move *)b;
+    if (x->direction != y->direction) {
+        return x->direction - y->direction;
+    }
+    if (x->row != y->row) {
+        return x->row - y->row;
+    }
+    if (x->col != y->col) {
+        return x->col - y->col;
+    }
+    if (x->length != y->length) {
+        return x->length - y->length;
+    }
+    char x_faces[BOARD_MAX_SIZE];
+    char y_faces[BOARD_MAX_SIZE];
+    move_faces(x, x_faces);
+    move_faces(y, y_faces);
+    return memcmp(x_faces, y_faces, x->length);
+}
+
+/* Every placement of every word for the rack, sorted like compare_moves */
+static void reference_generate(const char *rack)
+{
+    int counts[26] = {0};
+    int blanks = 0;
+    bool empty_board = true;
+
+    for (const char *p = rack; *p; p++) {
+        if (*p >= 'A' && *p <= 'Z') {
+            counts[*p - 'A']++;
+        }
+        blanks += *p == TILE_BLANK;
+    }
+    for (int r = 0; r < board_size(); r++) {
+        for (int c = 0; c < board_size(); c++) {
+            empty_board &= !model[r][c];
+        }
+    }
+
+    expected_count = 0;
+    for (int direction = MOVE_ACROSS; direction <= MOVE_DOWN; direction++) {
+        for (int r = 0; r < board_size(); r++) {
+            for (int c = 0; c < board_size(); c++) {
+                for (int w = 0; w < WORD_COUNT; w++) {
+                    reference_try(direction, r, c, words[w], counts, blanks, empty_board);
+                }
+            }
+        }
+    }
+    qsort(expected, expected_count, sizeof(Move), compare_moves);
+}
+
+/* The engine's list must hold exactly the reference moves, with the same scores and blanks */
+static void check_same_moves(MoveList *list)
+{
+    qsort(list->moves, list->count, sizeof(Move), compare_moves);
+    assert(list->count == expected_count);
+    for (int i = 0; i < expected_count; i++) {
+        assert(compare_moves(&list->moves[i], &expected[i]) == 0);
+        assert(list->moves[i].tiles_played == expected[i].tiles_played);
+        assert(list->moves[i].score == expected[i].score);
+        assert(move_blanks(&list->moves[i]) == move_blanks(&expected[i]));
+        assert(game_score_move(&expected[i]) == expected[i].score);
+        assert(game_score_move(&list->moves[i]) == expected[i].score);
+    }
+}
+
+static int compare_scores(const void *a, const void *b)
+{
+    return *(const int *)b - *(const int *)a;
+}
+
+/* Top-K must be some K best reference moves, best first */
+static void check_top_k(const char *rack, int k)
+{
+    static int scores[FUZZ_MAX_MOVES];
+    Move best[16];
+
+    for (int i = 0; i < expected_count; i++) {
+        scores[i] = expected[i].score;
+    }
+    qsort(scores, expected_count, sizeof(int), compare_scores);
+
+    int found = movegen_top_k(lexicon->dawg, rack, best, k);
+    assert(found == (expected_count < k ? expected_count : k));
+    for (int i = 0; i < found; i++) {
+        assert(best[i].score == scores[i]);
+        assert(bsearch(&best[i], expected, expected_count, sizeof(Move), compare_moves) != NULL);
+    }
+}
+
+/* Engine board, change stamps and game state against the model */
+static void check_board(const char before[BOARD_MAX_SIZE][BOARD_MAX_SIZE], const uint64_t rows[BOARD_MAX_SIZE],
+                        const uint64_t cols[BOARD_MAX_SIZE])
+{
+    for (int r = 0; r < board_size(); r++) {
+        for (int c = 0; c < board_size(); c++) {
+            assert(board_get_cell(r, c)->letter == model[r][c]);
+            if (before && before[r][c] != model[r][c]) {
+                assert(board_row_stamp(r) != rows[r]);
+                assert(board_col_stamp(c) != cols[c]);
+            }
+        }
+    }
+}
+
+static void save_stamps(uint64_t rows[BOARD_MAX_SIZE], uint64_t cols[BOARD_MAX_SIZE])
+{
+    for (int i = 0; i < board_size(); i++) {
+        rows[i] = board_row_stamp(i);
+        cols[i] = board_col_stamp(i);
+    }
+}
+
+static void push_history(void)
+{
+    const GameState *state = game_get_state();
+    ModelEntry *entry = &history[history_count++];
+
+    memcpy(entry->grid, model, sizeof(model));
+    memcpy(entry->racks, state->racks, sizeof(entry->racks));
+    entry->scores[0] = state->scores[0];
+    entry->scores[1] = state->scores[1];
+    entry->to_move = state->to_move;
+    entry->hash = game_hash();
+}
+
+/* Generate with and without the line cache, compare, then maybe play one of the moves */
+static void step_generate(FuzzInput *input, MoveList *list)
+{
+    GameState *state = game_get_state();
+    char rack[RACK_SIZE + 1];
+    unsigned choice = next_byte(input);
+
+    strcpy(rack, state->racks[state->to_move]);
+    reference_generate(rack);
+    for (int cached = 0; cached <= 1; cached++) {
+        movegen_cache_enable(cached == (int)(choice & 1));
+        movegen_generate(lexicon->dawg, rack, list);
+        check_same_moves(list);
+    }
+    movegen_cache_enable(true);
+    check_top_k(rack, 1 + (int)(choice >> 1) % 16);
+
+    if (expected_count == 0 || state->over || history_count == FUZZ_MAX_STEPS) {
+        return;
+    }
+
+    const Move *move = &expected[next_byte(input) % expected_count];
+    char before[BOARD_MAX_SIZE][BOARD_MAX_SIZE];
+    uint64_t rows[BOARD_MAX_SIZE];
+    uint64_t cols[BOARD_MAX_SIZE];
+    int player = state->to_move;
+    int score = state->scores[player];
+
+    memcpy(before, model, sizeof(model));
+    save_stamps(rows, cols);
+    push_history();
+    assert(game_play_move(move));
+    for (int i = 0; i < move->length; i++) {
+        if (move->tiles[i]) {
+            int r = move->row + (move->direction == MOVE_DOWN ? i : 0);
+            int c = move->col + (move->direction == MOVE_ACROSS ? i : 0);
+            model[r][c] = move->tiles[i];
+        }
+    }
+    check_board(before, rows, cols);
+    assert(state->scores[player] >= score + move->score);
+    assert(game_hash() != history[history_count - 1].hash);
+}
+
+/* Take back the last turn and expect the position before it */
+static void step_unplay(void)
+{
+    if (history_count == 0) {
+        return;
+    }
+
+    const GameState *state = game_get_state();
+    const ModelEntry *entry = &history[--history_count];
+    char before[BOARD_MAX_SIZE][BOARD_MAX_SIZE];
+    uint64_t rows[BOARD_MAX_SIZE];
+    uint64_t cols[BOARD_MAX_SIZE];
+
+    memcpy(before, model, sizeof(model));
+    save_stamps(rows, cols);
+    assert(game_unplay_move());
+    memcpy(model, entry->grid, sizeof(model));
+    check_board(before, rows, cols);
+    assert(memcmp(state->racks, entry->racks, sizeof(entry->racks)) == 0);
+    assert(state->scores[0] == entry->scores[0] && state->scores[1] == entry->scores[1]);
+    assert(state->to_move == entry->to_move);
+    assert(game_hash() == entry->hash);
+}
+
+/* A snapshot taken, moved past and restored must give back the same position */
+static void step_snapshot(void)
+{
+    const GameState *state = game_get_state();
+    GameSnapshot snapshot;
+    Move best;
+    uint64_t hash = game_hash();
+    int to_move = state->to_move;
+
+    game_snapshot(&snapshot);
+    if (movegen_top_k(lexicon->dawg, state->racks[to_move], &best, 1) == 1) {
+        game_play_move(&best);
+    } else {
+        game_pass_turn();
+    }
+    game_restore(&snapshot);
+    check_board(NULL, NULL, NULL);
+    assert(game_hash() == hash && state->to_move == to_move);
+
+    /* Restoring drops the undo history */
+    assert(game_undo_depth() == 0);
+    history_count = 0;
+}
+
+/* Ask every dictionary the same question the word list answers */
+static void step_dictionary(FuzzInput *input)
+{
+    char word[DAWG_MAX_WORD_LENGTH + 2];
+    unsigned kind = next_byte(input);
+    int length;
+
+    if (kind & 1) {
+        /* A listed word with one edit: case flip, substitution, insertion or deletion */
+        strcpy(word, words[next_byte(input) % WORD_COUNT]);
+        length = (int)strlen(word);
+        int at = (int)(next_byte(input) % (unsigned)length);
+        char letter = query_chars[next_byte(input) % (sizeof(query_chars) - 1)];
+        switch ((kind >> 1) % 4) {
+        case 0:
+            word[at] = (char)(word[at] - 'a' + 'A');
+            break;
+        case 1:
+            word[at] = letter;
+            break;
+        case 2:
+            memmove(word + at + 1, word + at, (size_t)(length - at + 1));
+            word[at] = letter;
+            break;
+        default:
+            memmove(word + at, word + at + 1, (size_t)(length - at));
+            break;
+        }
+    } else {
+        length = 1 + (int)((kind >> 1) % 8);
+        for (int i = 0; i < length; i++) {
+            word[i] = query_chars[next_byte(input) % (sizeof(query_chars) - 1)];
+        }
+        word[length] = '\0';
+    }
+
+    bool listed = reference_is_word(word);
+    assert(dictionary_is_word(word) == listed);
+    assert(dawg_contains(lexicon->dawg, word) == listed);
+    assert(lexicon_contains(lexicon, word) == listed);
+}
+
+/* Build the lexicon and dictionary every input is checked against */
+static void setup(void)
+{
+    if (lexicon) {
+        return;
+    }
+
+    tiles_reset();
+    assert(lexicon_publish(lexicon_from_words("fuzz", words, WORD_COUNT)));
+    assert(game_use_lexicon("fuzz"));
+    lexicon = lexicon_acquire("fuzz");
+    assert(lexicon != NULL);
+
+    FILE *file = fopen("test_fuzz_words.txt", "w");
+    assert(file != NULL);
+    for (int i = 0; i < WORD_COUNT; i++) {
+        fprintf(file, "%s\n", words[i]);
+    }
+    fclose(file);
+    assert(dictionary_load_file("test_fuzz_words.txt"));
+    remove("test_fuzz_words.txt");
+}
+
+/* Replay one input: the first bytes pick the variant and seed the game, each later byte an operation */
+static void run_input(const uint8_t *data, size_t size)
+{
+    FuzzInput input = {data, size, 0};
+    MoveList list;
+    uint64_t seed = 0;
+
+    assert(variant_select(variant_get((VariantId)(next_byte(&input) % VARIANT_COUNT))->name));
+    for (int i = 0; i < 8; i++) {
+        seed = seed << 8 | next_byte(&input);
+    }
+    assert(game_new(seed));
+    memset(model, 0, sizeof(model));
+    history_count = 0;
+    movegen_list_init(&list);
+
+    for (int step = 0; step < FUZZ_MAX_STEPS && input.pos < input.size; step++) {
+        switch (next_byte(&input) % 8) {
+        case 0:
+        case 1:
+        case 2:
+        case 3:
+            step_generate(&input, &list);
+            break;
+        case 4:
+            step_unplay();
+            break;
+        case 5:
+            if (!game_is_over() && history_count < FUZZ_MAX_STEPS) {
+                push_history();
+                game_pass_turn();
+            }
+            break;
+        case 6:
+            step_snapshot();
+            break;
+        default:
+            step_dictionary(&input);
+            break;
+        }
+    }
+    movegen_list_free(&list);
+}
+
+#ifdef XSCRABBLE_LIBFUZZER
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    setup();
+    run_input(data, size);
+    return 0;
+}
+
+#else
+
+int main(void)
+{
+    uint8_t data[FUZZ_INPUT_SIZE];
+    uint64_t state = 38;
+
+    printf("Running differential fuzz tests...\n");
+    setup();
+
+    /* Deterministic inputs, so a failure reproduces */
+    for (int i = 0; i < FUZZ_CASES; i++) {
+        for (size_t j = 0; j < sizeof(data); j++) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            data[j] = (uint8_t)(state >> 56);
+        }
+        run_input(data, sizeof(data));
+    }
+
+    movegen_cache_free();
+    lexicon_release(lexicon);
+    lexicon_registry_clear();
+    printf("Differential fuzz tests passed!\n");
+    return EXIT_SUCCESS;
+}
+
+#endif
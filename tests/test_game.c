@@ -31,7 +31,29 @@ int main(void)
     assert(state->player_rack[4] == 'E');
     assert(state->player_rack[5] == 'E');
     assert(state->player_rack[6] == 'L');
-    
+
+    /* Test passing keeps the seat's name and rack */
+    game_pass_turn();
+    assert(strcmp(state->current_player, "jwalsh") == 0);
+    assert(memcmp(state->player_rack, "OKIQEEL", 7) == 0);
+    assert(state->tiles_left == 82);
+
+    /* Test passing never ends the UI game or touches its scores */
+    for (int i = 0; i < MAX_SCORELESS_TURNS; i++) {
+        game_pass_turn();
+    }
+    assert(!state->over);
+    assert(state->scores[0] == 0 && state->scores[1] == 20);
+
+    /* Test changing letters exchanges the seat's rack */
+    assert(game_change_letters());
+    assert(strcmp(state->current_player, "jwalsh") == 0);
+    assert(strlen(state->racks[0]) == 7);
+    assert(memcmp(state->player_rack, state->racks[0], 7) == 0);
+    assert(state->tiles_left == 82);
+    assert(game_unplay_move());
+    assert(memcmp(state->player_rack, "OKIQEEL", 7) == 0);
+
     /* Test placing tiles */
     assert(game_place_tile(8, 8, 'E'));
     
@@ -46,6 +68,63 @@ int main(void)
     /* Clean up */
     game_cleanup();
     
+    /* Test snapshots and undo on an engine game */
+    assert(game_new(3));
+    GameSnapshot start, after, again;
+    game_snapshot(&start);
+    assert(sizeof(GameSnapshot) <= 384);
+    assert(game_undo_depth() == 0);
+    
+    Move move = {0};
+    move.type = MOVE_PLACE;
+    move.direction = MOVE_ACROSS;
+    move.row = 7;
+    move.col = 6;
+    move.length = 2;
+    move.tiles_played = 2;
+    move.tiles[0] = state->racks[0][0];
+    move.tiles[1] = state->racks[0][1];
+    Move off_board = move;
+    off_board.col = board_size() - 1;
+    assert(!game_play_move(&off_board));
+    off_board.col = -1;
+    assert(!game_play_move(&off_board));
+    assert(game_play_move(&move));
+    assert(game_hash() != start.hash);
+    assert(game_undo_depth() == 1);
+    assert(game_snapshot(&after));
+    
+    game_pass_turn();
+    assert(game_undo_depth() == 2);
+    assert(game_unplay_move());
+    game_snapshot(&again);
+    assert(memcmp(&again, &after, sizeof(again)) == 0);
+    
+    assert(game_unplay_move());
+    game_snapshot(&again);
+    assert(memcmp(&again, &start, sizeof(again)) == 0);
+    assert(board_get_cell(7, 6)->letter == '\0');
+    assert(!game_unplay_move());
+    
+    /* Test restoring snapshots */
+    game_restore(&after);
+    assert(board_get_cell(7, 6)->letter == move.tiles[0]);
+    assert(board_get_cell(7, 6)->is_fixed);
+    assert(game_hash() == after.hash);
+    game_restore(&start);
+    assert(board_get_cell(7, 6)->letter == '\0');
+    assert(game_get_state()->tiles_left == start.tiles_left);
+    
+    /* Test checkpoints */
+    game_restore(&after);
+    assert(game_save_checkpoint("test_game_checkpoint.dat"));
+    game_restore(&start);
+    assert(game_load_checkpoint("test_game_checkpoint.dat"));
+    game_snapshot(&again);
+    assert(memcmp(&again, &after, sizeof(again)) == 0);
+    remove("test_game_checkpoint.dat");
+    assert(!game_load_checkpoint("test_game_checkpoint.dat"));
+    
     printf("Game logic tests passed!\n");
     return EXIT_SUCCESS;
 }
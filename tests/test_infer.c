@@ -0,0 +1,197 @@
+/**
+ * XScrabble - Rack Inference Tests
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../include/infer.h"
+#include "../include/game.h"
+#include "../include/tiles.h"
+
+#define RACKS 1024
+
+static const char *words[] = {
+    "at", "ta", "cat", "act", "tab", "bat", "cab", "scab", "cats", "acts",
+    "tabs", "bats", "cabs", "stab", "abs", "as", "sat", "tas"
+};
+
+/* Every rack holds rack_size tiles the unseen pool can supply */
+static void check_racks(const InferState *state, const char *unseen, int rack_size)
+{
+    for (int i = 0; i < state->count; i++) {
+        const char *rack = state->racks[i];
+        assert((int)strlen(rack) == rack_size);
+        for (const char *p = rack; *p; p++) {
+            int held = 0;
+            int available = 0;
+            for (const char *q = rack; *q; q++) {
+                held += *q == *p;
+            }
+            for (const char *q = unseen; *q; q++) {
+                available += *q == *p;
+            }
+            assert(held <= available);
+        }
+    }
+}
+
+/* Weighted share of racks holding letter */
+static double holding(const InferState *state, char letter)
+{
+    double with = 0.0;
+    double total = 0.0;
+    for (int i = 0; i < state->count; i++) {
+        total += state->weights[i];
+        if (strchr(state->racks[i], letter)) {
+            with += state->weights[i];
+        }
+    }
+    return with / total;
+}
+
+int main(void)
+{
+    InferState state;
+    InferState serial;
+    GameSnapshot before;
+    char unseen[BAG_CAPACITY + 1];
+    Move best;
+
+    printf("Running rack inference tests...\n");
+    tiles_reset();
+    int word_count = sizeof(words) / sizeof(words[0]);
+    assert(lexicon_publish(lexicon_from_words("test", words, word_count)));
+    assert(game_use_lexicon("test"));
+    assert(game_new(3));
+    GameState *game = game_get_state();
+    const Dawg *dawg = game->lexicon->dawg;
+
+    /* Test the unseen tiles: everything but our own rack on an empty board */
+    strcpy(game->racks[0], "CATVVWQ");
+    strcpy(game->racks[1], "EEIOUUR");
+    assert(infer_unseen(1, unseen, sizeof(unseen)) == tiles_total() - RACK_SIZE);
+    assert(strchr(unseen, 'Q') != NULL);
+    int u = 0;
+    for (const char *p = unseen; *p; p++) {
+        u += *p == 'U';
+    }
+    assert(u == tiles_letter_count('U') - 2);
+    assert(infer_unseen(1, unseen, 10) == -1);
+    assert(infer_unseen(1, unseen, sizeof(unseen)) > 0);
+
+    /* Test the initial draw */
+    assert(infer_init(&state, RACKS, 4, 10.0, 99));
+    assert(infer_init(&serial, RACKS, 1, 10.0, 99));
+    infer_reset(&state, unseen, RACK_SIZE);
+    infer_reset(&serial, unseen, RACK_SIZE);
+    check_racks(&state, unseen, RACK_SIZE);
+    assert(infer_effective(&state) > RACKS - 0.5);
+    double prior_s = holding(&state, 'S');
+    assert(prior_s > 0.0);
+
+    /* Player 0 plays greedily; racks that could have used an S lose weight */
+    game_snapshot(&before);
+    assert(movegen_top_k(dawg, game->racks[0], &best, 1) == 1);
+    assert(infer_observe(&state, &before, dawg, &best));
+    assert(infer_observe(&serial, &before, dawg, &best));
+    assert(state.scored == RACKS);
+    assert(memcmp(state.weights, serial.weights, RACKS * sizeof(float)) == 0);
+    int lowered = 0;
+    for (int i = 0; i < RACKS; i++) {
+        assert((int)strlen(state.racks[i]) == RACK_SIZE - best.tiles_played);
+        assert(state.weights[i] <= 1.0f);
+        if (strchr(state.racks[i], 'S')) {
+            assert(state.weights[i] < 1.0f);
+        }
+        lowered += state.weights[i] < 1.0f;
+    }
+    assert(lowered > 0 && lowered < RACKS);
+    assert(holding(&state, 'S') < prior_s);
+
+    /* Once the tiles are drawn, racks refill from what is still unseen */
+    assert(game_play_move(&best));
+    assert(infer_unseen(1, unseen, sizeof(unseen)) > 0);
+    infer_sync(&state, unseen, RACK_SIZE);
+    check_racks(&state, unseen, RACK_SIZE);
+
+    /* Test the sampler: draws follow the weights */
+    uint64_t rng = 5;
+    for (int i = 0; i < RACKS; i++) {
+        state.weights[i] = i == 17 ? 1.0f : 0.0f;
+    }
+    char chosen[RACK_SIZE + 1];
+    strcpy(chosen, state.racks[17]);
+    infer_sync(&state, unseen, RACK_SIZE);
+    assert(state.resampled);
+    assert(infer_effective(&state) > RACKS - 0.5);
+    for (int i = 0; i < 100; i++) {
+        assert(strcmp(infer_sample(&state, &rng), chosen) == 0);
+    }
+    infer_reset(&state, unseen, RACK_SIZE);
+    int differ = 0;
+    for (int i = 0; i < 100; i++) {
+        differ += strcmp(infer_sample(&state, &rng), infer_sample(&state, &rng)) != 0;
+    }
+    assert(differ > 50);
+
+    /* Test the time budget: with none, each worker scores one chunk */
+    game_snapshot(&before);
+    game->to_move = 1;
+    assert(movegen_top_k(dawg, "CATSBAT", &best, 1) == 1);
+    serial.budget = 0.0;
+    infer_reset(&serial, unseen, RACK_SIZE);
+    assert(infer_observe(&serial, &before, dawg, &best));
+    assert(serial.scored == INFER_CHUNK);
+
+    /* Exchanges and passes: only the rack size changes */
+    Move exchange = {0};
+    exchange.type = MOVE_EXCHANGE;
+    exchange.length = 3;
+    infer_reset(&state, unseen, RACK_SIZE);
+    assert(infer_observe(&state, &before, dawg, &exchange));
+    check_racks(&state, unseen, RACK_SIZE - 3);
+    infer_sync(&state, unseen, RACK_SIZE);
+    check_racks(&state, unseen, RACK_SIZE);
+    exchange.type = MOVE_PASS;
+    assert(infer_observe(&state, &before, dawg, &exchange));
+    check_racks(&state, unseen, RACK_SIZE);
+
+    /* Test a played blank is scored as a blank, not as the letter it shows */
+    assert(game_new(3));
+    strcpy(game->racks[0], "CA_VVWQ");
+    Move blank = {0};
+    blank.type = MOVE_PLACE;
+    blank.direction = MOVE_ACROSS;
+    blank.row = 7;
+    blank.col = 5;
+    blank.tiles[0] = 'C';
+    blank.tiles[1] = 'A';
+    blank.tiles[2] = tiles_blank_as('T');
+    blank.length = 3;
+    blank.tiles_played = 3;
+    blank.score = game_score_move(&blank);
+    game_snapshot(&before);
+    assert(infer_unseen(1, unseen, sizeof(unseen)) > 0);
+    infer_reset(&state, unseen, RACK_SIZE);
+    assert(infer_observe(&state, &before, dawg, &blank));
+    int unbeaten = 0;
+    for (int i = 0; i < RACKS; i++) {
+        /* Without S, T, B or another blank no word here beats the blank CAT */
+        if (!strpbrk(state.racks[i], "STB_")) {
+            assert(state.weights[i] == 1.0f);
+            unbeaten++;
+        }
+    }
+    assert(unbeaten > 0);
+
+    infer_free(&state);
+    infer_free(&serial);
+    lexicon_release(game->lexicon);
+    game->lexicon = NULL;
+    lexicon_registry_clear();
+    movegen_cache_free();
+    printf("Rack inference tests passed!\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,176 @@
+/**
+ * XScrabble - Learner Progress Tests
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include "../include/learner.h"
+
+#define DIRECTORY "test_learner_store"
+#define WORDS 50
+#define NOW 1700000000u
+
+static long file_size(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+/* Brute-force next due word, for comparison with the queue */
+static int scan_next_due(const Learner *learner, uint32_t now)
+{
+    int best = -1;
+    for (int word = 0; word < learner->word_count; word++) {
+        if (learner->heap_pos[word] >= 0 && learner->due[word] <= now &&
+            (best < 0 || learner->due[word] < learner->due[best])) {
+            best = word;
+        }
+    }
+    return best;
+}
+
+/* Remove every log this test writes, so a failed run leaves nothing behind to trip the next */
+static void clean_store(void)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "%s/7.xsl", DIRECTORY);
+    remove(path);
+    for (uint32_t id = 100; id < 400; id++) {
+        snprintf(path, sizeof(path), "%s/%u.xsl", DIRECTORY, id);
+        remove(path);
+    }
+    rmdir(DIRECTORY);
+}
+
+static bool same_state(const Learner *a, const Learner *b)
+{
+    return a->studied == b->studied &&
+           memcmp(a->due, b->due, WORDS * sizeof(uint32_t)) == 0 &&
+           memcmp(a->interval, b->interval, WORDS * sizeof(uint16_t)) == 0 &&
+           memcmp(a->ease, b->ease, WORDS * sizeof(uint16_t)) == 0 &&
+           memcmp(a->reps, b->reps, WORDS) == 0 &&
+           memcmp(a->lapses, b->lapses, WORDS) == 0;
+}
+
+int main(void)
+{
+    LearnerStore store;
+    char path[64];
+
+    printf("Running learner progress tests...\n");
+    clean_store();
+    assert(learner_store_open(&store, DIRECTORY, WORDS));
+
+    /* Test SM-2 scheduling */
+    Learner *learner = learner_get(&store, 7);
+    assert(learner != NULL && learner->studied == 0);
+    assert(learner_next_due(learner, UINT32_MAX) == -1);
+    assert(learner_review(learner, 3, 5, NOW));
+    assert(learner->interval[3] == 1 && learner->due[3] == NOW + LEARNER_DAY_SECONDS);
+    assert(learner_review(learner, 3, 5, NOW));
+    assert(learner->interval[3] == 6);
+    assert(learner_review(learner, 3, 5, NOW));
+    assert(learner->ease[3] == 2800 && learner->interval[3] == 17);
+    assert(learner_review(learner, 4, 1, NOW));
+    assert(learner->reps[4] == 0 && learner->lapses[4] == 1);
+    assert(learner->due[4] == NOW + LEARNER_RELEARN_SECONDS);
+    assert(learner->ease[4] == LEARNER_INITIAL_EASE - 540);
+    assert(learner_next_due(learner, NOW) == -1);
+    assert(learner_next_due(learner, NOW + LEARNER_RELEARN_SECONDS) == 4);
+    assert(!learner_review(learner, WORDS, 5, NOW));
+    assert(!learner_review(learner, 0, 6, NOW));
+
+    /* Nothing is written until the buffer fills or the learner is flushed */
+    snprintf(path, sizeof(path), "%s/7.xsl", DIRECTORY);
+    assert(file_size(path) == -1);
+    assert(learner_flush(learner));
+    assert(file_size(path) == 8 + 4 * (long)sizeof(LearnerRecord));
+
+    /* Test the queue against a scan through many reviews */
+    uint64_t rng = 12345;
+    for (int i = 0; i < 2000; i++) {
+        rng = rng * 6364136223846793005ULL + 1442695040888963407ULL;
+        int word = (int)((rng >> 33) % WORDS);
+        int grade = (int)((rng >> 20) % (LEARNER_MAX_GRADE + 1));
+        uint32_t now = NOW + (uint32_t)(rng >> 45) % (40 * LEARNER_DAY_SECONDS);
+        assert(learner_review(learner, word, grade, now));
+        int due = learner_next_due(learner, now);
+        int expected = scan_next_due(learner, now);
+        assert(due == expected || (due >= 0 && learner->due[due] == learner->due[expected]));
+    }
+
+    /* The log stays within twice the studied words, plus a buffer */
+    long size = file_size(path);
+    assert(size >= 8 && (size - 8) % (long)sizeof(LearnerRecord) == 0);
+    assert((size - 8) / (long)sizeof(LearnerRecord) <= 2 * learner->studied + LEARNER_PENDING);
+
+    /* Test that state survives unloading and a torn final record */
+    Learner saved = *learner;
+    saved.due = malloc(WORDS * sizeof(uint32_t));
+    saved.interval = malloc(WORDS * sizeof(uint16_t));
+    saved.ease = malloc(WORDS * sizeof(uint16_t));
+    saved.reps = malloc(WORDS);
+    saved.lapses = malloc(WORDS);
+    memcpy(saved.due, learner->due, WORDS * sizeof(uint32_t));
+    memcpy(saved.interval, learner->interval, WORDS * sizeof(uint16_t));
+    memcpy(saved.ease, learner->ease, WORDS * sizeof(uint16_t));
+    memcpy(saved.reps, learner->reps, WORDS);
+    memcpy(saved.lapses, learner->lapses, WORDS);
+    int next = learner_next_due(learner, UINT32_MAX);
+    assert(learner_unload(&store, 7));
+    assert(!learner_unload(&store, 7));
+
+    FILE *file = fopen(path, "ab");
+    assert(file != NULL);
+    fwrite("torn!", 1, 5, file);
+    fclose(file);
+
+    learner = learner_get(&store, 7);
+    assert(learner != NULL);
+    assert(same_state(learner, &saved));
+    assert(learner_next_due(learner, UINT32_MAX) == next);
+    assert((file_size(path) - 8) % (long)sizeof(LearnerRecord) == 0);
+    free(saved.due);
+    free(saved.interval);
+    free(saved.ease);
+    free(saved.reps);
+    free(saved.lapses);
+
+    /* Test many loaded learners, with some unloaded in between */
+    for (uint32_t id = 100; id < 400; id++) {
+        Learner *other = learner_get(&store, id);
+        assert(other != NULL && other->studied == 0);
+        assert(learner_review(other, (int)(id % WORDS), 5, NOW + id));
+    }
+    assert(store.count == 301);
+    for (uint32_t id = 100; id < 400; id += 3) {
+        assert(learner_unload(&store, id));
+    }
+    for (uint32_t id = 100; id < 400; id++) {
+        Learner *other = learner_get(&store, id);
+        assert(other != NULL && other->id == id && other->studied == 1);
+        assert(learner_next_due(other, UINT32_MAX) == (int)(id % WORDS));
+        assert(other->due[id % WORDS] == NOW + id + LEARNER_DAY_SECONDS);
+    }
+    assert(store.count == 301);
+
+    /* Test that closing writes everything out */
+    learner_store_close(&store);
+    assert(learner_store_open(&store, DIRECTORY, WORDS));
+    assert(learner_get(&store, 399)->studied == 1);
+    learner_store_close(&store);
+
+    clean_store();
+
+    printf("Learner progress tests passed!\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,128 @@
+/**
+ * XScrabble - Lexicon Registry Tests
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include "../include/lexicon.h"
+
+#define STRESS_READERS 4
+#define STRESS_PUBLISHES 2000
+
+static const char *version_one[] = { "cat", "cats", "dog" };
+static const char *version_two[] = { "cat", "cats", "dog", "dogs", "zebra" };
+
+static int stop_readers = 0;
+
+/* Acquire, look up and release while the writer keeps publishing */
+static void *reader(void *arg)
+{
+    long *lookups = (long *)arg;
+
+    do {
+        Lexicon *lexicon = lexicon_acquire("STRESS");
+        assert(lexicon != NULL);
+        assert(lexicon_contains(lexicon, "cat"));
+        assert(!lexicon_contains(lexicon, "cow"));
+        assert(lexicon_contains(lexicon, "dogs") == (lexicon->dawg->word_count == 5));
+        lexicon_release(lexicon);
+        (*lookups)++;
+    } while (!__atomic_load_n(&stop_readers, __ATOMIC_ACQUIRE));
+    return NULL;
+}
+
+int main(void)
+{
+    printf("Running lexicon registry tests...\n");
+
+    /* Test publish and acquire */
+    assert(lexicon_acquire("TEST") == NULL);
+    Lexicon *lexicon = lexicon_from_words("TEST", version_one, 3);
+    assert(lexicon != NULL);
+    assert(lexicon_publish(lexicon));
+    assert(lexicon->version == 1);
+
+    Lexicon *held = lexicon_acquire("TEST");
+    assert(held == lexicon);
+    assert(lexicon_contains(held, "cats"));
+    assert(!lexicon_contains(held, "zebra"));
+    assert(lexicon_definition(held, "cat") == NULL);
+
+    /* Test that a hot swap leaves held handles on their version */
+    assert(lexicon_publish(lexicon_from_words("TEST", version_two, 5)));
+    Lexicon *fresh = lexicon_acquire("TEST");
+    assert(fresh != held);
+    assert(fresh->version == 2);
+    assert(lexicon_contains(fresh, "zebra"));
+    assert(!lexicon_contains(held, "zebra"));
+    assert(held->refs == 1);
+    lexicon_release(held);
+    lexicon_release(fresh);
+
+    const char *names[LEXICON_MAX];
+    assert(lexicon_names(names) == 1);
+    assert(strcmp(names[0], "TEST") == 0);
+
+    /* Test definitions from a JSON dictionary */
+    const char *path = "test_lexicon.json";
+    FILE *file = fopen(path, "w");
+    assert(file != NULL);
+    fputs("{\n"
+          "  \"zebu\": {\"definition\": \"Humped ox\", \"part_of_speech\": \"noun\"},\n"
+          "  \"Aardvark\": {\"definition\": \"Burrowing mammal\"},\n"
+          "  \"\xc3\xa9t\xc3\xa9\": {\"definition\": \"Summer\"}\n"
+          "}\n", file);
+    fclose(file);
+
+    assert(lexicon_reload("DEFS", path));
+    remove(path);
+    Lexicon *defs = lexicon_acquire("DEFS");
+    assert(defs != NULL && defs->entry_count == 3);
+    assert(lexicon_contains(defs, "ZEBU"));
+    assert(lexicon_contains(defs, "aardvark"));
+    assert(lexicon_contains(defs, "\xc3\xa9t\xc3\xa9"));
+    assert(!lexicon_contains(defs, "zebra"));
+    const DictionaryEntry *entry = lexicon_definition(defs, "zebu");
+    assert(entry != NULL && strcmp(entry->definition, "Humped ox") == 0);
+    assert(strcmp(entry->part_of_speech, "noun") == 0);
+    assert(lexicon_definition(defs, "aardvark")->example == NULL);
+    lexicon_release(defs);
+    assert(!lexicon_reload("DEFS", "missing.json"));
+    defs = lexicon_acquire("DEFS");
+    assert(defs != NULL && defs->version == 1);
+    lexicon_release(defs);
+
+    /* Test lookups racing against repeated publishes */
+    assert(lexicon_publish(lexicon_from_words("STRESS", version_one, 3)));
+    pthread_t readers[STRESS_READERS];
+    long lookups[STRESS_READERS] = {0};
+    for (int i = 0; i < STRESS_READERS; i++) {
+        assert(pthread_create(&readers[i], NULL, reader, &lookups[i]) == 0);
+    }
+    for (int i = 0; i < STRESS_PUBLISHES; i++) {
+        const char **words = (i & 1) ? version_one : version_two;
+        assert(lexicon_publish(lexicon_from_words("STRESS", words, (i & 1) ? 3 : 5)));
+    }
+    __atomic_store_n(&stop_readers, 1, __ATOMIC_RELEASE);
+    for (int i = 0; i < STRESS_READERS; i++) {
+        pthread_join(readers[i], NULL);
+        assert(lookups[i] > 0);
+    }
+    Lexicon *last = lexicon_acquire("STRESS");
+    assert(last->version == STRESS_PUBLISHES + 1);
+    assert(last->refs == 2);
+
+    /* Test that clearing the registry keeps held handles alive */
+    lexicon_registry_clear();
+    assert(lexicon_acquire("STRESS") == NULL);
+    assert(lexicon_names(names) == 0);
+    assert(lexicon_contains(last, "cat"));
+    assert(last->refs == 1);
+    lexicon_release(last);
+
+    printf("Lexicon registry tests passed!\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,289 @@
+/**
+ * XScrabble - Move Generation Tests
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../include/movegen.h"
+#include "../include/game.h"
+#include "../include/tiles.h"
+
+static const char *words[] = {
+    "at", "ta", "cat", "act", "tab", "bat", "cab", "scab", "cats", "acts",
+    "tabs", "bats", "cabs", "stab", "abs", "as", "sat", "tas"
+};
+
+/* Rebuild the word a move spells, reading played-through tiles off the board */
+static void move_word(const Move *move, char *word)
+{
+    int dr = move->direction == MOVE_DOWN ? 1 : 0;
+    int dc = move->direction == MOVE_ACROSS ? 1 : 0;
+    for (int i = 0; i < move->length; i++) {
+        char letter = move->tiles[i];
+        if (!letter) {
+            letter = board_get_cell(move->row + dr * i, move->col + dc * i)->letter;
+        }
+        word[i] = letter;
+    }
+    word[move->length] = '\0';
+}
+
+/* Every generated move must be a word, legal to play and scored like the game does */
+static void check_moves(const Dawg *dawg, const MoveList *list)
+{
+    char word[BOARD_MAX_SIZE + 1];
+    for (int i = 0; i < list->count; i++) {
+        const Move *move = &list->moves[i];
+        assert(move->type == MOVE_PLACE);
+        assert(move->tiles_played > 0);
+        move_word(move, word);
+        assert(dawg_contains(dawg, word));
+        assert(move->score == game_score_move(move));
+    }
+}
+
+/* Same moves in the same order, ignoring bytes past each move's length */
+static bool same_moves(const MoveList *a, const MoveList *b)
+{
+    if (a->count != b->count) {
+        return false;
+    }
+    for (int i = 0; i < a->count; i++) {
+        const Move *x = &a->moves[i];
+        const Move *y = &b->moves[i];
+        if (x->type != y->type || x->direction != y->direction || x->row != y->row ||
+            x->col != y->col || x->length != y->length || x->score != y->score ||
+            memcmp(x->tiles, y->tiles, x->length) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Stable order by descending score, what top-K must agree with */
+static void sort_by_score(MoveList *list)
+{
+    for (int i = 1; i < list->count; i++) {
+        Move move = list->moves[i];
+        int j = i;
+        while (j > 0 && list->moves[j - 1].score < move.score) {
+            list->moves[j] = list->moves[j - 1];
+            j--;
+        }
+        list->moves[j] = move;
+    }
+}
+
+/* Visitor that stops after a fixed number of moves */
+static bool count_until(const Move *move, void *context)
+{
+    int *remaining = (int *)context;
+    (void)move;
+    return --*remaining > 0;
+}
+
+int main(void)
+{
+    printf("Running move generation tests...\n");
+    
+    tiles_reset();
+    Dawg *dawg = dawg_build(words, sizeof(words) / sizeof(words[0]));
+    assert(dawg != NULL);
+    
+    MoveList list;
+    movegen_list_init(&list);
+    
+    /* Test opening moves: every one covers the centre square */
+    assert(game_new(1));
+    assert(movegen_generate(dawg, "CATSBXX", &list) > 0);
+    check_moves(dawg, &list);
+    for (int i = 0; i < list.count; i++) {
+        const Move *move = &list.moves[i];
+        int center = board_size() / 2;
+        if (move->direction == MOVE_ACROSS) {
+            assert(move->row == center);
+            assert(move->col <= center && move->col + move->length > center);
+        } else {
+            assert(move->col == center);
+            assert(move->row <= center && move->row + move->length > center);
+        }
+    }
+    
+    /* Test that the best opening is found and playable */
+    const Move *best = movegen_best(&list);
+    assert(best != NULL);
+    for (int i = 0; i < list.count; i++) {
+        assert(list.moves[i].score <= best->score);
+    }
+    
+    /* Test moves that hook and play through existing tiles */
+    Move opening = *best;
+    GameState *state = game_get_state();
+    strcpy(state->racks[state->to_move], "CATSB");
+    opening.tiles_played = 0;
+    for (int i = 0; i < opening.length; i++) {
+        opening.tiles_played += opening.tiles[i] != 0;
+    }
+    assert(game_play_move(&opening));
+    
+    assert(movegen_generate(dawg, "SABT", &list) > 0);
+    check_moves(dawg, &list);
+    
+    /* Test blanks: they stand in for missing letters only, and score nothing */
+    assert(movegen_generate(dawg, "SA_", &list) > 0);
+    check_moves(dawg, &list);
+    int blank_moves = 0;
+    for (int i = 0; i < list.count; i++) {
+        const Move *move = &list.moves[i];
+        for (int j = 0; j < move->length; j++) {
+            if (tiles_is_blank(move->tiles[j])) {
+                assert(tiles_face(move->tiles[j]) != 'S' && tiles_face(move->tiles[j]) != 'A');
+                blank_moves++;
+            }
+        }
+    }
+    assert(blank_moves > 0);
+    
+    /* Test an empty rack */
+    assert(movegen_generate(dawg, "", &list) == 0);
+    assert(movegen_best(&list) == NULL);
+    
+    /* Test that cached generation matches uncached generation move for move */
+    MoveList fresh;
+    movegen_list_init(&fresh);
+    uint64_t hits, misses, hits_before, misses_before;
+    assert(game_new(7));
+    for (int ply = 0; ply < 12 && !game_is_over(); ply++) {
+        const char *rack = state->racks[state->to_move];
+        movegen_cache_enable(false);
+        movegen_generate(dawg, rack, &fresh);
+        movegen_cache_enable(true);
+        movegen_generate(dawg, rack, &list);
+        assert(same_moves(&fresh, &list));
+    
+        /* Asking again is all hits */
+        movegen_cache_stats(&hits_before, &misses_before);
+        movegen_generate(dawg, rack, &list);
+        movegen_cache_stats(&hits, &misses);
+        assert(same_moves(&fresh, &list));
+        assert(misses == misses_before && hits > hits_before);
+    
+        best = movegen_best(&list);
+        if (best) {
+            Move move = *best;
+            assert(game_play_move(&move));
+        } else {
+            game_pass_turn();
+        }
+    }
+    
+    /* Test that unplaying a move and swapping lexicons are seen */
+    if (state->moves_played > 0) {
+        assert(game_unplay_move());
+    }
+    const char *rack = state->racks[state->to_move];
+    movegen_cache_enable(false);
+    movegen_generate(dawg, rack, &fresh);
+    movegen_cache_enable(true);
+    movegen_generate(dawg, rack, &list);
+    assert(same_moves(&fresh, &list));
+    
+    Dawg *smaller = dawg_build(words, 4);
+    movegen_cache_enable(false);
+    movegen_generate(smaller, rack, &fresh);
+    movegen_cache_enable(true);
+    movegen_generate(smaller, rack, &list);
+    assert(same_moves(&fresh, &list));
+    dawg_free(smaller);
+    
+    /* Test that top-K matches the sorted full list, with and without the cache */
+    Move top[64];
+    Move game_top;
+    int word_count = sizeof(words) / sizeof(words[0]);
+    assert(lexicon_publish(lexicon_from_words("test", words, word_count)));
+    assert(game_use_lexicon("test"));
+    assert(game_new(11));
+    for (int ply = 0; ply < 10 && !game_is_over(); ply++) {
+        rack = state->racks[state->to_move];
+        movegen_cache_enable(false);
+        movegen_generate(dawg, rack, &fresh);
+        sort_by_score(&fresh);
+        for (int k = 1; k <= 64; k *= 4) {
+            for (int cached = 0; cached <= 1; cached++) {
+                movegen_cache_enable(cached);
+                int count = movegen_top_k(dawg, rack, top, k);
+                assert(count == (fresh.count < k ? fresh.count : k));
+                MoveList expected = { fresh.moves, count, count };
+                MoveList actual = { top, count, count };
+                assert(same_moves(&expected, &actual));
+            }
+        }
+        movegen_cache_enable(true);
+
+        /* Batch best scores agree with top-1, and with -1 where a rack has no move */
+        const char *batch[] = { rack, "CATSBXY", "VVWQ", "", "SCABTA" };
+        int scores[5];
+        movegen_best_scores(dawg, batch, 5, scores);
+        for (int i = 0; i < 5; i++) {
+            int expected = movegen_top_k(dawg, batch[i], top, 1) == 1 ? top[0].score : -1;
+            assert(scores[i] == expected);
+        }
+        assert(scores[2] == -1 && scores[3] == -1);
+
+        if (fresh.count > 0) {
+            assert(game_best_moves(&game_top, 1) == 1);
+            MoveList expected = { fresh.moves, 1, 1 };
+            MoveList actual = { &game_top, 1, 1 };
+            assert(same_moves(&expected, &actual));
+        }
+    
+        /* A visitor can stop generation early */
+        if (fresh.count > 3) {
+            int remaining = 3;
+            assert(movegen_visit(dawg, rack, count_until, &remaining, NULL) == 3);
+        }
+    
+        best = movegen_best(&fresh);
+        if (best) {
+            Move move = *best;
+            assert(game_play_move(&move));
+        } else {
+            game_pass_turn();
+        }
+    }
+    assert(movegen_top_k(dawg, rack, top, 0) == 0);
+    lexicon_release(state->lexicon);
+    state->lexicon = NULL;
+    lexicon_registry_clear();
+    movegen_cache_free();
+    movegen_list_free(&fresh);
+    
+    /* Test formatting */
+    char text[64];
+    movegen_format(&opening, NULL, text, sizeof(text));
+    assert(strlen(text) > 0);
+    Move blank = {0};
+    blank.type = MOVE_PLACE;
+    blank.row = 0;
+    blank.col = 0;
+    blank.length = 2;
+    blank.tiles[0] = 'A';
+    blank.tiles[1] = tiles_blank_as('T');
+    blank.score = 1;
+    movegen_format(&blank, NULL, text, sizeof(text));
+    assert(strcmp(text, "1A At 1") == 0);
+    board_place_tile(0, 1, tiles_blank_as('T'));
+    blank.tiles[1] = 0;
+    movegen_format(&blank, NULL, text, sizeof(text));
+    assert(strcmp(text, "1A A(t) 1") == 0);
+    board_revert_word();
+    
+    /* Clean up */
+    movegen_list_free(&list);
+    dawg_free(dawg);
+    
+    printf("Move generation tests passed!\n");
+    return EXIT_SUCCESS;
+}
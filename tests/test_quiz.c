@@ -0,0 +1,161 @@
+/**
+ * XScrabble - Quiz Engine Tests
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../include/quiz.h"
+
+#define ENTRY_COUNT 8
+
+static DictionaryEntry entries[ENTRY_COUNT] = {
+    {"ABANTH", "Une plante.", "A medicinal plant.", "L'abanth pousse en altitude.", "nom"},
+    {"ABLEST", "Un outil.", "A woodworking tool.", "L'ablest joint les planches.", "nom"},
+    {"ABROND", "Une technique.", "A sailing technique.", NULL, "nom"},
+    {"ACLINE", "Incliner.", "To tilt.", "Il faut acliner la voile.", "verbe"},
+    {"ADORNE", "Orner.", "To adorn.", "Elle adorne la table.", "verbe"},
+    {"AGRIME", "Aigre.", NULL, "Un fruit agrime.", "adjectif"},
+    {"ALBENT", "Blanc.", "White.", "Le mur est albent.", "adjectif"},
+    {"ALFARE", NULL, NULL, NULL, NULL}
+};
+
+/* Whether a choice is the answer of some entry of the given part of speech */
+static bool from_speech(const char *choice, const char *speech)
+{
+    for (int i = 0; i < ENTRY_COUNT; i++) {
+        const DictionaryEntry *entry = &entries[i];
+        if (entry->part_of_speech && strcmp(entry->part_of_speech, speech) == 0 &&
+            (choice == entry->word || choice == entry->definition ||
+             choice == entry->english_definition)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(void)
+{
+    QuizBank bank;
+    QuizDeck deck;
+    QuizQuestion question;
+
+    printf("Running quiz engine tests...\n");
+
+    /* Test the questions each entry can give */
+    assert(quiz_bank_build(&bank, entries, ENTRY_COUNT));
+    assert(bank.kinds[0] == (1 << QUIZ_MEANING | 1 << QUIZ_WORD | 1 << QUIZ_BLANK | 1 << QUIZ_DEFINITION));
+    assert(!(bank.kinds[2] & 1 << QUIZ_BLANK));
+    assert(bank.kinds[5] == (1 << QUIZ_BLANK | 1 << QUIZ_DEFINITION));
+    assert(bank.kinds[7] == 0);
+    assert(strcmp(bank.blanks + bank.blank_offsets[0], "L'______ pousse en altitude.") == 0);
+    assert(strcmp(bank.blanks + bank.blank_offsets[3], "Il faut ______r la voile.") == 0);
+
+    /* Test that a pass draws every askable entry exactly once */
+    assert(quiz_deck_init(&deck, &bank, 42));
+    assert(deck.size == ENTRY_COUNT - 1);
+    for (int pass = 0; pass < 3; pass++) {
+        int seen[ENTRY_COUNT] = {0};
+        for (int i = 0; i < deck.size; i++) {
+            assert(quiz_next(&deck, &question));
+            assert(question.entry != 7);
+            seen[question.entry]++;
+        }
+        for (int i = 0; i < ENTRY_COUNT - 1; i++) {
+            assert(seen[i] == 1);
+        }
+    }
+
+    /* Test the shape of questions and their choices */
+    int kinds[QUIZ_KINDS] = {0};
+    for (int i = 0; i < 400; i++) {
+        assert(quiz_next(&deck, &question));
+        const DictionaryEntry *entry = &entries[question.entry];
+        kinds[question.kind]++;
+        assert(bank.kinds[question.entry] & 1 << question.kind);
+        assert(question.choice_count >= 2 && question.choice_count <= QUIZ_CHOICES);
+        assert(question.choices[question.correct] == question.answer);
+        for (int j = 0; j < question.choice_count; j++) {
+            for (int k = 0; k < j; k++) {
+                assert(strcmp(question.choices[j], question.choices[k]) != 0);
+            }
+        }
+
+        /* Wrong answers come from the same part of speech while it has enough */
+        if (strcmp(entry->part_of_speech, "nom") == 0) {
+            int same = 0;
+            for (int j = 0; j < question.choice_count; j++) {
+                same += from_speech(question.choices[j], "nom");
+            }
+            assert(same == 3);
+        }
+
+        switch (question.kind) {
+        case QUIZ_MEANING:
+            assert(question.prompt == entry->word && question.answer == entry->english_definition);
+            break;
+        case QUIZ_WORD:
+            assert(question.prompt == entry->english_definition && question.answer == entry->word);
+            break;
+        case QUIZ_BLANK:
+            assert(strstr(question.prompt, "______") && question.answer == entry->word);
+            break;
+        default:
+            assert(question.prompt == entry->word && question.answer == entry->definition);
+            break;
+        }
+    }
+    for (int kind = 0; kind < QUIZ_KINDS; kind++) {
+        assert(kinds[kind] > 0);
+    }
+
+    /* Test that the same seed draws the same questions */
+    QuizDeck again;
+    QuizQuestion other;
+    assert(quiz_deck_init(&again, &bank, 7));
+    quiz_deck_free(&deck);
+    assert(quiz_deck_init(&deck, &bank, 7));
+    for (int i = 0; i < 20; i++) {
+        assert(quiz_next(&deck, &question) && quiz_next(&again, &other));
+        assert(question.entry == other.entry && question.kind == other.kind);
+        assert(question.correct == other.correct);
+    }
+    quiz_deck_free(&again);
+
+    /* Test answer checking */
+    question.kind = QUIZ_WORD;
+    question.answer = "ABANTH";
+    question.choices[0] = "ABLEST";
+    question.choices[1] = "ABANTH";
+    question.choice_count = 2;
+    question.correct = 1;
+    assert(quiz_check(&question, "abanth\n"));
+    assert(quiz_check(&question, " b"));
+    assert(quiz_check(&question, "2"));
+    assert(!quiz_check(&question, "a"));
+    assert(!quiz_check(&question, "aban"));
+    assert(!quiz_check(&question, "\n"));
+    question.kind = QUIZ_MEANING;
+    question.answer = "A medicinal plant.";
+    assert(quiz_check(&question, "medicinal plant"));
+    assert(quiz_check(&question, "a medicinal plant."));
+    assert(quiz_check(&question, "2"));
+    assert(!quiz_check(&question, "a tool"));
+    assert(!quiz_check(&question, "e"));
+    assert(!quiz_check(&question, "9"));
+    assert(!quiz_check(&question, "medic"));
+    assert(!quiz_check(&question, "ant"));
+
+    /* Test an empty bank */
+    quiz_deck_free(&deck);
+    quiz_bank_free(&bank);
+    assert(quiz_bank_build(&bank, entries + 7, 1));
+    assert(quiz_deck_init(&deck, &bank, 1));
+    assert(!quiz_next(&deck, &question));
+    quiz_deck_free(&deck);
+    quiz_bank_free(&bank);
+
+    printf("Quiz engine tests passed!\n");
+    return EXIT_SUCCESS;
+}
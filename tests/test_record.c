@@ -0,0 +1,206 @@
+/**
+ * XScrabble - Game Record Tests
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include "../include/record.h"
+#include "../include/gcg.h"
+#include "../include/game.h"
+#include "../include/movegen.h"
+#include "../include/tiles.h"
+
+#define MAX_PLIES 64
+
+static const char *words[] = {
+    "aa", "ab", "ad", "ae", "ag", "ah", "ai", "al", "am", "an", "ar", "as", "at", "aw",
+    "ax", "ay", "ba", "be", "bi", "bo", "by", "de", "do", "ed", "ef", "eh", "el", "em",
+    "en", "er", "es", "et", "ex", "fa", "go", "ha", "he", "hi", "hm", "ho", "id", "if",
+    "in", "is", "it", "jo", "ka", "la", "li", "lo", "ma", "me", "mi", "mo", "mu", "my",
+    "na", "ne", "no", "nu", "od", "oe", "of", "oh", "oi", "om", "on", "op", "or", "os",
+    "ow", "ox", "oy", "pa", "pe", "pi", "re", "sh", "si", "so", "ta", "ti", "to", "uh",
+    "um", "un", "up", "us", "ut", "we", "wo", "xi", "xu", "ya", "ye", "yo", "za",
+    "eat", "tea", "ate", "rat", "tar", "art", "net", "ten", "tone", "note", "stone",
+    "onset", "notes", "rates", "stare", "tears", "aster", "irate", "retain", "ratine"
+};
+
+/* Board letters and scores after each ply of the recorded game */
+typedef struct {
+    char letters[BOARD_SQUARES];
+    int scores[2];
+    char racks[2][RACK_SIZE + 1];
+} Snapshot;
+
+static Snapshot snapshots[MAX_PLIES + 1];
+
+static void take_snapshot(Snapshot *snapshot)
+{
+    GameState *state = game_get_state();
+    board_snapshot(snapshot->letters);
+    memcpy(snapshot->scores, state->scores, sizeof(snapshot->scores));
+    memcpy(snapshot->racks, state->racks, sizeof(snapshot->racks));
+}
+
+static bool matches_snapshot(const Snapshot *snapshot)
+{
+    Snapshot now;
+    take_snapshot(&now);
+    return memcmp(now.letters, snapshot->letters, sizeof(now.letters)) == 0 &&
+           now.scores[0] == snapshot->scores[0] && now.scores[1] == snapshot->scores[1] &&
+           strcmp(now.racks[0], snapshot->racks[0]) == 0 &&
+           strcmp(now.racks[1], snapshot->racks[1]) == 0;
+}
+
+/* Play a greedy game, recording it and snapshotting every ply */
+static int play_recorded(const Dawg *dawg, GameRecord *record, uint64_t seed)
+{
+    GameState *state = game_get_state();
+    MoveList list;
+    int plies = 0;
+
+    movegen_list_init(&list);
+    assert(game_new(seed));
+    assert(record_begin(record, "TEST", state));
+    take_snapshot(&snapshots[0]);
+
+    while (!game_is_over() && plies < MAX_PLIES) {
+        int player = state->to_move;
+        Move pass = {0};
+        const Move *move;
+        
+        pass.type = MOVE_PASS;
+        movegen_generate(dawg, state->racks[player], &list);
+        move = movegen_best(&list);
+        if (!move) {
+            move = &pass;
+        }
+        assert(game_play_move(move));
+        assert(record_add_move(record, player, move, state->last_drawn));
+        take_snapshot(&snapshots[++plies]);
+    }
+    assert(record_finish(record, state->scores));
+    movegen_list_free(&list);
+    return plies;
+}
+
+int main(void)
+{
+    printf("Running game record tests...\n");
+    
+    tiles_reset();
+    Dawg *dawg = dawg_build(words, sizeof(words) / sizeof(words[0]));
+    assert(dawg != NULL);
+    
+    GameRecord record;
+    record_init(&record);
+    int plies = play_recorded(dawg, &record, 7);
+    assert(plies > 2);
+    GameState final = *game_get_state();
+    
+    /* Test the header */
+    RecordReader reader;
+    assert(record_reader_open(&reader, record.data, record.size));
+    assert(reader.seed == 7);
+    assert(strcmp(reader.lexicon, "TEST") == 0);
+    assert(strcmp(reader.racks[0], snapshots[0].racks[0]) == 0);
+    assert(strcmp(reader.racks[1], snapshots[0].racks[1]) == 0);
+    
+    /* Test replay to every intermediate position */
+    for (int ply = 0; ply < plies; ply++) {
+        assert(record_reader_open(&reader, record.data, record.size));
+        assert(record_replay(&reader, ply) == ply);
+        assert(matches_snapshot(&snapshots[ply]));
+    }
+    
+    /* Test a full replay */
+    assert(record_reader_open(&reader, record.data, record.size));
+    assert(record_replay(&reader, -1) == plies);
+    assert(reader.finished);
+    assert(reader.pos == record.size);
+    assert(matches_snapshot(&snapshots[plies]));
+    assert(game_get_state()->scores[0] == final.scores[0]);
+    assert(game_get_state()->scores[1] == final.scores[1]);
+    
+    /* Test that truncated records are rejected */
+    assert(record_reader_open(&reader, record.data, record.size - 1));
+    assert(record_replay(&reader, -1) == -1);
+    assert(!record_reader_open(&reader, record.data, 3));
+    
+    /* Test GCG export and import */
+    FILE *gcg = tmpfile();
+    assert(gcg != NULL);
+    assert(gcg_export(gcg, record.data, record.size));
+    rewind(gcg);
+    
+    GameRecord imported;
+    record_init(&imported);
+    assert(gcg_import(gcg, &imported));
+    fclose(gcg);
+    
+    RecordReader original;
+    RecordReader copy;
+    RecordMove a, b;
+    assert(record_reader_open(&original, record.data, record.size));
+    assert(record_reader_open(&copy, imported.data, imported.size));
+    assert(copy.seed == 7);
+    assert(strcmp(copy.lexicon, "TEST") == 0);
+    assert(strcmp(copy.racks[0], original.racks[0]) == 0);
+    assert(strcmp(copy.racks[1], original.racks[1]) == 0);
+    while (record_reader_next(&original, &a)) {
+        assert(record_reader_next(&copy, &b));
+        assert(a.player == b.player);
+        assert(memcmp(&a.move, &b.move, sizeof(Move)) == 0);
+        assert(strcmp(a.drawn, b.drawn) == 0 || a.move.type == MOVE_PASS);
+    }
+    assert(!record_reader_next(&copy, &b));
+    assert(original.finished && copy.finished);
+    assert(copy.final_scores[0] == original.final_scores[0]);
+    assert(copy.final_scores[1] == original.final_scores[1]);
+    
+    /* Test streaming across buffer refills, then a truncated last record */
+    FILE *archive = tmpfile();
+    assert(archive != NULL);
+    int copies = (int)(3 * (1 << 16) / record.size) + 1;
+    for (int i = 0; i < copies; i++) {
+        assert(record_write(archive, &record));
+    }
+    assert(fwrite(record.data, 1, record.size / 2, archive) == record.size / 2);
+    rewind(archive);
+
+    RecordStream stream;
+    const uint8_t *data;
+    size_t size;
+    int streamed = 0;
+    record_stream_open(&stream, archive);
+    while (record_stream_next(&stream, &data, &size)) {
+        assert(size == record.size);
+        assert(memcmp(data, record.data, size) == 0);
+        streamed++;
+    }
+    assert(streamed == copies);
+    assert(stream.error);
+    assert(stream.capacity <= 2 * (1 << 16));
+    record_stream_close(&stream);
+
+    rewind(archive);
+    assert(ftruncate(fileno(archive), (off_t)(record.size * 2)) == 0);
+    record_stream_open(&stream, archive);
+    streamed = 0;
+    while (record_stream_next(&stream, &data, &size)) {
+        streamed++;
+    }
+    assert(streamed == 2 && !stream.error);
+    record_stream_close(&stream);
+    fclose(archive);
+
+    /* Clean up */
+    record_free(&imported);
+    record_free(&record);
+    dawg_free(dawg);
+    
+    printf("Game record tests passed!\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,67 @@
+/**
+ * XScrabble - Instrumentation Tests
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include "../include/stats.h"
+
+#define THREADS 4
+#define RECORDS_PER_THREAD 1000
+
+static void *record_lookups(void *arg)
+{
+    (void)arg;
+    for (int i = 0; i < RECORDS_PER_THREAD; i++) {
+        STATS_TIMER_BEGIN(timer);
+        STATS_TIMER_END(timer, STAT_DICTIONARY_LOOKUP);
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    printf("Running stats tests...\n");
+
+    assert(stats_enabled());
+
+    /* Test single-thread recording */
+    stats_record(STAT_MOVE_SCORING, 100);
+    stats_record(STAT_MOVE_SCORING, 300);
+    STATS_COUNT(STAT_MOVE_SCORING);
+
+    StatsSummary summary;
+    stats_summary(STAT_MOVE_SCORING, &summary);
+    assert(summary.count == 3);
+    assert(summary.ticks == 400);
+    assert(summary.histogram[7] == 1);   /* 100 ticks: [64, 128) */
+    assert(summary.histogram[9] == 1);   /* 300 ticks: [256, 512) */
+
+    /* Test aggregation across threads, including ones that have exited */
+    pthread_t threads[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        assert(pthread_create(&threads[i], NULL, record_lookups, NULL) == 0);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    stats_summary(STAT_DICTIONARY_LOOKUP, &summary);
+    assert(summary.count == THREADS * RECORDS_PER_THREAD);
+
+    /* Test names and reset */
+    assert(strcmp(stats_name(STAT_UI_REDRAW), "ui_redraw") == 0);
+    stats_reset();
+    stats_summary(STAT_DICTIONARY_LOOKUP, &summary);
+    assert(summary.count == 0);
+
+    /* Test dumping */
+    stats_record(STAT_DICTIONARY_LOAD, 5000);
+    stats_dump(stdout);
+
+    printf("Stats tests passed!\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,160 @@
+/**
+ * XScrabble - Transposition Table Tests
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include "../include/ttable.h"
+#include "../include/game.h"
+
+#define THREADS 4
+#define THREAD_OPS 200000
+
+typedef struct {
+    TTable *table;
+    int seed;
+    int mismatches;
+} Worker;
+
+/* The result every thread stores for a key, so any hit can be checked */
+static int32_t value_for(uint64_t key)
+{
+    return (int32_t)(key * 0x9e3779b97f4a7c15ULL >> 32);
+}
+
+static void *hammer(void *arg)
+{
+    Worker *worker = (Worker *)arg;
+    uint64_t rng = (uint64_t)worker->seed;
+    TTableResult result;
+
+    for (int i = 0; i < THREAD_OPS; i++) {
+        rng = rng * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint64_t key = (rng >> 20) % 50000 * 0xbf58476d1ce4e5b9ULL;
+        if (rng >> 63) {
+            ttable_store(worker->table, key, value_for(key), (int)(key >> 58),
+                         TTABLE_EXACT, (uint16_t)key);
+        } else if (ttable_probe(worker->table, key, &result)) {
+            if (result.value != value_for(key) || result.hint != (uint16_t)key ||
+                result.depth != (int)(key >> 58) || result.bound != TTABLE_EXACT) {
+                worker->mismatches++;
+            }
+        }
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    TTable table;
+    TTableResult result;
+    TTableStats stats;
+
+    printf("Running transposition table tests...\n");
+
+    /* Test sizing: the largest power of two of buckets within the budget */
+    assert(ttable_init(&table, 1));
+    assert(table.mask + 1 == (1u << 20) / sizeof(TTableBucket));
+    assert(((uintptr_t)table.buckets & 63) == 0);
+    assert(sizeof(TTableBucket) == 64);
+
+    /* Test store and probe */
+    uint64_t key = 0x123456789abcdef0ULL;
+    assert(!ttable_probe(&table, key, &result));
+    ttable_store(&table, key, -1234, 6, TTABLE_LOWER, 77);
+    assert(ttable_probe(&table, key, &result));
+    assert(result.value == -1234 && result.depth == 6 && result.bound == TTABLE_LOWER);
+    assert(result.hint == 77);
+    assert(!ttable_probe(&table, key ^ 1, &result));
+    ttable_store(&table, key ^ 1, 5, 1, TTABLE_NONE, 0);
+    assert(!ttable_probe(&table, key ^ 1, &result));
+
+    /* A shallower bound does not overwrite a deeper current result; an exact one does */
+    ttable_store(&table, key, 99, 2, TTABLE_UPPER, 0);
+    assert(ttable_probe(&table, key, &result) && result.value == -1234);
+    ttable_store(&table, key, 99, 2, TTABLE_EXACT, 0);
+    assert(ttable_probe(&table, key, &result) && result.value == 99 && result.depth == 2);
+
+    /* Test replacement: the shallowest entry goes, and age counts against depth */
+    ttable_clear(&table);
+    uint64_t stride = table.mask + 1;
+    int depths[TTABLE_WAYS] = {10, 3, 7, 9};
+    for (int i = 0; i < TTABLE_WAYS; i++) {
+        ttable_store(&table, 5 + i * stride, i, depths[i], TTABLE_EXACT, 0);
+    }
+    ttable_store(&table, 5 + 4 * stride, 4, 5, TTABLE_EXACT, 0);
+    assert(!ttable_probe(&table, 5 + 1 * stride, &result));
+    for (int i = 0; i < 5; i++) {
+        assert(ttable_probe(&table, 5 + i * stride, &result) == (i != 1));
+    }
+    ttable_new_search(&table);
+    ttable_new_search(&table);
+    assert(ttable_probe(&table, 5 + 2 * stride, &result));    /* Refreshed: now current */
+    ttable_store(&table, 5 + 5 * stride, 5, 1, TTABLE_EXACT, 0);
+    assert(!ttable_probe(&table, 5 + 4 * stride, &result));    /* Depth 5 - 8 lost to 1 */
+    assert(ttable_probe(&table, 5 + 0 * stride, &result));     /* Depth 10 - 8 = 2 kept */
+    assert(ttable_probe(&table, 5 + 2 * stride, &result));
+
+    /* A torn entry reads as a miss */
+    TTableEntry *entry = &table.buckets[5].entries[0];
+    uint64_t saved = entry->data;
+    entry->data ^= 1u << 4;
+    assert(!ttable_probe(&table, 5 + 0 * stride, &result));
+    entry->data = saved;
+    assert(ttable_probe(&table, 5 + 0 * stride, &result));
+    ttable_free(&table);
+
+    /* Test concurrent use: every hit must be the result stored for its key */
+    Worker workers[THREADS];
+    pthread_t threads[THREADS];
+    assert(ttable_init(&table, 1));
+    for (int i = 0; i < THREADS; i++) {
+        workers[i].table = &table;
+        workers[i].seed = i + 1;
+        workers[i].mismatches = 0;
+        assert(pthread_create(&threads[i], NULL, hammer, &workers[i]) == 0);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        assert(workers[i].mismatches == 0);
+    }
+
+    /* Test the stats */
+    ttable_stats(&table, &stats);
+    assert(stats.buckets == table.mask + 1 && stats.bytes == 1u << 20);
+    assert(stats.probes + stats.stores == (uint64_t)THREADS * THREAD_OPS);
+    assert(stats.hits > 0 && stats.hits <= stats.probes);
+    assert(stats.hit_rate > 0.5 && stats.hit_rate <= 1.0);
+    assert(stats.occupancy > 0.0 && stats.occupancy <= 1.0);
+    assert(stats.current == stats.occupancy);
+    ttable_new_search(&table);
+    ttable_stats(&table, &stats);
+    assert(stats.current == 0.0 && stats.occupancy > 0.0);
+    ttable_clear(&table);
+    ttable_stats(&table, &stats);
+    assert(stats.probes == 0 && stats.occupancy == 0.0);
+    ttable_free(&table);
+
+    /* Test the position key: racks count, the order of their tiles does not */
+    assert(game_new(3));
+    GameState *state = game_get_state();
+    uint64_t position = game_position_hash();
+    assert(position != game_hash());
+    char rack[RACK_SIZE + 1];
+    strcpy(rack, state->racks[0]);
+    size_t length = strlen(rack);
+    for (size_t i = 0; i < length; i++) {
+        state->racks[0][i] = rack[length - 1 - i];
+    }
+    assert(game_position_hash() == position);
+    state->racks[0][0] = state->racks[0][0] == 'Q' ? 'Z' : 'Q';
+    assert(game_position_hash() != position);
+    strcpy(state->racks[0], rack);
+    assert(game_position_hash() == position);
+
+    printf("Transposition table tests passed!\n");
+    return EXIT_SUCCESS;
+}
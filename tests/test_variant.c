@@ -0,0 +1,202 @@
+/**
+ * XScrabble - Rule Variant Tests
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../include/variant.h"
+#include "../include/board.h"
+#include "../include/game.h"
+#include "../include/movegen.h"
+#include "../include/record.h"
+#include "../include/tiles.h"
+
+#define MAX_PLIES 48
+
+static const char *words[] = {
+    "aa", "ab", "ad", "ae", "ag", "ah", "ai", "al", "am", "an", "ar", "as", "at", "aw",
+    "ax", "ay", "ba", "be", "bi", "bo", "by", "de", "do", "ed", "ef", "eh", "el", "em",
+    "en", "er", "es", "et", "ex", "fa", "go", "ha", "he", "hi", "hm", "ho", "id", "if",
+    "in", "is", "it", "jo", "ka", "la", "li", "lo", "ma", "me", "mi", "mo", "mu", "my",
+    "na", "ne", "no", "nu", "od", "oe", "of", "oh", "oi", "om", "on", "op", "or", "os",
+    "ow", "ox", "oy", "pa", "pe", "pi", "re", "sh", "si", "so", "ta", "ti", "to", "uh",
+    "um", "un", "up", "us", "ut", "we", "wo", "xi", "xu", "ya", "ye", "yo", "za",
+    "eat", "tea", "ate", "rat", "tar", "art", "net", "ten", "tone", "note", "stone",
+    "onset", "notes", "rates", "stare", "tears", "aster", "irate", "retain", "ratine"
+};
+
+/* Board geometry, premiums and tile set of the selected variant */
+static void check_geometry(const Variant *variant, int tiles)
+{
+    int size = variant->board_size;
+    const BoardLayout *layout;
+
+    assert(variant_select(variant->name));
+    assert(variant_current() == variant);
+    assert(tiles_total() == tiles);
+    assert((int)strlen(variant->premiums) == size * size);
+
+    assert(board_init());
+    assert(board_variant() == variant);
+    assert(board_size() == size);
+    assert(board_get_cell(size - 1, size - 1) != NULL);
+    assert(board_get_cell(size, 0) == NULL && board_get_cell(0, size) == NULL);
+    assert(board_get_cell_type(0, 0) == CELL_TRIPLE_WORD);
+
+    /* Squares past the board are border in both orientations */
+    layout = board_layout();
+    for (int d = BOARD_ACROSS; d <= BOARD_DOWN; d++) {
+        for (int line = 1; line <= size; line++) {
+            assert(!(layout->flags[d][line][size] & BOARD_SQUARE_BORDER));
+            assert(layout->flags[d][line][size + 1] & BOARD_SQUARE_BORDER);
+        }
+        assert(layout->flags[d][size + 1][1] & BOARD_SQUARE_BORDER);
+    }
+}
+
+/* Every move fits the board, scores like the game scores it and opens on the centre */
+static void check_moves(const MoveList *list, bool opening)
+{
+    int size = board_size();
+    for (int i = 0; i < list->count; i++) {
+        const Move *move = &list->moves[i];
+        int across = move->direction == MOVE_ACROSS;
+        assert(move->row < size && move->col < size);
+        assert((across ? move->col : move->row) + move->length <= size);
+        assert(move->tiles_played <= board_variant()->rack_size);
+        assert(game_score_move(move) == move->score);
+        if (opening) {
+            int center = size / 2;
+            assert((across ? move->row : move->col) == center);
+            assert((across ? move->col : move->row) <= center);
+            assert((across ? move->col : move->row) + move->length > center);
+        }
+    }
+}
+
+/* Play a greedy recorded game under the selected variant, checking every list */
+static int play_recorded(const Dawg *dawg, GameRecord *record, uint64_t seed)
+{
+    GameState *state = game_get_state();
+    MoveList list;
+    int plies = 0;
+
+    movegen_list_init(&list);
+    assert(game_new(seed));
+    assert((int)strlen(state->racks[0]) == board_variant()->rack_size);
+    assert((int)strlen(state->racks[1]) == board_variant()->rack_size);
+    assert(record_begin(record, "TEST", state));
+
+    while (!game_is_over() && plies < MAX_PLIES) {
+        int player = state->to_move;
+        Move pass = {0};
+        const Move *move;
+
+        pass.type = MOVE_PASS;
+        movegen_generate(dawg, state->racks[player], &list);
+        check_moves(&list, plies == 0);
+
+        /* Streaming and bounds agree with the full list */
+        Move best;
+        move = movegen_best(&list);
+        assert(movegen_top_k(dawg, state->racks[player], &best, 1) == (move ? 1 : 0));
+        assert(!move || best.score == move->score);
+        if (!move) {
+            move = &pass;
+        }
+        assert(game_play_move(move));
+        assert(record_add_move(record, player, move, state->last_drawn));
+        plies++;
+    }
+    assert(record_finish(record, state->scores));
+    movegen_list_free(&list);
+    return plies;
+}
+
+int main(void)
+{
+    printf("Running rule variant tests...\n");
+
+    /* Test lookup */
+    assert(variant_find("standard") == variant_get(VARIANT_STANDARD));
+    assert(variant_find("super") == variant_get(VARIANT_SUPER));
+    assert(variant_find("quick") == variant_get(VARIANT_QUICK));
+    assert(variant_find("huge") == NULL);
+    assert(variant_get(VARIANT_COUNT) == NULL);
+    assert(!variant_select("huge"));
+    assert(variant_current() == variant_get(VARIANT_STANDARD));
+
+    /* Test the numbers of each variant */
+    const Variant *standard = variant_get(VARIANT_STANDARD);
+    const Variant *super = variant_get(VARIANT_SUPER);
+    const Variant *quick = variant_get(VARIANT_QUICK);
+    assert(standard->board_size == 15 && standard->rack_size == 7 && standard->bingo_bonus == 50);
+    assert(super->board_size == 21 && super->rack_size == 7 && super->bingo_bonus == 50);
+    assert(quick->board_size == 11 && quick->rack_size == 6 && quick->bingo_bonus == 30);
+
+    /* Test board geometry and tile sets */
+    check_geometry(super, 200);
+    check_geometry(quick, 54);
+    check_geometry(standard, 100);
+
+    /* Test generation, scoring and records on the non-standard boards */
+    Dawg *dawg = dawg_build(words, sizeof(words) / sizeof(words[0]));
+    assert(dawg != NULL);
+    const Variant *played[] = {super, quick};
+    for (int v = 0; v < 2; v++) {
+        GameRecord record;
+        RecordReader reader;
+
+        assert(variant_select(played[v]->name));
+        record_init(&record);
+        int plies = play_recorded(dawg, &record, 11 + v);
+        assert(plies > 2);
+        GameState final = *game_get_state();
+        char letters[BOARD_SQUARES];
+        board_snapshot(letters);
+
+        /* The record names its variant and replays under it */
+        assert(record_reader_open(&reader, record.data, record.size));
+        assert(reader.variant == played[v]);
+        assert(record_replay(&reader, -1) == plies);
+        char replayed[BOARD_SQUARES];
+        board_snapshot(replayed);
+        assert(memcmp(letters, replayed, sizeof(letters)) == 0);
+        assert(game_get_state()->scores[0] == final.scores[0]);
+        assert(game_get_state()->scores[1] == final.scores[1]);
+
+        /* And not under another */
+        assert(variant_select("standard"));
+        assert(record_reader_open(&reader, record.data, record.size));
+        assert(record_replay(&reader, -1) == -1);
+        record_free(&record);
+    }
+
+    /* Test a bingo: the whole rack, with the variant's bonus */
+    assert(variant_select("quick"));
+    assert(game_setup("RETAIN", "EEEEEE", 40));
+    MoveList list;
+    movegen_list_init(&list);
+    assert(movegen_generate(dawg, "RETAIN", &list) > 0);
+    const Move *bingo = NULL;
+    for (int i = 0; i < list.count; i++) {
+        if (list.moves[i].tiles_played == 6) {
+            bingo = &list.moves[i];
+        }
+    }
+    assert(bingo != NULL);
+    Move plain = *bingo;
+    plain.tiles_played = 5;
+    assert(game_score_move(bingo) == game_score_move(&plain) + 30);
+    movegen_list_free(&list);
+
+    /* Clean up */
+    movegen_cache_free();
+    dawg_free(dawg);
+    assert(variant_select("standard"));
+
+    printf("Rule variant tests passed!\n");
+    return EXIT_SUCCESS;
+}
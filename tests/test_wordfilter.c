@@ -0,0 +1,70 @@
+/**
+ * XScrabble - Word Prefilter Tests
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../include/wordfilter.h"
+
+#define WORD_COUNT 50000
+#define QUERY_COUNT 200000
+
+/* Deterministic pseudo-words: even seeds are added, odd ones are not */
+static void make_word(unsigned seed, char *word)
+{
+    unsigned x = seed * 2654435761u + 12345u;
+    int length = 2 + seed % 9;
+    for (int i = 0; i < length; i++) {
+        x = x * 1103515245u + 12345u;
+        word[i] = 'a' + (x >> 16) % 26;
+    }
+    snprintf(word + length, 8, "%u", seed);
+}
+
+int main(void)
+{
+    WordFilter filter = {0};
+    char word[32];
+
+    printf("Running word filter tests...\n");
+
+    /* Test that an unbuilt filter rejects nothing */
+    assert(wordfilter_may_contain(&filter, "anything"));
+
+    /* Test that added words are always accepted, in any case */
+    assert(wordfilter_init(&filter, WORD_COUNT));
+    assert(wordfilter_bytes(&filter) < 2 * WORD_COUNT);
+    assert((uintptr_t)filter.blocks % 64 == 0);
+    for (unsigned i = 0; i < WORD_COUNT; i++) {
+        make_word(2 * i, word);
+        wordfilter_add(&filter, word);
+    }
+    for (unsigned i = 0; i < WORD_COUNT; i++) {
+        make_word(2 * i, word);
+        assert(wordfilter_may_contain(&filter, word));
+        word[0] -= 'a' - 'A';
+        assert(wordfilter_may_contain(&filter, word));
+    }
+
+    /* Test the false positive rate on words never added */
+    int false_positives = 0;
+    for (unsigned i = 0; i < QUERY_COUNT; i++) {
+        make_word(2 * i + 1, word);
+        false_positives += wordfilter_may_contain(&filter, word);
+    }
+    printf("False positives: %d of %d\n", false_positives, QUERY_COUNT);
+    assert(false_positives < QUERY_COUNT / 100);
+
+    wordfilter_free(&filter);
+    assert(filter.blocks == NULL);
+
+    /* Test the empty word list */
+    assert(wordfilter_init(&filter, 0));
+    assert(!wordfilter_may_contain(&filter, "cat"));
+    wordfilter_free(&filter);
+
+    printf("Word filter tests passed!\n");
+    return EXIT_SUCCESS;
+}